@@ -1,4 +1,8 @@
-#if defined(_POSIX_C_SOURCE) || defined(__linux__) || defined(__unix__)
+#if defined(__linux__)
+    #ifndef _GNU_SOURCE
+        #define _GNU_SOURCE                /* sched_setaffinity for --pin */
+    #endif
+#elif defined(_POSIX_C_SOURCE) || defined(__unix__)
     #ifndef _POSIX_C_SOURCE
         #define _POSIX_C_SOURCE 199309L
     #endif
@@ -6,112 +10,379 @@
 
 #define NANODS_IMPLEMENTATION
 #include "../nanods.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-
-#define ITERATIONS 1000000
-
-#if defined(_WIN32) || defined(_WIN64)
-    #include <windows.h>
-    double get_time_ms(void) {
-        LARGE_INTEGER frequency, counter;
-        QueryPerformanceFrequency(&frequency);
-        QueryPerformanceCounter(&counter);
-        return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
-    }
-#elif defined(__APPLE__) || defined(__MACH__)
-    #include <mach/mach_time.h>
-    double get_time_ms(void) {
-        static mach_timebase_info_data_t timebase;
-        if (timebase.denom == 0) mach_timebase_info(&timebase);
-        uint64_t time = mach_absolute_time();
-        return (double)(time * timebase.numer / timebase. denom) / 1000000.0;
-    }
-#else
-    double get_time_ms(void) {
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
-    }
-#endif
+#include "bench_harness.h"
+
+/*
+ * NanoDS against plain baselines: a realloc-doubling vector, qsort and a
+ * textbook chained hash map, plus a sorted list as a timer queue. Run with
+ * --json FILE to record the numbers.
+ */
+
+#define VECTOR_OPS 1000000
+#define SORT_N 1000000
+#define MAP_KEYS 100000
+#define TIMER_PENDING 1024
+#define TIMER_OPS 50000
 
-/* Naive implementation for comparison */
+/* Keeps results alive so the optimizer cannot drop the loops */
+static volatile uintptr_t sink;
+
+/* ---- Baselines ----------------------------------------------------------------- */
+
+/* Naive vector: no checks, same growth policy */
 typedef struct {
     int* data;
     size_t size;
     size_t capacity;
 } NaiveVector;
 
-void naive_init(NaiveVector* vec) {
-    vec->data = NULL;
-    vec->size = 0;
-    vec->capacity = 0;
-}
-
-void naive_push(NaiveVector* vec, int value) {
+static void naive_push(NaiveVector* vec, int value) {
     if (vec->size >= vec->capacity) {
         size_t new_cap = vec->capacity == 0 ? 8 : vec->capacity * 2;
-        vec->data = realloc(vec->data, new_cap * sizeof(int));
+        vec->data = nb_realloc(vec->data, new_cap * sizeof(int));
         vec->capacity = new_cap;
     }
     vec->data[vec->size++] = value;
 }
 
-void naive_free(NaiveVector* vec) {
-    free(vec->data);
+static void naive_free(NaiveVector* vec) {
+    nb_free(vec->data);
     vec->data = NULL;
     vec->size = 0;
     vec->capacity = 0;
 }
 
-int main(void) {
+/* Reference map: separate chaining, djb2, node and key allocated separately, unseeded */
+typedef struct RefNode {
+    struct RefNode* next;
+    char* key;
+    void* value;
+} RefNode;
+
+typedef struct {
+    RefNode** buckets;
+    size_t bucket_count;
+    size_t size;
+} RefMap;
+
+static size_t ref_hash(const char* key) {
+    size_t h = 5381;
+    while (*key) h = h * 33 + (unsigned char)*key++;
+    return h;
+}
+
+static void ref_init(RefMap* map) {
+    map->bucket_count = 16;
+    map->size = 0;
+    map->buckets = nb_malloc(map->bucket_count * sizeof(RefNode*));
+    memset(map->buckets, 0, map->bucket_count * sizeof(RefNode*));
+}
+
+static void ref_grow(RefMap* map) {
+    size_t count = map->bucket_count * 2;
+    RefNode** buckets = nb_malloc(count * sizeof(RefNode*));
+    memset(buckets, 0, count * sizeof(RefNode*));
+    for (size_t i = 0; i < map->bucket_count; i++) {
+        RefNode* node = map->buckets[i];
+        while (node) {
+            RefNode* next = node->next;
+            size_t b = ref_hash(node->key) & (count - 1);
+            node->next = buckets[b];
+            buckets[b] = node;
+            node = next;
+        }
+    }
+    nb_free(map->buckets);
+    map->buckets = buckets;
+    map->bucket_count = count;
+}
+
+static void ref_set(RefMap* map, const char* key, void* value) {
+    size_t b = ref_hash(key) & (map->bucket_count - 1);
+    for (RefNode* node = map->buckets[b]; node; node = node->next) {
+        if (strcmp(node->key, key) == 0) {
+            node->value = value;
+            return;
+        }
+    }
+    size_t len = strlen(key) + 1;
+    RefNode* node = nb_malloc(sizeof(RefNode));
+    node->key = nb_malloc(len);
+    memcpy(node->key, key, len);
+    node->value = value;
+    node->next = map->buckets[b];
+    map->buckets[b] = node;
+    if (++map->size > map->bucket_count) ref_grow(map);
+}
+
+static void* ref_get(const RefMap* map, const char* key) {
+    size_t b = ref_hash(key) & (map->bucket_count - 1);
+    for (RefNode* node = map->buckets[b]; node; node = node->next) {
+        if (strcmp(node->key, key) == 0) return node->value;
+    }
+    return NULL;
+}
+
+static void ref_free(RefMap* map) {
+    for (size_t i = 0; i < map->bucket_count; i++) {
+        RefNode* node = map->buckets[i];
+        while (node) {
+            RefNode* next = node->next;
+            nb_free(node->key);
+            nb_free(node);
+            node = next;
+        }
+    }
+    nb_free(map->buckets);
+    map->buckets = NULL;
+    map->bucket_count = 0;
+    map->size = 0;
+}
+
+/* ---- Cases --------------------------------------------------------------------- */
+
+static NaiveVector g_naive;
+static IntVector g_vec;
+
+static void reset_push(void* ctx) {
+    (void)ctx;
+    naive_free(&g_naive);
+    nv_free_int(&g_vec);
+    nv_init_int(&g_vec);
+}
+
+static void run_naive_push(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) naive_push(&g_naive, (int)i);
+}
+
+static void run_nv_push(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) nv_push_int(&g_vec, (int)i);
+}
+
+static int* g_unsorted;
+static IntVector g_sort;
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static void reset_sort(void* ctx) {
+    (void)ctx;
+    memcpy(g_sort.data, g_unsorted, SORT_N * sizeof(int));
+}
+
+/* Whole trial: a sort cannot be split */
+static void run_qsort(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    qsort(g_sort.data, g_sort.size, sizeof(int), compare_int);
+}
+
+static void run_nv_sort(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_sort_int(&g_sort);
+}
+
+static void run_nv_radix_sort(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_radix_sort_int(&g_sort);
+}
+
+static char g_keys[MAP_KEYS][16];
+static int g_values[MAP_KEYS];
+static RefMap g_ref_build, g_ref;
+static NanoMap g_nm_build, g_nm;
+static NanoFlatMap g_nfm_build, g_nfm;
+
+static void reset_map_build(void* ctx) {
+    (void)ctx;
+    if (g_ref_build.buckets) ref_free(&g_ref_build);
+    ref_init(&g_ref_build);
+    nm_free(&g_nm_build);
+    nm_init(&g_nm_build);
+    nfm_free(&g_nfm_build);
+    nfm_init(&g_nfm_build);
+}
+
+static void run_ref_build(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) ref_set(&g_ref_build, g_keys[i], &g_values[i]);
+}
+
+static void run_nm_build(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) nm_set(&g_nm_build, g_keys[i], &g_values[i]);
+}
+
+static void run_nfm_build(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) nfm_set(&g_nfm_build, g_keys[i], &g_values[i]);
+}
+
+static void run_ref_get(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)ref_get(&g_ref, g_keys[i]);
+}
+
+static void run_nm_get(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nm_get(&g_nm, g_keys[i]);
+}
+
+static void run_nfm_get(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nfm_get(&g_nfm, g_keys[i]);
+}
+
+/* Timer queue, hold model: take the earliest deadline, re-arm it a random delay later */
+static IntList2 g_timer_list;
+static IntHeap g_timer_heap;
+static int g_timer_delays[TIMER_OPS];
+
+/* Sorted insert scanning back from the latest deadline */
+static void timer_list_insert(IntList2* list, int deadline) {
+    NanoList2Node_int* node = list->tail;
+    while (node && node->data > deadline) node = node->prev;
+    if (node) {
+        nl2_insert_after_int(list, node, deadline);
+    } else {
+        nl2_push_front_int(list, deadline);
+    }
+}
+
+static void reset_timers(void* ctx) {
+    (void)ctx;
+    nl2_free_int(&g_timer_list);
+    nl2_init_int(&g_timer_list);
+    nh_clear_int(&g_timer_heap);
+    for (int i = 0; i < TIMER_PENDING; i++) {
+        timer_list_insert(&g_timer_list, g_timer_delays[i]);
+        nh_push_int(&g_timer_heap, g_timer_delays[i]);
+    }
+}
+
+static void run_timer_list(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    int now;
+    for (size_t i = begin; i < end; i++) {
+        nl2_pop_front_int(&g_timer_list, &now);
+        timer_list_insert(&g_timer_list, now + g_timer_delays[i]);
+    }
+}
+
+static void run_timer_heap(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    int now;
+    for (size_t i = begin; i < end; i++) {
+        nh_pop_int(&g_timer_heap, &now);
+        nh_push_int(&g_timer_heap, now + g_timer_delays[i]);
+    }
+}
+
+static void run_timer_heap_replace(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    int now;
+    for (size_t i = begin; i < end; i++) {
+        nh_peek_int(&g_timer_heap, &now);
+        nh_replace_top_int(&g_timer_heap, now + g_timer_delays[i], NULL);
+    }
+}
+
+int main(int argc, char** argv) {
     printf("==============================================\n");
-    printf("  NanoDS v%s vs Naive Implementation\n", NANODS_VERSION);
+    printf("  NanoDS v%s vs Baselines\n", NANODS_VERSION);
     printf("==============================================\n\n");
-    
+
     nanods_seed_init(0);
-    
-    /* Benchmark NanoDS */
-    {
-        IntVector vec;
-        nv_init_int(&vec);
-        
-        double start = get_time_ms();
-        for (int i = 0; i < ITERATIONS; i++) {
-            nv_push_int(&vec, i);
-        }
-        double end = get_time_ms();
-        
-        printf("NanoDS Vector:\n");
-        printf("  Time:       %.2f ms\n", end - start);
-        printf("  Throughput: %.0f ops/sec\n", ITERATIONS / ((end - start) / 1000.0));
-        printf("  Features:   Type-safe, bounds-checked, overflow-protected\n\n");
-        
-        nv_free_int(&vec);
+    nb_init(argc, argv, "comparison");
+
+    /* Vector push: growth and bounds/overflow checks vs none */
+    nv_init_int(&g_vec);
+    nb_run(&(NanoBenchCase){ "vector_push", "naive", NULL, VECTOR_OPS,
+                             run_naive_push, reset_push, NULL });
+    nb_run(&(NanoBenchCase){ "vector_push", "nanods", "naive", VECTOR_OPS,
+                             run_nv_push, reset_push, NULL });
+    naive_free(&g_naive);
+    nv_free_int(&g_vec);
+
+    /* Sort: the same shuffled input each trial */
+    g_unsorted = malloc(SORT_N * sizeof(int));
+    uint32_t x = 2463534242u;
+    for (int i = 0; i < SORT_N; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        g_unsorted[i] = (int)x;
     }
-    
-    /* Benchmark Naive */
-    {
-        NaiveVector vec;
-        naive_init(&vec);
-        
-        double start = get_time_ms();
-        for (int i = 0; i < ITERATIONS; i++) {
-            naive_push(&vec, i);
-        }
-        double end = get_time_ms();
-        
-        printf("Naive Vector (no safety):\n");
-        printf("  Time:       %.2f ms\n", end - start);
-        printf("  Throughput:  %.0f ops/sec\n", ITERATIONS / ((end - start) / 1000.0));
-        printf("  Features:   No safety checks\n\n");
-        
-        naive_free(&vec);
+    nv_init_int(&g_sort);
+    nv_extend_int(&g_sort, g_unsorted, SORT_N);
+    nb_run_whole(&(NanoBenchCase){ "sort", "qsort", NULL, SORT_N,
+                                   run_qsort, reset_sort, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sort", "nv_sort", "qsort", SORT_N,
+                                   run_nv_sort, reset_sort, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sort", "nv_radix_sort", "qsort", SORT_N,
+                                   run_nv_radix_sort, reset_sort, NULL });
+    nv_free_int(&g_sort);
+    free(g_unsorted);
+
+    /* String-keyed maps: build from empty, then look every key up */
+    for (int i = 0; i < MAP_KEYS; i++) {
+        snprintf(g_keys[i], sizeof(g_keys[i]), "key_%d", i);
+        g_values[i] = i;
+    }
+    nm_init(&g_nm_build);
+    nfm_init(&g_nfm_build);
+    nb_run(&(NanoBenchCase){ "map_build", "reference", NULL, MAP_KEYS,
+                             run_ref_build, reset_map_build, NULL });
+    nb_run(&(NanoBenchCase){ "map_build", "nanomap", "reference", MAP_KEYS,
+                             run_nm_build, reset_map_build, NULL });
+    nb_run(&(NanoBenchCase){ "map_build", "flatmap", "reference", MAP_KEYS,
+                             run_nfm_build, reset_map_build, NULL });
+    ref_free(&g_ref_build);
+    nm_free(&g_nm_build);
+    nfm_free(&g_nfm_build);
+
+    ref_init(&g_ref);
+    nm_init(&g_nm);
+    nfm_init(&g_nfm);
+    for (int i = 0; i < MAP_KEYS; i++) {
+        ref_set(&g_ref, g_keys[i], &g_values[i]);
+        nm_set(&g_nm, g_keys[i], &g_values[i]);
+        nfm_set(&g_nfm, g_keys[i], &g_values[i]);
     }
+    nb_run(&(NanoBenchCase){ "map_get", "reference", NULL, MAP_KEYS, run_ref_get, NULL, NULL });
+    nb_run(&(NanoBenchCase){ "map_get", "nanomap", "reference", MAP_KEYS, run_nm_get, NULL, NULL });
+    nb_run(&(NanoBenchCase){ "map_get", "flatmap", "reference", MAP_KEYS, run_nfm_get, NULL, NULL });
+    ref_free(&g_ref);
+    nm_free(&g_nm);
+    nfm_free(&g_nfm);
     
-    printf("==============================================\n");
-    printf("Result: NanoDS provides safety with minimal overhead\n");
-    printf("==============================================\n");
-    return 0;
-}
\ No newline at end of file
+    /* Timer queue: sorted list insert is O(n), the 4-ary heap O(log n) */
+    for (int i = 0; i < TIMER_OPS; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        g_timer_delays[i] = (int)(x % 4096);
+    }
+    nl2_init_int(&g_timer_list);
+    nh_init_int(&g_timer_heap);
+    nb_run(&(NanoBenchCase){ "timer_queue", "sorted_list2", NULL, TIMER_OPS,
+                             run_timer_list, reset_timers, NULL });
+    nb_run(&(NanoBenchCase){ "timer_queue", "nanoheap", "sorted_list2", TIMER_OPS,
+                             run_timer_heap, reset_timers, NULL });
+    nb_run(&(NanoBenchCase){ "timer_queue", "nanoheap_replace", "sorted_list2", TIMER_OPS,
+                             run_timer_heap_replace, reset_timers, NULL });
+    nl2_free_int(&g_timer_list);
+    nh_free_int(&g_timer_heap);
+
+    printf("\n==============================================\n");
+    return nb_finish();
+}
@@ -0,0 +1,146 @@
+#if defined(__linux__)
+    #ifndef _GNU_SOURCE
+        #define _GNU_SOURCE                /* sched_setaffinity for --pin */
+    #endif
+#elif defined(_POSIX_C_SOURCE) || defined(__unix__)
+    #ifndef _POSIX_C_SOURCE
+        #define _POSIX_C_SOURCE 199309L
+    #endif
+#endif
+
+#define NANODS_IMPLEMENTATION
+#define NANODS_ENABLE_THREADS
+#include "../nanods.h"
+#include "bench_harness.h"
+
+/*
+ * 1-16 threads hammering KEYS keys in a mutex-guarded NanoMap vs a
+ * NanoConcurrentMap, with only lookups (reads_4t, ...) and with one set in
+ * 20 operations (mixed_4t, ...). ns/op is per operation across all threads.
+ * Same options as bench_comparison; --pin confines every thread to one CPU.
+ */
+
+#ifndef NANODS_HAVE_THREADS
+int main(void) {
+    printf("bench_concurrent_map needs C11 atomics and pthreads; skipped\n");
+    return 0;
+}
+#else
+
+#ifndef OPS_PER_THREAD
+    #define OPS_PER_THREAD 100000
+#endif
+#define KEYS 10000
+#define MAX_THREADS 16
+
+typedef enum { MODE_MUTEX, MODE_SHARDED } Mode;
+
+static Mode g_mode;
+static int g_write_every;   /* One ncm_set/nm_set per this many operations (0: reads only) */
+static char g_keys[KEYS][16];
+static int g_values[KEYS];
+static NanoMap g_map;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static NanoConcurrentMap g_cmap;
+static _Atomic long long g_hits;
+
+static void* worker(void* arg) {
+    unsigned x = (unsigned)(uintptr_t)arg * 2654435761u + 1;
+    long long hits = 0;
+    for (int i = 0; i < OPS_PER_THREAD; i++) {
+        x = x * 1664525u + 1013904223u;
+        int k = (int)((x >> 8) % KEYS);
+        int write = g_write_every && i % g_write_every == 0;
+        if (g_mode == MODE_MUTEX) {
+            /* The simplest baseline: one lock for reads and writes alike */
+            pthread_mutex_lock(&g_lock);
+            if (write) {
+                nm_set(&g_map, g_keys[k], &g_values[k]);
+            } else {
+                hits += nm_get(&g_map, g_keys[k]) != NULL;
+            }
+            pthread_mutex_unlock(&g_lock);
+        } else if (write) {
+            ncm_set(&g_cmap, g_keys[k], &g_values[k]);
+        } else {
+            hits += ncm_get(&g_cmap, g_keys[k]) != NULL;
+        }
+    }
+    atomic_fetch_add(&g_hits, hits);
+    return NULL;
+}
+
+typedef struct {
+    Mode mode;
+    int threads;
+    int write_every;
+} MapBench;
+
+static int g_lookups_ok = 1;
+
+static void reset_hits(void* ctx) {
+    (void)ctx;
+    atomic_store(&g_hits, 0);
+}
+
+/* Whole trial; thread start-up is inside the timed region, as it was before the harness */
+static void run_map(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    (void)begin;
+    (void)end;
+    pthread_t tids[MAX_THREADS];
+    g_mode = b->mode;
+    g_write_every = b->write_every;
+    for (int t = 0; t < b->threads; t++) {
+        pthread_create(&tids[t], NULL, worker, (void*)(uintptr_t)t);
+    }
+    for (int t = 0; t < b->threads; t++) pthread_join(tids[t], NULL);
+    
+    /* Every key is present throughout, so every lookup must hit */
+    long long reads = 0;
+    for (int i = 0; i < OPS_PER_THREAD; i++) reads += !(b->write_every && i % b->write_every == 0);
+    if (atomic_load(&g_hits) != reads * b->threads) g_lookups_ok = 0;
+}
+
+int main(int argc, char** argv) {
+    printf("==============================================\n");
+    printf("  NanoDS v%s Concurrent Map Benchmark\n", NANODS_VERSION);
+    printf("==============================================\n\n");
+    
+    nanods_seed_init(0);
+    nb_init(argc, argv, "concurrent_map");
+    nm_init(&g_map);
+    ncm_init(&g_cmap, 0);
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(g_keys[i], sizeof(g_keys[i]), "session_%d", i);
+        g_values[i] = i;
+        nm_set(&g_map, g_keys[i], &g_values[i]);
+        ncm_set(&g_cmap, g_keys[i], &g_values[i]);
+    }
+    
+    static const int write_every[] = {0, 20};
+    static const char* groups[2][5] = {
+        { "reads_1t", "reads_2t", "reads_4t", "reads_8t", "reads_16t" },
+        { "mixed_1t", "mixed_2t", "mixed_4t", "mixed_8t", "mixed_16t" }
+    };
+    static MapBench benches[2][5][2];
+    for (int m = 0; m < 2; m++) {
+        for (int t = 0, threads = 1; threads <= MAX_THREADS; t++, threads *= 2) {
+            size_t ops = (size_t)OPS_PER_THREAD * (size_t)threads;
+            benches[m][t][0] = (MapBench){ MODE_MUTEX, threads, write_every[m] };
+            benches[m][t][1] = (MapBench){ MODE_SHARDED, threads, write_every[m] };
+            nb_run_whole(&(NanoBenchCase){ groups[m][t], "mutex_map", NULL, ops,
+                                           run_map, reset_hits, &benches[m][t][0] });
+            nb_run_whole(&(NanoBenchCase){ groups[m][t], "concurrent_map", "mutex_map", ops,
+                                           run_map, reset_hits, &benches[m][t][1] });
+        }
+    }
+    if (!g_lookups_ok) printf("  concurrent_map: lookup missed!\n");
+    
+    nm_free(&g_map);
+    ncm_free(&g_cmap);
+    printf("\n==============================================\n");
+    int rc = nb_finish();
+    return g_lookups_ok ? rc : 1;
+}
+#endif
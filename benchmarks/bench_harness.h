@@ -0,0 +1,387 @@
+/**
+ * @file bench_harness.h
+ * @brief Shared timing, statistics and JSON reporting for the benchmarks
+ *
+ * Include after nanods.h. Every benchmark uses get_time_ms() from here; the
+ * suites built on nb_run() also get warmup, repeated trials, percentiles,
+ * allocation counts and a JSON report:
+ *
+ *     nb_init(argc, argv, "comparison");
+ *     nb_run(&(NanoBenchCase){ .group = "map", .name = "nm_get", .ops = N,
+ *                              .run = run_get, .reset = NULL, .ctx = &data });
+ *     return nb_finish();
+ *
+ * Options: --trials N, --warmup N, --batch N, --pin CPU, --json FILE,
+ * --filter TEXT. Each trial calls reset (untimed), then run(ctx, begin, end)
+ * on consecutive ranges of `batch` operations until all `ops` are done,
+ * timing every call. p50/p99/max are over those per-batch ns/op samples;
+ * mean is the average of the per-trial ns/op. A case that cannot be split
+ * (a sort, a threaded handoff) goes through nb_run_whole() instead, which
+ * calls run(ctx, 0, ops) once per trial; with one sample per trial its p99
+ * is left out below 100 trials, where it would equal max.
+ */
+
+#ifndef NANODS_BENCH_HARNESS_H
+#define NANODS_BENCH_HARNESS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+    static inline double get_time_ms(void) {
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
+    }
+#elif defined(__APPLE__) || defined(__MACH__)
+    #include <mach/mach_time.h>
+    static inline double get_time_ms(void) {
+        static mach_timebase_info_data_t timebase;
+        if (timebase.denom == 0) mach_timebase_info(&timebase);
+        uint64_t time = mach_absolute_time();
+        return (double)(time * timebase.numer / timebase.denom) / 1000000.0;
+    }
+#else
+    static inline double get_time_ms(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+    }
+#endif
+
+/* CPU pinning needs the GNU affinity API (define _GNU_SOURCE before any include) */
+#if defined(__linux__) && defined(_GNU_SOURCE)
+    #include <sched.h>
+    #define NB_HAVE_PIN 1
+#endif
+
+#ifndef NB_MAX_RESULTS
+    #define NB_MAX_RESULTS 128
+#endif
+#define NB_MAX_TRIALS 1000
+
+/* Operations per timed call of run: small enough for ~1000 samples per trial
+ * of a 1M-operation case, large enough that the clock reads stay under 2% */
+#ifndef NB_BATCH
+    #define NB_BATCH 1024
+#endif
+#define NB_MIN_P99_SAMPLES 100
+
+typedef struct {
+    const char* group;                     /* Cases in one group are compared */
+    const char* name;
+    const char* baseline;                  /* Earlier case in the group to compare with, or NULL */
+    size_t ops;                            /* Operations per trial */
+    void (*run)(void* ctx, size_t begin, size_t end); /* Timed: operations [begin, end) */
+    void (*reset)(void* ctx);              /* Before every trial, untimed; may be NULL */
+    void* ctx;
+} NanoBenchCase;
+
+typedef struct {
+    const char* group;
+    const char* name;
+    const char* baseline;
+    size_t ops;
+    int trials;
+    size_t batch;                          /* Operations per sample */
+    size_t samples;
+    double p50, p99, max, min;             /* ns/op over the batch samples; p99 < 0: too few */
+    double mean;                           /* ns/op averaged over trials */
+    double bytes;                          /* Bytes requested per trial */
+    double allocs;                         /* malloc/realloc calls per trial */
+    double speedup;                        /* baseline mean / mean; 0 without a baseline */
+} NanoBenchResult;
+
+typedef struct {
+    const char* suite;
+    const char* json_path;
+    const char* filter;
+    int trials;
+    int warmup;
+    size_t batch;
+    int pin_cpu;                           /* -1: not pinned */
+    size_t result_count;
+    NanoBenchResult results[NB_MAX_RESULTS];
+} NanoBench;
+
+static NanoBench g_nb = { "bench", NULL, NULL, 21, 3, NB_BATCH, -1, 0, {{0}} };
+
+/* ---- Counting allocator ------------------------------------------------------ */
+
+/* Relaxed atomics where available: threaded cases allocate from several threads */
+#ifdef NANODS_HAVE_ATOMICS
+    static NANODS_ATOMIC(size_t) g_nb_bytes;
+    static NANODS_ATOMIC(size_t) g_nb_allocs;
+    #define NB_COUNT(counter, n) ((void)NANODS_ATOMIC_FETCH_ADD(&(counter), (n), NANODS_MO_RELAXED))
+    #define NB_READ(counter) NANODS_ATOMIC_LOAD(&(counter), NANODS_MO_RELAXED)
+#else
+    static size_t g_nb_bytes;
+    static size_t g_nb_allocs;
+    #define NB_COUNT(counter, n) ((void)((counter) += (n)))
+    #define NB_READ(counter) (counter)
+#endif
+
+/* Also called directly by baselines, so both sides of a comparison are counted */
+static inline void* nb_malloc(size_t size) {
+    NB_COUNT(g_nb_bytes, size);
+    NB_COUNT(g_nb_allocs, 1);
+    return malloc(size);
+}
+
+static inline void* nb_realloc(void* ptr, size_t size) {
+    NB_COUNT(g_nb_bytes, size);
+    NB_COUNT(g_nb_allocs, 1);
+    return realloc(ptr, size);
+}
+
+static inline void nb_free(void* ptr) {
+    free(ptr);
+}
+
+static NanoAllocator g_nb_allocator = { nb_malloc, nb_realloc, nb_free };
+
+/* ---- Setup ------------------------------------------------------------------- */
+
+static inline int nb_pin(int cpu) {
+#ifdef NB_HAVE_PIN
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -1;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+/* Parse options and route NANODS_MALLOC through the counting allocator */
+static inline void nb_init(int argc, char** argv, const char* suite) {
+    g_nb.suite = suite;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val || arg[0] != '-' || arg[1] != '-') {
+            arg = "--help";
+        }
+        if (strcmp(arg, "--trials") == 0) {
+            g_nb.trials = atoi(val);
+        } else if (strcmp(arg, "--warmup") == 0) {
+            g_nb.warmup = atoi(val);
+        } else if (strcmp(arg, "--batch") == 0) {
+            g_nb.batch = (size_t)strtoul(val, NULL, 10);
+        } else if (strcmp(arg, "--pin") == 0) {
+            g_nb.pin_cpu = atoi(val);
+        } else if (strcmp(arg, "--json") == 0) {
+            g_nb.json_path = val;
+        } else if (strcmp(arg, "--filter") == 0) {
+            g_nb.filter = val;
+        } else {
+            fprintf(stderr, "usage: %s [--trials N] [--warmup N] [--batch N] [--pin CPU] "
+                    "[--json FILE] [--filter TEXT]\n", argv[0]);
+            exit(2);
+        }
+        i++;
+    }
+    if (g_nb.trials < 1) g_nb.trials = 1;
+    if (g_nb.trials > NB_MAX_TRIALS) g_nb.trials = NB_MAX_TRIALS;
+    if (g_nb.warmup < 0) g_nb.warmup = 0;
+    if (g_nb.batch < 1) g_nb.batch = 1;
+    if (g_nb.pin_cpu >= 0 && nb_pin(g_nb.pin_cpu) != 0) {
+        fprintf(stderr, "%s: could not pin to CPU %d, running unpinned\n", suite, g_nb.pin_cpu);
+        g_nb.pin_cpu = -1;
+    }
+    nanods_set_allocator(&g_nb_allocator);
+    printf("%d trials after %d warmup, batches of %zu ops, %s\n\n", g_nb.trials, g_nb.warmup,
+           g_nb.batch, g_nb.pin_cpu >= 0 ? "pinned" : "unpinned");
+    printf("  %-28s %10s %10s %10s %10s %10s %12s %8s\n", "case", "ops", "p50 ns", "p99 ns",
+           "max ns", "mean ns", "bytes/trial", "speedup");
+}
+
+/* ---- Running ----------------------------------------------------------------- */
+
+static inline int nb_cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static inline double nb_percentile(const double* sorted, size_t n, double pct) {
+    size_t rank = (size_t)(pct / 100.0 * (double)n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+static inline const NanoBenchResult* nb_find(const char* group, const char* name) {
+    for (size_t i = 0; i < g_nb.result_count; i++) {
+        if (strcmp(g_nb.results[i].group, group) == 0 && strcmp(g_nb.results[i].name, name) == 0) {
+            return &g_nb.results[i];
+        }
+    }
+    return NULL;
+}
+
+/* Run one case in timed calls of `batch` operations and record it; NULL if filtered out */
+static inline const NanoBenchResult* nb_run_batched(const NanoBenchCase* c, size_t batch) {
+    if (g_nb.filter && !strstr(c->group, g_nb.filter) && !strstr(c->name, g_nb.filter)) {
+        return NULL;
+    }
+    if (g_nb.result_count == NB_MAX_RESULTS) {
+        fprintf(stderr, "%s: more than %d cases\n", g_nb.suite, NB_MAX_RESULTS);
+        return NULL;
+    }
+    size_t ops = c->ops ? c->ops : 1;
+    if (batch > ops) batch = ops;
+    size_t per_trial = (ops + batch - 1) / batch;
+    size_t count = per_trial * (size_t)g_nb.trials;
+    /* Plain malloc, outside the timed region: the samples are not the case's allocations */
+    double* samples = (double*)malloc(count * sizeof(double));
+    if (!samples) {
+        fprintf(stderr, "%s: no memory for %zu samples\n", g_nb.suite, count);
+        return NULL;
+    }
+    size_t bytes = 0, allocs = 0;
+    double trial_sum = 0;
+    for (int t = -g_nb.warmup; t < g_nb.trials; t++) {
+        if (c->reset) c->reset(c->ctx);
+        size_t bytes_before = NB_READ(g_nb_bytes), allocs_before = NB_READ(g_nb_allocs);
+        double* out = samples + (size_t)(t < 0 ? 0 : t) * per_trial;
+        double elapsed = 0;
+        for (size_t begin = 0; begin < ops; begin += batch) {
+            size_t end = ops - begin < batch ? ops : begin + batch;
+            double start = get_time_ms();
+            c->run(c->ctx, begin, end);
+            double ms = get_time_ms() - start;
+            elapsed += ms;
+            *out++ = ms * 1e6 / (double)(end - begin);
+        }
+        if (t < 0) continue;
+        trial_sum += elapsed * 1e6 / (double)ops;
+        bytes += NB_READ(g_nb_bytes) - bytes_before;
+        allocs += NB_READ(g_nb_allocs) - allocs_before;
+    }
+
+    NanoBenchResult* r = &g_nb.results[g_nb.result_count++];
+    qsort(samples, count, sizeof(double), nb_cmp_double);
+    r->group = c->group;
+    r->name = c->name;
+    r->baseline = c->baseline;
+    r->ops = c->ops;
+    r->trials = g_nb.trials;
+    r->batch = batch;
+    r->samples = count;
+    r->p50 = nb_percentile(samples, count, 50);
+    r->p99 = count >= NB_MIN_P99_SAMPLES ? nb_percentile(samples, count, 99) : -1;
+    r->min = samples[0];
+    r->max = samples[count - 1];
+    r->mean = trial_sum / g_nb.trials;
+    r->bytes = (double)bytes / g_nb.trials;
+    r->allocs = (double)allocs / g_nb.trials;
+    free(samples);
+    const NanoBenchResult* base = c->baseline ? nb_find(c->group, c->baseline) : NULL;
+    /* Whole-trial throughput: a batch p50 would leave out growth and rehash spikes */
+    r->speedup = (base && r->mean > 0) ? base->mean / r->mean : 0;
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s/%s", c->group, c->name);
+    printf("  %-28s %10zu %10.2f ", label, c->ops, r->p50);
+    if (r->p99 >= 0) {
+        printf("%10.2f", r->p99);
+    } else {
+        printf("%10s", "-");
+    }
+    printf(" %10.2f %10.2f %12.0f", r->max, r->mean, r->bytes);
+    if (r->speedup > 0) {
+        printf(" %7.2fx\n", r->speedup);
+    } else {
+        printf(" %8s\n", base || !c->baseline ? "-" : "?");
+    }
+    return r;
+}
+
+/* Batches of --batch operations */
+static inline const NanoBenchResult* nb_run(const NanoBenchCase* c) {
+    return nb_run_batched(c, g_nb.batch);
+}
+
+/* One timed call per trial, for runs that cannot be split */
+static inline const NanoBenchResult* nb_run_whole(const NanoBenchCase* c) {
+    return nb_run_batched(c, SIZE_MAX);
+}
+
+/* ---- Reporting --------------------------------------------------------------- */
+
+static inline void nb_json_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; s && *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s < 0x20) {
+            fprintf(f, "\\u%04x", (unsigned char)*s);
+        } else {
+            fputc(*s, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static inline int nb_write_json(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "{\n  \"suite\": ");
+    nb_json_string(f, g_nb.suite);
+    fprintf(f, ",\n  \"nanods_version\": ");
+    nb_json_string(f, NANODS_VERSION);
+#if defined(__clang__)
+    fprintf(f, ",\n  \"compiler\": \"clang %d.%d\"", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+    fprintf(f, ",\n  \"compiler\": \"gcc %d.%d\"", __GNUC__, __GNUC_MINOR__);
+#else
+    fprintf(f, ",\n  \"compiler\": \"unknown\"");
+#endif
+    fprintf(f, ",\n  \"timestamp\": %lld", (long long)time(NULL));
+    fprintf(f, ",\n  \"trials\": %d,\n  \"warmup\": %d,\n  \"batch\": %zu,\n  \"pinned_cpu\": %d,"
+            "\n  \"results\": [", g_nb.trials, g_nb.warmup, g_nb.batch, g_nb.pin_cpu);
+    for (size_t i = 0; i < g_nb.result_count; i++) {
+        const NanoBenchResult* r = &g_nb.results[i];
+        fprintf(f, "%s\n    {\"group\": ", i ? "," : "");
+        nb_json_string(f, r->group);
+        fprintf(f, ", \"name\": ");
+        nb_json_string(f, r->name);
+        fprintf(f, ", \"baseline\": ");
+        if (r->baseline) {
+            nb_json_string(f, r->baseline);
+        } else {
+            fprintf(f, "null");
+        }
+        fprintf(f, ", \"ops\": %zu, \"batch\": %zu, \"samples\": %zu, "
+                "\"ns_per_op\": {\"p50\": %.3f, \"p99\": ", r->ops, r->batch, r->samples, r->p50);
+        if (r->p99 >= 0) {
+            fprintf(f, "%.3f", r->p99);
+        } else {
+            fprintf(f, "null");
+        }
+        fprintf(f, ", \"max\": %.3f, \"min\": %.3f, \"mean\": %.3f}, \"bytes_per_trial\": %.0f, "
+                "\"allocs_per_trial\": %.1f, \"speedup_vs_baseline\": %.3f}",
+                r->max, r->min, r->mean, r->bytes, r->allocs, r->speedup);
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+/* Restore the allocator and write the JSON report if one was asked for; returns the exit code */
+static inline int nb_finish(void) {
+    nanods_set_allocator(NULL);
+    if (!g_nb.json_path) return 0;
+    if (nb_write_json(g_nb.json_path) != 0) {
+        fprintf(stderr, "%s: could not write %s\n", g_nb.suite, g_nb.json_path);
+        return 1;
+    }
+    printf("\nResults written to %s\n", g_nb.json_path);
+    return 0;
+}
+
+#endif /* NANODS_BENCH_HARNESS_H */
@@ -1,4 +1,8 @@
-#if defined(_POSIX_C_SOURCE) || defined(__linux__) || defined(__unix__)
+#if defined(__linux__)
+    #ifndef _GNU_SOURCE
+        #define _GNU_SOURCE                /* sched_setaffinity for --pin */
+    #endif
+#elif defined(_POSIX_C_SOURCE) || defined(__unix__)
     #ifndef _POSIX_C_SOURCE
         #define _POSIX_C_SOURCE 199309L
     #endif
@@ -6,132 +10,253 @@
 
 #define NANODS_IMPLEMENTATION
 #include "../nanods.h"
-#include <stdio.h>
-#include <time.h>
+#include "bench_harness.h"
+
+/*
+ * Doubly linked list operations, then one queue workload on four containers:
+ * NanoList2 with per-node allocation, NanoList2 on a node pool, NanoDeque and
+ * caller-owned objects on a NanoIList. Same options as bench_comparison.
+ */
 
 #define ITERATIONS 100000
+#define CHURN (ITERATIONS * 10)
+
+/* Keeps traversal results alive so the optimizer cannot drop the loops */
+static volatile long sink;
+
+/* ---- List ends ------------------------------------------------------------------- */
+
+static IntList2 g_list;
+
+static void reset_empty(void* ctx) {
+    (void)ctx;
+    nl2_free_int(&g_list);
+    nl2_init_int(&g_list);
+}
+
+static void reset_full(void* ctx) {
+    reset_empty(ctx);
+    for (int i = 0; i < ITERATIONS; i++) nl2_push_back_int(&g_list, i);
+}
+
+static void run_push_front(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) nl2_push_front_int(&g_list, (int)i);
+}
+
+static void run_push_back(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) nl2_push_back_int(&g_list, (int)i);
+}
+
+static void run_pop_front(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    int val;
+    for (size_t i = begin; i < end; i++) nl2_pop_front_int(&g_list, &val);
+}
+
+static void run_pop_back(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    int val;
+    for (size_t i = begin; i < end; i++) nl2_pop_back_int(&g_list, &val);
+}
 
-#if defined(_WIN32) || defined(_WIN64)
-    #include <windows.h>
-    double get_time_ms(void) {
-        LARGE_INTEGER frequency, counter;
-        QueryPerformanceFrequency(&frequency);
-        QueryPerformanceCounter(&counter);
-        return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
+/* ---- Queue workload: fill, churn (pop_front + push_back), walk, free --------------- */
+
+typedef struct {
+    int value;
+    NanoIListHook hook;
+} Job;
+
+static IntList2 g_malloc_list, g_pooled_list;
+static IntDeque g_deque;
+static NanoIList g_jobs_list;
+static Job* g_jobs;
+
+static void reset_malloc_list(void* ctx) {
+    (void)ctx;
+    nl2_free_int(&g_malloc_list);
+    nl2_init_int(&g_malloc_list);
+}
+
+static void reset_pooled_list(void* ctx) {
+    (void)ctx;
+    nl2_free_int(&g_pooled_list);
+    nl2_init_pooled_int(&g_pooled_list, 1024);
+}
+
+static void reset_deque(void* ctx) {
+    (void)ctx;
+    nd_free_int(&g_deque);
+    nd_init_int(&g_deque);
+}
+
+static void reset_jobs(void* ctx) {
+    (void)ctx;
+    nil_clear(&g_jobs_list);
+}
+
+/*
+ * Operations [0, ITERATIONS) fill the queue, the next CHURN pop one element
+ * and push it back; ctx: the list to run on
+ */
+static void run_list_churn(void* ctx, size_t begin, size_t end) {
+    IntList2* list = ctx;
+    size_t i = begin;
+    for (; i < end && i < ITERATIONS; i++) nl2_push_back_int(list, (int)i);
+    int val;
+    for (; i < end; i++) {
+        nl2_pop_front_int(list, &val);
+        nl2_push_back_int(list, val);
     }
-#elif defined(__APPLE__) || defined(__MACH__)
-    #include <mach/mach_time.h>
-    double get_time_ms(void) {
-        static mach_timebase_info_data_t timebase;
-        if (timebase.denom == 0) mach_timebase_info(&timebase);
-        uint64_t time = mach_absolute_time();
-        return (double)(time * timebase.numer / timebase.denom) / 1000000.0;
+}
+
+static void run_deque_churn(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    size_t i = begin;
+    for (; i < end && i < ITERATIONS; i++) nd_push_back_int(&g_deque, (int)i);
+    int val;
+    for (; i < end; i++) {
+        nd_pop_front_int(&g_deque, &val);
+        nd_push_back_int(&g_deque, val);
     }
-#else
-    double get_time_ms(void) {
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        return ts. tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* No allocation: the objects already exist */
+static void run_jobs_churn(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    size_t i = begin;
+    for (; i < end && i < ITERATIONS; i++) {
+        g_jobs[i].value = (int)i;
+        nil_push_back(&g_jobs_list, &g_jobs[i].hook);
     }
-#endif
+    for (; i < end; i++) nil_push_back(&g_jobs_list, nil_pop_front(&g_jobs_list));
+}
+
+/* The linked walks resume where the previous batch stopped */
+static NanoList2Node_int* g_walk_node;
+static NanoIListHook* g_walk_hook;
 
-int main(void) {
+static void run_list_walk(void* ctx, size_t begin, size_t end) {
+    IntList2* list = ctx;
+    long sum = 0;
+    NanoList2Node_int* n = begin ? g_walk_node : list->head;
+    for (size_t i = begin; i < end && n; i++, n = n->next) sum += n->data;
+    g_walk_node = n;
+    sink += sum;
+}
+
+static void run_deque_walk(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    long sum = 0;
+    size_t run = 0;
+    if (end > g_deque.size) end = g_deque.size;
+    for (size_t i = begin; i < end; i += run) {
+        const int* span = nd_span_int(&g_deque, i, &run);
+        if (run > end - i) run = end - i;
+        for (size_t k = 0; k < run; k++) sum += span[k];
+    }
+    sink += sum;
+}
+
+static void run_jobs_walk(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    long sum = 0;
+    NanoIListHook* h = begin ? g_walk_hook : g_jobs_list.head;
+    for (size_t i = begin; i < end && h; i++, h = h->next) {
+        sum += NANODS_CONTAINER_OF(h, Job, hook)->value;
+    }
+    g_walk_hook = h;
+    sink += sum;
+}
+
+/* Free a full container; the reset refills it untimed */
+static void reset_fill_malloc(void* ctx) {
+    reset_malloc_list(ctx);
+    for (int i = 0; i < ITERATIONS; i++) nl2_push_back_int(&g_malloc_list, i);
+}
+
+static void reset_fill_pooled(void* ctx) {
+    reset_pooled_list(ctx);
+    for (int i = 0; i < ITERATIONS; i++) nl2_push_back_int(&g_pooled_list, i);
+}
+
+static void reset_fill_deque(void* ctx) {
+    reset_deque(ctx);
+    for (int i = 0; i < ITERATIONS; i++) nd_push_back_int(&g_deque, i);
+}
+
+/* Whole trial: freeing cannot be split */
+static void run_list_free(void* ctx, size_t begin, size_t end) {
+    (void)begin;
+    (void)end;
+    nl2_free_int(ctx);
+}
+
+static void run_deque_free(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nd_free_int(&g_deque);
+}
+
+int main(int argc, char** argv) {
     printf("==============================================\n");
     printf("  NanoDS v%s Doubly Linked List Benchmark\n", NANODS_VERSION);
     printf("==============================================\n\n");
-    
+
     nanods_seed_init(0);
-    
-    /* Benchmark 1: Push Front */
-    {
-        IntList2 list;
-        nl2_init_int(&list);
-        
-        double start = get_time_ms();
-        for (int i = 0; i < ITERATIONS; i++) {
-            nl2_push_front_int(&list, i);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Push Front (%d ops):\n", ITERATIONS);
-        printf("  Time:       %.2f ms\n", elapsed);
-        printf("  Throughput: %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:     %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nl2_free_int(&list);
-    }
-    
-    /* Benchmark 2: Push Back */
-    {
-        IntList2 list;
-        nl2_init_int(&list);
-        
-        double start = get_time_ms();
-        for (int i = 0; i < ITERATIONS; i++) {
-            nl2_push_back_int(&list, i);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Push Back (%d ops):\n", ITERATIONS);
-        printf("  Time:       %.2f ms\n", elapsed);
-        printf("  Throughput: %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:    %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nl2_free_int(&list);
-    }
-    
-    /* Benchmark 3: Pop Front */
-    {
-        IntList2 list;
-        nl2_init_int(&list);
-        
-        for (int i = 0; i < ITERATIONS; i++) {
-            nl2_push_back_int(&list, i);
-        }
-        
-        double start = get_time_ms();
-        int val;
-        for (int i = 0; i < ITERATIONS; i++) {
-            nl2_pop_front_int(&list, &val);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Pop Front (%d ops):\n", ITERATIONS);
-        printf("  Time:       %.2f ms\n", elapsed);
-        printf("  Throughput: %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:    %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nl2_free_int(&list);
-    }
-    
-    /* Benchmark 4: Pop Back */
-    {
-        IntList2 list;
-        nl2_init_int(&list);
-        
-        for (int i = 0; i < ITERATIONS; i++) {
-            nl2_push_back_int(&list, i);
-        }
-        
-        double start = get_time_ms();
-        int val;
-        for (int i = 0; i < ITERATIONS; i++) {
-            nl2_pop_back_int(&list, &val);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Pop Back (%d ops):\n", ITERATIONS);
-        printf("  Time:       %.2f ms\n", elapsed);
-        printf("  Throughput: %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:     %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nl2_free_int(&list);
-    }
-    
-    printf("==============================================\n");
-    return 0;
-}
\ No newline at end of file
+    nb_init(argc, argv, "list2");
+
+    nl2_init_int(&g_list);
+    nb_run(&(NanoBenchCase){ "list2", "push_front", NULL, ITERATIONS,
+                             run_push_front, reset_empty, NULL });
+    nb_run(&(NanoBenchCase){ "list2", "push_back", NULL, ITERATIONS,
+                             run_push_back, reset_empty, NULL });
+    nb_run(&(NanoBenchCase){ "list2", "pop_front", NULL, ITERATIONS,
+                             run_pop_front, reset_full, NULL });
+    nb_run(&(NanoBenchCase){ "list2", "pop_back", NULL, ITERATIONS,
+                             run_pop_back, reset_full, NULL });
+    nl2_free_int(&g_list);
+
+    /* Fill + churn is 21 operations per element */
+    g_jobs = (Job*)calloc(ITERATIONS, sizeof(Job));
+    if (!g_jobs) return 1;
+    nl2_init_int(&g_malloc_list);
+    nl2_init_pooled_int(&g_pooled_list, 1024);
+    nd_init_int(&g_deque);
+    nil_init(&g_jobs_list);
+    nb_run(&(NanoBenchCase){ "queue_churn", "list2_malloc", NULL, ITERATIONS * 21,
+                             run_list_churn, reset_malloc_list, &g_malloc_list });
+    nb_run(&(NanoBenchCase){ "queue_churn", "list2_pooled", "list2_malloc", ITERATIONS * 21,
+                             run_list_churn, reset_pooled_list, &g_pooled_list });
+    nb_run(&(NanoBenchCase){ "queue_churn", "deque", "list2_malloc", ITERATIONS * 21,
+                             run_deque_churn, reset_deque, NULL });
+    nb_run(&(NanoBenchCase){ "queue_churn", "intrusive", "list2_malloc", ITERATIONS * 21,
+                             run_jobs_churn, reset_jobs, NULL });
+
+    /* Each container is left holding the churned queue */
+    nb_run(&(NanoBenchCase){ "queue_walk", "list2_malloc", NULL, ITERATIONS,
+                             run_list_walk, NULL, &g_malloc_list });
+    nb_run(&(NanoBenchCase){ "queue_walk", "list2_pooled", "list2_malloc", ITERATIONS,
+                             run_list_walk, NULL, &g_pooled_list });
+    nb_run(&(NanoBenchCase){ "queue_walk", "deque", "list2_malloc", ITERATIONS,
+                             run_deque_walk, NULL, NULL });
+    nb_run(&(NanoBenchCase){ "queue_walk", "intrusive", "list2_malloc", ITERATIONS,
+                             run_jobs_walk, NULL, NULL });
+    nil_clear(&g_jobs_list);
+    free(g_jobs);
+
+    nb_run_whole(&(NanoBenchCase){ "queue_free", "list2_malloc", NULL, ITERATIONS,
+                                   run_list_free, reset_fill_malloc, &g_malloc_list });
+    nb_run_whole(&(NanoBenchCase){ "queue_free", "list2_pooled", "list2_malloc", ITERATIONS,
+                                   run_list_free, reset_fill_pooled, &g_pooled_list });
+    nb_run_whole(&(NanoBenchCase){ "queue_free", "deque", "list2_malloc", ITERATIONS,
+                                   run_deque_free, reset_fill_deque, NULL });
+    nl2_free_int(&g_malloc_list);
+    nl2_free_int(&g_pooled_list);
+    nd_free_int(&g_deque);
+
+    printf("\n==============================================\n");
+    return nb_finish();
+}
@@ -1,4 +1,8 @@
-#if defined(_POSIX_C_SOURCE) || defined(__linux__) || defined(__unix__)
+#if defined(__linux__)
+    #ifndef _GNU_SOURCE
+        #define _GNU_SOURCE                /* sched_setaffinity for --pin */
+    #endif
+#elif defined(_POSIX_C_SOURCE) || defined(__unix__)
     #ifndef _POSIX_C_SOURCE
         #define _POSIX_C_SOURCE 199309L
     #endif
@@ -6,101 +10,521 @@
 
 #define NANODS_IMPLEMENTATION
 #include "../nanods.h"
-#include <stdio.h>
-#include <time.h>
-
-#if defined(_WIN32) || defined(_WIN64)
-    #include <windows.h>
-    double get_time_ms(void) {
-        LARGE_INTEGER frequency, counter;
-        QueryPerformanceFrequency(&frequency);
-        QueryPerformanceCounter(&counter);
-        return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
-    }
-#elif defined(__APPLE__) || defined(__MACH__)
-    #include <mach/mach_time.h>
-    double get_time_ms(void) {
-        static mach_timebase_info_data_t timebase;
-        if (timebase.denom == 0) mach_timebase_info(&timebase);
-        uint64_t time = mach_absolute_time();
-        return (double)(time * timebase.numer / timebase.denom) / 1000000.0;
-    }
-#else
-    double get_time_ms(void) {
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#include "bench_harness.h"
+
+/*
+ * NanoMap, NanoFlatMap, the typed map and map snapshots at several sizes.
+ * Groups are named after the size (map_100000, batch_1000000, ...) so runs
+ * can be compared case by case. Same options as bench_comparison.
+ */
+
+#define KEY_LEN 16
+#define BATCH_KEYS 1024
+
+/* Keeps lookup results alive so the optimizer cannot drop the loops */
+static volatile uintptr_t sink;
+
+/* Group names outlive the call that formats them: results keep the pointer */
+static const char* group_name(const char* prefix, long n) {
+    static char names[NB_MAX_RESULTS][32];
+    static size_t used;
+    char* name = names[used++ % NB_MAX_RESULTS];
+    snprintf(name, sizeof(names[0]), "%s_%ld", prefix, n);
+    return name;
+}
+
+/* `count` keys "<prefix>_<i>", KEY_LEN bytes apart */
+static char* make_keys(const char* prefix, int count) {
+    char* buf = malloc((size_t)count * KEY_LEN);
+    for (int i = 0; i < count; i++) snprintf(buf + (size_t)i * KEY_LEN, KEY_LEN, "%s_%d", prefix, i);
+    return buf;
+}
+
+static uint32_t xorshift32(uint32_t* x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+/* ---- Raw hash throughput -------------------------------------------------------- */
+
+typedef struct {
+    char* buf;                             /* NUL at buf[len] while the group runs */
+    size_t len;
+    size_t iters;
+    uint64_t key[2];
+} HashBench;
+
+/* The seed varies so calls cannot be hoisted */
+static void run_fnv1a(void* ctx, size_t begin, size_t end) {
+    HashBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        size_t out_len;
+        sink += nanods_fnv1a_hash_len(b->buf, (uint32_t)i, &out_len);
     }
-#endif
+}
+
+static void run_wyhash(void* ctx, size_t begin, size_t end) {
+    HashBench* b = ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nanods_wyhash(b->buf, b->len, i);
+}
+
+static void run_siphash(void* ctx, size_t begin, size_t end) {
+    HashBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        b->key[0] ^= i;
+        sink += (uintptr_t)nanods_siphash13(b->buf, b->len, b->key);
+    }
+}
+
+static void benchmark_hash(void) {
+    static const size_t lengths[] = {8, 16, 64, 256, 1024};
+    HashBench b;
+    b.buf = malloc(1025);
+    nanods_get_hash_key(b.key);
+    for (int i = 0; i < 1024; i++) b.buf[i] = (char)('a' + i % 26);
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        b.len = lengths[l];
+        b.iters = (size_t)(16u << 20) / b.len;
+        b.buf[b.len] = '\0';
+        const char* group = group_name("hash", (long)b.len);
+        nb_run(&(NanoBenchCase){ group, "fnv1a", NULL, b.iters, run_fnv1a, NULL, &b });
+        nb_run(&(NanoBenchCase){ group, "wyhash", "fnv1a", b.iters, run_wyhash, NULL, &b });
+        nb_run(&(NanoBenchCase){ group, "siphash13", "fnv1a", b.iters, run_siphash, NULL, &b });
+        b.buf[b.len] = (char)('a' + b.len % 26);
+    }
+    free(b.buf);
+}
+
+/* ---- NanoMap ------------------------------------------------------------------------ */
 
-void benchmark_map(int size) {
+typedef struct {
+    int size;
+    NanoHashKind kind;
+    char* keys;
+    const char** queries;                  /* Lookup order */
+    NanoMapKey* hashed;                    /* queries, hashed once */
+    void** out;
+    int* values;
     NanoMap map;
-    nm_init(&map);
-    
-    /* Prepare keys and values */
-    char** keys = malloc(size * sizeof(char*));
-    int* values = malloc(size * sizeof(int));
-    
+} MapBench;
+
+static void map_bench_init(MapBench* b, int size, NanoHashKind kind) {
+    b->size = size;
+    b->kind = kind;
+    b->keys = make_keys("key", size);
+    b->queries = malloc((size_t)size * sizeof(char*));
+    b->hashed = malloc((size_t)size * sizeof(NanoMapKey));
+    b->out = malloc(BATCH_KEYS * sizeof(void*));
+    b->values = malloc((size_t)size * sizeof(int));
     for (int i = 0; i < size; i++) {
-        keys[i] = malloc(32);
-        snprintf(keys[i], 32, "key_%d", i);
-        values[i] = i;
+        b->queries[i] = b->keys + (size_t)i * KEY_LEN;
+        b->values[i] = i;
     }
-    
-    /* Benchmark:  Set */
-    double start = get_time_ms();
-    for (int i = 0; i < size; i++) {
-        nm_set(&map, keys[i], &values[i]);
+    nm_init(&b->map);
+    nm_set_hash_kind(&b->map, kind);
+}
+
+static void map_bench_fill(MapBench* b) {
+    for (int i = 0; i < b->size; i++) nm_set(&b->map, b->keys + (size_t)i * KEY_LEN, &b->values[i]);
+}
+
+static void map_bench_hash_queries(MapBench* b) {
+    for (int i = 0; i < b->size; i++) b->hashed[i] = nm_key(&b->map, b->queries[i]);
+}
+
+static void map_bench_free(MapBench* b) {
+    nm_free(&b->map);
+    free(b->keys);
+    free(b->queries);
+    free(b->hashed);
+    free(b->out);
+    free(b->values);
+}
+
+static void reset_nm_set(void* ctx) {
+    MapBench* b = ctx;
+    nm_free(&b->map);
+    nm_init(&b->map);
+    nm_set_hash_kind(&b->map, b->kind);
+}
+
+static void run_nm_set(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) nm_set(&b->map, b->keys + i * KEY_LEN, &b->values[i]);
+}
+
+/* Whole trial: the cold start is one rebuild of the full map */
+static void run_nm_rebuild(void* ctx, size_t begin, size_t end) {
+    (void)begin;
+    (void)end;
+    map_bench_fill(ctx);
+}
+
+static void run_nm_get(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nm_get(&b->map, b->queries[i]);
+}
+
+static void run_nm_has(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nm_has(&b->map, b->queries[i]);
+}
+
+static void run_nm_get_h(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nm_get_h(&b->map, b->hashed[i]);
+}
+
+static void run_nm_has_h(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nm_has_h(&b->map, b->hashed[i]);
+}
+
+/* Check-then-get, two lookups vs one nm_lookup */
+static void run_nm_has_get(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        if (nm_has(&b->map, b->queries[i])) sink += (uintptr_t)nm_get(&b->map, b->queries[i]);
     }
-    double end = get_time_ms();
-    double set_time = end - start;
-    
-    /* Benchmark: Get */
-    start = get_time_ms();
-    for (int i = 0; i < size; i++) {
-        nm_get(&map, keys[i]);
+}
+
+static void run_nm_lookup(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        void* value;
+        if (nm_lookup(&b->map, b->queries[i], &value)) sink += (uintptr_t)value;
     }
-    end = get_time_ms();
-    double get_time = end - start;
-    
-    /* Benchmark:  Has */
-    start = get_time_ms();
-    for (int i = 0; i < size; i++) {
-        nm_has(&map, keys[i]);
-    }
-    end = get_time_ms();
-    double has_time = end - start;
-    
-    printf("Map Size: %d entries\n", size);
-    printf("  Set:   %.2f ms (%.0f ops/sec)\n", set_time, size / (set_time / 1000.0));
-    printf("  Get:  %.2f ms (%.0f ops/sec)\n", get_time, size / (get_time / 1000.0));
-    printf("  Has:  %.2f ms (%.0f ops/sec)\n", has_time, size / (has_time / 1000.0));
-    printf("  Load Factor: %.2f\n", (double)map.size / map.bucket_count);
-    printf("  Seed: 0x%08X (Anti-DoS enabled)\n\n", map.seed);
-    
-    /* Cleanup */
-    nm_free(&map);
+}
+
+/* Whole trial: one pass over the table */
+static void run_nm_iter(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    (void)begin;
+    (void)end;
+    for (NanoIter it = nm_iter(&b->map); nm_iter_has_next(&it); nm_iter_advance(&it)) {
+        sink += (uintptr_t)((NanoMapEntry*)it.ptr)->value;
+    }
+}
+
+static void run_nm_foreach(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    (void)begin;
+    (void)end;
+    NANODS_MAP_FOREACH(&b->map, e) {
+        sink += (uintptr_t)e->value;
+    }
+}
+
+static void run_nm_get_batch(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i += BATCH_KEYS) {
+        size_t n = end - i < BATCH_KEYS ? end - i : BATCH_KEYS;
+        sink += nm_get_batch(&b->map, b->queries + i, n, b->out);
+        sink += (uintptr_t)b->out[0];
+    }
+}
+
+static void run_nm_get_batch_h(void* ctx, size_t begin, size_t end) {
+    MapBench* b = ctx;
+    for (size_t i = begin; i < end; i += BATCH_KEYS) {
+        size_t n = end - i < BATCH_KEYS ? end - i : BATCH_KEYS;
+        sink += nm_get_batch_h(&b->map, b->hashed + i, n, b->out);
+        sink += (uintptr_t)b->out[0];
+    }
+}
+
+static void benchmark_map(int size) {
+    MapBench b;
+    map_bench_init(&b, size, NANODS_HASH_FNV1A);
+    const char* group = group_name("map", size);
+    nb_run(&(NanoBenchCase){ group, "nm_set", NULL, (size_t)size, run_nm_set, reset_nm_set, &b });
+    map_bench_hash_queries(&b);
+    nb_run(&(NanoBenchCase){ group, "nm_get", NULL, (size_t)size, run_nm_get, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_has", NULL, (size_t)size, run_nm_has, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_get_h", "nm_get", (size_t)size, run_nm_get_h, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "has_then_get", NULL, (size_t)size,
+                             run_nm_has_get, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_lookup", "has_then_get", (size_t)size,
+                             run_nm_lookup, NULL, &b });
+    nb_run_whole(&(NanoBenchCase){ group, "nano_iter", NULL, (size_t)size,
+                                   run_nm_iter, NULL, &b });
+    nb_run_whole(&(NanoBenchCase){ group, "foreach", "nano_iter", (size_t)size,
+                                   run_nm_foreach, NULL, &b });
+    map_bench_free(&b);
+}
+
+/* Lookups in one map per hash function */
+static void benchmark_hash_kinds(int size) {
+    static const struct { NanoHashKind kind; const char* name; } kinds[] = {
+        {NANODS_HASH_FNV1A, "fnv1a"}, {NANODS_HASH_WYHASH, "wyhash"},
+        {NANODS_HASH_SIPHASH13, "siphash13"}
+    };
+    const char* group = group_name("hash_kind", size);
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        MapBench b;
+        map_bench_init(&b, size, kinds[k].kind);
+        map_bench_fill(&b);
+        nb_run(&(NanoBenchCase){ group, kinds[k].name, k ? "fnv1a" : NULL, (size_t)size,
+                                 run_nm_get, NULL, &b });
+        map_bench_free(&b);
+    }
+}
+
+/*
+ * One lookup at a time vs nm_get_batch over 1024-key batches, in shuffled
+ * order so neither side gets help from the hardware prefetcher.
+ */
+static void benchmark_batch(int size) {
+    MapBench b;
+    map_bench_init(&b, size, NANODS_HASH_FNV1A);
+    map_bench_fill(&b);
+    uint32_t x = 2463534242u;
+    for (int i = size - 1; i > 0; i--) {
+        int j = (int)(xorshift32(&x) % (uint32_t)(i + 1));
+        const char* t = b.queries[i];
+        b.queries[i] = b.queries[j];
+        b.queries[j] = t;
+    }
+    map_bench_hash_queries(&b);
+    const char* group = group_name("batch", size);
+    nb_run(&(NanoBenchCase){ group, "nm_get", NULL, (size_t)size, run_nm_get, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_get_batch", "nm_get", (size_t)size,
+                             run_nm_get_batch, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_get_h", NULL, (size_t)size, run_nm_get_h, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_get_batch_h", "nm_get_h", (size_t)size,
+                             run_nm_get_batch_h, NULL, &b });
+    map_bench_free(&b);
+}
+
+/* nm_has with 90% misses, without and with nm_enable_filter */
+static void benchmark_filter(int size) {
+    MapBench b;
+    map_bench_init(&b, size, NANODS_HASH_FNV1A);
+    map_bench_fill(&b);
+    char* misses = make_keys("miss", size);
+    uint32_t x = 2463534242u;
     for (int i = 0; i < size; i++) {
-        free(keys[i]);
+        int k = (int)(xorshift32(&x) % (uint32_t)size);
+        b.queries[i] = (i % 10 == 0 ? b.keys : misses) + (size_t)k * KEY_LEN;
+    }
+    map_bench_hash_queries(&b);
+    const char* group = group_name("filter", size);
+    nb_run(&(NanoBenchCase){ group, "nm_has", NULL, (size_t)size, run_nm_has, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_has_h", NULL, (size_t)size, run_nm_has_h, NULL, &b });
+    nm_enable_filter(&b.map, 0);
+    nb_run(&(NanoBenchCase){ group, "nm_has_filtered", "nm_has", (size_t)size,
+                             run_nm_has, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nm_has_h_filtered", "nm_has_h", (size_t)size,
+                             run_nm_has_h, NULL, &b });
+    map_bench_free(&b);
+    free(misses);
+}
+
+/* ---- NanoFlatMap --------------------------------------------------------------------- */
+
+typedef struct {
+    int size;
+    char* keys;
+    int* values;
+    NanoFlatMap map;
+} FlatBench;
+
+static void reset_nfm_set(void* ctx) {
+    FlatBench* b = ctx;
+    nfm_free(&b->map);
+    nfm_init(&b->map);
+}
+
+static void run_nfm_set(void* ctx, size_t begin, size_t end) {
+    FlatBench* b = ctx;
+    for (size_t i = begin; i < end; i++) nfm_set(&b->map, b->keys + i * KEY_LEN, &b->values[i]);
+}
+
+static void run_nfm_get(void* ctx, size_t begin, size_t end) {
+    FlatBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        sink += (uintptr_t)nfm_get(&b->map, b->keys + i * KEY_LEN);
     }
-    free(keys);
-    free(values);
 }
 
-int main(void) {
+static void run_nfm_has(void* ctx, size_t begin, size_t end) {
+    FlatBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        sink += (uintptr_t)nfm_has(&b->map, b->keys + i * KEY_LEN);
+    }
+}
+
+static void benchmark_flatmap(int size) {
+    FlatBench b;
+    b.size = size;
+    b.keys = make_keys("key", size);
+    b.values = malloc((size_t)size * sizeof(int));
+    for (int i = 0; i < size; i++) b.values[i] = i;
+    nfm_init(&b.map);
+    const char* group = group_name("flatmap", size);
+    nb_run(&(NanoBenchCase){ group, "nfm_set", NULL, (size_t)size, run_nfm_set, reset_nfm_set, &b });
+    nb_run(&(NanoBenchCase){ group, "nfm_get", NULL, (size_t)size, run_nfm_get, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "nfm_has", NULL, (size_t)size, run_nfm_has, NULL, &b });
+    nfm_free(&b.map);
+    free(b.keys);
+    free(b.values);
+}
+
+/* ---- Typed map: integer keys, values inline ----------------------------------------- */
+
+typedef struct {
+    int size;
+    int* keys;
+    NanoMap_int_int map;
+} TypedBench;
+
+static void reset_typed_set(void* ctx) {
+    TypedBench* b = ctx;
+    nm_free_int_int(&b->map);
+    nm_init_int_int(&b->map);
+}
+
+static void run_typed_set(void* ctx, size_t begin, size_t end) {
+    TypedBench* b = ctx;
+    for (size_t i = begin; i < end; i++) nm_set_int_int(&b->map, b->keys[i], (int)i);
+}
+
+static void run_typed_get(void* ctx, size_t begin, size_t end) {
+    TypedBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        int v = 0;
+        nm_get_int_int(&b->map, b->keys[i], &v);
+        sink += (uintptr_t)v;
+    }
+}
+
+static void run_typed_has(void* ctx, size_t begin, size_t end) {
+    TypedBench* b = ctx;
+    for (size_t i = begin; i < end; i++) sink += (uintptr_t)nm_has_int_int(&b->map, b->keys[i]);
+}
+
+static void benchmark_typed_map(int size) {
+    TypedBench b;
+    b.size = size;
+    b.keys = malloc((size_t)size * sizeof(int));
+    /* Scattered IDs so keys are not dense table indices */
+    for (int i = 0; i < size; i++) b.keys[i] = (int)((unsigned)i * 2654435761u >> 1);
+    nm_init_int_int(&b.map);
+    const char* group = group_name("typed_map", size);
+    nb_run(&(NanoBenchCase){ group, "set", NULL, (size_t)size, run_typed_set, reset_typed_set, &b });
+    nb_run(&(NanoBenchCase){ group, "get", NULL, (size_t)size, run_typed_get, NULL, &b });
+    nb_run(&(NanoBenchCase){ group, "has", NULL, (size_t)size, run_typed_has, NULL, &b });
+    nm_free_int_int(&b.map);
+    free(b.keys);
+}
+
+/* ---- Snapshots: rebuilding key by key vs attaching a saved file --------------------- */
+
+typedef struct {
+    MapBench m;
+    const char* path;
+    NanoSnapshot snap;
+    int open;
+} SnapBench;
+
+static void reset_snap_close(void* ctx) {
+    SnapBench* b = ctx;
+    if (b->open) nsnap_close(&b->snap);
+    b->open = 0;
+}
+
+/* Whole trial: one file per save */
+static void run_snap_save(void* ctx, size_t begin, size_t end) {
+    SnapBench* b = ctx;
+    (void)begin;
+    (void)end;
+    sink += (uintptr_t)nm_save(&b->m.map, b->path, sizeof(int));
+}
+
+/* Cold start: open, then the first lookup */
+static void run_snap_open(void* ctx, size_t begin, size_t end) {
+    SnapBench* b = ctx;
+    (void)begin;
+    (void)end;
+    b->open = nsnap_open(&b->snap, b->path) == NANODS_OK;
+    if (b->open) sink += (uintptr_t)nsnap_map_get(&b->snap, b->m.queries[b->m.size / 2], NULL);
+}
+
+static void run_snap_get(void* ctx, size_t begin, size_t end) {
+    SnapBench* b = ctx;
+    for (size_t i = begin; i < end; i++) {
+        sink += (uintptr_t)nsnap_map_get(&b->snap, b->m.queries[i], NULL);
+    }
+}
+
+/* Every case sets up its own fixture, so --filter can pick any one of them */
+static void benchmark_snapshot(int size) {
+    SnapBench b;
+    map_bench_init(&b.m, size, NANODS_HASH_FNV1A);
+    b.path = "bench_map.snap";
+    b.open = 0;
+    map_bench_fill(&b.m);
+    const char* cold = group_name("cold_start", size);
+    const char* group = group_name("snapshot", size);
+    nb_run(&(NanoBenchCase){ cold, "rebuild", NULL, 1, run_nm_rebuild, reset_nm_set, &b.m });
+    nb_run_whole(&(NanoBenchCase){ group, "nm_save", NULL, (size_t)size,
+                                   run_snap_save, NULL, &b });
+    if (nm_save(&b.m.map, b.path, sizeof(int)) != NANODS_OK) {
+        printf("  %s: snapshot could not be written\n", group);
+    } else {
+        nb_run(&(NanoBenchCase){ cold, "nsnap_open", "rebuild", 1,
+                                 run_snap_open, reset_snap_close, &b });
+        reset_snap_close(&b);
+        b.open = nsnap_open(&b.snap, b.path) == NANODS_OK;
+        if (b.open) {
+            nb_run(&(NanoBenchCase){ group, "nsnap_map_get", NULL, (size_t)size,
+                                     run_snap_get, NULL, &b });
+        } else {
+            printf("  %s: snapshot could not be opened\n", group);
+        }
+    }
+    reset_snap_close(&b);
+    remove(b.path);
+    map_bench_free(&b.m);
+}
+
+int main(int argc, char** argv) {
     printf("==============================================\n");
     printf("  NanoDS v%s Map Benchmark\n", NANODS_VERSION);
     printf("==============================================\n\n");
-    
+
     /* Initialize random seed for hash randomization */
     nanods_seed_init(0);
-    printf("Hash seed initialized:  0x%08X\n\n", nanods_get_seed());
-    
+    nb_init(argc, argv, "map");
+
+    benchmark_hash();
+
     benchmark_map(1000);
-    benchmark_map(10000);
     benchmark_map(100000);
     benchmark_map(1000000);
-    
-    printf("==============================================\n");
-    return 0;
-}
\ No newline at end of file
+    benchmark_hash_kinds(100000);
+
+    benchmark_batch(10000);
+    benchmark_batch(1000000);
+    benchmark_batch(4000000);
+
+    benchmark_filter(10000);
+    benchmark_filter(1000000);
+
+    /* NanoFlatMap probes a group of control bytes at a time (SSE2, NEON or scalar) */
+    benchmark_flatmap(1000);
+    benchmark_flatmap(100000);
+    benchmark_flatmap(1000000);
+
+    benchmark_typed_map(1000);
+    benchmark_typed_map(100000);
+    benchmark_typed_map(1000000);
+
+    benchmark_snapshot(100000);
+    benchmark_snapshot(1000000);
+
+    printf("\n==============================================\n");
+    return nb_finish();
+}
@@ -0,0 +1,158 @@
+#if defined(__linux__)
+    #ifndef _GNU_SOURCE
+        #define _GNU_SOURCE                /* sched_setaffinity for --pin */
+    #endif
+#elif defined(_POSIX_C_SOURCE) || defined(__unix__)
+    #ifndef _POSIX_C_SOURCE
+        #define _POSIX_C_SOURCE 199309L
+    #endif
+#endif
+
+#define NANODS_IMPLEMENTATION
+#define NANODS_ENABLE_THREADS
+#include "../nanods.h"
+#include "bench_harness.h"
+
+/*
+ * Parallel vector algorithms: the serial call vs nv_par_* on pools of 1, 2,
+ * 4, ... threads (up to the online CPUs, and always 2 and 4). One group per
+ * algorithm (map, filter, reduce, sort), ns/op per element. Same options as
+ * bench_comparison; --pin confines every pool thread to one CPU.
+ */
+
+#ifndef NANODS_HAVE_THREADS
+int main(void) {
+    printf("bench_parallel needs C11 atomics and pthreads; skipped\n");
+    return 0;
+}
+#else
+
+#ifndef ELEMENTS
+    #define ELEMENTS 1000000
+#endif
+#define MAX_POOLS 7
+
+typedef enum { OP_MAP, OP_FILTER, OP_REDUCE, OP_SORT } Op;
+
+typedef struct {
+    NanoThreadPool* pool;                  /* NULL: the plain serial call */
+    Op op;
+    FloatVector* vec;
+    FloatVector out;
+    int has_out;
+} ParBench;
+
+static volatile float sink;
+
+static float scale(float x) { return x * 1.5f + 0.25f; }
+static int above_half(float x) { return x > 0.5f; }
+static float add(float a, float b) { return a + b; }
+static int compare_float(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static void fill(FloatVector* vec) {
+    uint32_t state = 12345;
+    vec->size = 0;
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        state = state * 1664525u + 1013904223u;
+        vec->data[vec->size++] = (float)(state >> 8) / 16777216.0f;
+    }
+}
+
+/* Refill the input (sort leaves it sorted) and drop the previous output */
+static void reset_par(void* ctx) {
+    ParBench* b = ctx;
+    if (b->has_out) nv_free_float(&b->out);
+    b->has_out = 0;
+    fill(b->vec);
+}
+
+/* Whole trial: one call over the full vector */
+static void run_par(void* ctx, size_t begin, size_t end) {
+    ParBench* b = ctx;
+    (void)begin;
+    (void)end;
+    float sum;
+    switch (b->op) {
+    case OP_MAP:
+        if (b->pool) nv_par_map_float(b->pool, b->vec, &b->out, scale);
+        else nv_map_float(b->vec, &b->out, scale);
+        b->has_out = 1;
+        sink += b->out.data[b->out.size / 2];
+        break;
+    case OP_FILTER:
+        if (b->pool) nv_par_filter_float(b->pool, b->vec, &b->out, above_half);
+        else nv_filter_float(b->vec, &b->out, above_half);
+        b->has_out = 1;
+        sink += (float)b->out.size;
+        break;
+    case OP_REDUCE:
+        if (b->pool) {
+            nv_par_reduce_float(b->pool, b->vec, 0.0f, add, &sum);
+        } else {
+            sum = 0.0f;
+            for (size_t i = 0; i < b->vec->size; i++) sum = add(sum, b->vec->data[i]);
+        }
+        sink += sum;
+        break;
+    case OP_SORT:
+        if (b->pool) nv_par_sort_float(b->pool, b->vec, compare_float);
+        else qsort(b->vec->data, b->vec->size, sizeof(float), compare_float);
+        break;
+    }
+}
+
+int main(int argc, char** argv) {
+    printf("==============================================\n");
+    printf("  NanoDS v%s Parallel Algorithms Benchmark\n", NANODS_VERSION);
+    printf("==============================================\n\n");
+
+    nb_init(argc, argv, "parallel");
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = online > 0 ? (size_t)online : 1;
+    FloatVector vec;
+    nv_init_float(&vec);
+    if (nv_reserve_float(&vec, ELEMENTS) != NANODS_OK) return 1;
+
+    static const size_t counts[MAX_POOLS] = {1, 2, 4, 8, 16, 32, 64};
+    static const char* names[MAX_POOLS] = {
+        "threads_1", "threads_2", "threads_4", "threads_8", "threads_16", "threads_32", "threads_64"
+    };
+    static NanoThreadPool pools[MAX_POOLS];
+    size_t pool_count = 0;
+    while (pool_count < MAX_POOLS) {
+        /* Always include 2 and 4 threads, even when oversubscribed */
+        size_t c = counts[pool_count];
+        if (c > max_threads && c > 4) break;
+        if (ntp_init(&pools[pool_count], c) != NANODS_OK) break;
+        pool_count++;
+    }
+
+    static const char* groups[] = { "map", "filter", "reduce", "sort" };
+    int sorted = 1;
+    for (int op = OP_MAP; op <= OP_SORT; op++) {
+        ParBench b = { NULL, (Op)op, &vec, {0}, 0 };
+        nb_run_whole(&(NanoBenchCase){ groups[op], "serial", NULL, ELEMENTS,
+                                       run_par, reset_par, &b });
+        reset_par(&b);
+        for (size_t p = 0; p < pool_count; p++) {
+            b.pool = &pools[p];
+            if (!nb_run_whole(&(NanoBenchCase){ groups[op], names[p], "serial", ELEMENTS,
+                                                run_par, reset_par, &b })) continue;
+            if (op == OP_SORT) {
+                for (size_t i = 1; i < vec.size; i++) sorted &= vec.data[i - 1] <= vec.data[i];
+            }
+            reset_par(&b);
+        }
+    }
+    if (!sorted) printf("  sort: check failed!\n");
+
+    for (size_t p = 0; p < pool_count; p++) ntp_free(&pools[p]);
+    nv_free_float(&vec);
+    printf("\n==============================================\n");
+    int rc = nb_finish();
+    return sorted ? rc : 1;
+}
+#endif
@@ -1,4 +1,8 @@
-#if defined(_POSIX_C_SOURCE) || defined(__linux__) || defined(__unix__)
+#if defined(__linux__)
+    #ifndef _GNU_SOURCE
+        #define _GNU_SOURCE                /* sched_setaffinity for --pin */
+    #endif
+#elif defined(_POSIX_C_SOURCE) || defined(__unix__)
     #ifndef _POSIX_C_SOURCE
         #define _POSIX_C_SOURCE 199309L
     #endif
@@ -6,73 +10,216 @@
 
 #define NANODS_IMPLEMENTATION
 #include "../nanods.h"
-#include <stdio.h>
-#include <time.h>
+#include "bench_harness.h"
+
+/*
+ * Ring buffer write/read pairs, block transfer with nr_write_n/nr_read_n and,
+ * where threads are available, a two-thread handoff through NanoSpscRing vs a
+ * mutex-guarded NanoRing. Same options as bench_comparison. Sizes are chosen
+ * so one trial stays in the tens of milliseconds.
+ */
 
 #define ITERATIONS 10000000
+#define HANDOFF_MESSAGES 1000000
+
+#define BULK_SAMPLES 4000000
+
+NANODS_DEFINE_RING_POW2(float, 4096)
+
+#if defined(NANODS_HAVE_ATOMICS) && !defined(_WIN32)
+    #define BENCH_THREADS 1
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+/* Keeps the reads observable */
+static volatile long long sink;
+
+/* ---- Write/read pairs (256-element ring) ------------------------------------------ */
+
+static IntRing256 g_ring;
+
+static void reset_ring(void* ctx) {
+    (void)ctx;
+    nr_init_int_256(&g_ring);
+}
+
+/* Operation i and i + 1 are one write/read pair */
+static void run_pairs(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    long long sum = 0;
+    for (size_t i = begin / 2; i < end / 2; i++) {
+        if (!nr_is_full_int_256(&g_ring)) {
+            nr_write_int_256(&g_ring, (int)i);
+        }
+        if (!nr_is_empty_int_256(&g_ring)) {
+            int val;
+            nr_read_int_256(&g_ring, &val);
+            sum += val;
+        }
+    }
+    sink += sum;
+}
+
+/* ---- Block transfer of audio-style samples: one call per element vs one per block -- */
+
+typedef struct {
+    size_t block;
+    NanoRing_float_4096 ring;
+} BulkBench;
+
+static float g_in[1024], g_out[1024];
+
+static void reset_bulk(void* ctx) {
+    BulkBench* b = ctx;
+    nr_init_float_4096(&b->ring);
+    nr_write_n_float_4096(&b->ring, g_in, 100);   /* Keep the indices off zero */
+}
+
+/* Round r covers operations [r * block, (r + 1) * block); a batch runs the rounds that end in it */
+static void run_bulk_single(void* ctx, size_t begin, size_t end) {
+    BulkBench* b = ctx;
+    float acc = 0.0f;
+    for (size_t r = begin / b->block; r < end / b->block; r++) {
+        for (size_t i = 0; i < b->block; i++) nr_write_float_4096(&b->ring, g_in[i]);
+        for (size_t i = 0; i < b->block; i++) nr_read_float_4096(&b->ring, &g_out[i]);
+        acc += g_out[b->block - 1];
+    }
+    sink += (long long)acc;
+}
+
+static void run_bulk_n(void* ctx, size_t begin, size_t end) {
+    BulkBench* b = ctx;
+    float acc = 0.0f;
+    for (size_t r = begin / b->block; r < end / b->block; r++) {
+        nr_write_n_float_4096(&b->ring, g_in, b->block);
+        nr_read_n_float_4096(&b->ring, g_out, b->block);
+        acc += g_out[b->block - 1];
+    }
+    sink += (long long)acc;
+}
+
+static void benchmark_bulk(void) {
+    static BulkBench benches[] = { { .block = 64 }, { .block = 256 }, { .block = 1024 } };
+    static const char* groups[] = { "bulk_64", "bulk_256", "bulk_1024" };
+    for (int i = 0; i < 1024; i++) g_in[i] = (float)i;
 
-#if defined(_WIN32) || defined(_WIN64)
-    #include <windows.h>
-    double get_time_ms(void) {
-        LARGE_INTEGER frequency, counter;
-        QueryPerformanceFrequency(&frequency);
-        QueryPerformanceCounter(&counter);
-        return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        nb_run(&(NanoBenchCase){ groups[b], "per_element", NULL, BULK_SAMPLES,
+                                 run_bulk_single, reset_bulk, &benches[b] });
+        nb_run(&(NanoBenchCase){ groups[b], "nr_n", "per_element", BULK_SAMPLES,
+                                 run_bulk_n, reset_bulk, &benches[b] });
     }
-#elif defined(__APPLE__) || defined(__MACH__)
-    #include <mach/mach_time.h>
-    double get_time_ms(void) {
-        static mach_timebase_info_data_t timebase;
-        if (timebase.denom == 0) mach_timebase_info(&timebase);
-        uint64_t time = mach_absolute_time();
-        return (double)(time * timebase.numer / timebase.denom) / 1000000.0;
+}
+
+#ifdef BENCH_THREADS
+/* ---- Cross-thread handoff: lock-free SPSC ring vs the plain ring behind a mutex ---- */
+
+static IntSpscRing1024 g_spsc;
+static IntRing256 g_locked;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static int g_handoff_ok = 1;
+
+static void* spsc_producer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < HANDOFF_MESSAGES; i++) {
+        while (nsr_write_int_1024(&g_spsc, i) != NANODS_OK) sched_yield();
+    }
+    return NULL;
+}
+
+static void* locked_producer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < HANDOFF_MESSAGES; ) {
+        pthread_mutex_lock(&g_lock);
+        int full = nr_is_full_int_256(&g_locked);
+        if (!full) nr_write_int_256(&g_locked, i++);
+        pthread_mutex_unlock(&g_lock);
+        if (full) sched_yield();
+    }
+    return NULL;
+}
+
+static void check_handoff(long long sum) {
+    if (sum != (long long)HANDOFF_MESSAGES * (HANDOFF_MESSAGES - 1) / 2) g_handoff_ok = 0;
+}
+
+static void reset_spsc(void* ctx) {
+    (void)ctx;
+    nsr_init_int_1024(&g_spsc);
+}
+
+static void reset_locked(void* ctx) {
+    (void)ctx;
+    nr_init_int_256(&g_locked);
+}
+
+/* Whole trial; thread start-up is inside the timed region, as it was before the harness */
+static void run_spsc_handoff(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    long long sum = 0;
+    pthread_t producer;
+    int val;
+    pthread_create(&producer, NULL, spsc_producer, NULL);
+    for (int i = 0; i < HANDOFF_MESSAGES; ) {
+        if (nsr_read_int_1024(&g_spsc, &val) == NANODS_OK) { sum += val; i++; } else sched_yield();
     }
-#else
-    double get_time_ms(void) {
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+    pthread_join(producer, NULL);
+    check_handoff(sum);
+}
+
+static void run_locked_handoff(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    long long sum = 0;
+    pthread_t producer;
+    int val;
+    pthread_create(&producer, NULL, locked_producer, NULL);
+    for (int i = 0; i < HANDOFF_MESSAGES; ) {
+        pthread_mutex_lock(&g_lock);
+        int empty = nr_is_empty_int_256(&g_locked);
+        if (!empty) { nr_read_int_256(&g_locked, &val); sum += val; i++; }
+        pthread_mutex_unlock(&g_lock);
+        if (empty) sched_yield();
     }
+    pthread_join(producer, NULL);
+    check_handoff(sum);
+}
+
+static void benchmark_handoff(void) {
+    nb_run_whole(&(NanoBenchCase){ "handoff", "mutex_ring", NULL, HANDOFF_MESSAGES,
+                                   run_locked_handoff, reset_locked, NULL });
+    nb_run_whole(&(NanoBenchCase){ "handoff", "spsc_ring", "mutex_ring", HANDOFF_MESSAGES,
+                                   run_spsc_handoff, reset_spsc, NULL });
+    if (!g_handoff_ok) printf("  handoff: checksum mismatch!\n");
+}
 #endif
 
-int main(void) {
+int main(int argc, char** argv) {
     printf("==============================================\n");
     printf("  NanoDS v%s Ring Buffer Benchmark\n", NANODS_VERSION);
     printf("==============================================\n\n");
-    
+
     nanods_seed_init(0);
-    
-    /* Benchmark:  Write/Read (256-element ring) */
-    {
-        IntRing256 ring;
-        nr_init_int_256(&ring);
-        
-        double start = get_time_ms();
-        for (int i = 0; i < ITERATIONS; i++) {
-            if (! nr_is_full_int_256(&ring)) {
-                nr_write_int_256(&ring, i);
-            }
-            if (!nr_is_empty_int_256(&ring)) {
-                int val;
-                nr_read_int_256(&ring, &val);
-            }
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Ring Buffer (256 elements):\n");
-        printf("  Operations:  %d write/read pairs\n", ITERATIONS);
-        printf("  Time:       %.2f ms\n", elapsed);
-        printf("  Throughput:  %.0f ops/sec\n", (ITERATIONS * 2) / (elapsed / 1000.0));
-        printf("  Latency:    %.3f µs/op\n", (elapsed * 1000.0) / (ITERATIONS * 2));
-        printf("  Memory:     Stack-allocated (zero heap)\n\n");
-    }
-    
-    printf("==============================================\n");
-    printf("Ring buffers are ideal for:\n");
-    printf("  - Real-time audio/video streaming\n");
-    printf("  - Embedded systems (no dynamic allocation)\n");
-    printf("  - Producer-consumer queues\n");
-    printf("==============================================\n");
-    return 0;
-}
\ No newline at end of file
+    nb_init(argc, argv, "ring");
+
+    /* Two operations per iteration; the ring itself never touches the heap */
+    nb_run(&(NanoBenchCase){ "ring_256", "write_read", NULL, (size_t)ITERATIONS * 2,
+                             run_pairs, reset_ring, NULL });
+
+    benchmark_bulk();
+
+#ifdef BENCH_THREADS
+    benchmark_handoff();
+#endif
+
+    printf("\n==============================================\n");
+    int rc = nb_finish();
+#ifdef BENCH_THREADS
+    if (!g_handoff_ok) rc = 1;
+#endif
+    return rc;
+}
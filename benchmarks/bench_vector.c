@@ -1,4 +1,8 @@
-#if defined(_POSIX_C_SOURCE) || defined(__linux__) || defined(__unix__)
+#if defined(__linux__)
+    #ifndef _GNU_SOURCE
+        #define _GNU_SOURCE                /* sched_setaffinity for --pin */
+    #endif
+#elif defined(_POSIX_C_SOURCE) || defined(__unix__)
     #ifndef _POSIX_C_SOURCE
         #define _POSIX_C_SOURCE 199309L
     #endif
@@ -6,129 +10,437 @@
 
 #define NANODS_IMPLEMENTATION
 #include "../nanods.h"
-#include <stdio.h>
-#include <time.h>
+#include "bench_harness.h"
+
+/*
+ * Vector operations, each against the plain or function-pointer form it
+ * replaces. Same options as bench_comparison (--json FILE, --trials N, ...).
+ */
 
 #define ITERATIONS 1000000
+#define BATCH 256
+#define GET_SIZE 10000
+
+/* Keeps results alive so the optimizer cannot drop the loops */
+static volatile long long sink;
+
+/* Same operations as function pointers and as inlined expressions */
+static int scale(int x) { return x * 3 + 1; }
+static int keep_even(int x) { return x % 2 == 0; }
+
+NANODS_DEFINE_VECTOR_MAP(int, scale, x * 3 + 1)
+NANODS_DEFINE_VECTOR_FILTER(int, even, x % 2 == 0)
+NANODS_DEFINE_VECTOR_REDUCE(int, sum, long long, acc + x)
+NANODS_DEFINE_SMALL_VECTOR(int, 8)
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_float(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+/* ---- Push and get ---------------------------------------------------------------- */
+
+static IntVector g_vec;
+static uint8_t g_push_flags;
+static int g_batch[BATCH];
 
-#if defined(_WIN32) || defined(_WIN64)
-    #include <windows.h>
-    double get_time_ms(void) {
-        LARGE_INTEGER frequency, counter;
-        QueryPerformanceFrequency(&frequency);
-        QueryPerformanceCounter(&counter);
-        return (double)(counter.QuadPart * 1000.0) / frequency.QuadPart;
+static void reset_push(void* ctx) {
+    (void)ctx;
+    nv_free_int(&g_vec);
+    nv_init_ex_int(&g_vec, g_push_flags);
+}
+
+static void run_push(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) nv_push_int(&g_vec, (int)i);
+}
+
+/* The reserve is part of the first batch */
+static void run_reserve_push(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    if (begin == 0) nv_reserve_int(&g_vec, ITERATIONS);
+    for (size_t i = begin; i < end; i++) nv_push_int(&g_vec, (int)i);
+}
+
+static void run_get(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    int val;
+    for (size_t i = begin; i < end; i++) {
+        nv_get_int(&g_vec, i % GET_SIZE, &val);
+        sink += val;
     }
-#elif defined(__APPLE__) || defined(__MACH__)
-    #include <mach/mach_time.h>
-    double get_time_ms(void) {
-        static mach_timebase_info_data_t timebase;
-        if (timebase. denom == 0) mach_timebase_info(&timebase);
-        uint64_t time = mach_absolute_time();
-        return (double)(time * timebase.numer / timebase.denom) / 1000000.0;
+}
+
+/* Concatenating decoded batches; a timed range runs the BATCH-sized rounds that end in it */
+static void run_append_push(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t r = begin / BATCH; r < end / BATCH; r++) {
+        for (int i = 0; i < BATCH; i++) nv_push_int(&g_vec, g_batch[i]);
     }
-#else
-    double get_time_ms(void) {
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void run_append_extend(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t r = begin / BATCH; r < end / BATCH; r++) nv_extend_int(&g_vec, g_batch, BATCH);
+}
+
+/* ---- Functional ops: function pointers vs inlined (vectorizable) forms ------------ */
+
+static IntVector g_out;
+/* Opaque pointers, as for callbacks defined in another translation unit */
+static int (*volatile g_map_fn)(int) = scale;
+static int (*volatile g_filter_fn)(int) = keep_even;
+
+/* Whole trial, as are the sorts and reductions below: each call covers the whole vector */
+static void run_map_ptr(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_map_int(&g_vec, &g_out, g_map_fn);
+    sink += g_out.data[1];
+    nv_free_int(&g_out);
+}
+
+static void run_map_inline(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_map_scale_int(&g_vec, &g_out);
+    sink += g_out.data[1];
+    nv_free_int(&g_out);
+}
+
+static void run_filter_ptr(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_filter_int(&g_vec, &g_out, g_filter_fn);
+    sink += (long long)g_out.size;
+    nv_free_int(&g_out);
+}
+
+static void run_filter_inline(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_filter_even_int(&g_vec, &g_out);
+    sink += (long long)g_out.size;
+    nv_free_int(&g_out);
+}
+
+static void run_reduce_get(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    long long sum = 0;
+    int value;
+    for (size_t i = 0; i < nv_size_int(&g_vec); i++) {
+        nv_get_int(&g_vec, i, &value);
+        sum += value;
     }
-#endif
+    sink += sum;
+}
+
+static void run_reduce_inline(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    sink += nv_reduce_sum_int(&g_vec, 0);
+}
+
+/* ---- Sort and search ----------------------------------------------------------------- */
+
+static IntVector g_isrc, g_isort;
+static FloatVector g_fsrc, g_fsort;
+
+static void reset_sort_int(void* ctx) {
+    (void)ctx;
+    memcpy(g_isort.data, g_isrc.data, g_isrc.size * sizeof(int));
+}
+
+static void reset_sort_float(void* ctx) {
+    (void)ctx;
+    memcpy(g_fsort.data, g_fsrc.data, g_fsrc.size * sizeof(float));
+}
+
+static void run_qsort_int(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    qsort(g_isort.data, g_isort.size, sizeof(int), compare_int);
+}
+
+static void run_nv_sort_int(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_sort_int(&g_isort);
+}
+
+static void run_radix_sort_int(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_radix_sort_int(&g_isort);
+}
+
+static void run_qsort_float(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    qsort(g_fsort.data, g_fsort.size, sizeof(float), compare_float);
+}
+
+static void run_nv_sort_float(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_sort_float(&g_fsort);
+}
+
+static void run_radix_sort_float(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    nv_radix_sort_float(&g_fsort);
+}
 
-int main(void) {
+/* Every key is present; g_isort is sorted by then */
+static void run_bsearch(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) {
+        int key = g_isrc.data[i];
+        sink += bsearch(&key, g_isort.data, g_isort.size, sizeof(int), compare_int) != NULL;
+    }
+}
+
+static void run_nv_bsearch(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) {
+        sink += nv_bsearch_int(&g_isort, g_isrc.data[i], NULL) == NANODS_OK;
+    }
+}
+
+/* ---- Reductions: plain loops vs the vectorized kernels ------------------------------ */
+
+static FloatVector g_fvec;
+static IntVector g_ivec;
+static int g_absent = -1;
+
+static void run_sum_loop(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    float sum = 0.0f;
+    for (size_t i = 0; i < g_fvec.size; i++) sum += g_fvec.data[i];
+    sink += (long long)sum;
+}
+
+static void run_sum_simd(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    sink += (long long)nv_sum_float(&g_fvec);
+}
+
+static void run_dot_loop(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    float dot = 0.0f;
+    for (size_t i = 0; i < g_fvec.size; i++) dot += g_fvec.data[i] * g_fvec.data[i];
+    sink += (long long)dot;
+}
+
+static void run_dot_simd(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    float dot;
+    nv_dot_float(&g_fvec, &g_fvec, &dot);
+    sink += (long long)dot;
+}
+
+static void run_min_loop(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    int best = g_ivec.data[0];
+    for (size_t i = 1; i < g_ivec.size; i++) if (g_ivec.data[i] < best) best = g_ivec.data[i];
+    sink += best;
+}
+
+static void run_min_simd(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    int best;
+    nv_min_int(&g_ivec, &best);
+    sink += best;
+}
+
+/* The needle is absent, so every search scans the whole vector */
+static void run_find_loop(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    size_t i = 0;
+    while (i < g_ivec.size && g_ivec.data[i] != g_absent) i++;
+    sink += (long long)i;
+}
+
+static void run_find_simd(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    (void)begin;
+    (void)end;
+    size_t at = 0;
+    sink += nv_find_int(&g_ivec, g_absent, &at) == NANODS_OK ? (long long)at
+                                                            : (long long)g_ivec.size;
+}
+
+/* ---- Short-lived vectors of a few elements, heap vs inline storage ------------------ */
+
+static void run_small_heap(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (int i = (int)begin; i < (int)end; i++) {
+        IntVector tags;
+        nv_init_int(&tags);
+        for (int k = 0; k < 1 + i % 8; k++) nv_push_int(&tags, i + k);
+        sink += tags.data[tags.size - 1];
+        nv_free_int(&tags);
+    }
+}
+
+static void run_small_inline(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (int i = (int)begin; i < (int)end; i++) {
+        NanoSmallVector_int_8 tags;
+        nsv_init_int_8(&tags);
+        for (int k = 0; k < 1 + i % 8; k++) nsv_push_int_8(&tags, i + k);
+        sink += tags.data[tags.size - 1];
+        nsv_free_int_8(&tags);
+    }
+}
+
+int main(int argc, char** argv) {
     printf("==============================================\n");
     printf("  NanoDS v%s Vector Benchmark\n", NANODS_VERSION);
     printf("==============================================\n\n");
-    
-    /* Initialize random seed */
+
     nanods_seed_init(0);
-    
-    /* Benchmark 1: Sequential Push */
-    {
-        IntVector vec;
-        nv_init_int(&vec);
-        
-        double start = get_time_ms();
-        for (int i = 0; i < ITERATIONS; i++) {
-            nv_push_int(&vec, i);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Sequential Push (%d ops):\n", ITERATIONS);
-        printf("  Time:          %.2f ms\n", elapsed);
-        printf("  Throughput:    %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:      %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nv_free_int(&vec);
-    }
-    
-    /* Benchmark 2: Random Access (Get) */
-    {
-        IntVector vec;
-        nv_init_int(&vec);
-        
-        for (int i = 0; i < 10000; i++) {
-            nv_push_int(&vec, i);
-        }
-        
-        double start = get_time_ms();
-        int val;
-        for (int i = 0; i < ITERATIONS; i++) {
-            nv_get_int(&vec, i % 10000, &val);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Random Access Get (%d ops):\n", ITERATIONS);
-        printf("  Time:         %.2f ms\n", elapsed);
-        printf("  Throughput:   %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:      %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nv_free_int(&vec);
-    }
-    
-    /* Benchmark 3: Reserve Performance */
-    {
-        IntVector vec;
-        nv_init_int(&vec);
-        
-        double start = get_time_ms();
-        nv_reserve_int(&vec, ITERATIONS);
-        for (int i = 0; i < ITERATIONS; i++) {
-            nv_push_int(&vec, i);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Pre-Reserved Push (%d ops):\n", ITERATIONS);
-        printf("  Time:         %.2f ms\n", elapsed);
-        printf("  Throughput:   %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:      %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nv_free_int(&vec);
+    nb_init(argc, argv, "vector");
+
+    /* Push: growth from empty, pre-reserved, and with NANODS_FLAG_SECURE wipes */
+    nv_init_int(&g_vec);
+    nb_run(&(NanoBenchCase){ "push", "nv_push", NULL, ITERATIONS, run_push, reset_push, NULL });
+    nb_run(&(NanoBenchCase){ "push", "reserved", "nv_push", ITERATIONS,
+                             run_reserve_push, reset_push, NULL });
+    g_push_flags = NANODS_FLAG_SECURE;
+    nb_run(&(NanoBenchCase){ "push", "secure", "nv_push", ITERATIONS,
+                             run_push, reset_push, NULL });
+    g_push_flags = NANODS_FLAG_NONE;
+
+    /* Batch append: push loop vs nv_extend */
+    for (int i = 0; i < BATCH; i++) g_batch[i] = i;
+    nb_run(&(NanoBenchCase){ "append", "push_loop", NULL, ITERATIONS / BATCH * BATCH,
+                             run_append_push, reset_push, NULL });
+    nb_run(&(NanoBenchCase){ "append", "nv_extend", "push_loop", ITERATIONS / BATCH * BATCH,
+                             run_append_extend, reset_push, NULL });
+
+    nv_clear_int(&g_vec);
+    for (int i = 0; i < GET_SIZE; i++) nv_push_int(&g_vec, i);
+    nb_run(&(NanoBenchCase){ "get", "nv_get", NULL, ITERATIONS, run_get, NULL, NULL });
+
+    /* Map/filter/reduce over one vector, ns per element */
+    nv_clear_int(&g_vec);
+    for (int i = 0; i < ITERATIONS; i++) nv_push_int(&g_vec, i);
+    nb_run_whole(&(NanoBenchCase){ "map", "fn_ptr", NULL, ITERATIONS,
+                                   run_map_ptr, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "map", "inlined", "fn_ptr", ITERATIONS,
+                                   run_map_inline, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "filter", "fn_ptr", NULL, ITERATIONS,
+                                   run_filter_ptr, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "filter", "inlined", "fn_ptr", ITERATIONS,
+                                   run_filter_inline, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "reduce", "nv_get_loop", NULL, ITERATIONS,
+                                   run_reduce_get, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "reduce", "inlined", "nv_get_loop", ITERATIONS,
+                                   run_reduce_inline, NULL, NULL });
+    nv_free_int(&g_vec);
+
+    /* Sort: the same random input each trial */
+    nv_init_int(&g_isrc);
+    nv_init_float(&g_fsrc);
+    uint32_t state = 12345;
+    for (int i = 0; i < ITERATIONS; i++) {
+        state = state * 1664525u + 1013904223u;
+        nv_push_int(&g_isrc, (int)state);
+        nv_push_float(&g_fsrc, (float)(int)state / 65536.0f);
     }
-    
-    /* Benchmark 4: Secure Flag Performance */
-    {
-        IntVector vec;
-        nv_init_ex_int(&vec, NANODS_FLAG_SECURE);
-        
-        double start = get_time_ms();
-        for (int i = 0; i < ITERATIONS; i++) {
-            nv_push_int(&vec, i);
-        }
-        double end = get_time_ms();
-        double elapsed = end - start;
-        
-        printf("Secure Mode Push (%d ops):\n", ITERATIONS);
-        printf("  Time:         %.2f ms\n", elapsed);
-        printf("  Throughput:   %.0f ops/sec\n", ITERATIONS / (elapsed / 1000.0));
-        printf("  Latency:      %.3f µs/op\n\n", (elapsed * 1000.0) / ITERATIONS);
-        
-        nv_free_int(&vec);
+    nv_init_int(&g_isort);
+    nv_extend_int(&g_isort, g_isrc.data, g_isrc.size);
+    nv_init_float(&g_fsort);
+    nv_extend_float(&g_fsort, g_fsrc.data, g_fsrc.size);
+    nb_run_whole(&(NanoBenchCase){ "sort_int", "qsort", NULL, ITERATIONS,
+                                   run_qsort_int, reset_sort_int, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sort_int", "nv_sort", "qsort", ITERATIONS,
+                                   run_nv_sort_int, reset_sort_int, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sort_int", "nv_radix_sort", "qsort", ITERATIONS,
+                                   run_radix_sort_int, reset_sort_int, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sort_float", "qsort", NULL, ITERATIONS,
+                                   run_qsort_float, reset_sort_float, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sort_float", "nv_sort", "qsort", ITERATIONS,
+                                   run_nv_sort_float, reset_sort_float, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sort_float", "nv_radix_sort", "qsort", ITERATIONS,
+                                   run_radix_sort_float, reset_sort_float, NULL });
+
+    /* Search the sorted copy for every original key */
+    nv_sort_int(&g_isort);
+    nb_run(&(NanoBenchCase){ "search", "bsearch", NULL, ITERATIONS, run_bsearch, NULL, NULL });
+    nb_run(&(NanoBenchCase){ "search", "nv_bsearch", "bsearch", ITERATIONS,
+                             run_nv_bsearch, NULL, NULL });
+    nv_free_int(&g_isrc);
+    nv_free_int(&g_isort);
+    nv_free_float(&g_fsrc);
+    nv_free_float(&g_fsort);
+
+    /* Reductions, ns per element */
+    nv_init_float(&g_fvec);
+    nv_init_int(&g_ivec);
+    for (int i = 0; i < ITERATIONS; i++) {
+        nv_push_float(&g_fvec, (float)(i % 1000) * 0.001f);
+        nv_push_int(&g_ivec, (int)(((unsigned)i * 7919u) % 100000u));
     }
-    
-    printf("==============================================\n");
-    return 0;
-}
\ No newline at end of file
+    nb_run_whole(&(NanoBenchCase){ "sum_float", "loop", NULL, ITERATIONS,
+                                   run_sum_loop, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "sum_float", "nv_sum", "loop", ITERATIONS,
+                                   run_sum_simd, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "dot_float", "loop", NULL, ITERATIONS,
+                                   run_dot_loop, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "dot_float", "nv_dot", "loop", ITERATIONS,
+                                   run_dot_simd, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "min_int", "loop", NULL, ITERATIONS,
+                                   run_min_loop, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "min_int", "nv_min", "loop", ITERATIONS,
+                                   run_min_simd, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "find_int", "loop", NULL, ITERATIONS,
+                                   run_find_loop, NULL, NULL });
+    nb_run_whole(&(NanoBenchCase){ "find_int", "nv_find", "loop", ITERATIONS,
+                                   run_find_simd, NULL, NULL });
+    nv_free_float(&g_fvec);
+    nv_free_int(&g_ivec);
+
+    /* 1-8 ints per vector: heap NanoVector vs NanoSmallVector_int_8 */
+    nb_run(&(NanoBenchCase){ "small_vector", "nanovector", NULL, ITERATIONS,
+                             run_small_heap, NULL, NULL });
+    nb_run(&(NanoBenchCase){ "small_vector", "inline_8", "nanovector", ITERATIONS,
+                             run_small_inline, NULL, NULL });
+
+    printf("\n==============================================\n");
+    return nb_finish();
+}
@@ -14,21 +14,41 @@ else
     CC=gcc
 fi
 
+# Machine-readable results (one JSON file per harness suite), optional core
+# pinning, trial count and operations per timed batch:
+#   RESULTS_DIR=out PIN_CPU=2 TRIALS=51 BATCH=4096 ./run_benchmarks.sh
+# Threads inherit the pinning, so PIN_CPU puts the queue, parallel and
+# concurrent map suites on one core: leave it unset to measure scaling.
+RESULTS_DIR=${RESULTS_DIR:-results}
+HARNESS_ARGS=""
+[ -n "$PIN_CPU" ] && HARNESS_ARGS="$HARNESS_ARGS --pin $PIN_CPU"
+[ -n "$TRIALS" ] && HARNESS_ARGS="$HARNESS_ARGS --trials $TRIALS"
+[ -n "$BATCH" ] && HARNESS_ARGS="$HARNESS_ARGS --batch $BATCH"
+mkdir -p "$RESULTS_DIR"
+
+# Stop at the first benchmark that fails to compile
+build() {
+    src=$1
+    shift
+    if ! $CC -std=c11 -Wall -Wextra -O3 -march=native "$src" "$@"; then
+        echo "Build failed: $src"
+        exit 1
+    fi
+}
+
 echo "Compiler: $CC"
 echo ""
 
 # Build benchmarks
 echo "Building benchmarks..."
-$CC -std=c11 -Wall -Wextra -O3 -march=native bench_vector.c -o bench_vector
-$CC -std=c11 -Wall -Wextra -O3 -march=native bench_map.c -o bench_map
-$CC -std=c11 -Wall -Wextra -O3 -march=native bench_comparison.c -o bench_comparison
-$CC -std=c11 -Wall -Wextra -O3 -march=native bench_list2.c -o bench_list2
-$CC -std=c11 -Wall -Wextra -O3 -march=native bench_ring.c -o bench_ring
-
-if [ $? -ne 0 ]; then
-    echo "Build failed!"
-    exit 1
-fi
+build bench_vector.c -o bench_vector
+build bench_map.c -o bench_map
+build bench_comparison.c -o bench_comparison
+build bench_list2.c -o bench_list2
+build bench_ring.c -o bench_ring -pthread
+build bench_queue.c -o bench_queue -pthread
+build bench_parallel.c -o bench_parallel -pthread
+build bench_concurrent_map.c -o bench_concurrent_map -pthread
 
 echo "Build successful!"
 echo ""
@@ -37,31 +57,49 @@ echo ""
 echo "========================================"
 echo "Running Vector Benchmark..."
 echo "========================================"
-./bench_vector
+./bench_vector $HARNESS_ARGS --json "$RESULTS_DIR/vector.json"
 echo ""
 
 echo "========================================"
 echo "Running Map Benchmark..."
 echo "========================================"
-./bench_map
+./bench_map $HARNESS_ARGS --json "$RESULTS_DIR/map.json"
 echo ""
 
 echo "========================================"
 echo "Running Comparison Benchmark..."
 echo "========================================"
-./bench_comparison
+./bench_comparison $HARNESS_ARGS --json "$RESULTS_DIR/comparison.json"
 echo ""
 
 echo "========================================"
 echo "Running Doubly Linked List Benchmark..."
 echo "========================================"
-./bench_list2
+./bench_list2 $HARNESS_ARGS --json "$RESULTS_DIR/list2.json"
 echo ""
 
 echo "========================================"
 echo "Running Ring Buffer Benchmark..."
 echo "========================================"
-./bench_ring
+./bench_ring $HARNESS_ARGS --json "$RESULTS_DIR/ring.json"
+echo ""
+
+echo "========================================"
+echo "Running MPMC Queue Benchmark..."
+echo "========================================"
+./bench_queue $HARNESS_ARGS --json "$RESULTS_DIR/queue.json"
+echo ""
+
+echo "========================================"
+echo "Running Parallel Algorithms Benchmark..."
+echo "========================================"
+./bench_parallel $HARNESS_ARGS --json "$RESULTS_DIR/parallel.json"
+echo ""
+
+echo "========================================"
+echo "Running Concurrent Map Benchmark..."
+echo "========================================"
+./bench_concurrent_map $HARNESS_ARGS --json "$RESULTS_DIR/concurrent_map.json"
 echo ""
 
 echo "========================================"
@@ -69,4 +107,4 @@ echo "Benchmarks complete!"
 echo "========================================"
 
 # Cleanup
-rm -f bench_vector bench_map bench_comparison bench_list2 bench_ring
\ No newline at end of file
+rm -f bench_vector bench_map bench_comparison bench_list2 bench_ring bench_queue bench_parallel bench_concurrent_map
\ No newline at end of file
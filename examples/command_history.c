@@ -6,6 +6,7 @@
  * - Vector usage for sequential data
  * - Custom struct storage
  * - Search and filtering
+ * - Bounded recent-command buffer (NanoRing with NANODS_FLAG_OVERWRITE)
  */
 
 #define NANODS_IMPLEMENTATION
@@ -21,13 +22,27 @@ typedef struct {
 } Command;
 
 NANODS_DEFINE_VECTOR(Command)
+NANODS_DEFINE_RING(Command, 4)   /* Last 4 commands, oldest overwritten */
 
-void add_command(NanoVector_Command* history, const char* cmd, int timestamp) {
+void add_command(NanoVector_Command* history, NanoRing_Command_4* recent,
+                 const char* cmd, int timestamp) {
     Command c;
     strncpy(c.cmd, cmd, MAX_CMD_LEN - 1);
     c.cmd[MAX_CMD_LEN - 1] = '\0';
     c.timestamp = timestamp;
     nv_push_Command(history, c);
+    nr_write_Command_4(recent, c);   /* Never full: drops the oldest instead */
+}
+
+void display_recent(const NanoRing_Command_4* recent) {
+    Command last[4];
+    size_t n = nr_peek_n_Command_4(recent, last, 4);
+    printf("Recent ring (%zu of %zu slots, oldest first):\n", n, nr_capacity_Command_4(recent));
+    printf("─────────────────────────────────────────────\n");
+    for (size_t i = 0; i < n; i++) {
+        printf("    [T=%04d] %s\n", last[i].timestamp, last[i].cmd);
+    }
+    printf("\n");
 }
 
 void display_history(const NanoVector_Command* history) {
@@ -113,23 +128,26 @@ int main(void) {
     
     NanoVector_Command history;
     nv_init_Command(&history);
+    NanoRing_Command_4 recent;
+    nr_init_ex_Command_4(&recent, NANODS_FLAG_OVERWRITE);
     
     printf("Simulating user commands...\n\n");
     
-    add_command(&history, "ls -la", 1000);
-    add_command(&history, "cd /home/user", 1005);
-    add_command(&history, "git status", 1010);
-    add_command(&history, "git add .", 1015);
-    add_command(&history, "git commit -m 'Initial commit'", 1020);
-    add_command(&history, "git push origin main", 1025);
-    add_command(&history, "make clean", 1030);
-    add_command(&history, "make all", 1035);
-    add_command(&history, "./program", 1040);
-    add_command(&history, "git log --oneline", 1045);
+    add_command(&history, &recent, "ls -la", 1000);
+    add_command(&history, &recent, "cd /home/user", 1005);
+    add_command(&history, &recent, "git status", 1010);
+    add_command(&history, &recent, "git add .", 1015);
+    add_command(&history, &recent, "git commit -m 'Initial commit'", 1020);
+    add_command(&history, &recent, "git push origin main", 1025);
+    add_command(&history, &recent, "make clean", 1030);
+    add_command(&history, &recent, "make all", 1035);
+    add_command(&history, &recent, "./program", 1040);
+    add_command(&history, &recent, "git log --oneline", 1045);
     
     display_history(&history);
     search_history(&history, "git");
     get_recent_commands(&history, 3);
+    display_recent(&recent);
     clear_old_commands(&history, 1020);
     display_history(&history);
     
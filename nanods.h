@@ -28,6 +28,102 @@
 #include <assert.h>
 #include <time.h>
 
+/* SIMD intrinsics (define NANODS_NO_SIMD to force portable scalar code) */
+#if !defined(NANODS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define NANODS_HAVE_SSE2 1
+#elif !defined(NANODS_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+    #include <arm_neon.h>
+    #define NANODS_HAVE_NEON 1
+#endif
+/* Wider x86 kernels when the compiler targets them (-mavx2, -mavx512f, -march=native) */
+#if !defined(NANODS_NO_SIMD) && (defined(__AVX2__) || defined(__AVX512F__))
+    #include <immintrin.h>
+    #ifdef __AVX2__
+        #define NANODS_HAVE_AVX2 1
+    #endif
+    #ifdef __AVX512F__
+        #define NANODS_HAVE_AVX512 1
+    #endif
+#endif
+
+/* Atomics for the concurrent containers: C11 <stdatomic.h>, or the GCC/Clang
+ * builtins on plain integers when compiled as C++ (define NANODS_NO_ATOMICS to drop them) */
+#if !defined(NANODS_NO_ATOMICS) && !defined(__cplusplus) && defined(__STDC_VERSION__) && \
+    __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+    #include <stdatomic.h>
+    #define NANODS_HAVE_ATOMICS 1
+    #define NANODS_ATOMIC(T) _Atomic(T)
+    #define NANODS_ATOMIC_LOAD(p, mo) atomic_load_explicit((p), mo)
+    #define NANODS_ATOMIC_STORE(p, v, mo) atomic_store_explicit((p), (v), mo)
+    #define NANODS_ATOMIC_CAS_WEAK(p, expected, desired, success_mo, fail_mo) \
+        atomic_compare_exchange_weak_explicit((p), (expected), (desired), success_mo, fail_mo)
+    #define NANODS_ATOMIC_CAS_STRONG(p, expected, desired, success_mo, fail_mo) \
+        atomic_compare_exchange_strong_explicit((p), (expected), (desired), success_mo, fail_mo)
+    #define NANODS_ATOMIC_FETCH_ADD(p, v, mo) atomic_fetch_add_explicit((p), (v), mo)
+    #define NANODS_ATOMIC_FETCH_SUB(p, v, mo) atomic_fetch_sub_explicit((p), (v), mo)
+    #define NANODS_ATOMIC_FENCE(mo) atomic_thread_fence(mo)
+    #define NANODS_MO_RELAXED memory_order_relaxed
+    #define NANODS_MO_ACQUIRE memory_order_acquire
+    #define NANODS_MO_RELEASE memory_order_release
+    #define NANODS_MO_SEQ_CST memory_order_seq_cst
+#elif !defined(NANODS_NO_ATOMICS) && defined(__GNUC__)
+    #define NANODS_HAVE_ATOMICS 1
+    #define NANODS_ATOMIC(T) T
+    #define NANODS_ATOMIC_LOAD(p, mo) __atomic_load_n((p), mo)
+    #define NANODS_ATOMIC_STORE(p, v, mo) __atomic_store_n((p), (v), mo)
+    #define NANODS_ATOMIC_CAS_WEAK(p, expected, desired, success_mo, fail_mo) \
+        __atomic_compare_exchange_n((p), (expected), (desired), 1, success_mo, fail_mo)
+    #define NANODS_ATOMIC_CAS_STRONG(p, expected, desired, success_mo, fail_mo) \
+        __atomic_compare_exchange_n((p), (expected), (desired), 0, success_mo, fail_mo)
+    #define NANODS_ATOMIC_FETCH_ADD(p, v, mo) __atomic_fetch_add((p), (v), mo)
+    #define NANODS_ATOMIC_FETCH_SUB(p, v, mo) __atomic_fetch_sub((p), (v), mo)
+    #define NANODS_ATOMIC_FENCE(mo) __atomic_thread_fence(mo)
+    #define NANODS_MO_RELAXED __ATOMIC_RELAXED
+    #define NANODS_MO_ACQUIRE __ATOMIC_ACQUIRE
+    #define NANODS_MO_RELEASE __ATOMIC_RELEASE
+    #define NANODS_MO_SEQ_CST __ATOMIC_SEQ_CST
+#endif
+
+/* Opt-in thread pool and parallel vector algorithms (define NANODS_ENABLE_THREADS
+ * before including; POSIX threads, link with -pthread) */
+#if defined(NANODS_ENABLE_THREADS) && defined(NANODS_HAVE_ATOMICS) && !defined(_WIN32)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    #define NANODS_HAVE_THREADS 1
+    #if defined(__cplusplus)
+        #define NANODS_THREAD_LOCAL thread_local
+    #elif defined(__GNUC__)
+        #define NANODS_THREAD_LOCAL __thread
+    #else
+        #define NANODS_THREAD_LOCAL _Thread_local
+    #endif
+#endif
+
+/* Snapshot files (opt out with NANODS_NO_SNAPSHOT); zero-copy attach where mmap exists */
+#ifndef NANODS_NO_SNAPSHOT
+    #include <stdio.h>
+    #if defined(__unix__) || defined(__APPLE__)
+        #include <fcntl.h>
+        #include <sys/mman.h>
+        #include <sys/stat.h>
+        #include <unistd.h>
+        #define NANODS_HAVE_MMAP 1
+    #endif
+#endif
+
+/* Opt-in counters (NANODS_STATS); nanods_stats_dump writes to a FILE */
+#ifdef NANODS_STATS
+    #include <stdio.h>
+#endif
+
+/* Padding unit that keeps independently written fields off each other's cache line */
+#ifndef NANODS_CACHE_LINE
+    #define NANODS_CACHE_LINE 64
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,21 +137,56 @@ extern "C" {
     #define NANODS_UNLIKELY(x) (x)
 #endif
 
+/* Start loading the line at `addr` for a read; never faults, no-op where unsupported */
+#if defined(__GNUC__)
+    #define NANODS_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#elif defined(_MSC_VER) && defined(NANODS_HAVE_SSE2)
+    #define NANODS_PREFETCH(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#else
+    #define NANODS_PREFETCH(addr) ((void)(addr))
+#endif
+
+/* Trailing variable-length member (C99 flexible array; one-element array in C++) */
+#ifdef __cplusplus
+    #define NANODS_FLEXIBLE_ARRAY 1
+#else
+    #define NANODS_FLEXIBLE_ARRAY
+#endif
+
 /* Flags for initialization */
-#define NANODS_FLAG_NONE   0x00
-#define NANODS_FLAG_SECURE 0x01  /* Automatic secure wipe on free */
+#define NANODS_FLAG_NONE      0x00
+#define NANODS_FLAG_SECURE    0x01  /* Automatic secure wipe on free */
+#define NANODS_FLAG_OVERWRITE 0x02  /* NanoRing: writing to a full ring drops the oldest element */
 
 /* Core definitions and utilities */
 #include "src/core.h"
+#include "src/pool_impl.h"     /* Node pool allocator */
 
 /* Data structure implementations */
 #include "src/vector_impl.h"
+#include "src/sort_impl.h"     /* Vector sort and binary search */
+#include "src/simd_impl.h"     /* Vectorized reductions and search */
 #include "src/stack_impl.h"
+#include "src/heap_impl.h"     /* d-ary and indexed priority queues */
 #include "src/list_impl.h"
 #include "src/list2_impl.h"    /* NEW: Doubly linked list */
+#include "src/ilist_impl.h"    /* Intrusive doubly linked list */
 #include "src/ring_impl.h"     /* NEW:  Circular buffer */
+#include "src/spsc_ring_impl.h" /* Lock-free SPSC ring */
+#include "src/queue_impl.h"    /* Bounded MPMC queue */
+#include "src/hash_impl.h"     /* Seeded string hashes */
+#include "src/bloom_impl.h"    /* Blocked Bloom filter */
 #include "src/map_impl.h"
+#include "src/strpool_impl.h"  /* Interned strings with cached hashes */
+#include "src/flatmap_impl.h"  /* Open-addressing map */
+#include "src/typed_map_impl.h" /* Typed map for integer/POD keys */
 #include "src/iterator_impl.h" /* NEW: Universal iterator */
+#include "src/small_vector_impl.h" /* Vector with inline storage */
+#include "src/deque_impl.h"    /* Chunked double-ended queue */
+#include "src/snapshot_impl.h" /* Save/load and mmap attach */
+#include "src/thread_pool_impl.h" /* Work-stealing thread pool (opt-in) */
+#include "src/parallel_impl.h" /* Parallel vector algorithms (opt-in) */
+#include "src/concurrent_map_impl.h" /* Sharded thread-safe map (opt-in) */
 
 #ifdef __cplusplus
 }
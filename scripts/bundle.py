@@ -130,13 +130,31 @@ def bundle_nanods():
     # Read and process source files
     src_files = [
         ('src/core.h', 'NANODS_CORE_H'),
+        ('src/pool_impl.h', 'NANODS_POOL_IMPL_H'),
         ('src/vector_impl.h', 'NANODS_VECTOR_IMPL_H'),
+        ('src/sort_impl.h', 'NANODS_SORT_IMPL_H'),
+        ('src/simd_impl.h', 'NANODS_SIMD_IMPL_H'),
         ('src/stack_impl.h', 'NANODS_STACK_IMPL_H'),
+        ('src/heap_impl.h', 'NANODS_HEAP_IMPL_H'),
         ('src/list_impl.h', 'NANODS_LIST_IMPL_H'),
         ('src/list2_impl.h', 'NANODS_LIST2_IMPL_H'),
+        ('src/ilist_impl.h', 'NANODS_ILIST_IMPL_H'),
         ('src/ring_impl.h', 'NANODS_RING_IMPL_H'),
+        ('src/spsc_ring_impl.h', 'NANODS_SPSC_RING_IMPL_H'),
+        ('src/queue_impl.h', 'NANODS_QUEUE_IMPL_H'),
+        ('src/hash_impl.h', 'NANODS_HASH_IMPL_H'),
+        ('src/bloom_impl.h', 'NANODS_BLOOM_IMPL_H'),
         ('src/map_impl.h', 'NANODS_MAP_IMPL_H'),
+        ('src/strpool_impl.h', 'NANODS_STRPOOL_IMPL_H'),
+        ('src/flatmap_impl.h', 'NANODS_FLATMAP_IMPL_H'),
+        ('src/typed_map_impl.h', 'NANODS_TYPED_MAP_IMPL_H'),
         ('src/iterator_impl.h', 'NANODS_ITERATOR_IMPL_H'),
+        ('src/small_vector_impl.h', 'NANODS_SMALL_VECTOR_IMPL_H'),
+        ('src/deque_impl.h', 'NANODS_DEQUE_IMPL_H'),
+        ('src/snapshot_impl.h', 'NANODS_SNAPSHOT_IMPL_H'),
+        ('src/thread_pool_impl.h', 'NANODS_THREAD_POOL_IMPL_H'),
+        ('src/parallel_impl.h', 'NANODS_PARALLEL_IMPL_H'),
+        ('src/concurrent_map_impl.h', 'NANODS_CONCURRENT_MAP_IMPL_H'),
     ]
     
     bundled_content = []
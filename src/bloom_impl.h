@@ -0,0 +1,202 @@
+/**
+ * @file bloom_impl.h
+ * @brief Split block Bloom filter: definite misses from one cache line
+ */
+
+#ifndef NANODS_BLOOM_IMPL_H
+#define NANODS_BLOOM_IMPL_H
+
+/**
+ * @defgroup NanoBloom Blocked Bloom Filter
+ * @{
+ *
+ * Each key sets 8 bits, one in each 32-bit word of a single 32-byte block,
+ * so nbf_test reads one aligned cache line and no pointers. With the default
+ * 10 bits per key the false positive rate at capacity is about 1%; keys
+ * beyond the capacity still work, they only raise it.
+ *
+ * The block and bits come from nanods_hash_u64(hash, seed): any 64-bit hash
+ * can be fed to nbf_add_hash/nbf_test_hash, and keys cannot be aimed at one
+ * block without knowing the seed. Two filters (or two processes sharing one
+ * through nbf_attach) agree only if they use the same seed and block count.
+ *
+ *     NanoBloom seen;
+ *     nbf_init(&seen, 1000000);
+ *     if (nbf_add(&seen, url, strlen(url))) { ... }  // 1: definitely new
+ *
+ * There is no removal; rebuild from the live keys instead (NanoMap does this
+ * for its own filter, see nm_enable_filter).
+ */
+
+/* Filter size per expected key; 8 gives ~2.5%, 16 under 0.1% */
+#ifndef NANODS_BLOOM_BITS_PER_KEY
+    #define NANODS_BLOOM_BITS_PER_KEY 10
+#endif
+
+#define NANODS_BLOOM_BLOCK_WORDS 8
+#define NANODS_BLOOM_BLOCK_BYTES (NANODS_BLOOM_BLOCK_WORDS * sizeof(uint32_t))
+
+typedef struct {
+    uint32_t* blocks;  /* block_count * 8 words, 32-byte aligned; NULL until init */
+    size_t block_count;
+    void* mem;         /* Allocation behind blocks; NULL if attached */
+    const NanoCtxAllocator* alloc;  /* NULL: global allocator */
+    uint32_t seed;
+    uint8_t flags;
+} NanoBloom;
+
+/**
+ * Size the filter for `expected_keys` at `bits_per_key` (0: the default)
+ * and clear it. The seed is this process's nanods seed.
+ */
+static inline int nbf_init_alloc(NanoBloom* bloom, size_t expected_keys, unsigned bits_per_key,
+                                 uint8_t flags, const NanoCtxAllocator* alloc) {
+    NANODS_CHECK_NULL(bloom, NANODS_ERR_NULL);
+    memset(bloom, 0, sizeof(*bloom));
+    if (bits_per_key == 0) bits_per_key = NANODS_BLOOM_BITS_PER_KEY;
+    size_t bits, bytes;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(expected_keys, bits_per_key, &bits)))
+        return NANODS_ERR_OVERFLOW;
+    size_t block_count = bits / (NANODS_BLOOM_BLOCK_BYTES * 8) + 1;
+    if (NANODS_UNLIKELY((uint64_t)block_count > UINT32_MAX ||
+                        nanods_check_mul_overflow(block_count, NANODS_BLOOM_BLOCK_BYTES, &bytes)))
+        return NANODS_ERR_OVERFLOW;
+    void* mem = nanods_mem_alloc(alloc, bytes + NANODS_BLOOM_BLOCK_BYTES);
+    if (NANODS_UNLIKELY(!mem)) return NANODS_ERR_NOMEM;
+    uintptr_t base = (uintptr_t)mem + NANODS_BLOOM_BLOCK_BYTES - 1;
+    bloom->blocks = (uint32_t*)(base - base % NANODS_BLOOM_BLOCK_BYTES);
+    memset(bloom->blocks, 0, bytes);
+    bloom->block_count = block_count;
+    bloom->mem = mem;
+    bloom->alloc = alloc;
+    bloom->seed = nanods_get_seed();
+    bloom->flags = flags;
+    return NANODS_OK;
+}
+
+static inline int nbf_init_ex(NanoBloom* bloom, size_t expected_keys, unsigned bits_per_key,
+                              uint8_t flags) {
+    return nbf_init_alloc(bloom, expected_keys, bits_per_key, flags, NULL);
+}
+
+static inline int nbf_init(NanoBloom* bloom, size_t expected_keys) {
+    return nbf_init_alloc(bloom, expected_keys, 0, NANODS_FLAG_NONE, NULL);
+}
+
+/**
+ * Use caller memory (e.g. a shared mapping) as the filter, without clearing
+ * it. `mem` must be 32-byte aligned and `bytes` a non-zero multiple of 32;
+ * every process attaching it must pass the same seed. nbf_free leaves `mem`
+ * alone. Concurrent nbf_add calls on one filter need an outside lock.
+ */
+static inline int nbf_attach(NanoBloom* bloom, void* mem, size_t bytes, uint32_t seed) {
+    NANODS_CHECK_NULL(bloom, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(mem, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY((uintptr_t)mem % NANODS_BLOOM_BLOCK_BYTES != 0 || bytes == 0 ||
+                        bytes % NANODS_BLOOM_BLOCK_BYTES != 0 ||
+                        (uint64_t)(bytes / NANODS_BLOOM_BLOCK_BYTES) > UINT32_MAX))
+        return NANODS_ERR_BOUNDS;
+    memset(bloom, 0, sizeof(*bloom));
+    bloom->blocks = (uint32_t*)mem;
+    bloom->block_count = bytes / NANODS_BLOOM_BLOCK_BYTES;
+    bloom->seed = seed;
+    return NANODS_OK;
+}
+
+/* Block for `h` (high 32 bits, multiply-shift range reduction) */
+static inline uint32_t* nbf_block(const NanoBloom* bloom, uint64_t h) {
+    size_t idx = (size_t)(((h >> 32) * (uint64_t)bloom->block_count) >> 32);
+    return bloom->blocks + idx * NANODS_BLOOM_BLOCK_WORDS;
+}
+
+/* The bit for word `i` of the block, from the low 32 bits (split block filter salts) */
+static inline uint32_t nbf_bit(uint64_t h, int i) {
+    static const uint32_t salt[NANODS_BLOOM_BLOCK_WORDS] = {
+        0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+        0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+    };
+    return (uint32_t)1 << (((uint32_t)h * salt[i]) >> 27);
+}
+
+/* Add a hashed key. Returns 1 if it was definitely not in the filter yet */
+static inline int nbf_add_hash(NanoBloom* bloom, uint64_t hash) {
+    NANODS_CHECK_NULL(bloom, 0);
+    NANODS_CHECK_NULL(bloom->blocks, 0);
+    uint64_t h = nanods_hash_u64(hash, bloom->seed);
+    uint32_t* block = nbf_block(bloom, h);
+    uint32_t fresh = 0;
+    for (int i = 0; i < NANODS_BLOOM_BLOCK_WORDS; i++) {
+        uint32_t bit = nbf_bit(h, i);
+        fresh |= bit & ~block[i];
+        block[i] |= bit;
+    }
+    return fresh != 0;
+}
+
+/**
+ * 0: definitely never added. 1: probably added. Stops at the first clear
+ * bit: a miss is usually decided by one word, and the predictable branch
+ * lets the next lookups start before this block arrives (2-3x the
+ * throughput of a branch-free test of all 8 words, on a 10 MB filter).
+ */
+static inline int nbf_test_hash(const NanoBloom* bloom, uint64_t hash) {
+    NANODS_CHECK_NULL(bloom, 0);
+    if (NANODS_UNLIKELY(!bloom->blocks)) return 0;
+    uint64_t h = nanods_hash_u64(hash, bloom->seed);
+    const uint32_t* block = nbf_block(bloom, h);
+    for (int i = 0; i < NANODS_BLOOM_BLOCK_WORDS; i++) {
+        if (!(block[i] & nbf_bit(h, i))) return 0;
+    }
+    return 1;
+}
+
+/* Byte-string keys, hashed with wyhash under the filter's seed */
+static inline int nbf_add(NanoBloom* bloom, const void* data, size_t len) {
+    NANODS_CHECK_NULL(bloom, 0);
+    NANODS_CHECK_NULL(data, 0);
+    return nbf_add_hash(bloom, nanods_wyhash(data, len, bloom->seed));
+}
+
+static inline int nbf_test(const NanoBloom* bloom, const void* data, size_t len) {
+    NANODS_CHECK_NULL(bloom, 0);
+    NANODS_CHECK_NULL(data, 0);
+    return nbf_test_hash(bloom, nanods_wyhash(data, len, bloom->seed));
+}
+
+/* dst |= src: the union of two filters with the same seed and size */
+static inline int nbf_merge(NanoBloom* dst, const NanoBloom* src) {
+    NANODS_CHECK_NULL(dst, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(src, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(!dst->blocks || !src->blocks || dst->block_count != src->block_count ||
+                        dst->seed != src->seed))
+        return NANODS_ERR_BOUNDS;
+    size_t words = dst->block_count * NANODS_BLOOM_BLOCK_WORDS;
+    for (size_t i = 0; i < words; i++) {
+        dst->blocks[i] |= src->blocks[i];
+    }
+    return NANODS_OK;
+}
+
+static inline size_t nbf_bytes(const NanoBloom* bloom) {
+    return bloom ? bloom->block_count * NANODS_BLOOM_BLOCK_BYTES : 0;
+}
+
+static inline void nbf_clear(NanoBloom* bloom) {
+    if (!bloom || !bloom->blocks) return;
+    memset(bloom->blocks, 0, nbf_bytes(bloom));
+}
+
+static inline void nbf_free(NanoBloom* bloom) {
+    if (!bloom) return;
+    if (bloom->mem) {
+        if (bloom->flags & NANODS_FLAG_SECURE) nbf_clear(bloom);
+        nanods_mem_free(bloom->alloc, bloom->mem);
+    }
+    bloom->blocks = NULL;
+    bloom->block_count = 0;
+    bloom->mem = NULL;
+}
+
+/** @} */
+
+#endif /* NANODS_BLOOM_IMPL_H */
@@ -0,0 +1,560 @@
+/**
+ * @file concurrent_map_impl.h
+ * @brief Sharded thread-safe string map with lock-free lookups (opt-in: NANODS_ENABLE_THREADS)
+ */
+
+#ifndef NANODS_CONCURRENT_MAP_IMPL_H
+#define NANODS_CONCURRENT_MAP_IMPL_H
+
+#ifdef NANODS_HAVE_THREADS
+
+/**
+ * @defgroup NanoConcurrentMap Concurrent Sharded Map
+ * @{
+ *
+ * Keys are spread over a power-of-two number of shards by the top bits of
+ * their hash (the same hash NanoMap uses); the low bits pick the bucket inside
+ * the shard. Each shard is a chained table with its own mutex, so writers only
+ * wait for writers that hit the same shard.
+ *
+ * Lookups take no lock. Writers publish a fully built entry with one release
+ * store, change a value with an atomic store, and remove an entry by
+ * unlinking it, which leaves its own next pointer intact for a reader still
+ * standing on it. Growing a shard copies the entries into a new table and
+ * swaps the table pointer, so no chain a reader may be walking is ever
+ * relinked.
+ *
+ * Unlinked entries and replaced tables are freed by epoch-based reclamation.
+ * A lookup claims one of NANODS_CMAP_READERS slots and records the global
+ * epoch it started in. Writers collect retired memory per shard, advance the
+ * epoch once every active slot has caught up with it, and free what was
+ * retired two epochs back: no reader can still reach it by then. A lookup
+ * that finds no free slot takes the shard mutex instead.
+ *
+ * A lookup racing with ncm_set on the same key returns the old or the new
+ * value. The map never owns values, and reclamation covers only its own
+ * memory: a value replaced by ncm_set or dropped by ncm_remove may still be
+ * held by a thread that just read it, so free it only after such a thread
+ * is done (a grace period, a reference count, or values that outlive the
+ * map). Init and ncm_free are not thread-safe; everything else may be called
+ * from any thread.
+ */
+
+/* Shards for ncm_init(map, 0) */
+#ifndef NANODS_CMAP_SHARDS
+    #define NANODS_CMAP_SHARDS 64
+#endif
+
+/* Lock-free reader slots (power of two); readers beyond this take the shard lock */
+#ifndef NANODS_CMAP_READERS
+    #define NANODS_CMAP_READERS 128
+#endif
+
+/* Retired entries a shard collects before it tries to free them */
+#ifndef NANODS_CMAP_RECLAIM_BATCH
+    #define NANODS_CMAP_RECLAIM_BATCH 64
+#endif
+
+/* Upper bound for the shard count (shard index comes from the top 16 hash bits) */
+#define NANODS_CMAP_MAX_SHARDS 65536
+
+/* Slots a lookup tries before it falls back to the shard lock */
+#define NANODS_CMAP_READER_PROBES 8
+
+typedef char nanods_cmap_readers_must_be_power_of_two[
+    (NANODS_CMAP_READERS >= NANODS_CMAP_READER_PROBES &&
+     (NANODS_CMAP_READERS & (NANODS_CMAP_READERS - 1)) == 0) ? 1 : -1];
+
+typedef struct NanoCMapEntry {
+    NANODS_ATOMIC(struct NanoCMapEntry*) next;
+    NANODS_ATOMIC(void*) value;
+    struct NanoCMapEntry* retired_next;    /* Writer-only, once unlinked */
+    uint64_t retire_epoch;
+    uint32_t hash;
+    uint32_t key_len;
+    char key[NANODS_FLEXIBLE_ARRAY];       /* Immutable once published */
+} NanoCMapEntry;
+
+#define NANODS_CMAP_ENTRY_SIZE(key_len) (offsetof(NanoCMapEntry, key) + (key_len) + 1)
+
+typedef struct NanoCMapTable {
+    struct NanoCMapTable* retired_next;   /* Retired tables still own their entries */
+    uint64_t retire_epoch;
+    size_t mask;                           /* bucket count - 1 */
+    NANODS_ATOMIC(NanoCMapEntry*) buckets[NANODS_FLEXIBLE_ARRAY];
+} NanoCMapTable;
+
+typedef struct {
+    NANODS_ATOMIC(NanoCMapTable*) table;   /* NULL until the first insert */
+    NANODS_ATOMIC(size_t) size;
+    pthread_mutex_t lock;                  /* Serializes writers of this shard */
+    NanoCMapEntry* retired_entries;        /* Newest first, so retire epochs descend */
+    NanoCMapTable* retired_tables;
+    size_t retired_count;
+    size_t reclaim_at;
+    char pad[NANODS_CACHE_LINE];           /* Keeps neighbouring shards off this line */
+} NanoCMapShard;
+
+typedef struct {
+    NANODS_ATOMIC(uint64_t) epoch;         /* 0: free, else the epoch its lookup began in */
+    char pad[NANODS_CACHE_LINE - sizeof(uint64_t)];
+} NanoCMapReader;
+
+typedef struct {
+    NanoCMapShard* shards;
+    size_t shard_count;
+    uint32_t shard_bits;
+    uint32_t seed;
+    uint64_t hash_key[2];
+    uint8_t hash_kind;
+    uint8_t flags;
+    const NanoCtxAllocator* alloc;         /* Must be thread-safe */
+    NanoCMapReader* readers;               /* Cache-line aligned view of reader_block */
+    void* reader_block;
+    NANODS_ATOMIC(uint64_t) epoch;
+} NanoConcurrentMap;
+
+/* Per-thread starting slot, so concurrent readers rarely probe the same line */
+static NANODS_ATOMIC(size_t) g_nanods_cmap_next_slot = 0;
+static NANODS_THREAD_LOCAL size_t g_nanods_cmap_slot = 0;
+
+static inline uint32_t ncm_hash(const NanoConcurrentMap* map, const char* key, size_t* out_len) {
+    if (NANODS_LIKELY(map->hash_kind == NANODS_HASH_FNV1A))
+        return nanods_fnv1a_hash_len(key, map->seed, out_len);
+    return nanods_hash_str((NanoHashKind)map->hash_kind, key, out_len, map->seed, map->hash_key);
+}
+
+static inline NanoCMapShard* ncm_shard(const NanoConcurrentMap* map, uint32_t hash) {
+    return &map->shards[(size_t)(((uint64_t)hash << map->shard_bits) >> 32)];
+}
+
+/* Announce a lookup; NULL means every probed slot is busy and the caller must lock */
+static inline NanoCMapReader* ncm_reader_enter(NanoConcurrentMap* map) {
+    size_t slot = g_nanods_cmap_slot;
+    if (NANODS_UNLIKELY(slot == 0)) {
+        slot = NANODS_ATOMIC_FETCH_ADD(&g_nanods_cmap_next_slot, (size_t)1, NANODS_MO_RELAXED) + 1;
+        g_nanods_cmap_slot = slot;
+    }
+    uint64_t epoch = NANODS_ATOMIC_LOAD(&map->epoch, NANODS_MO_SEQ_CST);
+    for (size_t i = 0; i < NANODS_CMAP_READER_PROBES; i++) {
+        NanoCMapReader* reader = &map->readers[(slot + i) & (NANODS_CMAP_READERS - 1)];
+        uint64_t expected = 0;
+        if (NANODS_ATOMIC_LOAD(&reader->epoch, NANODS_MO_RELAXED) == 0 &&
+            NANODS_ATOMIC_CAS_STRONG(&reader->epoch, &expected, epoch,
+                                     NANODS_MO_RELAXED, NANODS_MO_RELAXED)) {
+            /* The announcement is visible before any table pointer is read */
+            NANODS_ATOMIC_FENCE(NANODS_MO_SEQ_CST);
+            return reader;
+        }
+    }
+    return NULL;
+}
+
+static inline void ncm_reader_exit(NanoCMapReader* reader) {
+    NANODS_ATOMIC_STORE(&reader->epoch, (uint64_t)0, NANODS_MO_RELEASE);
+}
+
+/* Move the global epoch on if every active reader has caught up; returns the epoch now */
+static inline uint64_t ncm_try_advance(NanoConcurrentMap* map) {
+    uint64_t epoch = NANODS_ATOMIC_LOAD(&map->epoch, NANODS_MO_SEQ_CST);
+    NANODS_ATOMIC_FENCE(NANODS_MO_SEQ_CST);
+    for (size_t i = 0; i < NANODS_CMAP_READERS; i++) {
+        uint64_t seen = NANODS_ATOMIC_LOAD(&map->readers[i].epoch, NANODS_MO_ACQUIRE);
+        if (seen != 0 && seen != epoch) return epoch;
+    }
+    if (NANODS_ATOMIC_CAS_STRONG(&map->epoch, &epoch, epoch + 1,
+                                 NANODS_MO_SEQ_CST, NANODS_MO_SEQ_CST)) {
+        return epoch + 1;
+    }
+    return epoch;   /* Another writer advanced it; the CAS loaded the new value */
+}
+
+/* Read the epoch an unlinked object is retired in; the unlink must come first */
+static inline uint64_t ncm_retire_epoch(NanoConcurrentMap* map) {
+    NANODS_ATOMIC_FENCE(NANODS_MO_SEQ_CST);
+    return NANODS_ATOMIC_LOAD(&map->epoch, NANODS_MO_SEQ_CST);
+}
+
+static inline NanoCMapTable* ncm_alloc_table(const NanoConcurrentMap* map, size_t bucket_count) {
+    size_t bytes;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(bucket_count, sizeof(NanoCMapEntry*), &bytes) ||
+                        nanods_check_add_overflow(bytes, offsetof(NanoCMapTable, buckets),
+                                                  &bytes))) {
+        return NULL;
+    }
+    NanoCMapTable* table = (NanoCMapTable*)nanods_mem_alloc(map->alloc, bytes);
+    if (NANODS_UNLIKELY(!table)) return NULL;
+    table->retired_next = NULL;
+    table->retire_epoch = 0;
+    table->mask = bucket_count - 1;
+    for (size_t i = 0; i < bucket_count; i++) {
+        NANODS_ATOMIC_STORE(&table->buckets[i], (NanoCMapEntry*)NULL, NANODS_MO_RELAXED);
+    }
+    return table;
+}
+
+static inline NanoCMapEntry* ncm_alloc_entry(const NanoConcurrentMap* map, const char* key,
+                                             size_t key_len, uint32_t hash, void* value) {
+    NanoCMapEntry* entry = (NanoCMapEntry*)nanods_mem_alloc(map->alloc,
+                                                            NANODS_CMAP_ENTRY_SIZE(key_len));
+    if (NANODS_UNLIKELY(!entry)) return NULL;
+    NANODS_ATOMIC_STORE(&entry->next, (NanoCMapEntry*)NULL, NANODS_MO_RELAXED);
+    NANODS_ATOMIC_STORE(&entry->value, value, NANODS_MO_RELAXED);
+    entry->retired_next = NULL;
+    entry->retire_epoch = 0;
+    entry->hash = hash;
+    entry->key_len = (uint32_t)key_len;
+    memcpy(entry->key, key, key_len + 1);
+    return entry;
+}
+
+static inline void ncm_free_entry(const NanoConcurrentMap* map, NanoCMapEntry* entry) {
+    if (map->flags & NANODS_FLAG_SECURE) {
+        nanods_mem_secure_free(map->alloc, entry, NANODS_CMAP_ENTRY_SIZE(entry->key_len));
+    } else {
+        nanods_mem_free(map->alloc, entry);
+    }
+}
+
+/* Free a table nobody can reach any more, together with the entries still linked in it */
+static inline void ncm_free_table(const NanoConcurrentMap* map, NanoCMapTable* table) {
+    for (size_t i = 0; i <= table->mask; i++) {
+        NanoCMapEntry* entry = NANODS_ATOMIC_LOAD(&table->buckets[i], NANODS_MO_RELAXED);
+        while (entry) {
+            NanoCMapEntry* next = NANODS_ATOMIC_LOAD(&entry->next, NANODS_MO_RELAXED);
+            ncm_free_entry(map, entry);
+            entry = next;
+        }
+    }
+    nanods_mem_free(map->alloc, table);
+}
+
+/* Free whatever this shard retired at least two epochs ago (shard lock held) */
+static inline void ncm_reclaim(NanoConcurrentMap* map, NanoCMapShard* shard) {
+    /* Two steps, so memory retired just now can go if no lookup is running */
+    ncm_try_advance(map);
+    uint64_t epoch = ncm_try_advance(map);
+    NanoCMapEntry** link = &shard->retired_entries;
+    while (*link && (*link)->retire_epoch + 2 > epoch) link = &(*link)->retired_next;
+    NanoCMapEntry* entry = *link;
+    *link = NULL;
+    while (entry) {
+        NanoCMapEntry* next = entry->retired_next;
+        ncm_free_entry(map, entry);
+        shard->retired_count--;
+        entry = next;
+    }
+    NanoCMapTable** table_link = &shard->retired_tables;
+    while (*table_link && (*table_link)->retire_epoch + 2 > epoch) {
+        table_link = &(*table_link)->retired_next;
+    }
+    NanoCMapTable* table = *table_link;
+    *table_link = NULL;
+    while (table) {
+        NanoCMapTable* next = table->retired_next;
+        ncm_free_table(map, table);
+        table = next;
+    }
+    shard->reclaim_at = shard->retired_count + NANODS_CMAP_RECLAIM_BATCH;
+}
+
+static inline void ncm_retire_table(NanoConcurrentMap* map, NanoCMapShard* shard,
+                                    NanoCMapTable* table) {
+    table->retire_epoch = ncm_retire_epoch(map);
+    table->retired_next = shard->retired_tables;
+    shard->retired_tables = table;
+    ncm_reclaim(map, shard);
+}
+
+/**
+ * Double a shard's table past a 0.75 load factor (shard lock held). Entries
+ * are copied, not relinked, so lookups on the old table stay correct; the old
+ * table is retired with its entries. The copy is O(shard size) under the
+ * lock, so other writers to this shard wait for it; lookups do not.
+ * Allocation failure just keeps the table.
+ */
+static inline void ncm_maybe_grow(NanoConcurrentMap* map, NanoCMapShard* shard,
+                                  NanoCMapTable* table, size_t size) {
+    size_t bucket_count = table->mask + 1;
+    if (size * NANODS_MAP_LOAD_DEN <= bucket_count * NANODS_MAP_LOAD_NUM) return;
+    size_t new_count;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(bucket_count, 2, &new_count))) return;
+    NanoCMapTable* grown = ncm_alloc_table(map, new_count);
+    if (NANODS_UNLIKELY(!grown)) return;
+    for (size_t i = 0; i < bucket_count; i++) {
+        NanoCMapEntry* entry = NANODS_ATOMIC_LOAD(&table->buckets[i], NANODS_MO_RELAXED);
+        while (entry) {
+            NanoCMapEntry* copy = ncm_alloc_entry(map, entry->key, entry->key_len, entry->hash,
+                                                  NANODS_ATOMIC_LOAD(&entry->value,
+                                                                     NANODS_MO_RELAXED));
+            if (NANODS_UNLIKELY(!copy)) {
+                ncm_free_table(map, grown);
+                return;
+            }
+            NANODS_ATOMIC_STORE(&copy->next,
+                                NANODS_ATOMIC_LOAD(&grown->buckets[copy->hash & grown->mask],
+                                                   NANODS_MO_RELAXED),
+                                NANODS_MO_RELAXED);
+            NANODS_ATOMIC_STORE(&grown->buckets[copy->hash & grown->mask], copy,
+                                NANODS_MO_RELAXED);
+            entry = NANODS_ATOMIC_LOAD(&entry->next, NANODS_MO_RELAXED);
+        }
+    }
+    NANODS_ATOMIC_STORE(&shard->table, grown, NANODS_MO_RELEASE);
+    ncm_retire_table(map, shard, table);
+}
+
+/**
+ * Set up a map with `shard_count` shards (0: NANODS_CMAP_SHARDS), rounded up
+ * to a power of two and capped at NANODS_CMAP_MAX_SHARDS. `alloc` (NULL: the
+ * global allocator) is called from many threads and must be thread-safe.
+ */
+static inline int ncm_init_alloc(NanoConcurrentMap* map, size_t shard_count, uint8_t flags,
+                                 const NanoCtxAllocator* alloc) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    if (shard_count == 0) shard_count = NANODS_CMAP_SHARDS;
+    if (shard_count > NANODS_CMAP_MAX_SHARDS) shard_count = NANODS_CMAP_MAX_SHARDS;
+    uint32_t bits = 0;
+    while (((size_t)1 << bits) < shard_count) bits++;
+    map->shard_count = (size_t)1 << bits;
+    map->shard_bits = bits;
+    map->seed = nanods_get_seed();
+    nanods_get_hash_key(map->hash_key);
+    map->hash_kind = (uint8_t)NANODS_MAP_DEFAULT_HASH;
+    map->flags = flags;
+    map->alloc = alloc;
+    NANODS_ATOMIC_STORE(&map->epoch, (uint64_t)1, NANODS_MO_RELAXED);
+
+    map->reader_block = nanods_mem_alloc(alloc, (NANODS_CMAP_READERS + 1) * sizeof(NanoCMapReader));
+    map->shards = (NanoCMapShard*)nanods_mem_alloc(alloc, map->shard_count * sizeof(NanoCMapShard));
+    if (NANODS_UNLIKELY(!map->reader_block || !map->shards)) {
+        nanods_mem_free(alloc, map->reader_block);
+        nanods_mem_free(alloc, map->shards);
+        map->shards = NULL;
+        return NANODS_ERR_NOMEM;
+    }
+    uintptr_t base = (uintptr_t)map->reader_block + NANODS_CACHE_LINE - 1;
+    map->readers = (NanoCMapReader*)(base - base % NANODS_CACHE_LINE);
+    for (size_t i = 0; i < NANODS_CMAP_READERS; i++) {
+        NANODS_ATOMIC_STORE(&map->readers[i].epoch, (uint64_t)0, NANODS_MO_RELAXED);
+    }
+    for (size_t i = 0; i < map->shard_count; i++) {
+        NanoCMapShard* shard = &map->shards[i];
+        if (NANODS_UNLIKELY(pthread_mutex_init(&shard->lock, NULL) != 0)) {
+            while (i-- > 0) pthread_mutex_destroy(&map->shards[i].lock);
+            nanods_mem_free(alloc, map->reader_block);
+            nanods_mem_free(alloc, map->shards);
+            map->shards = NULL;
+            return NANODS_ERR_NOMEM;
+        }
+        NANODS_ATOMIC_STORE(&shard->table, (NanoCMapTable*)NULL, NANODS_MO_RELAXED);
+        NANODS_ATOMIC_STORE(&shard->size, (size_t)0, NANODS_MO_RELAXED);
+        shard->retired_entries = NULL;
+        shard->retired_tables = NULL;
+        shard->retired_count = 0;
+        shard->reclaim_at = NANODS_CMAP_RECLAIM_BATCH;
+    }
+    return NANODS_OK;
+}
+
+static inline int ncm_init(NanoConcurrentMap* map, size_t shard_count) {
+    return ncm_init_alloc(map, shard_count, NANODS_FLAG_NONE, NULL);
+}
+
+static inline NanoCMapEntry* ncm_find(NanoCMapTable* table, const char* key, size_t key_len,
+                                      uint32_t hash) {
+    if (!table) return NULL;
+    NanoCMapEntry* entry = NANODS_ATOMIC_LOAD(&table->buckets[hash & table->mask],
+                                              NANODS_MO_ACQUIRE);
+    while (entry) {
+        if (entry->hash == hash && entry->key_len == key_len &&
+            memcmp(entry->key, key, key_len) == 0) {
+            return entry;
+        }
+        entry = NANODS_ATOMIC_LOAD(&entry->next, NANODS_MO_ACQUIRE);
+    }
+    return NULL;
+}
+
+/* Lock-free lookup (shard lock only if no reader slot is free); 1 if found */
+static inline int ncm_lookup(NanoConcurrentMap* map, const char* key, void** out_value) {
+    size_t key_len;
+    uint32_t hash = ncm_hash(map, key, &key_len);
+    NanoCMapShard* shard = ncm_shard(map, hash);
+    NanoCMapReader* reader = ncm_reader_enter(map);
+    if (NANODS_UNLIKELY(!reader)) pthread_mutex_lock(&shard->lock);
+    NanoCMapEntry* entry = ncm_find(NANODS_ATOMIC_LOAD(&shard->table, NANODS_MO_ACQUIRE),
+                                    key, key_len, hash);
+    if (entry && out_value) *out_value = NANODS_ATOMIC_LOAD(&entry->value, NANODS_MO_ACQUIRE);
+    if (NANODS_LIKELY(reader != NULL)) {
+        ncm_reader_exit(reader);
+    } else {
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return entry != NULL;
+}
+
+static inline void* ncm_get(NanoConcurrentMap* map, const char* key) {
+    NANODS_CHECK_NULL(map, NULL);
+    NANODS_CHECK_NULL(key, NULL);
+    void* value = NULL;
+    ncm_lookup(map, key, &value);
+    return value;
+}
+
+static inline int ncm_has(NanoConcurrentMap* map, const char* key) {
+    NANODS_CHECK_NULL(map, 0);
+    NANODS_CHECK_NULL(key, 0);
+    return ncm_lookup(map, key, NULL);
+}
+
+/**
+ * Insert or replace. A replaced value is not freed and may still be in use by
+ * a concurrent ncm_get caller: release it only after a grace period.
+ */
+static inline int ncm_set(NanoConcurrentMap* map, const char* key, void* value) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
+    size_t key_len;
+    uint32_t hash = ncm_hash(map, key, &key_len);
+    if (NANODS_UNLIKELY((uint64_t)key_len > UINT32_MAX)) return NANODS_ERR_OVERFLOW;
+    NanoCMapShard* shard = ncm_shard(map, hash);
+    int err = NANODS_OK;
+    pthread_mutex_lock(&shard->lock);
+    NanoCMapTable* table = NANODS_ATOMIC_LOAD(&shard->table, NANODS_MO_RELAXED);
+    if (!table) {
+        table = ncm_alloc_table(map, 16);
+        if (NANODS_UNLIKELY(!table)) {
+            pthread_mutex_unlock(&shard->lock);
+            return NANODS_ERR_NOMEM;
+        }
+        NANODS_ATOMIC_STORE(&shard->table, table, NANODS_MO_RELEASE);
+    }
+    NanoCMapEntry* existing = ncm_find(table, key, key_len, hash);
+    if (existing) {
+        NANODS_ATOMIC_STORE(&existing->value, value, NANODS_MO_RELEASE);
+    } else {
+        NanoCMapEntry* entry = ncm_alloc_entry(map, key, key_len, hash, value);
+        if (NANODS_UNLIKELY(!entry)) {
+            err = NANODS_ERR_NOMEM;
+        } else {
+            NANODS_ATOMIC(NanoCMapEntry*)* bucket = &table->buckets[hash & table->mask];
+            NANODS_ATOMIC_STORE(&entry->next, NANODS_ATOMIC_LOAD(bucket, NANODS_MO_RELAXED),
+                                NANODS_MO_RELAXED);
+            NANODS_ATOMIC_STORE(bucket, entry, NANODS_MO_RELEASE);
+            size_t size = NANODS_ATOMIC_LOAD(&shard->size, NANODS_MO_RELAXED) + 1;
+            NANODS_ATOMIC_STORE(&shard->size, size, NANODS_MO_RELAXED);
+            ncm_maybe_grow(map, shard, table, size);
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return err;
+}
+
+/* Unlink `key`; as with ncm_set, its value may still be in use by a concurrent reader */
+static inline int ncm_remove(NanoConcurrentMap* map, const char* key) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
+    size_t key_len;
+    uint32_t hash = ncm_hash(map, key, &key_len);
+    NanoCMapShard* shard = ncm_shard(map, hash);
+    int err = NANODS_ERR_NOTFOUND;
+    pthread_mutex_lock(&shard->lock);
+    NanoCMapTable* table = NANODS_ATOMIC_LOAD(&shard->table, NANODS_MO_RELAXED);
+    if (table) {
+        NANODS_ATOMIC(NanoCMapEntry*)* link = &table->buckets[hash & table->mask];
+        NanoCMapEntry* entry = NANODS_ATOMIC_LOAD(link, NANODS_MO_RELAXED);
+        while (entry) {
+            NanoCMapEntry* next = NANODS_ATOMIC_LOAD(&entry->next, NANODS_MO_RELAXED);
+            if (entry->hash == hash && entry->key_len == key_len &&
+                memcmp(entry->key, key, key_len) == 0) {
+                /* `entry->next` stays valid for lookups still standing on it */
+                NANODS_ATOMIC_STORE(link, next, NANODS_MO_RELEASE);
+                NANODS_ATOMIC_STORE(&shard->size,
+                                    NANODS_ATOMIC_LOAD(&shard->size, NANODS_MO_RELAXED) - 1,
+                                    NANODS_MO_RELAXED);
+                entry->retire_epoch = ncm_retire_epoch(map);
+                entry->retired_next = shard->retired_entries;
+                shard->retired_entries = entry;
+                if (++shard->retired_count >= shard->reclaim_at) ncm_reclaim(map, shard);
+                err = NANODS_OK;
+                break;
+            }
+            link = &entry->next;
+            entry = next;
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return err;
+}
+
+/* Entry count; exact when no writer is running, a snapshot otherwise */
+static inline size_t ncm_size(const NanoConcurrentMap* map) {
+    if (!map || !map->shards) return 0;
+    size_t size = 0;
+    for (size_t i = 0; i < map->shard_count; i++) {
+        size += NANODS_ATOMIC_LOAD(&map->shards[i].size, NANODS_MO_RELAXED);
+    }
+    return size;
+}
+
+static inline int ncm_empty(const NanoConcurrentMap* map) {
+    return ncm_size(map) == 0;
+}
+
+/* Remove every entry, one shard at a time; concurrent lookups stay safe */
+static inline void ncm_clear(NanoConcurrentMap* map) {
+    if (!map || !map->shards) return;
+    for (size_t i = 0; i < map->shard_count; i++) {
+        NanoCMapShard* shard = &map->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        NanoCMapTable* table = NANODS_ATOMIC_LOAD(&shard->table, NANODS_MO_RELAXED);
+        if (table) {
+            NANODS_ATOMIC_STORE(&shard->table, (NanoCMapTable*)NULL, NANODS_MO_RELEASE);
+            NANODS_ATOMIC_STORE(&shard->size, (size_t)0, NANODS_MO_RELAXED);
+            ncm_retire_table(map, shard, table);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+/* Not thread-safe: every other thread must be done with the map */
+static inline void ncm_free(NanoConcurrentMap* map) {
+    if (!map || !map->shards) return;
+    for (size_t i = 0; i < map->shard_count; i++) {
+        NanoCMapShard* shard = &map->shards[i];
+        NanoCMapTable* table = NANODS_ATOMIC_LOAD(&shard->table, NANODS_MO_RELAXED);
+        if (table) ncm_free_table(map, table);
+        while (shard->retired_entries) {
+            NanoCMapEntry* next = shard->retired_entries->retired_next;
+            ncm_free_entry(map, shard->retired_entries);
+            shard->retired_entries = next;
+        }
+        while (shard->retired_tables) {
+            NanoCMapTable* next = shard->retired_tables->retired_next;
+            ncm_free_table(map, shard->retired_tables);
+            shard->retired_tables = next;
+        }
+        pthread_mutex_destroy(&shard->lock);
+    }
+    nanods_mem_free(map->alloc, map->shards);
+    nanods_mem_free(map->alloc, map->reader_block);
+    map->shards = NULL;
+    map->reader_block = NULL;
+    map->readers = NULL;
+    map->shard_count = 0;
+}
+
+static inline void ncm_secure_free(NanoConcurrentMap* map) {
+    if (!map) return;
+    uint8_t flags = map->flags;
+    map->flags |= NANODS_FLAG_SECURE;
+    ncm_free(map);
+    map->flags = flags;
+}
+
+/** @} */
+
+#endif /* NANODS_HAVE_THREADS */
+
+#endif /* NANODS_CONCURRENT_MAP_IMPL_H */
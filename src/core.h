@@ -0,0 +1,665 @@
+/**
+ * @file core.h
+ * @brief Core utilities, allocator interface, security, and flags
+ */
+
+#ifndef NANODS_CORE_H
+#define NANODS_CORE_H
+
+/**
+ * @defgroup ErrorCodes Error Codes
+ * @{
+ */
+typedef enum {
+    NANODS_OK = 0,
+    NANODS_ERR_NOMEM = -1,
+    NANODS_ERR_BOUNDS = -2,
+    NANODS_ERR_EMPTY = -3,
+    NANODS_ERR_OVERFLOW = -4,
+    NANODS_ERR_NOTFOUND = -5,
+    NANODS_ERR_NULL = -6,
+    NANODS_ERR_FULL = -7,       /* NEW: For ring buffer */
+    NANODS_ERR_IO = -8,         /* File open/read/write/map failed */
+    NANODS_ERR_FORMAT = -9      /* Not a snapshot, wrong version/kind, or corrupt */
+} NanoDSError;
+/** @} */
+
+/**
+ * @defgroup Allocator Custom Allocator Interface
+ * @{
+ */
+typedef struct {
+    void* (*malloc_fn)(size_t size);
+    void* (*realloc_fn)(void* ptr, size_t size);
+    void  (*free_fn)(void* ptr);
+} NanoAllocator;
+
+void nanods_set_allocator(NanoAllocator* allocator);
+NanoAllocator* nanods_get_allocator(void);
+
+/**
+ * Allocator handle with user context, attached to one container through
+ * its _init_alloc function (nv_init_alloc_##T, nm_init_alloc, ...).
+ * Containers keep the pointer, so the handle must outlive them.
+ * Containers without a handle use the global allocator above.
+ */
+typedef struct {
+    void* (*malloc_fn)(void* ctx, size_t size);
+    void* (*realloc_fn)(void* ctx, void* ptr, size_t size);
+    void  (*free_fn)(void* ctx, void* ptr);
+    void* ctx;
+} NanoCtxAllocator;
+/** @} */
+
+/**
+ * @defgroup Arena Arena (Region) Allocator
+ * @{
+ *
+ * Bump allocation inside large blocks. Individual frees are no-ops, the
+ * most recent allocation can grow or shrink in place, and
+ * nanods_arena_reset releases everything at once. Blocks come straight
+ * from malloc so an arena can itself back NANODS_MALLOC.
+ */
+#ifndef NANODS_ARENA_DEFAULT_BLOCK
+    #define NANODS_ARENA_DEFAULT_BLOCK (64 * 1024)
+#endif
+#define NANODS_ARENA_ALIGN 16  /* Allocation alignment; also the per-allocation header size */
+
+typedef struct NanoArenaBlock {
+    struct NanoArenaBlock* next;
+    size_t size;               /* Usable bytes after the header */
+} NanoArenaBlock;
+
+typedef struct {
+    NanoArenaBlock* blocks;    /* Head is the block being bumped */
+    uint8_t* ptr;              /* Next free byte in the head block */
+    uint8_t* end;
+    uint8_t* last;             /* Most recent allocation, resizable in place */
+    size_t block_size;
+    size_t used;               /* Bytes handed out since the last reset */
+} NanoArena;
+
+static inline void nanods_arena_init(NanoArena* arena, size_t block_size);
+static inline void* nanods_arena_alloc(NanoArena* arena, size_t size);
+static inline void* nanods_arena_realloc(NanoArena* arena, void* ptr, size_t new_size);
+static inline void nanods_arena_reset(NanoArena* arena);
+static inline void nanods_arena_free(NanoArena* arena);
+static inline int nanods_arena_owns(const NanoArena* arena, const void* ptr);
+
+/* Handle that allocates from `arena`, for one container instead of globally */
+static inline NanoCtxAllocator nanods_arena_allocator(NanoArena* arena);
+
+/**
+ * Route NANODS_MALLOC/REALLOC/FREE to `arena` (free becomes a no-op).
+ * NULL restores the allocator that was active before. While an arena is
+ * active, nanods_set_allocator replaces that saved allocator instead of the
+ * arena. Like nanods_set_allocator this is process-wide and not thread-safe.
+ *
+ * Containers created before the call keep working: a pointer the arena does
+ * not own is grown or freed by the saved allocator. The reverse is not
+ * checked: memory allocated inside the scope must not be freed or grown
+ * after it ends; it is released by nanods_arena_reset/free.
+ */
+void nanods_set_arena(NanoArena* arena);
+/** @} */
+
+/**
+ * @defgroup Security Security Functions
+ * @{
+ */
+
+/**
+ * Initialize global seed for hash randomization (Anti-DoS)
+ * Call once at program startup, or pass custom seed
+ */
+void nanods_seed_init(uint32_t custom_seed);
+
+/**
+ * Get current hash seed
+ */
+uint32_t nanods_get_seed(void);
+
+/**
+ * Set the 128-bit key used by keyed hashes (SipHash-1-3, wyhash).
+ * nanods_seed_init derives one from the seed; call this afterwards to
+ * supply your own secret key.
+ */
+void nanods_seed_init_key(uint64_t k0, uint64_t k1);
+
+/**
+ * Get current 128-bit hash key
+ */
+void nanods_get_hash_key(uint64_t out[2]);
+
+/** @} */
+
+/**
+ * @defgroup SafetyMacros Safety Checking Macros
+ * @{
+ */
+#ifdef NANODS_HARD_SAFETY
+    #define NANODS_CHECK_NULL(ptr, ret) \
+        do { if (NANODS_UNLIKELY(!(ptr))) return (ret); } while(0)
+    #define NANODS_CHECK_NULL_VOID(ptr) \
+        do { if (NANODS_UNLIKELY(!(ptr))) return; } while(0)
+    #define NANODS_CHECK_BOUNDS(idx, size, ret) \
+        do { if (NANODS_UNLIKELY((idx) >= (size))) return (ret); } while(0)
+    #define NANODS_CHECK_EMPTY(size, ret) \
+        do { if (NANODS_UNLIKELY((size) == 0)) return (ret); } while(0)
+    /* As NANODS_CHECK_EMPTY, but zero *out (if non-NULL) so it is written on every path */
+    #define NANODS_CHECK_EMPTY_OUT(size, out, ret) \
+        do { if (NANODS_UNLIKELY((size) == 0)) { \
+            if (out) memset((out), 0, sizeof(*(out))); \
+            return (ret); \
+        } } while(0)
+    #define NANODS_CHECK_FULL(size, capacity, ret) \
+        do { if (NANODS_UNLIKELY((size) >= (capacity))) return (ret); } while(0)
+#else
+    #define NANODS_CHECK_NULL(ptr, ret) \
+        assert((ptr) != NULL && "Null pointer")
+    #define NANODS_CHECK_NULL_VOID(ptr) \
+        assert((ptr) != NULL && "Null pointer")
+    #define NANODS_CHECK_BOUNDS(idx, size, ret) \
+        assert((idx) < (size) && "Index out of bounds")
+    #define NANODS_CHECK_EMPTY(size, ret) \
+        assert((size) > 0 && "Container is empty")
+    #define NANODS_CHECK_EMPTY_OUT(size, out, ret) \
+        assert((size) > 0 && "Container is empty")
+    #define NANODS_CHECK_FULL(size, capacity, ret) \
+        assert((size) < (capacity) && "Container is full")
+#endif
+/** @} */
+
+/**
+ * @defgroup Stats Instrumentation (NANODS_STATS)
+ * @{
+ *
+ * With NANODS_STATS defined, vectors, maps and rings carry a NanoStats
+ * member (NANODS_STATS_OF(container)) and every event is also added to
+ * process-wide totals (nanods_stats_global). The allocation counters there
+ * cover every container, since all of them allocate through nanods_mem_*.
+ * Without NANODS_STATS the member and every hook below compile to nothing.
+ *
+ * Container counters are plain integers, updated with the container itself,
+ * except the map lookup counters: reads may run in parallel on a const map,
+ * so those are bumped with relaxed atomic adds (GCC/Clang builtins). Global
+ * counters are relaxed atomics where available, so containers on different
+ * threads may record at once.
+ */
+#define NANODS_STATS_CHAIN_BUCKETS 6       /* Lookups by entries compared: 0, 1, 2, 3, 4-7, 8+ */
+
+typedef struct {
+    uint64_t allocs;                       /* malloc/realloc calls */
+    uint64_t frees;                        /* Global only */
+    uint64_t bytes;                        /* Bytes requested by those calls */
+    uint64_t reallocs;                     /* Vector capacity changes (nv_reserve) */
+    uint64_t grows;                        /* Map table doublings */
+    uint64_t lookups;                      /* Map key searches, including the one in nm_set */
+    uint64_t probes;                       /* Map entries compared during those searches */
+    uint64_t chain_hist[NANODS_STATS_CHAIN_BUCKETS];
+    uint64_t rejected_full;                /* Ring writes refused when full (elements for _n) */
+    uint64_t rejected_empty;               /* Ring reads on an empty ring */
+    uint64_t peak_size;                    /* Largest element count seen; per container only */
+} NanoStats;
+
+#ifdef NANODS_STATS
+    #ifdef NANODS_HAVE_ATOMICS
+        #define NANODS_ATOMIC_STAT NANODS_ATOMIC(uint64_t)
+        #define NANODS_STAT_GLOBAL(field, n) \
+            ((void)NANODS_ATOMIC_FETCH_ADD(&g_nanods_stats.field, (uint64_t)(n), NANODS_MO_RELAXED))
+        #define NANODS_STAT_READ(field) NANODS_ATOMIC_LOAD(&g_nanods_stats.field, NANODS_MO_RELAXED)
+        #define NANODS_STAT_CLEAR(field) NANODS_ATOMIC_STORE(&g_nanods_stats.field, 0, NANODS_MO_RELAXED)
+    #else
+        #define NANODS_ATOMIC_STAT uint64_t
+        #define NANODS_STAT_GLOBAL(field, n) ((void)(g_nanods_stats.field += (uint64_t)(n)))
+        #define NANODS_STAT_READ(field) (g_nanods_stats.field)
+        #define NANODS_STAT_CLEAR(field) (g_nanods_stats.field = 0)
+    #endif
+
+    typedef struct {
+        NANODS_ATOMIC_STAT allocs, frees, bytes, reallocs, grows, lookups, probes;
+        NANODS_ATOMIC_STAT chain_hist[NANODS_STATS_CHAIN_BUCKETS];
+        NANODS_ATOMIC_STAT rejected_full, rejected_empty;
+    } NanoStatsGlobal;
+
+    extern NanoStatsGlobal g_nanods_stats;
+
+    #define NANODS_STATS_MEMBER NanoStats stats;
+    #define NANODS_STAT_ONLY(...) __VA_ARGS__
+    #define NANODS_STATS_OF(c) (&(c)->stats)
+    #define NANODS_STAT_INIT(c) memset(&(c)->stats, 0, sizeof(NanoStats))
+    /* Container counter only (allocations, which nanods_mem_* already count globally) */
+    #define NANODS_STAT_LOCAL(c, field, n) ((c)->stats.field += (uint64_t)(n))
+    /* Container counter and the global total */
+    #define NANODS_STAT_ADD(c, field, n) \
+        (NANODS_STAT_LOCAL(c, field, n), NANODS_STAT_GLOBAL(field, n))
+    #define NANODS_STAT_PEAK(c, size) \
+        ((c)->stats.peak_size = (uint64_t)(size) > (c)->stats.peak_size \
+            ? (uint64_t)(size) : (c)->stats.peak_size)
+    /* Container counter bumped by a read path on a possibly const, shared container */
+    #if defined(__GNUC__) && !defined(NANODS_NO_ATOMICS)
+        #define NANODS_STAT_SHARED(c, field, n) \
+            ((void)__atomic_fetch_add((uint64_t*)&(c)->stats.field, (uint64_t)(n), __ATOMIC_RELAXED))
+    #else
+        #define NANODS_STAT_SHARED(c, field, n) \
+            ((void)(*(uint64_t*)&(c)->stats.field += (uint64_t)(n)))
+    #endif
+    /* One map lookup that compared `n` entries */
+    #define NANODS_STAT_LOOKUP(c, n) \
+        (NANODS_STAT_SHARED(c, lookups, 1), NANODS_STAT_GLOBAL(lookups, 1), \
+         NANODS_STAT_SHARED(c, probes, n), NANODS_STAT_GLOBAL(probes, n), \
+         NANODS_STAT_SHARED(c, chain_hist[nanods_stats_chain_bucket(n)], 1), \
+         NANODS_STAT_GLOBAL(chain_hist[nanods_stats_chain_bucket(n)], 1))
+
+    /* Read a consistent-enough copy of the global totals (peak_size stays 0) */
+    void nanods_stats_global(NanoStats* out);
+    void nanods_stats_reset(void);
+    /* One labelled line per non-zero counter group */
+    void nanods_stats_dump(FILE* out, const char* label, const NanoStats* stats);
+
+    static inline size_t nanods_stats_chain_bucket(size_t n) {
+        return n < 4 ? n : (n < 8 ? 4 : 5);
+    }
+#else
+    #define NANODS_STATS_MEMBER
+    #define NANODS_STAT_ONLY(...)
+    #define NANODS_STAT_GLOBAL(field, n) ((void)0)
+    #define NANODS_STAT_INIT(c) ((void)0)
+    #define NANODS_STAT_LOCAL(c, field, n) ((void)0)
+    #define NANODS_STAT_ADD(c, field, n) ((void)0)
+    #define NANODS_STAT_PEAK(c, size) ((void)0)
+    #define NANODS_STAT_SHARED(c, field, n) ((void)0)
+    #define NANODS_STAT_LOOKUP(c, n) ((void)0)
+#endif
+/** @} */
+
+/**
+ * @defgroup CoreUtilities Core Utility Functions
+ * @{
+ */
+static inline void nanods_secure_free(void* ptr, size_t size);
+static inline int nanods_check_mul_overflow(size_t a, size_t b, size_t* result);
+static inline int nanods_check_add_overflow(size_t a, size_t b, size_t* result);
+/** @} */
+
+/* =============================================================================
+ * IMPLEMENTATION
+ * =============================================================================
+ */
+
+#ifdef NANODS_IMPLEMENTATION
+
+static NanoAllocator g_nanods_default_allocator = {
+    .malloc_fn = malloc,
+    .realloc_fn = realloc,
+    .free_fn = free
+};
+
+static NanoAllocator* g_nanods_allocator = &g_nanods_default_allocator;
+static NanoArena* g_nanods_arena = NULL;
+static NanoAllocator* g_nanods_arena_prev_allocator = NULL;
+static uint32_t g_nanods_hash_seed = 0;
+static uint64_t g_nanods_hash_key[2] = {0, 0};
+static int g_nanods_seed_initialized = 0;
+
+void nanods_set_allocator(NanoAllocator* allocator) {
+    allocator = allocator ? allocator : &g_nanods_default_allocator;
+    if (g_nanods_arena) {
+        /* The arena stays in front; this is what nanods_set_arena(NULL) restores */
+        g_nanods_arena_prev_allocator = allocator;
+    } else {
+        g_nanods_allocator = allocator;
+    }
+}
+
+NanoAllocator* nanods_get_allocator(void) {
+    return g_nanods_allocator;
+}
+
+static void* nanods_arena_malloc_fn(size_t size) {
+    return nanods_arena_alloc(g_nanods_arena, size);
+}
+
+/* Pointers from before nanods_set_arena go back to the allocator that made them */
+static void* nanods_arena_realloc_fn(void* ptr, size_t size) {
+    if (ptr && !nanods_arena_owns(g_nanods_arena, ptr)) {
+        return g_nanods_arena_prev_allocator->realloc_fn(ptr, size);
+    }
+    return nanods_arena_realloc(g_nanods_arena, ptr, size);
+}
+
+static void nanods_arena_free_fn(void* ptr) {
+    /* Arena memory is reclaimed by nanods_arena_reset */
+    if (ptr && !nanods_arena_owns(g_nanods_arena, ptr)) g_nanods_arena_prev_allocator->free_fn(ptr);
+}
+
+static NanoAllocator g_nanods_arena_allocator = {
+    .malloc_fn = nanods_arena_malloc_fn,
+    .realloc_fn = nanods_arena_realloc_fn,
+    .free_fn = nanods_arena_free_fn
+};
+
+void nanods_set_arena(NanoArena* arena) {
+    if (arena) {
+        if (!g_nanods_arena) g_nanods_arena_prev_allocator = g_nanods_allocator;
+        g_nanods_arena = arena;
+        g_nanods_allocator = &g_nanods_arena_allocator;
+    } else if (g_nanods_arena) {
+        g_nanods_arena = NULL;
+        g_nanods_allocator = g_nanods_arena_prev_allocator;
+    }
+}
+
+void nanods_seed_init(uint32_t custom_seed) {
+    if (custom_seed == 0) {
+        /* Generate seed from time + address space randomization */
+        uint32_t t = (uint32_t)time(NULL);
+        uintptr_t p = (uintptr_t)&g_nanods_hash_seed;
+        g_nanods_hash_seed = t ^ (uint32_t)(p >> 16) ^ (uint32_t)(p & 0xFFFF);
+    } else {
+        g_nanods_hash_seed = custom_seed;
+    }
+    /* Expand the 32-bit seed into the 128-bit key with splitmix64 */
+    uint64_t x = g_nanods_hash_seed;
+    for (int i = 0; i < 2; i++) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        g_nanods_hash_key[i] = z ^ (z >> 31);
+    }
+    g_nanods_seed_initialized = 1;
+}
+
+void nanods_seed_init_key(uint64_t k0, uint64_t k1) {
+    if (NANODS_UNLIKELY(!g_nanods_seed_initialized)) {
+        nanods_seed_init(0);
+    }
+    g_nanods_hash_key[0] = k0;
+    g_nanods_hash_key[1] = k1;
+}
+
+void nanods_get_hash_key(uint64_t out[2]) {
+    if (NANODS_UNLIKELY(!g_nanods_seed_initialized)) {
+        nanods_seed_init(0);
+    }
+    out[0] = g_nanods_hash_key[0];
+    out[1] = g_nanods_hash_key[1];
+}
+
+uint32_t nanods_get_seed(void) {
+    if (NANODS_UNLIKELY(!g_nanods_seed_initialized)) {
+        nanods_seed_init(0);
+    }
+    return g_nanods_hash_seed;
+}
+
+#ifdef NANODS_STATS
+NanoStatsGlobal g_nanods_stats;
+
+void nanods_stats_global(NanoStats* out) {
+    if (!out) return;
+    out->allocs = NANODS_STAT_READ(allocs);
+    out->frees = NANODS_STAT_READ(frees);
+    out->bytes = NANODS_STAT_READ(bytes);
+    out->reallocs = NANODS_STAT_READ(reallocs);
+    out->grows = NANODS_STAT_READ(grows);
+    out->lookups = NANODS_STAT_READ(lookups);
+    out->probes = NANODS_STAT_READ(probes);
+    for (int i = 0; i < NANODS_STATS_CHAIN_BUCKETS; i++) {
+        out->chain_hist[i] = NANODS_STAT_READ(chain_hist[i]);
+    }
+    out->rejected_full = NANODS_STAT_READ(rejected_full);
+    out->rejected_empty = NANODS_STAT_READ(rejected_empty);
+    out->peak_size = 0;
+}
+
+void nanods_stats_reset(void) {
+    NANODS_STAT_CLEAR(allocs);
+    NANODS_STAT_CLEAR(frees);
+    NANODS_STAT_CLEAR(bytes);
+    NANODS_STAT_CLEAR(reallocs);
+    NANODS_STAT_CLEAR(grows);
+    NANODS_STAT_CLEAR(lookups);
+    NANODS_STAT_CLEAR(probes);
+    for (int i = 0; i < NANODS_STATS_CHAIN_BUCKETS; i++) {
+        NANODS_STAT_CLEAR(chain_hist[i]);
+    }
+    NANODS_STAT_CLEAR(rejected_full);
+    NANODS_STAT_CLEAR(rejected_empty);
+}
+
+void nanods_stats_dump(FILE* out, const char* label, const NanoStats* s) {
+    if (!out || !s) return;
+    if (!label) label = "nanods";
+    fprintf(out, "%s: allocs %llu (%llu bytes), frees %llu, reallocs %llu, peak size %llu\n",
+            label, (unsigned long long)s->allocs, (unsigned long long)s->bytes,
+            (unsigned long long)s->frees, (unsigned long long)s->reallocs,
+            (unsigned long long)s->peak_size);
+    if (s->lookups) {
+        fprintf(out, "%s: lookups %llu, probes %llu (%.2f per lookup), grows %llu\n", label,
+                (unsigned long long)s->lookups, (unsigned long long)s->probes,
+                (double)s->probes / (double)s->lookups, (unsigned long long)s->grows);
+        fprintf(out, "%s: entries compared  0: %llu  1: %llu  2: %llu  3: %llu  4-7: %llu  8+: %llu\n",
+                label, (unsigned long long)s->chain_hist[0], (unsigned long long)s->chain_hist[1],
+                (unsigned long long)s->chain_hist[2], (unsigned long long)s->chain_hist[3],
+                (unsigned long long)s->chain_hist[4], (unsigned long long)s->chain_hist[5]);
+    }
+    if (s->rejected_full || s->rejected_empty) {
+        fprintf(out, "%s: rejected full %llu, empty %llu\n", label,
+                (unsigned long long)s->rejected_full, (unsigned long long)s->rejected_empty);
+    }
+}
+#endif
+
+#define NANODS_MALLOC(size) g_nanods_allocator->malloc_fn(size)
+#define NANODS_REALLOC(ptr, size) g_nanods_allocator->realloc_fn(ptr, size)
+#define NANODS_FREE(ptr) g_nanods_allocator->free_fn(ptr)
+
+#else
+
+#define NANODS_MALLOC(size) malloc(size)
+#define NANODS_REALLOC(ptr, size) realloc(ptr, size)
+#define NANODS_FREE(ptr) free(ptr)
+
+#endif
+
+static inline void nanods_secure_free(void* ptr, size_t size) {
+    if (NANODS_LIKELY(ptr && size > 0)) {
+        memset(ptr, 0, size);
+        NANODS_FREE(ptr);
+    } else if (ptr) {
+        NANODS_FREE(ptr);
+    }
+}
+
+static inline int nanods_check_mul_overflow(size_t a, size_t b, size_t* result) {
+    if (NANODS_UNLIKELY(a > 0 && b > SIZE_MAX / a)) return 1;
+    *result = a * b;
+    return 0;
+}
+
+static inline int nanods_check_add_overflow(size_t a, size_t b, size_t* result) {
+    if (NANODS_UNLIKELY(a > SIZE_MAX - b)) return 1;
+    *result = a + b;
+    return 0;
+}
+
+static inline void nanods_arena_init(NanoArena* arena, size_t block_size) {
+    NANODS_CHECK_NULL_VOID(arena);
+    arena->blocks = NULL;
+    arena->ptr = NULL;
+    arena->end = NULL;
+    arena->last = NULL;
+    arena->block_size = block_size ? block_size : NANODS_ARENA_DEFAULT_BLOCK;
+    arena->used = 0;
+}
+
+static inline uint8_t* nanods_arena_block_data(NanoArenaBlock* block) {
+    return (uint8_t*)(block + 1);
+}
+
+/* Block data is not guaranteed to be 16-aligned, so allocations align the bump pointer */
+static inline uint8_t* nanods_arena_align(uint8_t* p) {
+    uintptr_t a = ((uintptr_t)p + NANODS_ARENA_ALIGN - 1) & ~(uintptr_t)(NANODS_ARENA_ALIGN - 1);
+    return (uint8_t*)a;
+}
+
+/**
+ * Each allocation is preceded by a 16-byte header holding its size, which
+ * realloc needs to copy when it cannot resize in place.
+ */
+static inline void* nanods_arena_alloc(NanoArena* arena, size_t size) {
+    NANODS_CHECK_NULL(arena, NULL);
+    size_t need;
+    if (NANODS_UNLIKELY(nanods_check_add_overflow(size, 2 * NANODS_ARENA_ALIGN, &need))) return NULL;
+    uint8_t* p = arena->ptr ? nanods_arena_align(arena->ptr) : NULL;
+    if (NANODS_UNLIKELY(!p || need > (size_t)(arena->end - arena->ptr))) {
+        int dedicated = need > arena->block_size / 2;
+        size_t data_size = dedicated ? need : arena->block_size;
+        if (NANODS_UNLIKELY(data_size > SIZE_MAX - sizeof(NanoArenaBlock))) return NULL;
+        NanoArenaBlock* block = (NanoArenaBlock*)malloc(sizeof(NanoArenaBlock) + data_size);
+        if (NANODS_UNLIKELY(!block)) return NULL;
+        block->size = data_size;
+        p = nanods_arena_align(nanods_arena_block_data(block));
+        if (dedicated && arena->blocks) {
+            /* Large allocation: keep bumping the current block */
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+            *(size_t*)p = size;
+            arena->used += size;
+            return p + NANODS_ARENA_ALIGN;
+        }
+        block->next = arena->blocks;
+        arena->blocks = block;
+        arena->end = nanods_arena_block_data(block) + data_size;
+    }
+    *(size_t*)p = size;
+    arena->last = p + NANODS_ARENA_ALIGN;
+    arena->ptr = arena->last + size;
+    arena->used += size;
+    return arena->last;
+}
+
+static inline void* nanods_arena_realloc(NanoArena* arena, void* ptr, size_t new_size) {
+    NANODS_CHECK_NULL(arena, NULL);
+    if (!ptr) return nanods_arena_alloc(arena, new_size);
+    size_t* header = (size_t*)((uint8_t*)ptr - NANODS_ARENA_ALIGN);
+    size_t old_size = *header;
+    if ((uint8_t*)ptr == arena->last && new_size <= (size_t)(arena->end - arena->last)) {
+        *header = new_size;
+        arena->ptr = arena->last + new_size;
+        arena->used = arena->used - old_size + new_size;
+        return ptr;
+    }
+    void* moved = nanods_arena_alloc(arena, new_size);
+    if (NANODS_UNLIKELY(!moved)) return NULL;
+    memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    return moved;
+}
+
+/**
+ * Invalidate every allocation. One standard block is kept for reuse so a
+ * request-scoped arena stops calling malloc once it has warmed up.
+ */
+static inline void nanods_arena_reset(NanoArena* arena) {
+    if (!arena) return;
+    NanoArenaBlock* keep = NULL;
+    NanoArenaBlock* block = arena->blocks;
+    while (block) {
+        NanoArenaBlock* next = block->next;
+        if (!keep && block->size == arena->block_size) {
+            keep = block;
+        } else {
+            free(block);
+        }
+        block = next;
+    }
+    arena->blocks = keep;
+    arena->last = NULL;
+    arena->used = 0;
+    if (keep) {
+        keep->next = NULL;
+        arena->ptr = nanods_arena_block_data(keep);
+        arena->end = arena->ptr + keep->size;
+    } else {
+        arena->ptr = NULL;
+        arena->end = NULL;
+    }
+}
+
+static inline void nanods_arena_free(NanoArena* arena) {
+    if (!arena) return;
+    NanoArenaBlock* block = arena->blocks;
+    while (block) {
+        NanoArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->ptr = NULL;
+    arena->end = NULL;
+    arena->last = NULL;
+    arena->used = 0;
+}
+
+/* Whether `ptr` lies in one of the arena's blocks; O(blocks), newest first */
+static inline int nanods_arena_owns(const NanoArena* arena, const void* ptr) {
+    if (!arena || !ptr) return 0;
+    const uint8_t* p = (const uint8_t*)ptr;
+    for (NanoArenaBlock* block = arena->blocks; block; block = block->next) {
+        const uint8_t* data = nanods_arena_block_data(block);
+        if (p >= data && p < data + block->size) return 1;
+    }
+    return 0;
+}
+
+static inline void* nanods_arena_ctx_malloc(void* ctx, size_t size) {
+    return nanods_arena_alloc((NanoArena*)ctx, size);
+}
+
+static inline void* nanods_arena_ctx_realloc(void* ctx, void* ptr, size_t size) {
+    return nanods_arena_realloc((NanoArena*)ctx, ptr, size);
+}
+
+static inline void nanods_arena_ctx_free(void* ctx, void* ptr) {
+    (void)ctx;
+    (void)ptr;
+}
+
+static inline NanoCtxAllocator nanods_arena_allocator(NanoArena* arena) {
+    NanoCtxAllocator handle;
+    handle.malloc_fn = nanods_arena_ctx_malloc;
+    handle.realloc_fn = nanods_arena_ctx_realloc;
+    handle.free_fn = nanods_arena_ctx_free;
+    handle.ctx = arena;
+    return handle;
+}
+
+/* Container allocation entry points: per-container handle, else the global allocator */
+static inline void* nanods_mem_alloc(const NanoCtxAllocator* alloc, size_t size) {
+    NANODS_STAT_GLOBAL(allocs, 1);
+    NANODS_STAT_GLOBAL(bytes, size);
+    return alloc ? alloc->malloc_fn(alloc->ctx, size) : NANODS_MALLOC(size);
+}
+
+static inline void* nanods_mem_realloc(const NanoCtxAllocator* alloc, void* ptr, size_t size) {
+    NANODS_STAT_GLOBAL(allocs, 1);
+    NANODS_STAT_GLOBAL(bytes, size);
+    return alloc ? alloc->realloc_fn(alloc->ctx, ptr, size) : NANODS_REALLOC(ptr, size);
+}
+
+static inline void nanods_mem_free(const NanoCtxAllocator* alloc, void* ptr) {
+    if (ptr) NANODS_STAT_GLOBAL(frees, 1);
+    if (alloc) {
+        alloc->free_fn(alloc->ctx, ptr);
+    } else {
+        NANODS_FREE(ptr);
+    }
+}
+
+static inline void nanods_mem_secure_free(const NanoCtxAllocator* alloc, void* ptr, size_t size) {
+    if (ptr && size > 0) memset(ptr, 0, size);
+    if (ptr) nanods_mem_free(alloc, ptr);
+}
+
+#endif /* NANODS_CORE_H */
\ No newline at end of file
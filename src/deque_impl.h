@@ -0,0 +1,307 @@
+/**
+ * @file deque_impl.h
+ * @brief Chunked double-ended queue
+ */
+
+#ifndef NANODS_DEQUE_IMPL_H
+#define NANODS_DEQUE_IMPL_H
+
+/**
+ * @defgroup NanoDeque Chunked Deque
+ * @{
+ *
+ * Elements live in fixed-size chunks of NANODS_DEQUE_CHUNK_LEN(T) slots.
+ * A ring of chunk pointers indexes them, so push and pop at either end are
+ * O(1) and element i sits at chunk (head + i) / len, offset (head + i) % len.
+ * A chunk emptied by a pop is kept as a spare and reused by the next push
+ * that needs a chunk, so a FIFO in steady state does not allocate. The chunk
+ * map doubles (a copy of chunk pointers only) when it runs out of slots.
+ *
+ * Pointers to elements stay valid until that element is popped: pushes add
+ * chunks but never move existing ones.
+ */
+
+/* Target chunk size; each chunk holds at least 16 elements */
+#ifndef NANODS_DEQUE_CHUNK_BYTES
+    #define NANODS_DEQUE_CHUNK_BYTES 512
+#endif
+
+#define NANODS_DEQUE_CHUNK_LEN(T)                                              \
+    (sizeof(T) * 16 > NANODS_DEQUE_CHUNK_BYTES ? (size_t)16 : NANODS_DEQUE_CHUNK_BYTES / sizeof(T))
+
+#define NANODS_DEFINE_DEQUE(T)                                                 \
+    typedef struct {                                                           \
+        T** chunks;                       /* Ring of chunk pointers */         \
+        size_t map_capacity;              /* Slots in chunks, a power of two */ \
+        size_t first;                     /* Slot of the chunk holding element 0 */ \
+        size_t used;                      /* Chunks in use, from first */      \
+        size_t head;                      /* Offset of element 0 in its chunk */ \
+        size_t size;                                                           \
+        T* spare;                         /* Emptied chunk kept for reuse */   \
+        const NanoCtxAllocator* alloc;    /* NULL: global allocator */         \
+        uint8_t flags;                                                         \
+    } NanoDeque_##T;                                                           \
+                                                                               \
+    static inline void nd_init_ex_##T(NanoDeque_##T* dq, uint8_t flags) {      \
+        NANODS_CHECK_NULL_VOID(dq);                                            \
+        dq->chunks = NULL;                                                     \
+        dq->map_capacity = 0;                                                  \
+        dq->first = 0;                                                         \
+        dq->used = 0;                                                          \
+        dq->head = 0;                                                          \
+        dq->size = 0;                                                          \
+        dq->spare = NULL;                                                      \
+        dq->alloc = NULL;                                                      \
+        dq->flags = flags;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline void nd_init_##T(NanoDeque_##T* dq) {                        \
+        nd_init_ex_##T(dq, NANODS_FLAG_NONE);                                  \
+    }                                                                          \
+                                                                               \
+    static inline void nd_init_alloc_##T(NanoDeque_##T* dq, uint8_t flags,     \
+                                          const NanoCtxAllocator* alloc) {     \
+        NANODS_CHECK_NULL_VOID(dq);                                            \
+        nd_init_ex_##T(dq, flags);                                             \
+        dq->alloc = alloc;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline T* nd_slot_##T(const NanoDeque_##T* dq, size_t index) {      \
+        size_t pos = dq->head + index;                                         \
+        return dq->chunks[(dq->first + pos / NANODS_DEQUE_CHUNK_LEN(T)) & (dq->map_capacity - 1)] + \
+               pos % NANODS_DEQUE_CHUNK_LEN(T);                                \
+    }                                                                          \
+                                                                               \
+    static inline T* nd_chunk_acquire_##T(NanoDeque_##T* dq) {                 \
+        T* chunk = dq->spare;                                                  \
+        if (chunk) {                                                           \
+            dq->spare = NULL;                                                  \
+            return chunk;                                                      \
+        }                                                                      \
+        return (T*)nanods_mem_alloc(dq->alloc, NANODS_DEQUE_CHUNK_LEN(T) * sizeof(T)); \
+    }                                                                          \
+                                                                               \
+    static inline void nd_chunk_release_##T(NanoDeque_##T* dq, T* chunk) {     \
+        if (dq->flags & NANODS_FLAG_SECURE) memset(chunk, 0, NANODS_DEQUE_CHUNK_LEN(T) * sizeof(T)); \
+        if (!dq->spare) {                                                      \
+            dq->spare = chunk;                                                 \
+        } else {                                                               \
+            nanods_mem_free(dq->alloc, chunk);                                 \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* Make sure the map has a free slot for one more chunk */                 \
+    static inline int nd_map_reserve_##T(NanoDeque_##T* dq) {                  \
+        if (NANODS_LIKELY(dq->used < dq->map_capacity)) return NANODS_OK;      \
+        size_t new_capacity, bytes;                                            \
+        if (NANODS_UNLIKELY(nanods_check_mul_overflow(dq->map_capacity ? dq->map_capacity : 4, 2, \
+                                                      &new_capacity) ||        \
+                            nanods_check_mul_overflow(new_capacity, sizeof(T*), &bytes))) \
+            return NANODS_ERR_OVERFLOW;                                        \
+        T** map = (T**)nanods_mem_alloc(dq->alloc, bytes);                     \
+        if (NANODS_UNLIKELY(!map)) return NANODS_ERR_NOMEM;                    \
+        for (size_t i = 0; i < dq->used; i++) {                                \
+            map[i] = dq->chunks[(dq->first + i) & (dq->map_capacity - 1)];     \
+        }                                                                      \
+        nanods_mem_free(dq->alloc, dq->chunks);                                \
+        dq->chunks = map;                                                      \
+        dq->map_capacity = new_capacity;                                       \
+        dq->first = 0;                                                         \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_push_back_##T(NanoDeque_##T* dq, T value) {           \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        if (NANODS_UNLIKELY(dq->head + dq->size == dq->used * NANODS_DEQUE_CHUNK_LEN(T))) { \
+            /* The last chunk is full (or there is none) */                    \
+            int err = nd_map_reserve_##T(dq);                                  \
+            if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                 \
+            T* chunk = nd_chunk_acquire_##T(dq);                               \
+            if (NANODS_UNLIKELY(!chunk)) return NANODS_ERR_NOMEM;              \
+            dq->chunks[(dq->first + dq->used) & (dq->map_capacity - 1)] = chunk; \
+            dq->used++;                                                        \
+        }                                                                      \
+        *nd_slot_##T(dq, dq->size) = value;                                    \
+        dq->size++;                                                            \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_push_front_##T(NanoDeque_##T* dq, T value) {          \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        if (NANODS_UNLIKELY(dq->head == 0)) {                                  \
+            if (dq->size == 0 && dq->used == 1) {                              \
+                dq->head = NANODS_DEQUE_CHUNK_LEN(T);   /* Fill the empty chunk from its end */ \
+            } else {                                                           \
+                int err = nd_map_reserve_##T(dq);                              \
+                if (NANODS_UNLIKELY(err != NANODS_OK)) return err;             \
+                T* chunk = nd_chunk_acquire_##T(dq);                           \
+                if (NANODS_UNLIKELY(!chunk)) return NANODS_ERR_NOMEM;          \
+                dq->first = (dq->first - 1) & (dq->map_capacity - 1);          \
+                dq->chunks[dq->first] = chunk;                                 \
+                dq->used++;                                                    \
+                dq->head = NANODS_DEQUE_CHUNK_LEN(T);                          \
+            }                                                                  \
+        }                                                                      \
+        dq->head--;                                                            \
+        dq->chunks[dq->first][dq->head] = value;                               \
+        dq->size++;                                                            \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_pop_front_##T(NanoDeque_##T* dq, T* out) {            \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        NANODS_CHECK_EMPTY(dq->size, NANODS_ERR_EMPTY);                        \
+        T* slot = dq->chunks[dq->first] + dq->head;                            \
+        if (out) *out = *slot;                                                 \
+        if (dq->flags & NANODS_FLAG_SECURE) memset(slot, 0, sizeof(T));        \
+        dq->head++;                                                            \
+        dq->size--;                                                            \
+        if (dq->size == 0) {                                                   \
+            dq->head = 0;                 /* Keep the one chunk left for the next push */ \
+        } else if (dq->head == NANODS_DEQUE_CHUNK_LEN(T)) {                    \
+            nd_chunk_release_##T(dq, dq->chunks[dq->first]);                   \
+            dq->first = (dq->first + 1) & (dq->map_capacity - 1);              \
+            dq->used--;                                                        \
+            dq->head = 0;                                                      \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_pop_back_##T(NanoDeque_##T* dq, T* out) {             \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        NANODS_CHECK_EMPTY(dq->size, NANODS_ERR_EMPTY);                        \
+        size_t pos = dq->head + dq->size - 1;                                  \
+        T* slot = nd_slot_##T(dq, dq->size - 1);                               \
+        if (out) *out = *slot;                                                 \
+        if (dq->flags & NANODS_FLAG_SECURE) memset(slot, 0, sizeof(T));        \
+        dq->size--;                                                            \
+        if (dq->size == 0) {                                                   \
+            dq->head = 0;                                                      \
+        } else if (pos % NANODS_DEQUE_CHUNK_LEN(T) == 0) {                     \
+            /* That element was the only one in the last chunk */              \
+            nd_chunk_release_##T(dq, dq->chunks[(dq->first + dq->used - 1) & (dq->map_capacity - 1)]); \
+            dq->used--;                                                        \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_peek_front_##T(const NanoDeque_##T* dq, T* out) {     \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_EMPTY(dq->size, NANODS_ERR_EMPTY);                        \
+        *out = dq->chunks[dq->first][dq->head];                                \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_peek_back_##T(const NanoDeque_##T* dq, T* out) {      \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_EMPTY(dq->size, NANODS_ERR_EMPTY);                        \
+        *out = *nd_slot_##T(dq, dq->size - 1);                                 \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_get_##T(const NanoDeque_##T* dq, size_t index, T* out) { \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_BOUNDS(index, dq->size, NANODS_ERR_BOUNDS);               \
+        *out = *nd_slot_##T(dq, index);                                        \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nd_set_##T(NanoDeque_##T* dq, size_t index, T value) {   \
+        NANODS_CHECK_NULL(dq, NANODS_ERR_NULL);                                \
+        NANODS_CHECK_BOUNDS(index, dq->size, NANODS_ERR_BOUNDS);               \
+        *nd_slot_##T(dq, index) = value;                                       \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Element `index` and the number of elements contiguous with it (NULL past the end) */ \
+    static inline T* nd_span_##T(const NanoDeque_##T* dq, size_t index, size_t* count) { \
+        if (!dq || index >= dq->size) {                                        \
+            if (count) *count = 0;                                             \
+            return NULL;                                                       \
+        }                                                                      \
+        size_t offset = (dq->head + index) % NANODS_DEQUE_CHUNK_LEN(T);        \
+        size_t run = NANODS_DEQUE_CHUNK_LEN(T) - offset;                       \
+        if (run > dq->size - index) run = dq->size - index;                    \
+        if (count) *count = run;                                               \
+        return nd_slot_##T(dq, index);                                         \
+    }                                                                          \
+                                                                               \
+    static inline size_t nd_size_##T(const NanoDeque_##T* dq) {                \
+        return dq ? dq->size : 0;                                              \
+    }                                                                          \
+                                                                               \
+    static inline int nd_empty_##T(const NanoDeque_##T* dq) {                  \
+        return dq ? (dq->size == 0) : 1;                                       \
+    }                                                                          \
+                                                                               \
+    /* Remove every element; one chunk stays cached as the spare */            \
+    static inline void nd_clear_##T(NanoDeque_##T* dq) {                       \
+        if (!dq) return;                                                       \
+        for (size_t i = 0; i < dq->used; i++) {                                \
+            nd_chunk_release_##T(dq, dq->chunks[(dq->first + i) & (dq->map_capacity - 1)]); \
+        }                                                                      \
+        dq->first = 0;                                                         \
+        dq->used = 0;                                                          \
+        dq->head = 0;                                                          \
+        dq->size = 0;                                                          \
+    }                                                                          \
+                                                                               \
+    static inline void nd_free_##T(NanoDeque_##T* dq) {                        \
+        if (!dq) return;                                                       \
+        nd_clear_##T(dq);                                                      \
+        if (dq->spare) nanods_mem_free(dq->alloc, dq->spare);   /* Wiped on release if secure */ \
+        nanods_mem_free(dq->alloc, dq->chunks);                                \
+        dq->spare = NULL;                                                      \
+        dq->chunks = NULL;                                                     \
+        dq->map_capacity = 0;                                                  \
+    }                                                                          \
+                                                                               \
+    static inline void nd_secure_free_##T(NanoDeque_##T* dq) {                 \
+        if (!dq) return;                                                       \
+        uint8_t flags = dq->flags;                                             \
+        dq->flags |= NANODS_FLAG_SECURE;                                       \
+        if (dq->spare) memset(dq->spare, 0, NANODS_DEQUE_CHUNK_LEN(T) * sizeof(T)); \
+        nd_free_##T(dq);                                                       \
+        dq->flags = flags;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline NanoIter nd_iter_##T(NanoDeque_##T* dq) {                    \
+        NanoIter it;                                                           \
+        it.type = NANODS_ITER_DEQUE;                                           \
+        it.container = dq;                                                     \
+        it.index = 0;                                                          \
+        it.ptr = (dq && dq->size > 0) ? nd_slot_##T(dq, 0) : NULL;             \
+        it.internal = NULL;                                                    \
+        it.finished = (!dq || dq->size == 0);                                  \
+        return it;                                                             \
+    }                                                                          \
+                                                                               \
+    static inline int nd_iter_next_##T(NanoIter* it) {                         \
+        if (!it || it->finished) return 0;                                     \
+        NanoDeque_##T* dq = (NanoDeque_##T*)it->container;                     \
+        it->index++;                                                           \
+        if (it->index >= dq->size) {                                           \
+            it->finished = 1;                                                  \
+            it->ptr = NULL;                                                    \
+            return 0;                                                          \
+        }                                                                      \
+        it->ptr = nd_slot_##T(dq, it->index);                                  \
+        return 1;                                                              \
+    }
+
+NANODS_DEFINE_DEQUE(int)
+NANODS_DEFINE_DEQUE(float)
+NANODS_DEFINE_DEQUE(double)
+NANODS_DEFINE_DEQUE(char)
+
+typedef NanoDeque_int IntDeque;
+typedef NanoDeque_float FloatDeque;
+typedef NanoDeque_double DoubleDeque;
+typedef NanoDeque_char CharDeque;
+
+/** @} */
+
+#endif /* NANODS_DEQUE_IMPL_H */
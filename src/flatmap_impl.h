@@ -0,0 +1,375 @@
+/**
+ * @file flatmap_impl.h
+ * @brief Open-addressing string-keyed hash map with SIMD group probing
+ */
+
+#ifndef NANODS_FLATMAP_IMPL_H
+#define NANODS_FLATMAP_IMPL_H
+
+/**
+ * @defgroup NanoFlatMap Open-Addressing String-Keyed Hash Map
+ *
+ * Swiss-table layout: a control byte per slot holds either a 7-bit hash tag
+ * (full slot) or an EMPTY/DELETED marker. Lookups scan 16 control bytes at a
+ * time with SSE2/NEON and only touch the slot array on tag matches.
+ * Define NANODS_NO_SIMD to force the portable scalar group scan.
+ * @{
+ */
+
+#define NANODS_FLATMAP_GROUP   16
+#define NANODS_FLATMAP_EMPTY   ((uint8_t)0x80)
+#define NANODS_FLATMAP_DELETED ((uint8_t)0xFE)
+
+/* Maximum load factor (full + deleted slots) before the table grows: 7/8 */
+#define NANODS_FLATMAP_LOAD_NUM 7
+#define NANODS_FLATMAP_LOAD_DEN 8
+
+typedef struct {
+    char* key;
+    void* value;
+} NanoFlatMapSlot;
+
+typedef struct {
+    uint8_t* ctrl;           /* One control byte per slot */
+    NanoFlatMapSlot* slots;  /* Same allocation, right after ctrl */
+    size_t capacity;         /* 0 or a power of two >= NANODS_FLATMAP_GROUP */
+    size_t size;
+    size_t tombstones;
+    const NanoCtxAllocator* alloc;  /* NULL: global allocator */
+    uint32_t seed;
+    uint8_t flags;
+} NanoFlatMap;
+
+/* Group scans: bit i of the result is set if control byte i matches */
+static inline uint32_t nfm_group_match(const uint8_t* group, uint8_t tag) {
+#if defined(NANODS_HAVE_SSE2)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)(const void*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#elif defined(NANODS_HAVE_NEON)
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                     1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t eq = vceqq_u8(vld1q_u8(group), vdupq_n_u8(tag));
+    uint8x16_t m = vandq_u8(eq, vld1q_u8(bits));
+    return (uint32_t)vaddv_u8(vget_low_u8(m)) | ((uint32_t)vaddv_u8(vget_high_u8(m)) << 8);
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < NANODS_FLATMAP_GROUP; i++) {
+        if (group[i] == tag) mask |= (1u << i);
+    }
+    return mask;
+#endif
+}
+
+/* EMPTY and DELETED both have the high bit set, full slots never do */
+static inline uint32_t nfm_group_match_free(const uint8_t* group) {
+#if defined(NANODS_HAVE_SSE2)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(const void*)group));
+#elif defined(NANODS_HAVE_NEON)
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                     1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t hi = vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(group)), vdupq_n_s8(0));
+    uint8x16_t m = vandq_u8(hi, vld1q_u8(bits));
+    return (uint32_t)vaddv_u8(vget_low_u8(m)) | ((uint32_t)vaddv_u8(vget_high_u8(m)) << 8);
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < NANODS_FLATMAP_GROUP; i++) {
+        if (group[i] & 0x80) mask |= (1u << i);
+    }
+    return mask;
+#endif
+}
+
+static inline int nfm_ctz(uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int n = 0;
+    while (!(mask & 1u)) { mask >>= 1; n++; }
+    return n;
+#endif
+}
+
+/* Final avalanche so both the group index and the 7-bit tag get good bits */
+static inline uint32_t nfm_hash(const NanoFlatMap* map, const char* key) {
+    uint32_t h = nanods_fnv1a_hash_seeded(key, map->seed);
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline void nfm_init(NanoFlatMap* map) {
+    NANODS_CHECK_NULL_VOID(map);
+    map->ctrl = NULL;
+    map->slots = NULL;
+    map->capacity = 0;
+    map->size = 0;
+    map->tombstones = 0;
+    map->alloc = NULL;
+    map->seed = nanods_get_seed();
+    map->flags = NANODS_FLAG_NONE;
+}
+
+static inline void nfm_init_ex(NanoFlatMap* map, uint8_t flags) {
+    NANODS_CHECK_NULL_VOID(map);
+    nfm_init(map);
+    map->flags = flags;
+}
+
+/* Use `alloc` (with its ctx) for the table and key copies instead of the global allocator */
+static inline void nfm_init_alloc(NanoFlatMap* map, uint8_t flags, const NanoCtxAllocator* alloc) {
+    NANODS_CHECK_NULL_VOID(map);
+    nfm_init_ex(map, flags);
+    map->alloc = alloc;
+}
+
+static inline size_t nfm_alloc_bytes(size_t capacity) {
+    return capacity + capacity * sizeof(NanoFlatMapSlot);
+}
+
+static inline void nfm_release_table(NanoFlatMap* map) {
+    if (!map->ctrl) return;
+    if (map->flags & NANODS_FLAG_SECURE) {
+        nanods_mem_secure_free(map->alloc, map->ctrl, nfm_alloc_bytes(map->capacity));
+    } else {
+        nanods_mem_free(map->alloc, map->ctrl);
+    }
+    map->ctrl = NULL;
+    map->slots = NULL;
+}
+
+/* Place a key known to be absent; used by rehash, where the table has no tombstones */
+static inline size_t nfm_find_free(const NanoFlatMap* map, uint32_t hash) {
+    size_t group_mask = map->capacity / NANODS_FLATMAP_GROUP - 1;
+    size_t group = (hash >> 7) & group_mask;
+    for (size_t probe = 1;; probe++) {
+        uint32_t free_mask = nfm_group_match_free(map->ctrl + group * NANODS_FLATMAP_GROUP);
+        if (free_mask) return group * NANODS_FLATMAP_GROUP + (size_t)nfm_ctz(free_mask);
+        group = (group + probe) & group_mask;  /* Triangular probing visits every group */
+    }
+}
+
+static inline int nfm_rehash(NanoFlatMap* map, size_t new_capacity) {
+    size_t byte_size;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(new_capacity, sizeof(NanoFlatMapSlot), &byte_size) ||
+                        nanods_check_add_overflow(byte_size, new_capacity, &byte_size)))
+        return NANODS_ERR_OVERFLOW;
+    uint8_t* block = (uint8_t*)nanods_mem_alloc(map->alloc, byte_size);
+    if (NANODS_UNLIKELY(!block)) return NANODS_ERR_NOMEM;
+    memset(block, NANODS_FLATMAP_EMPTY, new_capacity);
+
+    NanoFlatMap old = *map;
+    map->ctrl = block;
+    map->slots = (NanoFlatMapSlot*)(void*)(block + new_capacity);
+    map->capacity = new_capacity;
+    map->tombstones = 0;
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.ctrl[i] & 0x80) continue;
+        uint32_t hash = nfm_hash(map, old.slots[i].key);
+        size_t idx = nfm_find_free(map, hash);
+        map->ctrl[idx] = (uint8_t)(hash & 0x7F);
+        map->slots[idx] = old.slots[i];
+    }
+    nfm_release_table(&old);
+    return NANODS_OK;
+}
+
+static inline int nfm_init_with_capacity(NanoFlatMap* map, size_t expected) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    nfm_init(map);
+    size_t capacity = NANODS_FLATMAP_GROUP;
+    while (capacity / NANODS_FLATMAP_LOAD_DEN * NANODS_FLATMAP_LOAD_NUM < expected) {
+        if (NANODS_UNLIKELY(capacity > SIZE_MAX / 2)) return NANODS_ERR_OVERFLOW;
+        capacity *= 2;
+    }
+    return nfm_rehash(map, capacity);
+}
+
+static inline int nfm_init_with_capacity_ex(NanoFlatMap* map, size_t expected, uint8_t flags) {
+    int err = nfm_init_with_capacity(map, expected);
+    if (NANODS_LIKELY(err == NANODS_OK)) {
+        map->flags = flags;
+    }
+    return err;
+}
+
+/**
+ * Returns the slot index of `key`, or SIZE_MAX if absent.
+ */
+static inline size_t nfm_find_slot(const NanoFlatMap* map, const char* key, uint32_t hash) {
+    if (map->capacity == 0) return SIZE_MAX;
+    size_t group_mask = map->capacity / NANODS_FLATMAP_GROUP - 1;
+    size_t group = (hash >> 7) & group_mask;
+    uint8_t tag = (uint8_t)(hash & 0x7F);
+    for (size_t probe = 1; probe <= group_mask + 1; probe++) {
+        const uint8_t* ctrl = map->ctrl + group * NANODS_FLATMAP_GROUP;
+        uint32_t match = nfm_group_match(ctrl, tag);
+        while (match) {
+            size_t idx = group * NANODS_FLATMAP_GROUP + (size_t)nfm_ctz(match);
+            if (NANODS_LIKELY(strcmp(map->slots[idx].key, key) == 0)) return idx;
+            match &= match - 1;
+        }
+        if (NANODS_LIKELY(nfm_group_match(ctrl, NANODS_FLATMAP_EMPTY))) return SIZE_MAX;
+        group = (group + probe) & group_mask;
+    }
+    return SIZE_MAX;
+}
+
+static inline int nfm_set(NanoFlatMap* map, const char* key, void* value) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
+    uint32_t hash = nfm_hash(map, key);
+    size_t idx = nfm_find_slot(map, key, hash);
+    if (idx != SIZE_MAX) {
+        map->slots[idx].value = value;
+        return NANODS_OK;
+    }
+    size_t used = map->size + map->tombstones + 1;
+    if (NANODS_UNLIKELY(used * NANODS_FLATMAP_LOAD_DEN > map->capacity * NANODS_FLATMAP_LOAD_NUM)) {
+        size_t new_capacity;
+        if (map->capacity == 0) {
+            new_capacity = NANODS_FLATMAP_GROUP;
+        } else if ((map->size + 1) * 2 * NANODS_FLATMAP_LOAD_DEN <= map->capacity * NANODS_FLATMAP_LOAD_NUM) {
+            new_capacity = map->capacity;  /* Mostly tombstones: rebuild at the same size */
+        } else {
+            if (NANODS_UNLIKELY(map->capacity > SIZE_MAX / 2)) return NANODS_ERR_OVERFLOW;
+            new_capacity = map->capacity * 2;
+        }
+        int err = nfm_rehash(map, new_capacity);
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    }
+    size_t key_len = strlen(key);
+    char* key_copy = (char*)nanods_mem_alloc(map->alloc, key_len + 1);
+    if (NANODS_UNLIKELY(!key_copy)) return NANODS_ERR_NOMEM;
+    memcpy(key_copy, key, key_len + 1);
+
+    /* First free slot on the probe sequence; reuses tombstones */
+    size_t group_mask = map->capacity / NANODS_FLATMAP_GROUP - 1;
+    size_t group = (hash >> 7) & group_mask;
+    for (size_t probe = 1;; probe++) {
+        uint32_t free_mask = nfm_group_match_free(map->ctrl + group * NANODS_FLATMAP_GROUP);
+        if (free_mask) {
+            idx = group * NANODS_FLATMAP_GROUP + (size_t)nfm_ctz(free_mask);
+            break;
+        }
+        group = (group + probe) & group_mask;
+    }
+    if (map->ctrl[idx] == NANODS_FLATMAP_DELETED) map->tombstones--;
+    map->ctrl[idx] = (uint8_t)(hash & 0x7F);
+    map->slots[idx].key = key_copy;
+    map->slots[idx].value = value;
+    map->size++;
+    return NANODS_OK;
+}
+
+static inline void* nfm_get(const NanoFlatMap* map, const char* key) {
+    NANODS_CHECK_NULL(map, NULL);
+    NANODS_CHECK_NULL(key, NULL);
+    size_t idx = nfm_find_slot(map, key, nfm_hash(map, key));
+    return idx != SIZE_MAX ? map->slots[idx].value : NULL;
+}
+
+static inline int nfm_has(const NanoFlatMap* map, const char* key) {
+    NANODS_CHECK_NULL(map, 0);
+    NANODS_CHECK_NULL(key, 0);
+    return nfm_find_slot(map, key, nfm_hash(map, key)) != SIZE_MAX;
+}
+
+static inline void nfm_free_key(const NanoFlatMap* map, char* key) {
+    if (map->flags & NANODS_FLAG_SECURE) {
+        nanods_mem_secure_free(map->alloc, key, strlen(key));
+    } else {
+        nanods_mem_free(map->alloc, key);
+    }
+}
+
+static inline int nfm_remove(NanoFlatMap* map, const char* key) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
+    size_t idx = nfm_find_slot(map, key, nfm_hash(map, key));
+    if (idx == SIZE_MAX) return NANODS_ERR_NOTFOUND;
+    nfm_free_key(map, map->slots[idx].key);
+    if (map->flags & NANODS_FLAG_SECURE) {
+        memset(&map->slots[idx], 0, sizeof(NanoFlatMapSlot));
+    }
+    /* A group that still has an EMPTY slot already stops every probe, so no tombstone is needed */
+    const uint8_t* group = map->ctrl + (idx & ~(size_t)(NANODS_FLATMAP_GROUP - 1));
+    if (nfm_group_match(group, NANODS_FLATMAP_EMPTY)) {
+        map->ctrl[idx] = NANODS_FLATMAP_EMPTY;
+    } else {
+        map->ctrl[idx] = NANODS_FLATMAP_DELETED;
+        map->tombstones++;
+    }
+    map->size--;
+    return NANODS_OK;
+}
+
+static inline size_t nfm_size(const NanoFlatMap* map) {
+    return map ? map->size : 0;
+}
+
+static inline int nfm_empty(const NanoFlatMap* map) {
+    return map ? (map->size == 0) : 1;
+}
+
+static inline void nfm_clear(NanoFlatMap* map) {
+    if (!map) return;
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (map->ctrl[i] & 0x80) continue;
+        nfm_free_key(map, map->slots[i].key);
+    }
+    if (map->capacity) {
+        if (map->flags & NANODS_FLAG_SECURE) {
+            memset(map->slots, 0, map->capacity * sizeof(NanoFlatMapSlot));
+        }
+        memset(map->ctrl, NANODS_FLATMAP_EMPTY, map->capacity);
+    }
+    map->size = 0;
+    map->tombstones = 0;
+}
+
+static inline void nfm_free(NanoFlatMap* map) {
+    if (!map) return;
+    nfm_clear(map);
+    nfm_release_table(map);
+    map->capacity = 0;
+}
+
+static inline void nfm_secure_free(NanoFlatMap* map) {
+    if (!map) return;
+    uint8_t flags = map->flags;
+    map->flags |= NANODS_FLAG_SECURE;
+    nfm_free(map);
+    map->flags = flags;
+}
+
+typedef struct {
+    const NanoFlatMap* map;
+    size_t index;
+} NanoFlatMapIterator;
+
+static inline void nfm_iter_init(NanoFlatMapIterator* iter, const NanoFlatMap* map) {
+    NANODS_CHECK_NULL_VOID(iter);
+    NANODS_CHECK_NULL_VOID(map);
+    iter->map = map;
+    iter->index = 0;
+}
+
+static inline int nfm_iter_next(NanoFlatMapIterator* iter, const char** out_key, void** out_value) {
+    NANODS_CHECK_NULL(iter, NANODS_ERR_NULL);
+    const NanoFlatMap* map = iter->map;
+    while (iter->index < map->capacity) {
+        size_t i = iter->index++;
+        if (map->ctrl[i] & 0x80) continue;
+        if (out_key) *out_key = map->slots[i].key;
+        if (out_value) *out_value = map->slots[i].value;
+        return NANODS_OK;
+    }
+    return NANODS_ERR_EMPTY;
+}
+
+/** @} */
+
+#endif /* NANODS_FLATMAP_IMPL_H */
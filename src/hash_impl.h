@@ -0,0 +1,216 @@
+/**
+ * @file hash_impl.h
+ * @brief Seeded string hash functions (FNV-1a, wyhash, SipHash-1-3)
+ */
+
+#ifndef NANODS_HASH_IMPL_H
+#define NANODS_HASH_IMPL_H
+
+/**
+ * @defgroup NanoHash Seeded Hash Functions
+ * @{
+ */
+
+typedef enum {
+    NANODS_HASH_FNV1A = 0,     /* Seeded FNV-1a, one byte per step (default) */
+    NANODS_HASH_WYHASH = 1,    /* wyhash: fast 64-bit keyed hash, 16-48 bytes per step */
+    NANODS_HASH_SIPHASH13 = 2  /* SipHash-1-3 with a 128-bit key: strong hash-flooding resistance */
+} NanoHashKind;
+
+/* Hash used by nm_init*; override before including nanods.h */
+#ifndef NANODS_MAP_DEFAULT_HASH
+    #define NANODS_MAP_DEFAULT_HASH NANODS_HASH_FNV1A
+#endif
+
+/**
+ * FNV-1a hash with seed (Anti-DoS protection)
+ */
+static inline uint32_t nanods_fnv1a_hash_seeded(const char* key, uint32_t seed) {
+    NANODS_CHECK_NULL(key, 0);
+    uint32_t hash = 2166136261u ^ seed;
+    while (*key) {
+        hash ^= (uint8_t)(*key++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Seeded FNV-1a that also reports strlen(key), so callers walk the key once
+ */
+static inline uint32_t nanods_fnv1a_hash_len(const char* key, uint32_t seed, size_t* out_len) {
+    const char* p = key;
+    uint32_t hash = 2166136261u ^ seed;
+    while (*p) {
+        hash ^= (uint8_t)(*p++);
+        hash *= 16777619u;
+    }
+    *out_len = (size_t)(p - key);
+    return hash;
+}
+
+/* Little-endian loads: same hash values on every platform */
+static inline uint64_t nanods_load_le64(const uint8_t* p) {
+    return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+           ((uint64_t)p[3] << 24) | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) |
+           ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+static inline uint64_t nanods_load_le32(const uint8_t* p) {
+    return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+           ((uint64_t)p[3] << 24);
+}
+
+/* 64x64 -> 128-bit multiply, low half in *a, high half in *b */
+static inline void nanods_mul128(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static inline uint64_t nanods_wymix(uint64_t a, uint64_t b) {
+    nanods_mul128(&a, &b);
+    return a ^ b;
+}
+
+/**
+ * wyhash (final version 4) with the default secret
+ */
+static inline uint64_t nanods_wyhash(const void* data, size_t len, uint64_t seed) {
+    static const uint64_t secret[4] = {
+        0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+        0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+    };
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t a, b;
+    seed ^= nanods_wymix(seed ^ secret[0], secret[1]);
+    if (NANODS_LIKELY(len <= 16)) {
+        if (NANODS_LIKELY(len >= 4)) {
+            a = (nanods_load_le32(p) << 32) | nanods_load_le32(p + ((len >> 3) << 2));
+            b = (nanods_load_le32(p + len - 4) << 32) | nanods_load_le32(p + len - 4 - ((len >> 3) << 2));
+        } else if (NANODS_LIKELY(len > 0)) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (NANODS_UNLIKELY(i >= 48)) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = nanods_wymix(nanods_load_le64(p) ^ secret[1], nanods_load_le64(p + 8) ^ seed);
+                see1 = nanods_wymix(nanods_load_le64(p + 16) ^ secret[2], nanods_load_le64(p + 24) ^ see1);
+                see2 = nanods_wymix(nanods_load_le64(p + 32) ^ secret[3], nanods_load_le64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (NANODS_LIKELY(i >= 48));
+            seed ^= see1 ^ see2;
+        }
+        while (NANODS_UNLIKELY(i > 16)) {
+            seed = nanods_wymix(nanods_load_le64(p) ^ secret[1], nanods_load_le64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = nanods_load_le64(p + i - 16);
+        b = nanods_load_le64(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    nanods_mul128(&a, &b);
+    return nanods_wymix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+#define NANODS_ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define NANODS_SIPROUND(v0, v1, v2, v3)                                        \
+    do {                                                                       \
+        v0 += v1; v1 = NANODS_ROTL64(v1, 13); v1 ^= v0; v0 = NANODS_ROTL64(v0, 32); \
+        v2 += v3; v3 = NANODS_ROTL64(v3, 16); v3 ^= v2;                        \
+        v0 += v3; v3 = NANODS_ROTL64(v3, 21); v3 ^= v0;                        \
+        v2 += v1; v1 = NANODS_ROTL64(v1, 17); v1 ^= v2; v2 = NANODS_ROTL64(v2, 32); \
+    } while (0)
+
+/**
+ * SipHash-c-d; callers pass constant round counts so the loops unroll
+ */
+static inline uint64_t nanods_siphash(const void* data, size_t len, const uint64_t key[2],
+                                      int c_rounds, int d_rounds) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t v0 = 0x736f6d6570736575ull ^ key[0];
+    uint64_t v1 = 0x646f72616e646f6dull ^ key[1];
+    uint64_t v2 = 0x6c7967656e657261ull ^ key[0];
+    uint64_t v3 = 0x7465646279746573ull ^ key[1];
+    const uint8_t* end = p + (len & ~(size_t)7);
+    for (; p != end; p += 8) {
+        uint64_t m = nanods_load_le64(p);
+        v3 ^= m;
+        for (int r = 0; r < c_rounds; r++) NANODS_SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    uint64_t b = (uint64_t)len << 56;
+    for (size_t i = 0; i < (len & 7); i++) {
+        b |= (uint64_t)p[i] << (8 * i);
+    }
+    v3 ^= b;
+    for (int r = 0; r < c_rounds; r++) NANODS_SIPROUND(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xff;
+    for (int r = 0; r < d_rounds; r++) NANODS_SIPROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+static inline uint64_t nanods_siphash13(const void* data, size_t len, const uint64_t key[2]) {
+    return nanods_siphash(data, len, key, 1, 3);
+}
+
+/**
+ * Seeded 64-bit integer mixer (murmur3 fmix64 over key ^ scrambled seed)
+ */
+static inline uint64_t nanods_hash_u64(uint64_t x, uint32_t seed) {
+    x ^= (uint64_t)seed * 0x9e3779b97f4a7c15ull;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * Hash a NUL-terminated key with the selected function, reporting strlen(key).
+ * 64-bit results are folded to the 32 bits stored in map entries.
+ */
+static inline uint32_t nanods_hash_str(NanoHashKind kind, const char* key, size_t* out_len,
+                                       uint32_t seed, const uint64_t hash_key[2]) {
+    uint64_t h;
+    switch (kind) {
+        case NANODS_HASH_WYHASH:
+            *out_len = strlen(key);
+            h = nanods_wyhash(key, *out_len, hash_key[0] ^ seed);
+            break;
+        case NANODS_HASH_SIPHASH13:
+            *out_len = strlen(key);
+            h = nanods_siphash13(key, *out_len, hash_key);
+            break;
+        case NANODS_HASH_FNV1A:
+        default:
+            return nanods_fnv1a_hash_len(key, seed, out_len);
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+/** @} */
+
+#endif /* NANODS_HASH_IMPL_H */
@@ -0,0 +1,415 @@
+/**
+ * @file heap_impl.h
+ * @brief d-ary heap priority queue over NanoVector, plus an indexed variant
+ */
+
+#ifndef NANODS_HEAP_IMPL_H
+#define NANODS_HEAP_IMPL_H
+
+/**
+ * @defgroup NanoHeap Priority Queues
+ * @{
+ *
+ * NANODS_DEFINE_HEAP_BY(T, NAME, LESS) generates NanoHeap_NAME_T, a
+ * NanoVector_T kept in heap order. LESS is an expression over `a` and `b`,
+ * true when a leaves the heap before b (`a < b` is a min-heap), expanded
+ * inline as in the sorts. NANODS_DEFINE_HEAP(T, LESS) drops NAME:
+ *
+ *     NANODS_DEFINE_HEAP_BY(Timer, by_deadline, a.deadline < b.deadline)
+ *     nh_push_by_deadline_Timer(&timers, timer);
+ *
+ * Any NanoVector_T is a valid NanoHeap_T once nh_heapify has run on it.
+ *
+ * Nodes have NANODS_HEAP_ARITY children (default 4): the tree is half as
+ * deep as a binary heap and the children compared at each sift-down step
+ * are adjacent, usually in one cache line.
+ *
+ * NANODS_DEFINE_INDEXED_HEAP_BY(T, NAME, LESS) generates
+ * NanoIndexedHeap_NAME_T, holding (id, key) pairs for dense ids (0, 1, 2,
+ * ...). A position table finds any id in O(1), so its key can be changed
+ * (nih_decrease_key for Dijkstra, nih_push to reschedule) or removed in
+ * O(log n).
+ *
+ * Min-heaps of int and double are predefined for both.
+ */
+
+#ifndef NANODS_HEAP_ARITY
+    #define NANODS_HEAP_ARITY 4
+#endif
+#if NANODS_HEAP_ARITY < 2
+    #error "NANODS_HEAP_ARITY must be at least 2"
+#endif
+
+/* Heap over NanoVector_T; S is the function suffix (T or NAME_T) */
+#define NANODS_DEFINE_HEAP_IMPL(T, S, LESS)                                    \
+    typedef NanoVector_##T NanoHeap_##S;                                       \
+                                                                               \
+    static inline int nh_less_##S(T a, T b) {                                  \
+        return (LESS);                                                         \
+    }                                                                          \
+                                                                               \
+    /* Move data[i] towards the root; the hole moves instead of swapping */    \
+    static inline void nh_sift_up_##S(T* data, size_t i) {                     \
+        T value = data[i];                                                     \
+        while (i > 0) {                                                        \
+            size_t parent = (i - 1) / NANODS_HEAP_ARITY;                       \
+            if (!nh_less_##S(value, data[parent])) break;                      \
+            data[i] = data[parent];                                            \
+            i = parent;                                                        \
+        }                                                                      \
+        data[i] = value;                                                       \
+    }                                                                          \
+                                                                               \
+    static inline void nh_sift_down_##S(T* data, size_t i, size_t n) {         \
+        /* Nodes below `limit` have at least one child */                      \
+        size_t limit = n < 2 ? 0 : (n - 2) / NANODS_HEAP_ARITY + 1;            \
+        T value = data[i];                                                     \
+        while (i < limit) {                                                    \
+            size_t first = i * NANODS_HEAP_ARITY + 1;                          \
+            size_t end = n - first > NANODS_HEAP_ARITY ? first + NANODS_HEAP_ARITY : n; \
+            size_t best = first;                                               \
+            for (size_t c = first + 1; c < end; c++) {                         \
+                if (nh_less_##S(data[c], data[best])) best = c;                \
+            }                                                                  \
+            if (!nh_less_##S(data[best], value)) break;                        \
+            data[i] = data[best];                                              \
+            i = best;                                                          \
+        }                                                                      \
+        data[i] = value;                                                       \
+    }                                                                          \
+                                                                               \
+    static inline void nh_init_##S(NanoHeap_##S* heap) {                       \
+        nv_init_##T(heap);                                                     \
+    }                                                                          \
+                                                                               \
+    static inline void nh_init_ex_##S(NanoHeap_##S* heap, uint8_t flags) {     \
+        nv_init_ex_##T(heap, flags);                                           \
+    }                                                                          \
+                                                                               \
+    static inline void nh_init_alloc_##S(NanoHeap_##S* heap, uint8_t flags,    \
+                                         const NanoCtxAllocator* alloc) {      \
+        nv_init_alloc_##T(heap, flags, alloc);                                 \
+    }                                                                          \
+                                                                               \
+    /* Floyd's bottom-up build: O(n) over the vector's current contents */     \
+    static inline void nh_heapify_##S(NanoHeap_##S* heap) {                    \
+        if (!heap || heap->size < 2) return;                                   \
+        for (size_t i = (heap->size - 2) / NANODS_HEAP_ARITY + 1; i-- > 0;) {  \
+            nh_sift_down_##S(heap->data, i, heap->size);                       \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nh_push_##S(NanoHeap_##S* heap, T value) {               \
+        int err = nv_push_##T(heap, value);                                    \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        nh_sift_up_##S(heap->data, heap->size - 1);                            \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nh_peek_##S(const NanoHeap_##S* heap, T* out) {          \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_EMPTY_OUT(heap->size, out, NANODS_ERR_EMPTY);             \
+        *out = heap->data[0];                                                  \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nh_pop_##S(NanoHeap_##S* heap, T* out) {                 \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_EMPTY_OUT(heap->size, out, NANODS_ERR_EMPTY);             \
+        if (out) *out = heap->data[0];                                         \
+        size_t n = --heap->size;                                               \
+        if (n > 0) {                                                           \
+            heap->data[0] = heap->data[n];                                     \
+            nh_sift_down_##S(heap->data, 0, n);                                \
+        }                                                                      \
+        if (heap->flags & NANODS_FLAG_SECURE) {                                \
+            memset(heap->data + n, 0, sizeof(T));                              \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Pop the top into `out` (may be NULL) and push `value` in one sift */    \
+    static inline int nh_replace_top_##S(NanoHeap_##S* heap, T value, T* out) { \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_EMPTY_OUT(heap->size, out, NANODS_ERR_EMPTY);             \
+        if (out) *out = heap->data[0];                                         \
+        heap->data[0] = value;                                                 \
+        nh_sift_down_##S(heap->data, 0, heap->size);                           \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nh_is_heap_##S(const NanoHeap_##S* heap) {               \
+        if (!heap) return 1;                                                   \
+        for (size_t i = 1; i < heap->size; i++) {                              \
+            if (nh_less_##S(heap->data[i], heap->data[(i - 1) / NANODS_HEAP_ARITY])) return 0; \
+        }                                                                      \
+        return 1;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline size_t nh_size_##S(const NanoHeap_##S* heap) {               \
+        return nv_size_##T(heap);                                              \
+    }                                                                          \
+                                                                               \
+    static inline int nh_empty_##S(const NanoHeap_##S* heap) {                 \
+        return nv_empty_##T(heap);                                             \
+    }                                                                          \
+                                                                               \
+    static inline void nh_clear_##S(NanoHeap_##S* heap) {                      \
+        nv_clear_##T(heap);                                                    \
+    }                                                                          \
+                                                                               \
+    static inline void nh_free_##S(NanoHeap_##S* heap) {                       \
+        nv_free_##T(heap);                                                     \
+    }
+
+#define NANODS_DEFINE_HEAP(T, LESS) NANODS_DEFINE_HEAP_IMPL(T, T, LESS)
+#define NANODS_DEFINE_HEAP_BY(T, NAME, LESS)                                   \
+    NANODS_DEFINE_HEAP_IMPL(T, NAME##_##T, LESS)
+
+/* Heap of (id, key) with a position table; S is the function suffix as above */
+#define NANODS_DEFINE_INDEXED_HEAP_IMPL(T, S, LESS)                            \
+    typedef struct {                                                           \
+        T key;                                                                 \
+        size_t id;                                                             \
+    } NanoIndexedHeapNode_##S;                                                 \
+                                                                               \
+    typedef struct {                                                           \
+        NanoIndexedHeapNode_##S* nodes;  /* Heap order; keys beside ids for compares */ \
+        size_t* pos;                     /* pos[id]: node index + 1, 0 = absent */ \
+        size_t size;                                                           \
+        size_t capacity;                 /* Ids covered by pos; nodes has as many slots */ \
+        const NanoCtxAllocator* alloc;   /* NULL: global allocator */          \
+        uint8_t flags;                                                         \
+    } NanoIndexedHeap_##S;                                                     \
+                                                                               \
+    static inline int nih_less_##S(T a, T b) {                                 \
+        return (LESS);                                                         \
+    }                                                                          \
+                                                                               \
+    static inline void nih_place_##S(NanoIndexedHeap_##S* heap, size_t i,      \
+                                     NanoIndexedHeapNode_##S node) {           \
+        heap->nodes[i] = node;                                                 \
+        heap->pos[node.id] = i + 1;                                            \
+    }                                                                          \
+                                                                               \
+    static inline void nih_sift_up_##S(NanoIndexedHeap_##S* heap, size_t i) {  \
+        NanoIndexedHeapNode_##S node = heap->nodes[i];                         \
+        while (i > 0) {                                                        \
+            size_t parent = (i - 1) / NANODS_HEAP_ARITY;                       \
+            if (!nih_less_##S(node.key, heap->nodes[parent].key)) break;       \
+            nih_place_##S(heap, i, heap->nodes[parent]);                       \
+            i = parent;                                                        \
+        }                                                                      \
+        nih_place_##S(heap, i, node);                                          \
+    }                                                                          \
+                                                                               \
+    static inline void nih_sift_down_##S(NanoIndexedHeap_##S* heap, size_t i) { \
+        size_t n = heap->size;                                                 \
+        size_t limit = n < 2 ? 0 : (n - 2) / NANODS_HEAP_ARITY + 1;            \
+        NanoIndexedHeapNode_##S node = heap->nodes[i];                         \
+        while (i < limit) {                                                    \
+            size_t first = i * NANODS_HEAP_ARITY + 1;                          \
+            size_t end = n - first > NANODS_HEAP_ARITY ? first + NANODS_HEAP_ARITY : n; \
+            size_t best = first;                                               \
+            for (size_t c = first + 1; c < end; c++) {                         \
+                if (nih_less_##S(heap->nodes[c].key, heap->nodes[best].key)) best = c; \
+            }                                                                  \
+            if (!nih_less_##S(heap->nodes[best].key, node.key)) break;         \
+            nih_place_##S(heap, i, heap->nodes[best]);                         \
+            i = best;                                                          \
+        }                                                                      \
+        nih_place_##S(heap, i, node);                                          \
+    }                                                                          \
+                                                                               \
+    /* Node i holds a new key: move it whichever way restores heap order */    \
+    static inline void nih_restore_##S(NanoIndexedHeap_##S* heap, size_t i) {  \
+        if (i > 0 && nih_less_##S(heap->nodes[i].key,                          \
+                                  heap->nodes[(i - 1) / NANODS_HEAP_ARITY].key)) { \
+            nih_sift_up_##S(heap, i);                                          \
+        } else {                                                               \
+            nih_sift_down_##S(heap, i);                                        \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void nih_init_##S(NanoIndexedHeap_##S* heap) {               \
+        NANODS_CHECK_NULL_VOID(heap);                                          \
+        heap->nodes = NULL;                                                    \
+        heap->pos = NULL;                                                      \
+        heap->size = 0;                                                        \
+        heap->capacity = 0;                                                    \
+        heap->alloc = NULL;                                                    \
+        heap->flags = NANODS_FLAG_NONE;                                        \
+    }                                                                          \
+                                                                               \
+    static inline void nih_init_ex_##S(NanoIndexedHeap_##S* heap, uint8_t flags) { \
+        NANODS_CHECK_NULL_VOID(heap);                                          \
+        nih_init_##S(heap);                                                    \
+        heap->flags = flags;                                                   \
+    }                                                                          \
+                                                                               \
+    static inline void nih_init_alloc_##S(NanoIndexedHeap_##S* heap, uint8_t flags, \
+                                          const NanoCtxAllocator* alloc) {     \
+        NANODS_CHECK_NULL_VOID(heap);                                          \
+        nih_init_ex_##S(heap, flags);                                          \
+        heap->alloc = alloc;                                                   \
+    }                                                                          \
+                                                                               \
+    /* Room for ids [0, ids), so pushes of those ids cannot fail */            \
+    static inline int nih_reserve_##S(NanoIndexedHeap_##S* heap, size_t ids) { \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        if (ids <= heap->capacity) return NANODS_OK;                           \
+        size_t pos_bytes, node_bytes;                                          \
+        if (NANODS_UNLIKELY(nanods_check_mul_overflow(ids, sizeof(size_t), &pos_bytes) || \
+                            nanods_check_mul_overflow(ids, sizeof(NanoIndexedHeapNode_##S), \
+                                                      &node_bytes)))           \
+            return NANODS_ERR_OVERFLOW;                                        \
+        NanoIndexedHeapNode_##S* nodes =                                       \
+            (NanoIndexedHeapNode_##S*)nanods_mem_realloc(heap->alloc, heap->nodes, node_bytes); \
+        if (NANODS_UNLIKELY(!nodes)) return NANODS_ERR_NOMEM;                  \
+        heap->nodes = nodes;                                                   \
+        size_t* pos = (size_t*)nanods_mem_realloc(heap->alloc, heap->pos, pos_bytes); \
+        if (NANODS_UNLIKELY(!pos)) return NANODS_ERR_NOMEM;                    \
+        memset(pos + heap->capacity, 0, (ids - heap->capacity) * sizeof(size_t)); \
+        heap->pos = pos;                                                       \
+        heap->capacity = ids;                                                  \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nih_contains_##S(const NanoIndexedHeap_##S* heap, size_t id) { \
+        return heap && id < heap->capacity && heap->pos[id] != 0;              \
+    }                                                                          \
+                                                                               \
+    /* Insert `id`, or give it a new key (earlier or later) if already present */ \
+    static inline int nih_push_##S(NanoIndexedHeap_##S* heap, size_t id, T key) { \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        if (nih_contains_##S(heap, id)) {                                      \
+            size_t i = heap->pos[id] - 1;                                      \
+            heap->nodes[i].key = key;                                          \
+            nih_restore_##S(heap, i);                                          \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        /* Distinct ids below capacity, so only a new id can need room */      \
+        if (NANODS_UNLIKELY(id >= heap->capacity)) {                           \
+            if (NANODS_UNLIKELY(id == SIZE_MAX)) return NANODS_ERR_OVERFLOW;   \
+            int err = nih_reserve_##S(heap, nanods_vector_grow_capacity(heap->capacity, id + 1)); \
+            if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                 \
+        }                                                                      \
+        NanoIndexedHeapNode_##S node;                                          \
+        node.key = key;                                                        \
+        node.id = id;                                                          \
+        nih_place_##S(heap, heap->size, node);                                 \
+        nih_sift_up_##S(heap, heap->size++);                                   \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Lower `id`'s key; a key that would not move it earlier is ignored */    \
+    static inline int nih_decrease_key_##S(NanoIndexedHeap_##S* heap, size_t id, T key) { \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        if (!nih_contains_##S(heap, id)) return NANODS_ERR_NOTFOUND;           \
+        size_t i = heap->pos[id] - 1;                                          \
+        if (nih_less_##S(key, heap->nodes[i].key)) {                           \
+            heap->nodes[i].key = key;                                          \
+            nih_sift_up_##S(heap, i);                                          \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nih_key_##S(const NanoIndexedHeap_##S* heap, size_t id, T* out) { \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        if (!nih_contains_##S(heap, id)) return NANODS_ERR_NOTFOUND;           \
+        *out = heap->nodes[heap->pos[id] - 1].key;                             \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nih_peek_##S(const NanoIndexedHeap_##S* heap, size_t* id, T* key) { \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        if (NANODS_UNLIKELY(heap->size == 0) && id) *id = 0;                   \
+        NANODS_CHECK_EMPTY_OUT(heap->size, key, NANODS_ERR_EMPTY);             \
+        if (id) *id = heap->nodes[0].id;                                       \
+        if (key) *key = heap->nodes[0].key;                                    \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Unlink node i: the last node fills the hole and moves into place */     \
+    static inline void nih_remove_at_##S(NanoIndexedHeap_##S* heap, size_t i) { \
+        heap->pos[heap->nodes[i].id] = 0;                                      \
+        size_t n = --heap->size;                                               \
+        if (i != n) {                                                          \
+            nih_place_##S(heap, i, heap->nodes[n]);                            \
+            nih_restore_##S(heap, i);                                          \
+        }                                                                      \
+        if (heap->flags & NANODS_FLAG_SECURE) {                                \
+            memset(&heap->nodes[n], 0, sizeof(NanoIndexedHeapNode_##S));       \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* Either output may be NULL */                                            \
+    static inline int nih_pop_##S(NanoIndexedHeap_##S* heap, size_t* id, T* key) { \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        if (NANODS_UNLIKELY(heap->size == 0) && id) *id = 0;                   \
+        NANODS_CHECK_EMPTY_OUT(heap->size, key, NANODS_ERR_EMPTY);             \
+        if (id) *id = heap->nodes[0].id;                                       \
+        if (key) *key = heap->nodes[0].key;                                    \
+        nih_remove_at_##S(heap, 0);                                            \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nih_remove_##S(NanoIndexedHeap_##S* heap, size_t id) {   \
+        NANODS_CHECK_NULL(heap, NANODS_ERR_NULL);                              \
+        if (!nih_contains_##S(heap, id)) return NANODS_ERR_NOTFOUND;           \
+        nih_remove_at_##S(heap, heap->pos[id] - 1);                            \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline size_t nih_size_##S(const NanoIndexedHeap_##S* heap) {       \
+        return heap ? heap->size : 0;                                          \
+    }                                                                          \
+                                                                               \
+    static inline int nih_empty_##S(const NanoIndexedHeap_##S* heap) {         \
+        return heap ? heap->size == 0 : 1;                                     \
+    }                                                                          \
+                                                                               \
+    /* O(size): only the ids present are cleared from the position table */    \
+    static inline void nih_clear_##S(NanoIndexedHeap_##S* heap) {              \
+        if (!heap) return;                                                     \
+        for (size_t i = 0; i < heap->size; i++) heap->pos[heap->nodes[i].id] = 0; \
+        if (heap->flags & NANODS_FLAG_SECURE) {                                \
+            memset(heap->nodes, 0, heap->size * sizeof(NanoIndexedHeapNode_##S)); \
+        }                                                                      \
+        heap->size = 0;                                                        \
+    }                                                                          \
+                                                                               \
+    static inline void nih_free_##S(NanoIndexedHeap_##S* heap) {               \
+        if (!heap) return;                                                     \
+        if (heap->flags & NANODS_FLAG_SECURE) {                                \
+            nanods_mem_secure_free(heap->alloc, heap->nodes,                   \
+                                   heap->capacity * sizeof(NanoIndexedHeapNode_##S)); \
+        } else {                                                               \
+            nanods_mem_free(heap->alloc, heap->nodes);                         \
+        }                                                                      \
+        nanods_mem_free(heap->alloc, heap->pos);                               \
+        heap->nodes = NULL;                                                    \
+        heap->pos = NULL;                                                      \
+        heap->size = 0;                                                        \
+        heap->capacity = 0;                                                    \
+    }
+
+#define NANODS_DEFINE_INDEXED_HEAP(T, LESS) NANODS_DEFINE_INDEXED_HEAP_IMPL(T, T, LESS)
+#define NANODS_DEFINE_INDEXED_HEAP_BY(T, NAME, LESS)                           \
+    NANODS_DEFINE_INDEXED_HEAP_IMPL(T, NAME##_##T, LESS)
+
+NANODS_DEFINE_HEAP(int, a < b)
+NANODS_DEFINE_HEAP(double, a < b)
+NANODS_DEFINE_INDEXED_HEAP(int, a < b)
+NANODS_DEFINE_INDEXED_HEAP(double, a < b)
+
+typedef NanoHeap_int IntHeap;
+typedef NanoHeap_double DoubleHeap;
+typedef NanoIndexedHeap_int IntIndexedHeap;
+typedef NanoIndexedHeap_double DoubleIndexedHeap;
+
+/** @} */
+
+#endif /* NANODS_HEAP_IMPL_H */
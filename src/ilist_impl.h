@@ -0,0 +1,324 @@
+/**
+ * @file ilist_impl.h
+ * @brief Intrusive doubly linked list
+ */
+
+#ifndef NANODS_ILIST_IMPL_H
+#define NANODS_ILIST_IMPL_H
+
+/**
+ * @defgroup NanoIList Intrusive Doubly Linked List
+ * @{
+ *
+ * The caller embeds a NanoIListHook in their own struct, one per list the
+ * object can be on, and the list links the hooks directly: nothing is
+ * allocated or copied, and every operation is O(1). NANODS_ILIST_ENTRY maps a
+ * hook back to its object:
+ *
+ *     typedef struct { int id; NanoIListHook lru; NanoIListHook by_peer; } Conn;
+ *
+ *     nil_push_front(&lru, &conn->lru);
+ *     Conn* oldest = NANODS_ILIST_ENTRY(nil_back(&lru), Conn, lru);
+ *
+ * The list owns nothing: freeing the objects is the caller's job, after
+ * unlinking them. A hook must be zeroed (or nil_hook_init) before its first
+ * insert; removal clears it again. Inserting a hook that is already linked
+ * fails with NANODS_ERR_BOUNDS.
+ *
+ * Removal and nil_is_linked need the hook to be on the list passed in (or
+ * on none): a plain hook does not know its list. With NANODS_HARD_SAFETY
+ * each hook also records its list, so a hook on another list is reported as
+ * NANODS_ERR_NOTFOUND instead of corrupting both, at the cost of a third
+ * pointer per hook and O(n) splices (every moved hook is retagged).
+ */
+
+typedef struct NanoIListHook {
+    struct NanoIListHook* prev;
+    struct NanoIListHook* next;
+#ifdef NANODS_HARD_SAFETY
+    struct NanoIList* owner;       /* List this hook is on; NULL if unlinked */
+#endif
+} NanoIListHook;
+
+typedef struct NanoIList {
+    NanoIListHook* head;
+    NanoIListHook* tail;
+    size_t size;
+} NanoIList;
+
+/* Object of type `type` whose `member` is the given pointer */
+#define NANODS_CONTAINER_OF(ptr, type, member)                                 \
+    ((type*)(void*)((char*)(ptr) - offsetof(type, member)))
+
+/* NANODS_CONTAINER_OF that passes NULL through; `hook` is evaluated once */
+#define NANODS_ILIST_ENTRY(hook, type, member)                                 \
+    ((type*)nanods_ilist_entry(hook, offsetof(type, member)))
+
+/* Front to back; the loop body must not unlink `hook` */
+#define NANODS_ILIST_FOREACH(list, hook)                                       \
+    for (NanoIListHook* hook = (list)->head; hook; hook = hook->next)
+
+/* Front to back; the body may unlink (or free) `hook` */
+#define NANODS_ILIST_FOREACH_SAFE(list, hook, tmp)                             \
+    for (NanoIListHook *hook = (list)->head, *tmp = hook ? hook->next : NULL;  \
+         hook; hook = tmp, tmp = hook ? hook->next : NULL)
+
+static inline void* nanods_ilist_entry(const NanoIListHook* hook, size_t offset) {
+    return hook ? (void*)((char*)(uintptr_t)hook - offset) : NULL;
+}
+
+/* 1 if `hook` is on some list. Without HARD_SAFETY a hook alone on its list reads as 0 */
+static inline int nanods_ilist_hook_linked(const NanoIListHook* hook) {
+#ifdef NANODS_HARD_SAFETY
+    return hook->owner != NULL;
+#else
+    return hook->prev || hook->next;
+#endif
+}
+
+static inline void nanods_ilist_set_owner(NanoIListHook* hook, NanoIList* list) {
+#ifdef NANODS_HARD_SAFETY
+    hook->owner = list;
+#else
+    (void)hook;
+    (void)list;
+#endif
+}
+
+static inline void nil_init(NanoIList* list) {
+    NANODS_CHECK_NULL_VOID(list);
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+}
+
+static inline void nil_hook_init(NanoIListHook* hook) {
+    NANODS_CHECK_NULL_VOID(hook);
+    hook->prev = NULL;
+    hook->next = NULL;
+    nanods_ilist_set_owner(hook, NULL);
+}
+
+/*
+ * 1 if `hook` is on `list`. Without NANODS_HARD_SAFETY the hook must be on
+ * `list` or on no list: one linked elsewhere may read as either.
+ */
+static inline int nil_is_linked(const NanoIList* list, const NanoIListHook* hook) {
+#ifdef NANODS_HARD_SAFETY
+    return list && hook && hook->owner == list;
+#else
+    return list && hook && (hook->prev || hook->next || list->head == hook);
+#endif
+}
+
+static inline size_t nil_size(const NanoIList* list) {
+    return list ? list->size : 0;
+}
+
+static inline int nil_empty(const NanoIList* list) {
+    return list ? (list->size == 0) : 1;
+}
+
+static inline NanoIListHook* nil_front(const NanoIList* list) {
+    return list ? list->head : NULL;
+}
+
+static inline NanoIListHook* nil_back(const NanoIList* list) {
+    return list ? list->tail : NULL;
+}
+
+static inline int nil_push_front(NanoIList* list, NanoIListHook* hook) {
+    NANODS_CHECK_NULL(list, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(hook, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(nanods_ilist_hook_linked(hook) || list->head == hook)) {
+        return NANODS_ERR_BOUNDS;
+    }
+    nanods_ilist_set_owner(hook, list);
+    hook->prev = NULL;
+    hook->next = list->head;
+    if (list->head) {
+        list->head->prev = hook;
+    } else {
+        list->tail = hook;
+    }
+    list->head = hook;
+    list->size++;
+    return NANODS_OK;
+}
+
+static inline int nil_push_back(NanoIList* list, NanoIListHook* hook) {
+    NANODS_CHECK_NULL(list, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(hook, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(nanods_ilist_hook_linked(hook) || list->head == hook)) {
+        return NANODS_ERR_BOUNDS;
+    }
+    nanods_ilist_set_owner(hook, list);
+    hook->next = NULL;
+    hook->prev = list->tail;
+    if (list->tail) {
+        list->tail->next = hook;
+    } else {
+        list->head = hook;
+    }
+    list->tail = hook;
+    list->size++;
+    return NANODS_OK;
+}
+
+/* Link `hook` right after `pos`, which must be on this list (NANODS_ERR_NOTFOUND if not linked) */
+static inline int nil_insert_after(NanoIList* list, NanoIListHook* pos, NanoIListHook* hook) {
+    NANODS_CHECK_NULL(list, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(pos, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(hook, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(!nil_is_linked(list, pos))) return NANODS_ERR_NOTFOUND;
+    if (NANODS_UNLIKELY(nanods_ilist_hook_linked(hook) || list->head == hook)) {
+        return NANODS_ERR_BOUNDS;
+    }
+    nanods_ilist_set_owner(hook, list);
+    hook->prev = pos;
+    hook->next = pos->next;
+    if (pos->next) {
+        pos->next->prev = hook;
+    } else {
+        list->tail = hook;
+    }
+    pos->next = hook;
+    list->size++;
+    return NANODS_OK;
+}
+
+static inline int nil_insert_before(NanoIList* list, NanoIListHook* pos, NanoIListHook* hook) {
+    NANODS_CHECK_NULL(list, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(pos, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(hook, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(!nil_is_linked(list, pos))) return NANODS_ERR_NOTFOUND;
+    if (NANODS_UNLIKELY(nanods_ilist_hook_linked(hook) || list->head == hook)) {
+        return NANODS_ERR_BOUNDS;
+    }
+    nanods_ilist_set_owner(hook, list);
+    hook->next = pos;
+    hook->prev = pos->prev;
+    if (pos->prev) {
+        pos->prev->next = hook;
+    } else {
+        list->head = hook;
+    }
+    pos->prev = hook;
+    list->size++;
+    return NANODS_OK;
+}
+
+/*
+ * Unlink `hook` from this list and clear it; NANODS_ERR_NOTFOUND if it is not
+ * linked (or, with NANODS_HARD_SAFETY, linked into another list)
+ */
+static inline int nil_remove(NanoIList* list, NanoIListHook* hook) {
+    NANODS_CHECK_NULL(list, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(hook, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(!nil_is_linked(list, hook))) return NANODS_ERR_NOTFOUND;
+    if (hook->prev) {
+        hook->prev->next = hook->next;
+    } else {
+        list->head = hook->next;
+    }
+    if (hook->next) {
+        hook->next->prev = hook->prev;
+    } else {
+        list->tail = hook->prev;
+    }
+    hook->prev = NULL;
+    hook->next = NULL;
+    nanods_ilist_set_owner(hook, NULL);
+    list->size--;
+    return NANODS_OK;
+}
+
+/* Unlink and return the first hook (NULL if empty) */
+static inline NanoIListHook* nil_pop_front(NanoIList* list) {
+    NanoIListHook* hook = nil_front(list);
+    if (hook) nil_remove(list, hook);
+    return hook;
+}
+
+static inline NanoIListHook* nil_pop_back(NanoIList* list) {
+    NanoIListHook* hook = nil_back(list);
+    if (hook) nil_remove(list, hook);
+    return hook;
+}
+
+/* Move a linked hook to the front, e.g. an LRU touch */
+static inline int nil_move_to_front(NanoIList* list, NanoIListHook* hook) {
+    NANODS_CHECK_NULL(list, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(hook, NANODS_ERR_NULL);
+    if (list->head == hook) return NANODS_OK;
+    int err = nil_remove(list, hook);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    return nil_push_front(list, hook);
+}
+
+static inline int nil_move_to_back(NanoIList* list, NanoIListHook* hook) {
+    NANODS_CHECK_NULL(list, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(hook, NANODS_ERR_NULL);
+    if (list->tail == hook) return NANODS_OK;
+    int err = nil_remove(list, hook);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    return nil_push_back(list, hook);
+}
+
+/* Append every hook of `src` to `dst` in O(1) (O(n) with HARD_SAFETY); `src` is left empty */
+static inline int nil_splice_back(NanoIList* dst, NanoIList* src) {
+    NANODS_CHECK_NULL(dst, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(src, NANODS_ERR_NULL);
+    if (dst == src || !src->head) return NANODS_OK;
+#ifdef NANODS_HARD_SAFETY
+    for (NanoIListHook* hook = src->head; hook; hook = hook->next) hook->owner = dst;
+#endif
+    if (dst->tail) {
+        dst->tail->next = src->head;
+        src->head->prev = dst->tail;
+    } else {
+        dst->head = src->head;
+    }
+    dst->tail = src->tail;
+    dst->size += src->size;
+    nil_init(src);
+    return NANODS_OK;
+}
+
+/* Prepend every hook of `src` to `dst` in O(1) (O(n) with HARD_SAFETY); `src` is left empty */
+static inline int nil_splice_front(NanoIList* dst, NanoIList* src) {
+    NANODS_CHECK_NULL(dst, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(src, NANODS_ERR_NULL);
+    if (dst == src || !src->head) return NANODS_OK;
+#ifdef NANODS_HARD_SAFETY
+    for (NanoIListHook* hook = src->head; hook; hook = hook->next) hook->owner = dst;
+#endif
+    if (dst->head) {
+        src->tail->next = dst->head;
+        dst->head->prev = src->tail;
+    } else {
+        dst->tail = src->tail;
+    }
+    dst->head = src->head;
+    dst->size += src->size;
+    nil_init(src);
+    return NANODS_OK;
+}
+
+/* Unlink every hook (clearing each); the objects themselves are untouched */
+static inline void nil_clear(NanoIList* list) {
+    if (!list) return;
+    NanoIListHook* hook = list->head;
+    while (hook) {
+        NanoIListHook* next = hook->next;
+        hook->prev = NULL;
+        hook->next = NULL;
+        nanods_ilist_set_owner(hook, NULL);
+        hook = next;
+    }
+    nil_init(list);
+}
+
+/** @} */
+
+#endif /* NANODS_ILIST_IMPL_H */
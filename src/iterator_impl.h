@@ -15,14 +15,15 @@ typedef enum {
     NANODS_ITER_VECTOR,
     NANODS_ITER_LIST,
     NANODS_ITER_LIST2,
-    NANODS_ITER_MAP
+    NANODS_ITER_MAP,
+    NANODS_ITER_DEQUE
 } NanoIterType;
 
 typedef struct {
     NanoIterType type;
     void* container;
     void* ptr;           /* Current element pointer */
-    void* internal;      /* Internal state (node, bucket, etc.) */
+    void* internal;      /* Private per-container state: use the typed accessors */
     size_t index;        /* Current index (for vectors) */
     int finished;        /* 1 if iteration complete */
 } NanoIter;
@@ -125,34 +126,76 @@ NANODS_LIST2_ITER_INIT(float)
 NANODS_LIST2_ITER_INIT(double)
 NANODS_LIST2_ITER_INIT(char)
 
-/* Map Iterator (already has nm_iter_init/nm_iter_next) */
+/*
+ * Map Iterator. The state lives in the NanoIter itself (internal is the
+ * current NanoMapEntry, also exposed as ptr), so nothing is allocated.
+ */
 static inline NanoIter nm_iter(NanoMap* map) {
     NanoIter it;
     it.type = NANODS_ITER_MAP;
     it.container = map;
     it.index = 0;
-    it.ptr = NULL;
-    it.internal = NANODS_MALLOC(sizeof(NanoMapIterator));
-    if (it.internal) {
-        nm_iter_init((NanoMapIterator*)it.internal, map);
-    }
-    it.finished = (! map || map->size == 0);
+    it.internal = nm_entry_first(map);
+    it.ptr = it.internal;
+    it.finished = (it.internal == NULL);
     return it;
 }
 
+/* Move to the next entry; 0 once past the last */
+static inline int nm_iter_advance(NanoIter* it) {
+    if (!it || it->finished) return 0;
+    NanoMapEntry* next = nm_entry_next((const NanoMap*)it->container,
+                                       (const NanoMapEntry*)it->internal);
+    it->internal = next;
+    it->ptr = next;
+    it->index++;
+    if (!next) {
+        it->finished = 1;
+        return 0;
+    }
+    return 1;
+}
+
+/* The current entry, or NULL once the walk is over */
+static inline NanoMapEntry* nm_iter_entry(const NanoIter* it) {
+    return (it && it->type == NANODS_ITER_MAP && !it->finished)
+        ? (NanoMapEntry*)it->internal : NULL;
+}
+
 static inline int nm_iter_has_next(NanoIter* it) {
-    if (!it || it->finished || ! it->internal) return 0;
-    NanoMapIterator* map_it = (NanoMapIterator*)it->internal;
-    return map_it->current != NULL;
+    return it && !it->finished && it->internal != NULL;
 }
 
+/* Kept for source compatibility: map iterators no longer own memory */
 static inline void nm_iter_free(NanoIter* it) {
-    if (it && it->internal && it->type == NANODS_ITER_MAP) {
-        NANODS_FREE(it->internal);
-        it->internal = NULL;
-    }
+    if (it && it->type == NANODS_ITER_MAP) it->internal = NULL;
 }
 
+/*
+ * Typed loops with no NanoIter in between: each is a plain for loop, so
+ * `break`/`continue` work and the optimizer sees straight array or pointer
+ * walks. The body must not add or remove elements.
+ *
+ *     NANODS_VECTOR_FOREACH(int, &vec, x) sum += *x;          (int* x)
+ *     NANODS_LIST_FOREACH(int, &list, node) use(node->data);
+ *     NANODS_MAP_FOREACH(&map, e) printf("%s\n", e->key);     (NanoMapEntry* e)
+ */
+#define NANODS_VECTOR_FOREACH(T, vec, elem)                                    \
+    for (T *elem = (vec)->data, *nanods_end_##elem = elem ? elem + (vec)->size : elem; \
+         elem != nanods_end_##elem; elem++)
+
+#define NANODS_LIST_FOREACH(T, list, node)                                     \
+    for (NanoListNode_##T* node = (list)->head; node; node = node->next)
+
+#define NANODS_LIST2_FOREACH(T, list, node)                                    \
+    for (NanoList2Node_##T* node = (list)->head; node; node = node->next)
+
+#define NANODS_LIST2_FOREACH_REVERSE(T, list, node)                            \
+    for (NanoList2Node_##T* node = (list)->tail; node; node = node->prev)
+
+#define NANODS_MAP_FOREACH(map, entry)                                         \
+    for (NanoMapEntry* entry = nm_entry_first(map); entry; entry = nm_entry_next(map, entry))
+
 /* Generic iterator check */
 static inline int nanods_iter_has_next(NanoIter* it) {
     if (!it) return 0;
@@ -160,6 +203,7 @@ static inline int nanods_iter_has_next(NanoIter* it) {
         case NANODS_ITER_VECTOR: 
         case NANODS_ITER_LIST:
         case NANODS_ITER_LIST2:
+        case NANODS_ITER_DEQUE:
             return ! it->finished;
         case NANODS_ITER_MAP: 
             return nm_iter_has_next(it);
@@ -22,7 +22,10 @@
         NanoList2Node_##T* head;                                               \
         NanoList2Node_##T* tail;                                               \
         size_t size;                                                           \
+        NanoPool* pool;                   /* NULL: nodes come from alloc (or the global allocator) */ \
+        const NanoCtxAllocator* alloc;    /* NULL: global allocator */         \
         uint8_t flags;                                                         \
+        uint8_t owns_pool;                /* pool was created by nl2_init_pooled */ \
     } NanoList2_##T;                                                           \
                                                                                \
     static inline void nl2_init_##T(NanoList2_##T* list) {                    \
@@ -31,6 +34,9 @@
         list->tail = NULL;                                                     \
         list->size = 0;                                                        \
         list->flags = NANODS_FLAG_NONE;                                        \
+        list->pool = NULL;                                                     \
+        list->owns_pool = 0;                                                   \
+        list->alloc = NULL;                                                    \
     }                                                                          \
                                                                                \
     static inline void nl2_init_ex_##T(NanoList2_##T* list, uint8_t flags) {  \
@@ -39,11 +45,56 @@
         list->tail = NULL;                                                     \
         list->size = 0;                                                        \
         list->flags = flags;                                                   \
+        list->pool = NULL;                                                     \
+        list->owns_pool = 0;                                                   \
+        list->alloc = NULL;                                                    \
+    }                                                                          \
+                                                                               \
+    /* Use `alloc` (with its ctx) for this list's nodes instead of the global allocator */ \
+    static inline void nl2_init_alloc_##T(NanoList2_##T* list, uint8_t flags,  \
+                                          const NanoCtxAllocator* alloc) {     \
+        NANODS_CHECK_NULL_VOID(list);                                          \
+        nl2_init_ex_##T(list, flags);                                          \
+        list->alloc = alloc;                                                   \
+    }                                                                          \
+                                                                               \
+    static inline NanoList2Node_##T* nl2_node_alloc_##T(NanoList2_##T* list) { \
+        if (list->pool) return (NanoList2Node_##T*)np_alloc(list->pool);       \
+        return (NanoList2Node_##T*)nanods_mem_alloc(list->alloc, sizeof(NanoList2Node_##T)); \
+    }                                                                          \
+                                                                               \
+    static inline void nl2_node_free_##T(NanoList2_##T* list, NanoList2Node_##T* node) { \
+        if (list->flags & NANODS_FLAG_SECURE) memset(node, 0, sizeof(NanoList2Node_##T)); \
+        if (list->pool) {                                                      \
+            np_release(list->pool, node);                                      \
+        } else {                                                               \
+            nanods_mem_free(list->alloc, node);                                \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* Take nodes from a caller-owned pool, possibly shared with other containers */ \
+    static inline int nl2_init_pool_##T(NanoList2_##T* list, NanoPool* pool) { \
+        NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_NULL(pool, NANODS_ERR_NULL);                              \
+        if (NANODS_UNLIKELY(pool->node_size < sizeof(NanoList2Node_##T))) return NANODS_ERR_BOUNDS; \
+        nl2_init_##T(list);                                                    \
+        list->pool = pool;                                                     \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Own a private pool; nl2_free releases all of its chunks at once */      \
+    static inline int nl2_init_pooled_##T(NanoList2_##T* list, size_t nodes_per_chunk) { \
+        NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
+        nl2_init_##T(list);                                                    \
+        list->pool = np_create(sizeof(NanoList2Node_##T), nodes_per_chunk, NANODS_FLAG_NONE); \
+        if (NANODS_UNLIKELY(!list->pool)) return NANODS_ERR_NOMEM;             \
+        list->owns_pool = 1;                                                   \
+        return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
     static inline int nl2_push_front_##T(NanoList2_##T* list, T value) {      \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
-        NanoList2Node_##T* node = (NanoList2Node_##T*)NANODS_MALLOC(sizeof(NanoList2Node_##T)); \
+        NanoList2Node_##T* node = nl2_node_alloc_##T(list);                    \
         if (NANODS_UNLIKELY(!node)) return NANODS_ERR_NOMEM;                   \
         node->data = value;                                                    \
         node->prev = NULL;                                                     \
@@ -60,7 +111,7 @@
                                                                                \
     static inline int nl2_push_back_##T(NanoList2_##T* list, T value) {       \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
-        NanoList2Node_##T* node = (NanoList2Node_##T*)NANODS_MALLOC(sizeof(NanoList2Node_##T)); \
+        NanoList2Node_##T* node = nl2_node_alloc_##T(list);                    \
         if (NANODS_UNLIKELY(! node)) return NANODS_ERR_NOMEM;                   \
         node->data = value;                                                    \
         node->prev = list->tail;                                               \
@@ -77,7 +128,7 @@
                                                                                \
     static inline int nl2_pop_front_##T(NanoList2_##T* list, T* out) {        \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
-        NANODS_CHECK_EMPTY(list->size, NANODS_ERR_EMPTY);                     \
+        NANODS_CHECK_EMPTY_OUT(list->size, out, NANODS_ERR_EMPTY);             \
         NanoList2Node_##T* node = list->head;                                  \
         if (out) *out = node->data;                                            \
         list->head = node->next;                                               \
@@ -86,18 +137,14 @@
         } else {                                                               \
             list->tail = NULL;                                                 \
         }                                                                      \
-        if (list->flags & NANODS_FLAG_SECURE) {                                \
-            nanods_secure_free(node, sizeof(NanoList2Node_##T));               \
-        } else {                                                               \
-            NANODS_FREE(node);                                                 \
-        }                                                                      \
+        nl2_node_free_##T(list, node);                                         \
         list->size--;                                                          \
         return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
     static inline int nl2_pop_back_##T(NanoList2_##T* list, T* out) {         \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
-        NANODS_CHECK_EMPTY(list->size, NANODS_ERR_EMPTY);                     \
+        NANODS_CHECK_EMPTY_OUT(list->size, out, NANODS_ERR_EMPTY);             \
         NanoList2Node_##T* node = list->tail;                                  \
         if (out) *out = node->data;                                            \
         list->tail = node->prev;                                               \
@@ -106,11 +153,7 @@
         } else {                                                               \
             list->head = NULL;                                                 \
         }                                                                      \
-        if (list->flags & NANODS_FLAG_SECURE) {                                \
-            nanods_secure_free(node, sizeof(NanoList2Node_##T));               \
-        } else {                                                               \
-            NANODS_FREE(node);                                                 \
-        }                                                                      \
+        nl2_node_free_##T(list, node);                                         \
         list->size--;                                                          \
         return NANODS_OK;                                                      \
     }                                                                          \
@@ -120,7 +163,7 @@
                                             T value) {                         \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
         NANODS_CHECK_NULL(node, NANODS_ERR_NULL);                              \
-        NanoList2Node_##T* new_node = (NanoList2Node_##T*)NANODS_MALLOC(sizeof(NanoList2Node_##T)); \
+        NanoList2Node_##T* new_node = nl2_node_alloc_##T(list);                \
         if (NANODS_UNLIKELY(!new_node)) return NANODS_ERR_NOMEM;               \
         new_node->data = value;                                                \
         new_node->prev = node;                                                 \
@@ -149,11 +192,7 @@
         } else {                                                               \
             list->tail = node->prev;                                           \
         }                                                                      \
-        if (list->flags & NANODS_FLAG_SECURE) {                                \
-            nanods_secure_free(node, sizeof(NanoList2Node_##T));               \
-        } else {                                                               \
-            NANODS_FREE(node);                                                 \
-        }                                                                      \
+        nl2_node_free_##T(list, node);                                         \
         list->size--;                                                          \
         return NANODS_OK;                                                      \
     }                                                                          \
@@ -166,18 +205,21 @@
         return list ? (list->size == 0) : 1;                                   \
     }                                                                          \
                                                                                \
-    static inline void nl2_free_##T(NanoList2_##T* list) {                    \
+    static inline void nl2_free_##T(NanoList2_##T* list) {                     \
         if (!list) return;                                                     \
-        NanoList2Node_##T* current = list->head;                               \
-        int secure = (list->flags & NANODS_FLAG_SECURE);                       \
-        while (current) {                                                      \
-            NanoList2Node_##T* next = current->next;                           \
-            if (secure) {                                                      \
-                nanods_secure_free(current, sizeof(NanoList2Node_##T));        \
-            } else {                                                           \
-                NANODS_FREE(current);                                          \
+        if (list->owns_pool) {                                                 \
+            /* Every node lives in the pool's chunks: drop them all at once */ \
+            if (list->flags & NANODS_FLAG_SECURE) list->pool->flags |= NANODS_FLAG_SECURE; \
+            np_destroy(list->pool);                                            \
+            list->pool = NULL;                                                 \
+            list->owns_pool = 0;                                               \
+        } else {                                                               \
+            NanoList2Node_##T* current = list->head;                           \
+            while (current) {                                                  \
+                NanoList2Node_##T* next = current->next;                       \
+                nl2_node_free_##T(list, current);                              \
+                current = next;                                                \
             }                                                                  \
-            current = next;                                                    \
         }                                                                      \
         list->head = NULL;                                                     \
         list->tail = NULL;                                                     \
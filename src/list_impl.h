@@ -21,7 +21,10 @@
         NanoListNode_##T* head;                                                \
         NanoListNode_##T* tail;                                                \
         size_t size;                                                           \
+        NanoPool* pool;                   /* NULL: nodes come from alloc (or the global allocator) */ \
+        const NanoCtxAllocator* alloc;    /* NULL: global allocator */         \
         uint8_t flags;                                                         \
+        uint8_t owns_pool;                /* pool was created by nl_init_pooled */ \
     } NanoList_##T;                                                            \
                                                                                \
     static inline void nl_init_##T(NanoList_##T* list) {                      \
@@ -30,6 +33,9 @@
         list->tail = NULL;                                                     \
         list->size = 0;                                                        \
         list->flags = NANODS_FLAG_NONE;                                        \
+        list->pool = NULL;                                                     \
+        list->owns_pool = 0;                                                   \
+        list->alloc = NULL;                                                    \
     }                                                                          \
                                                                                \
     static inline void nl_init_ex_##T(NanoList_##T* list, uint8_t flags) {    \
@@ -38,11 +44,56 @@
         list->tail = NULL;                                                     \
         list->size = 0;                                                        \
         list->flags = flags;                                                   \
+        list->pool = NULL;                                                     \
+        list->owns_pool = 0;                                                   \
+        list->alloc = NULL;                                                    \
+    }                                                                          \
+                                                                               \
+    /* Use `alloc` (with its ctx) for this list's nodes instead of the global allocator */ \
+    static inline void nl_init_alloc_##T(NanoList_##T* list, uint8_t flags,    \
+                                          const NanoCtxAllocator* alloc) {     \
+        NANODS_CHECK_NULL_VOID(list);                                          \
+        nl_init_ex_##T(list, flags);                                           \
+        list->alloc = alloc;                                                   \
+    }                                                                          \
+                                                                               \
+    static inline NanoListNode_##T* nl_node_alloc_##T(NanoList_##T* list) {    \
+        if (list->pool) return (NanoListNode_##T*)np_alloc(list->pool);        \
+        return (NanoListNode_##T*)nanods_mem_alloc(list->alloc, sizeof(NanoListNode_##T)); \
+    }                                                                          \
+                                                                               \
+    static inline void nl_node_free_##T(NanoList_##T* list, NanoListNode_##T* node) { \
+        if (list->flags & NANODS_FLAG_SECURE) memset(node, 0, sizeof(NanoListNode_##T)); \
+        if (list->pool) {                                                      \
+            np_release(list->pool, node);                                      \
+        } else {                                                               \
+            nanods_mem_free(list->alloc, node);                                \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* Take nodes from a caller-owned pool, possibly shared with other containers */ \
+    static inline int nl_init_pool_##T(NanoList_##T* list, NanoPool* pool) {   \
+        NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_NULL(pool, NANODS_ERR_NULL);                              \
+        if (NANODS_UNLIKELY(pool->node_size < sizeof(NanoListNode_##T))) return NANODS_ERR_BOUNDS; \
+        nl_init_##T(list);                                                     \
+        list->pool = pool;                                                     \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Own a private pool; nl_free releases all of its chunks at once */       \
+    static inline int nl_init_pooled_##T(NanoList_##T* list, size_t nodes_per_chunk) { \
+        NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
+        nl_init_##T(list);                                                     \
+        list->pool = np_create(sizeof(NanoListNode_##T), nodes_per_chunk, NANODS_FLAG_NONE); \
+        if (NANODS_UNLIKELY(!list->pool)) return NANODS_ERR_NOMEM;             \
+        list->owns_pool = 1;                                                   \
+        return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
     static inline int nl_push_front_##T(NanoList_##T* list, T value) {        \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
-        NanoListNode_##T* node = (NanoListNode_##T*)NANODS_MALLOC(sizeof(NanoListNode_##T)); \
+        NanoListNode_##T* node = nl_node_alloc_##T(list);                      \
         if (NANODS_UNLIKELY(!node)) return NANODS_ERR_NOMEM;                   \
         node->data = value;                                                    \
         node->next = list->head;                                               \
@@ -54,7 +105,7 @@
                                                                                \
     static inline int nl_push_back_##T(NanoList_##T* list, T value) {         \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
-        NanoListNode_##T* node = (NanoListNode_##T*)NANODS_MALLOC(sizeof(NanoListNode_##T)); \
+        NanoListNode_##T* node = nl_node_alloc_##T(list);                      \
         if (NANODS_UNLIKELY(!  node)) return NANODS_ERR_NOMEM;                   \
         node->data = value;                                                    \
         node->next = NULL;                                                     \
@@ -70,16 +121,12 @@
                                                                                \
     static inline int nl_pop_front_##T(NanoList_##T* list, T* out) {          \
         NANODS_CHECK_NULL(list, NANODS_ERR_NULL);                              \
-        NANODS_CHECK_EMPTY(list->size, NANODS_ERR_EMPTY);                     \
+        NANODS_CHECK_EMPTY_OUT(list->size, out, NANODS_ERR_EMPTY);             \
         NanoListNode_##T* node = list->head;                                   \
         if (out) *out = node->data;                                            \
         list->head = node->next;                                               \
         if (list->head == NULL) list->tail = NULL;                             \
-        if (list->flags & NANODS_FLAG_SECURE) {                                \
-            nanods_secure_free(node, sizeof(NanoListNode_##T));                \
-        } else {                                                               \
-            NANODS_FREE(node);                                                 \
-        }                                                                      \
+        nl_node_free_##T(list, node);                                          \
         list->size--;                                                          \
         return NANODS_OK;                                                      \
     }                                                                          \
@@ -92,18 +139,21 @@
         return list ?   (list->size == 0) : 1;                                   \
     }                                                                          \
                                                                                \
-    static inline void nl_free_##T(NanoList_##T* list) {                      \
-        if (! list) return;                                                     \
-        NanoListNode_##T* current = list->head;                                \
-        int secure = (list->flags & NANODS_FLAG_SECURE);                       \
-        while (current) {                                                      \
-            NanoListNode_##T* next = current->next;                            \
-            if (secure) {                                                      \
-                nanods_secure_free(current, sizeof(NanoListNode_##T));         \
-            } else {                                                           \
-                NANODS_FREE(current);                                          \
+    static inline void nl_free_##T(NanoList_##T* list) {                       \
+        if (!list) return;                                                     \
+        if (list->owns_pool) {                                                 \
+            /* Every node lives in the pool's chunks: drop them all at once */ \
+            if (list->flags & NANODS_FLAG_SECURE) list->pool->flags |= NANODS_FLAG_SECURE; \
+            np_destroy(list->pool);                                            \
+            list->pool = NULL;                                                 \
+            list->owns_pool = 0;                                               \
+        } else {                                                               \
+            NanoListNode_##T* current = list->head;                            \
+            while (current) {                                                  \
+                NanoListNode_##T* next = current->next;                        \
+                nl_node_free_##T(list, current);                               \
+                current = next;                                                \
             }                                                                  \
-            current = next;                                                    \
         }                                                                      \
         list->head = NULL;                                                     \
         list->tail = NULL;                                                     \
@@ -12,31 +12,61 @@
  */
 
 typedef struct NanoMapEntry {
-    char* key;
-    void* value;
     struct NanoMapEntry* next;
+    void* value;
+    uint32_t hash;     /* Full seeded hash, compared before the key bytes */
+    uint32_t key_len;  /* strlen(key) */
+    char key[NANODS_FLEXIBLE_ARRAY];  /* NUL-terminated, stored inline: one allocation per entry */
 } NanoMapEntry;
 
+#define NANODS_MAP_ENTRY_SIZE(key_len) (offsetof(NanoMapEntry, key) + (key_len) + 1)
+
 typedef struct {
     NanoMapEntry** buckets;
     size_t bucket_count;
     size_t size;
     uint32_t seed;
     uint8_t flags;
+    uint8_t hash_kind;           /* NanoHashKind, see nm_set_hash_kind */
+    uint8_t owns_pool;           /* pool was created by nm_init_pooled */
+    NanoPool* pool;              /* NULL: entries come from the map allocator */
+    const NanoCtxAllocator* alloc;  /* NULL: global allocator */
+    uint64_t hash_key[2];        /* Key for SipHash-1-3 / wyhash */
+    NanoMapEntry** old_buckets;  /* Non-NULL while an incremental rehash is in progress */
+    size_t old_bucket_count;
+    size_t rehash_idx;           /* Next old bucket to migrate */
+    NanoBloom filter;            /* filter.blocks == NULL: none, see nm_enable_filter */
+    size_t filter_capacity;      /* Keys the filter was sized for */
+    size_t filter_keys;          /* Keys added since the last rebuild, removed ones included */
+    unsigned filter_bits;        /* Bits per key */
+    NanoBloom filter_next;       /* Filled by the rehash in progress, replaces filter at its end */
+    size_t filter_next_capacity;
+    NANODS_STATS_MEMBER
 } NanoMap;
 
-/**
- * FNV-1a hash with seed (Anti-DoS protection)
- */
-static inline uint32_t nanods_fnv1a_hash_seeded(const char* key, uint32_t seed) {
-    NANODS_CHECK_NULL(key, 0);
-    uint32_t hash = 2166136261u ^ seed;
-    while (*key) {
-        hash ^= (uint8_t)(*key++);
-        hash *= 16777619u;
-    }
-    return hash;
-}
+/* Maximum load factor (size / bucket_count) before the table doubles: 3/4 */
+#define NANODS_MAP_LOAD_NUM 3
+#define NANODS_MAP_LOAD_DEN 4
+
+/* Pool node size for nm_init_pooled: entries with keys up to 39 bytes */
+#ifndef NANODS_MAP_POOL_NODE_SIZE
+    #define NANODS_MAP_POOL_NODE_SIZE 64
+#endif
+
+/* How many keys nm_get_batch prefetches ahead of the one it probes */
+#ifndef NANODS_MAP_PREFETCH_DIST
+    #define NANODS_MAP_PREFETCH_DIST 8
+#endif
+
+/* String keys nm_get_batch hashes before looking any of them up */
+#ifndef NANODS_MAP_HASH_CHUNK
+    #define NANODS_MAP_HASH_CHUNK 64
+#endif
+
+/* Old buckets migrated per nm_set/nm_upsert/nm_remove during a rehash; reads never migrate */
+#ifndef NANODS_MAP_REHASH_STEP
+    #define NANODS_MAP_REHASH_STEP 4
+#endif
 
 static inline void nm_init(NanoMap* map) {
     NANODS_CHECK_NULL_VOID(map);
@@ -45,30 +75,56 @@ static inline void nm_init(NanoMap* map) {
     map->size = 0;
     map->seed = nanods_get_seed();
     map->flags = NANODS_FLAG_NONE;
+    map->hash_kind = (uint8_t)NANODS_MAP_DEFAULT_HASH;
+    nanods_get_hash_key(map->hash_key);
+    map->owns_pool = 0;
+    map->pool = NULL;
+    map->alloc = NULL;
+    map->old_buckets = NULL;
+    map->old_bucket_count = 0;
+    map->rehash_idx = 0;
+    memset(&map->filter, 0, sizeof(map->filter));
+    map->filter_capacity = 0;
+    map->filter_keys = 0;
+    map->filter_bits = 0;
+    memset(&map->filter_next, 0, sizeof(map->filter_next));
+    map->filter_next_capacity = 0;
+    NANODS_STAT_INIT(map);
 }
 
 static inline void nm_init_ex(NanoMap* map, uint8_t flags) {
     NANODS_CHECK_NULL_VOID(map);
-    map->buckets = NULL;
-    map->bucket_count = 0;
-    map->size = 0;
-    map->seed = nanods_get_seed();
+    nm_init(map);
     map->flags = flags;
 }
 
-static inline int nm_init_with_capacity(NanoMap* map, size_t bucket_count) {
-    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
-    if (bucket_count == 0) bucket_count = 16;
+/* Use `alloc` (with its ctx) for buckets and entries instead of the global allocator */
+static inline void nm_init_alloc(NanoMap* map, uint8_t flags, const NanoCtxAllocator* alloc) {
+    NANODS_CHECK_NULL_VOID(map);
+    nm_init_ex(map, flags);
+    map->alloc = alloc;
+}
+
+static inline int nm_alloc_buckets(const NanoMap* map, size_t bucket_count, NanoMapEntry*** out) {
     size_t byte_size;
     if (NANODS_UNLIKELY(nanods_check_mul_overflow(bucket_count, sizeof(NanoMapEntry*), &byte_size)))
         return NANODS_ERR_OVERFLOW;
-    map->buckets = (NanoMapEntry**)NANODS_MALLOC(byte_size);
-    if (NANODS_UNLIKELY(!map->buckets)) return NANODS_ERR_NOMEM;
-    memset(map->buckets, 0, byte_size);
+    NanoMapEntry** buckets = (NanoMapEntry**)nanods_mem_alloc(map->alloc, byte_size);
+    if (NANODS_UNLIKELY(!buckets)) return NANODS_ERR_NOMEM;
+    NANODS_STAT_LOCAL((NanoMap*)map, allocs, 1);
+    NANODS_STAT_LOCAL((NanoMap*)map, bytes, byte_size);
+    memset(buckets, 0, byte_size);
+    *out = buckets;
+    return NANODS_OK;
+}
+
+static inline int nm_init_with_capacity(NanoMap* map, size_t bucket_count) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    if (bucket_count == 0) bucket_count = 16;
+    nm_init(map);
+    int err = nm_alloc_buckets(map, bucket_count, &map->buckets);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
     map->bucket_count = bucket_count;
-    map->size = 0;
-    map->seed = nanods_get_seed();
-    map->flags = NANODS_FLAG_NONE;
     return NANODS_OK;
 }
 
@@ -80,84 +136,544 @@ static inline int nm_init_with_capacity_ex(NanoMap* map, size_t bucket_count, ui
     return err;
 }
 
-static inline NanoMapEntry* nm_find_entry(NanoMap* map, const char* key, size_t* out_bucket_idx) {
-    NANODS_CHECK_NULL(map, NULL);
-    NANODS_CHECK_NULL(key, NULL);
-    if (map->bucket_count == 0) return NULL;
-    uint32_t hash = nanods_fnv1a_hash_seeded(key, map->seed);
-    size_t bucket_idx = hash % map->bucket_count;
-    if (out_bucket_idx) *out_bucket_idx = bucket_idx;
-    NanoMapEntry* entry = map->buckets[bucket_idx];
+/**
+ * Take entries from a caller-owned pool, possibly shared with other maps.
+ * Entries whose key does not fit in pool->node_size fall back to the map's allocator.
+ */
+static inline int nm_init_pool(NanoMap* map, NanoPool* pool) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(pool, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(pool->node_size < NANODS_MAP_ENTRY_SIZE(0))) return NANODS_ERR_BOUNDS;
+    nm_init(map);
+    map->pool = pool;
+    return NANODS_OK;
+}
+
+/* Own a private pool of NANODS_MAP_POOL_NODE_SIZE nodes; nm_free drops it at once */
+static inline int nm_init_pooled(NanoMap* map, size_t nodes_per_chunk) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    nm_init(map);
+    map->pool = np_create(NANODS_MAP_POOL_NODE_SIZE, nodes_per_chunk, NANODS_FLAG_NONE);
+    if (NANODS_UNLIKELY(!map->pool)) return NANODS_ERR_NOMEM;
+    map->owns_pool = 1;
+    return NANODS_OK;
+}
+
+static inline int nm_entry_pooled(const NanoMap* map, size_t key_len) {
+    return map->pool && NANODS_MAP_ENTRY_SIZE(key_len) <= map->pool->node_size;
+}
+
+static inline uint32_t nm_hash(const NanoMap* map, const char* key, size_t* out_len) {
+    if (NANODS_LIKELY(map->hash_kind == NANODS_HASH_FNV1A))
+        return nanods_fnv1a_hash_len(key, map->seed, out_len);
+    return nanods_hash_str((NanoHashKind)map->hash_kind, key, out_len, map->seed, map->hash_key);
+}
+
+/**
+ * A key hashed once, for the _h variants (nm_get_h, nm_set_h, ...). The hash
+ * depends on the map's seed, hash kind and hash key, so a NanoMapKey from
+ * nm_key(a, ...) is valid for any map b with nm_same_hashing(a, b): every map
+ * set up by nm_init* in one process, unless nm_set_hash_kind or a later
+ * nanods_seed_init changed one of them. `str` is not copied.
+ */
+typedef struct {
+    const char* str;
+    size_t len;
+    uint32_t hash;
+} NanoMapKey;
+
+static inline NanoMapKey nm_key(const NanoMap* map, const char* str) {
+    NanoMapKey key = { str, 0, 0 };
+    if (map && str) key.hash = nm_hash(map, str, &key.len);
+    return key;
+}
+
+static inline int nm_same_hashing(const NanoMap* a, const NanoMap* b) {
+    if (!a || !b) return 0;
+    return a->seed == b->seed && a->hash_kind == b->hash_kind &&
+           (a->hash_kind == NANODS_HASH_FNV1A ||
+            (a->hash_key[0] == b->hash_key[0] && a->hash_key[1] == b->hash_key[1]));
+}
+
+static inline int nm_filter_alloc(const NanoMap* map, NanoBloom* filter, size_t capacity) {
+    int err = nbf_init_alloc(filter, capacity, map->filter_bits, map->flags, map->alloc);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    filter->seed = map->seed;
+    return NANODS_OK;
+}
+
+/* Drop the filter a rehash was filling, if any */
+static inline void nm_filter_next_free(NanoMap* map) {
+    if (map->flags & NANODS_FLAG_SECURE) map->filter_next.flags |= NANODS_FLAG_SECURE;
+    nbf_free(&map->filter_next);
+    map->filter_next_capacity = 0;
+}
+
+/* A fresh filter for `capacity` keys holding every entry's cached hash; O(size) */
+static inline int nm_filter_build(NanoMap* map, size_t capacity) {
+    NanoBloom filter;
+    int err = nm_filter_alloc(map, &filter, capacity);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    for (int table = 0; table < 2; table++) {
+        NanoMapEntry** buckets = table ? map->old_buckets : map->buckets;
+        size_t count = table ? map->old_bucket_count : map->bucket_count;
+        for (size_t i = 0; buckets && i < count; i++) {
+            for (NanoMapEntry* entry = buckets[i]; entry; entry = entry->next) {
+                nbf_add_hash(&filter, entry->hash);
+            }
+        }
+    }
+    if (map->flags & NANODS_FLAG_SECURE) map->filter.flags |= NANODS_FLAG_SECURE;
+    nbf_free(&map->filter);
+    nm_filter_next_free(map);  /* This build already holds every key */
+    map->filter = filter;
+    map->filter_capacity = capacity;
+    map->filter_keys = map->size;
+    return NANODS_OK;
+}
+
+/*
+ * Record a new entry. An entry linked during a rehash is in the new table
+ * and is never migrated, so it also goes straight into filter_next. Past
+ * capacity the filter only loses selectivity until nm_maybe_grow starts the
+ * rehash that replaces it.
+ */
+static inline void nm_filter_insert(NanoMap* map, uint32_t hash) {
+    nbf_add_hash(&map->filter, hash);
+    map->filter_keys++;
+    if (map->filter_next.blocks) nbf_add_hash(&map->filter_next, hash);
+}
+
+/**
+ * Attach a blocked Bloom filter (see NanoBloom) so lookups of absent keys
+ * usually stop after one cache line, before the bucket array and chain. It
+ * uses the map's seed and is kept in sync by every insert. It is rebuilt
+ * from the cached hashes (no key is rehashed) a few buckets at a time,
+ * alongside the incremental rehash of a table resize; once inserts since
+ * the last rebuild reach its capacity without a resize, the table is
+ * rehashed at its current size to do the same. Removed keys linger until
+ * then. bits_per_key 0 picks NANODS_BLOOM_BITS_PER_KEY. Worth it when most
+ * lookups miss and the table is larger than the cache.
+ */
+static inline int nm_enable_filter(NanoMap* map, unsigned bits_per_key) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    map->filter_bits = bits_per_key ? bits_per_key : NANODS_BLOOM_BITS_PER_KEY;
+    return nm_filter_build(map, map->size < 32 ? 64 : map->size * 2);
+}
+
+static inline void nm_disable_filter(NanoMap* map) {
+    if (!map) return;
+    if (map->flags & NANODS_FLAG_SECURE) map->filter.flags |= NANODS_FLAG_SECURE;
+    nbf_free(&map->filter);
+    nm_filter_next_free(map);
+    map->filter_capacity = 0;
+    map->filter_keys = 0;
+}
+
+static inline int nm_has_filter(const NanoMap* map) {
+    return map && map->filter.blocks != NULL;
+}
+
+/**
+ * Migrate up to `steps` buckets from the old table into the current one.
+ * Entries are relinked, never reallocated, so pointers stay valid. Each
+ * migrated entry is also added to filter_next, which holds every live key
+ * once the last bucket is done and then takes the place of the filter.
+ */
+static inline void nm_rehash_step(NanoMap* map, size_t steps) {
+    if (NANODS_LIKELY(!map->old_buckets)) return;
+    NanoBloom* next_filter = map->filter_next.blocks ? &map->filter_next : NULL;
+    while (steps-- > 0 && map->rehash_idx < map->old_bucket_count) {
+        NanoMapEntry* entry = map->old_buckets[map->rehash_idx];
+        while (entry) {
+            NanoMapEntry* next = entry->next;
+            size_t bucket_idx = entry->hash % map->bucket_count;
+            entry->next = map->buckets[bucket_idx];
+            map->buckets[bucket_idx] = entry;
+            if (next_filter) nbf_add_hash(next_filter, entry->hash);
+            entry = next;
+        }
+        map->old_buckets[map->rehash_idx++] = NULL;
+    }
+    if (map->rehash_idx >= map->old_bucket_count) {
+        nanods_mem_free(map->alloc, map->old_buckets);
+        map->old_buckets = NULL;
+        map->old_bucket_count = 0;
+        map->rehash_idx = 0;
+        if (next_filter) {
+            if (map->flags & NANODS_FLAG_SECURE) map->filter.flags |= NANODS_FLAG_SECURE;
+            nbf_free(&map->filter);
+            map->filter = map->filter_next;
+            map->filter_capacity = map->filter_next_capacity;
+            map->filter_keys = map->size;
+            memset(&map->filter_next, 0, sizeof(map->filter_next));
+            map->filter_next_capacity = 0;
+        }
+    }
+}
+
+/**
+ * Start an incremental rehash into 2x buckets once the load factor exceeds
+ * 0.75, or into the same number of buckets once the filter is full, with a
+ * filter for the new table to be filled along the way. Allocation failure
+ * is not an error: the map keeps chaining in the current table and the
+ * full filter stays in place, less selective.
+ */
+static inline void nm_maybe_grow(NanoMap* map) {
+    if (map->old_buckets) return;
+    int grow = map->size * NANODS_MAP_LOAD_DEN > map->bucket_count * NANODS_MAP_LOAD_NUM;
+    if (!grow && (!map->filter.blocks || map->filter_keys < map->filter_capacity)) return;
+    size_t new_count = map->bucket_count;
+    if (grow && NANODS_UNLIKELY(nanods_check_mul_overflow(map->bucket_count, 2, &new_count))) {
+        return;
+    }
+    if (map->filter.blocks) {
+        /* Room for the keys until the next grow (0.75 * new_count) and for churn */
+        size_t capacity = new_count < 64 ? 64 : new_count;
+        if (nm_filter_alloc(map, &map->filter_next, capacity) == NANODS_OK) {
+            map->filter_next_capacity = capacity;
+        } else if (!grow) {
+            return;
+        }
+    }
+    NanoMapEntry** new_buckets;
+    if (NANODS_UNLIKELY(nm_alloc_buckets(map, new_count, &new_buckets) != NANODS_OK)) {
+        nm_filter_next_free(map);
+        return;
+    }
+    map->old_buckets = map->buckets;
+    map->old_bucket_count = map->bucket_count;
+    map->rehash_idx = 0;
+    map->buckets = new_buckets;
+    map->bucket_count = new_count;
+    if (grow) NANODS_STAT_ADD(map, grows, 1);
+}
+
+/**
+ * Select the hash function for this map. Existing entries are rehashed
+ * in place (relinked, not reallocated), so entry pointers stay valid.
+ */
+static inline int nm_set_hash_kind(NanoMap* map, NanoHashKind kind) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY((unsigned)kind > NANODS_HASH_SIPHASH13)) return NANODS_ERR_BOUNDS;
+    if (map->hash_kind == (uint8_t)kind) return NANODS_OK;
+    nm_rehash_step(map, SIZE_MAX);
+    map->hash_kind = (uint8_t)kind;
+    NanoMapEntry* all = NULL;
+    for (size_t i = 0; i < map->bucket_count; i++) {
+        NanoMapEntry* entry = map->buckets[i];
+        while (entry) {
+            NanoMapEntry* next = entry->next;
+            entry->next = all;
+            all = entry;
+            entry = next;
+        }
+        map->buckets[i] = NULL;
+    }
+    while (all) {
+        NanoMapEntry* next = all->next;
+        size_t key_len;
+        all->hash = nm_hash(map, all->key, &key_len);
+        size_t bucket_idx = all->hash % map->bucket_count;
+        all->next = map->buckets[bucket_idx];
+        map->buckets[bucket_idx] = all;
+        all = next;
+    }
+    /* The old filter would now reject present keys: rebuild it, or drop it */
+    if (map->filter.blocks && nm_filter_build(map, map->filter_capacity) != NANODS_OK) {
+        nm_disable_filter(map);
+    }
+    return NANODS_OK;
+}
+
+/* Hash and length are checked first; the key bytes are only read on a full match */
+static inline int nm_entry_matches(const NanoMapEntry* entry, const char* key,
+                                    size_t key_len, uint32_t hash) {
+    return entry->hash == hash && entry->key_len == key_len &&
+           memcmp(entry->key, key, key_len) == 0;
+}
+
+static inline NanoMapEntry* nm_find_hashed(const NanoMap* map, const char* key,
+                                            size_t key_len, uint32_t hash) {
+    NANODS_STAT_ONLY(size_t probes = 0;)
+    if (map->filter.blocks && !nbf_test_hash(&map->filter, hash)) {
+        NANODS_STAT_LOOKUP(map, probes);
+        return NULL;
+    }
+    NanoMapEntry* entry = map->buckets[hash % map->bucket_count];
     while (entry) {
-        if (strcmp(entry->key, key) == 0) return entry;
+        NANODS_STAT_ONLY(probes++;)
+        if (nm_entry_matches(entry, key, key_len, hash)) {
+            NANODS_STAT_LOOKUP(map, probes);
+            return entry;
+        }
         entry = entry->next;
     }
+    if (NANODS_UNLIKELY(map->old_buckets != NULL)) {
+        size_t old_idx = hash % map->old_bucket_count;
+        if (old_idx >= map->rehash_idx) {
+            entry = map->old_buckets[old_idx];
+            while (entry) {
+                NANODS_STAT_ONLY(probes++;)
+                if (nm_entry_matches(entry, key, key_len, hash)) {
+                    NANODS_STAT_LOOKUP(map, probes);
+                    return entry;
+                }
+                entry = entry->next;
+            }
+        }
+    }
+    NANODS_STAT_LOOKUP(map, probes);
     return NULL;
 }
 
-static inline int nm_set(NanoMap* map, const char* key, void* value) {
-    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
-    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
+static inline NanoMapEntry* nm_find_entry(NanoMap* map, const char* key, size_t* out_bucket_idx) {
+    NANODS_CHECK_NULL(map, NULL);
+    NANODS_CHECK_NULL(key, NULL);
+    if (map->bucket_count == 0) return NULL;
+    size_t key_len;
+    uint32_t hash = nm_hash(map, key, &key_len);
+    if (out_bucket_idx) *out_bucket_idx = hash % map->bucket_count;
+    return nm_find_hashed(map, key, key_len, hash);
+}
+
+/* Find `key` or link a new entry with a NULL value: one hash, one chain walk */
+static inline int nm_upsert_entry(NanoMap* map, NanoMapKey key, NanoMapEntry** out_entry,
+                                  int* out_inserted) {
     if (map->bucket_count == 0) {
-        int err = nm_init_with_capacity(map, 16);
+        int err = nm_alloc_buckets(map, 16, &map->buckets);
         if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+        map->bucket_count = 16;
     }
-    size_t bucket_idx;
-    NanoMapEntry* existing = nm_find_entry(map, key, &bucket_idx);
+    nm_rehash_step(map, NANODS_MAP_REHASH_STEP);
+    NanoMapEntry* existing = nm_find_hashed(map, key.str, key.len, key.hash);
     if (existing) {
-        existing->value = value;
+        *out_entry = existing;
+        if (out_inserted) *out_inserted = 0;
         return NANODS_OK;
     }
-    NanoMapEntry* new_entry = (NanoMapEntry*)NANODS_MALLOC(sizeof(NanoMapEntry));
+    if (NANODS_UNLIKELY((uint64_t)key.len > UINT32_MAX)) return NANODS_ERR_OVERFLOW;
+    NanoMapEntry* new_entry = nm_entry_pooled(map, key.len)
+        ? (NanoMapEntry*)np_alloc(map->pool)
+        : (NanoMapEntry*)nanods_mem_alloc(map->alloc, NANODS_MAP_ENTRY_SIZE(key.len));
     if (NANODS_UNLIKELY(!new_entry)) return NANODS_ERR_NOMEM;
-    new_entry->key = (char*)NANODS_MALLOC(strlen(key) + 1);
-    if (NANODS_UNLIKELY(!new_entry->key)) {
-        NANODS_FREE(new_entry);
-        return NANODS_ERR_NOMEM;
-    }
-    strcpy(new_entry->key, key);
-    new_entry->value = value;
+    memcpy(new_entry->key, key.str, key.len);
+    new_entry->key[key.len] = '\0';
+    new_entry->value = NULL;
+    new_entry->hash = key.hash;
+    new_entry->key_len = (uint32_t)key.len;
+    size_t bucket_idx = key.hash % map->bucket_count;
     new_entry->next = map->buckets[bucket_idx];
     map->buckets[bucket_idx] = new_entry;
     map->size++;
+    if (map->filter.blocks) nm_filter_insert(map, key.hash);
+    NANODS_STAT_ONLY(if (!nm_entry_pooled(map, key.len)) {
+        NANODS_STAT_LOCAL(map, allocs, 1);
+        NANODS_STAT_LOCAL(map, bytes, NANODS_MAP_ENTRY_SIZE(key.len));
+    })
+    NANODS_STAT_PEAK(map, map->size);
+    nm_maybe_grow(map);
+    *out_entry = new_entry;
+    if (out_inserted) *out_inserted = 1;
     return NANODS_OK;
 }
 
+static inline int nm_set_h(NanoMap* map, NanoMapKey key, void* value) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key.str, NANODS_ERR_NULL);
+    NanoMapEntry* entry;
+    int err = nm_upsert_entry(map, key, &entry, NULL);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    entry->value = value;
+    return NANODS_OK;
+}
+
+static inline int nm_set(NanoMap* map, const char* key, void* value) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
+    return nm_set_h(map, nm_key(map, key), value);
+}
+
+/**
+ * Get-or-insert: find `key`, or insert it with a NULL value, in one hash and
+ * one chain walk. Returns the entry's value slot, valid until the key is
+ * removed, or NULL on allocation failure or an over-long key.
+ *
+ *     void** slot = nm_upsert(&counts, word, NULL);
+ *     *slot = (void*)((uintptr_t)*slot + 1);
+ */
+static inline void** nm_upsert_h(NanoMap* map, NanoMapKey key, int* out_inserted) {
+    NANODS_CHECK_NULL(map, NULL);
+    NANODS_CHECK_NULL(key.str, NULL);
+    NanoMapEntry* entry;
+    if (NANODS_UNLIKELY(nm_upsert_entry(map, key, &entry, out_inserted) != NANODS_OK)) return NULL;
+    return &entry->value;
+}
+
+static inline void** nm_upsert(NanoMap* map, const char* key, int* out_inserted) {
+    NANODS_CHECK_NULL(map, NULL);
+    NANODS_CHECK_NULL(key, NULL);
+    return nm_upsert_h(map, nm_key(map, key), out_inserted);
+}
+
+/* 1 if found, with the value in *out_value (may be NULL): replaces nm_has + nm_get */
+static inline int nm_lookup_h(const NanoMap* map, NanoMapKey key, void** out_value) {
+    NANODS_CHECK_NULL(map, 0);
+    NANODS_CHECK_NULL(key.str, 0);
+    if (map->bucket_count == 0) return 0;
+    NanoMapEntry* entry = nm_find_hashed(map, key.str, key.len, key.hash);
+    if (entry && out_value) *out_value = entry->value;
+    return entry != NULL;
+}
+
+static inline int nm_lookup(const NanoMap* map, const char* key, void** out_value) {
+    NANODS_CHECK_NULL(map, 0);
+    NANODS_CHECK_NULL(key, 0);
+    return nm_lookup_h(map, nm_key(map, key), out_value);
+}
+
+static inline void* nm_get_h(const NanoMap* map, NanoMapKey key) {
+    void* value = NULL;
+    nm_lookup_h(map, key, &value);
+    return value;
+}
+
 static inline void* nm_get(const NanoMap* map, const char* key) {
     NANODS_CHECK_NULL(map, NULL);
     NANODS_CHECK_NULL(key, NULL);
-    NanoMapEntry* entry = nm_find_entry((NanoMap*)map, key, NULL);
-    return entry ? entry->value : NULL;
+    return nm_get_h(map, nm_key(map, key));
+}
+
+static inline int nm_has_h(const NanoMap* map, NanoMapKey key) {
+    return nm_lookup_h(map, key, NULL);
 }
 
 static inline int nm_has(const NanoMap* map, const char* key) {
     NANODS_CHECK_NULL(map, 0);
     NANODS_CHECK_NULL(key, 0);
-    return nm_find_entry((NanoMap*)map, key, NULL) != NULL;
+    return nm_has_h(map, nm_key(map, key));
 }
 
-static inline int nm_remove(NanoMap* map, const char* key) {
-    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
-    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
-    if (map->bucket_count == 0) return NANODS_ERR_NOTFOUND;
-    uint32_t hash = nanods_fnv1a_hash_seeded(key, map->seed);
-    size_t bucket_idx = hash % map->bucket_count;
-    NanoMapEntry** indirect = &map->buckets[bucket_idx];
-    int secure = (map->flags & NANODS_FLAG_SECURE);
+/* Bucket slot for `key` (and its filter block): the first miss of a lookup */
+static inline void nm_prefetch_slot(const NanoMap* map, NanoMapKey key) {
+    if (!key.str) return;
+    if (map->filter.blocks) {
+        NANODS_PREFETCH(nbf_block(&map->filter, nanods_hash_u64(key.hash, map->filter.seed)));
+    }
+    NANODS_PREFETCH(&map->buckets[key.hash % map->bucket_count]);
+}
+
+/* Chain head for `key`, once its bucket slot has arrived: the second miss */
+static inline void nm_prefetch_head(const NanoMap* map, NanoMapKey key) {
+    if (!key.str) return;
+    NanoMapEntry* head = map->buckets[key.hash % map->bucket_count];
+    if (head) NANODS_PREFETCH(head);
+}
+
+/**
+ * Look up pre-hashed keys in one pass, staying NANODS_MAP_PREFETCH_DIST keys
+ * ahead: while key i is probed, key i + DIST has its bucket slot (and filter
+ * block) prefetched and key i + DIST/2, whose slot has had time to arrive,
+ * has its chain head prefetched. The probe is the plain nm_find_hashed, so
+ * the filter is tested once per key. Either output may be NULL.
+ */
+static inline size_t nm_lookup_hashed(const NanoMap* map, const NanoMapKey* keys, size_t count,
+                                      void** out_values, uint8_t* out_found) {
+    const size_t dist = NANODS_MAP_PREFETCH_DIST, half = NANODS_MAP_PREFETCH_DIST / 2;
+    for (size_t j = 0; j < count && j < dist; j++) nm_prefetch_slot(map, keys[j]);
+    for (size_t j = 0; j < count && j < half; j++) nm_prefetch_head(map, keys[j]);
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i + dist < count) nm_prefetch_slot(map, keys[i + dist]);
+        if (i + half < count) nm_prefetch_head(map, keys[i + half]);
+        NanoMapEntry* entry = keys[i].str
+            ? nm_find_hashed(map, keys[i].str, keys[i].len, keys[i].hash) : NULL;
+        if (out_values) out_values[i] = entry ? entry->value : NULL;
+        if (out_found) out_found[i] = entry != NULL;
+        found += entry != NULL;
+    }
+    return found;
+}
+
+/* Shared by the batch calls: pre-hashed `hashed`, or `strs` hashed a chunk at a time */
+static inline size_t nm_lookup_batch_impl(const NanoMap* map, const char* const* strs,
+                                          const NanoMapKey* hashed, size_t count,
+                                          void** out_values, uint8_t* out_found) {
+    NANODS_CHECK_NULL(map, 0);
+    if (count == 0) return 0;
+    if (map->bucket_count == 0) {
+        if (out_values) memset(out_values, 0, count * sizeof(void*));
+        if (out_found) memset(out_found, 0, count);
+        return 0;
+    }
+    if (hashed) return nm_lookup_hashed(map, hashed, count, out_values, out_found);
+    NanoMapKey chunk[NANODS_MAP_HASH_CHUNK];
+    size_t found = 0;
+    for (size_t i = 0; i < count; i += NANODS_MAP_HASH_CHUNK) {
+        size_t n = count - i < NANODS_MAP_HASH_CHUNK ? count - i : NANODS_MAP_HASH_CHUNK;
+        for (size_t j = 0; j < n; j++) NANODS_PREFETCH(strs[i + j]);
+        for (size_t j = 0; j < n; j++) chunk[j] = nm_key(map, strs[i + j]);
+        found += nm_lookup_hashed(map, chunk, n, out_values ? out_values + i : NULL,
+                                  out_found ? out_found + i : NULL);
+    }
+    return found;
+}
+
+/**
+ * Batched nm_get: out_values[i] is the value for keys[i] (NULL if missing or
+ * if keys[i] is NULL). Returns how many keys were found. Pays off once the
+ * table is larger than the cache, mostly because the strings are hashed
+ * NANODS_MAP_HASH_CHUNK at a time before any of them is probed.
+ */
+static inline size_t nm_get_batch(const NanoMap* map, const char* const* keys, size_t count,
+                                  void** out_values) {
+    if (count == 0) return 0;
+    NANODS_CHECK_NULL(keys, 0);
+    NANODS_CHECK_NULL(out_values, 0);
+    return nm_lookup_batch_impl(map, keys, NULL, count, out_values, NULL);
+}
+
+/* Batched nm_has: out_found[i] is 1 or 0 (may be NULL to only count) */
+static inline size_t nm_has_batch(const NanoMap* map, const char* const* keys, size_t count,
+                                  uint8_t* out_found) {
+    if (count == 0) return 0;
+    NANODS_CHECK_NULL(keys, 0);
+    return nm_lookup_batch_impl(map, keys, NULL, count, NULL, out_found);
+}
+
+/* Pre-hashed keys (nm_key, nsp_key): about as fast as a loop of nm_get_h */
+static inline size_t nm_get_batch_h(const NanoMap* map, const NanoMapKey* keys, size_t count,
+                                    void** out_values) {
+    if (count == 0) return 0;
+    NANODS_CHECK_NULL(keys, 0);
+    NANODS_CHECK_NULL(out_values, 0);
+    return nm_lookup_batch_impl(map, NULL, keys, count, out_values, NULL);
+}
+
+static inline size_t nm_has_batch_h(const NanoMap* map, const NanoMapKey* keys, size_t count,
+                                    uint8_t* out_found) {
+    if (count == 0) return 0;
+    NANODS_CHECK_NULL(keys, 0);
+    return nm_lookup_batch_impl(map, NULL, keys, count, NULL, out_found);
+}
+
+static inline void nm_free_entry(NanoMap* map, NanoMapEntry* entry) {
+    size_t key_len = entry->key_len;
+    if (map->flags & NANODS_FLAG_SECURE) memset(entry, 0, NANODS_MAP_ENTRY_SIZE(key_len));
+    if (nm_entry_pooled(map, key_len)) {
+        np_release(map->pool, entry);
+    } else {
+        nanods_mem_free(map->alloc, entry);
+    }
+}
+
+static inline int nm_remove_from_chain(NanoMap* map, NanoMapEntry** indirect, const char* key,
+                                        size_t key_len, uint32_t hash) {
     while (*indirect) {
         NanoMapEntry* entry = *indirect;
-        if (strcmp(entry->key, key) == 0) {
+        if (nm_entry_matches(entry, key, key_len, hash)) {
             *indirect = entry->next;
-            if (secure) {
-                size_t key_len = strlen(entry->key);
-                memset(entry->key, 0, key_len);
-            }
-            NANODS_FREE(entry->key);
-            if (secure) {
-                nanods_secure_free(entry, sizeof(NanoMapEntry));
-            } else {
-                NANODS_FREE(entry);
-            }
+            nm_free_entry(map, entry);
             map->size--;
             return NANODS_OK;
         }
@@ -166,6 +682,33 @@ static inline int nm_remove(NanoMap* map, const char* key) {
     return NANODS_ERR_NOTFOUND;
 }
 
+static inline int nm_remove_h(NanoMap* map, NanoMapKey key) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key.str, NANODS_ERR_NULL);
+    if (map->bucket_count == 0) return NANODS_ERR_NOTFOUND;
+    nm_rehash_step(map, NANODS_MAP_REHASH_STEP);
+    if (map->filter.blocks && !nbf_test_hash(&map->filter, key.hash)) return NANODS_ERR_NOTFOUND;
+    size_t bucket_idx = key.hash % map->bucket_count;
+    if (nm_remove_from_chain(map, &map->buckets[bucket_idx], key.str, key.len, key.hash) ==
+        NANODS_OK) {
+        return NANODS_OK;
+    }
+    if (NANODS_UNLIKELY(map->old_buckets != NULL)) {
+        size_t old_idx = key.hash % map->old_bucket_count;
+        if (old_idx >= map->rehash_idx) {
+            return nm_remove_from_chain(map, &map->old_buckets[old_idx], key.str, key.len,
+                                        key.hash);
+        }
+    }
+    return NANODS_ERR_NOTFOUND;
+}
+
+static inline int nm_remove(NanoMap* map, const char* key) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(key, NANODS_ERR_NULL);
+    return nm_remove_h(map, nm_key(map, key));
+}
+
 static inline size_t nm_size(const NanoMap* map) {
     return map ? map->size : 0;
 }
@@ -174,82 +717,118 @@ static inline int nm_empty(const NanoMap* map) {
     return map ? (map->size == 0) : 1;
 }
 
-static inline void nm_clear(NanoMap* map) {
-    if (!map) return;
-    int secure = (map->flags & NANODS_FLAG_SECURE);
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        NanoMapEntry* entry = map->buckets[i];
+/* keep_pooled: leave pool entries in place because the whole pool is about to go */
+static inline void nm_clear_buckets(NanoMap* map, NanoMapEntry** buckets, size_t bucket_count,
+                                    int keep_pooled) {
+    for (size_t i = 0; i < bucket_count; i++) {
+        NanoMapEntry* entry = buckets[i];
         while (entry) {
             NanoMapEntry* next = entry->next;
-            if (secure) {
-                size_t key_len = strlen(entry->key);
-                memset(entry->key, 0, key_len);
-            }
-            NANODS_FREE(entry->key);
-            if (secure) {
-                nanods_secure_free(entry, sizeof(NanoMapEntry));
-            } else {
-                NANODS_FREE(entry);
+            if (!keep_pooled || !nm_entry_pooled(map, entry->key_len)) {
+                nm_free_entry(map, entry);
             }
             entry = next;
         }
-        map->buckets[i] = NULL;
+        buckets[i] = NULL;
+    }
+}
+
+static inline void nm_clear_tables(NanoMap* map, int keep_pooled) {
+    nm_clear_buckets(map, map->buckets, map->bucket_count, keep_pooled);
+    if (map->old_buckets) {
+        nm_clear_buckets(map, map->old_buckets, map->old_bucket_count, keep_pooled);
+        nanods_mem_free(map->alloc, map->old_buckets);
+        map->old_buckets = NULL;
+        map->old_bucket_count = 0;
+        map->rehash_idx = 0;
     }
     map->size = 0;
 }
 
+static inline void nm_clear(NanoMap* map) {
+    if (!map) return;
+    nm_clear_tables(map, 0);
+    nbf_clear(&map->filter);
+    nm_filter_next_free(map);
+    map->filter_keys = 0;
+}
+
 static inline void nm_free(NanoMap* map) {
     if (!map) return;
-    nm_clear(map);
+    nm_clear_tables(map, map->owns_pool);
+    if (map->owns_pool) {
+        if (map->flags & NANODS_FLAG_SECURE) map->pool->flags |= NANODS_FLAG_SECURE;
+        np_destroy(map->pool);
+        map->pool = NULL;
+        map->owns_pool = 0;
+    }
     if (map->buckets) {
-        NANODS_FREE(map->buckets);
+        nanods_mem_free(map->alloc, map->buckets);
         map->buckets = NULL;
     }
     map->bucket_count = 0;
+    nm_disable_filter(map);
 }
 
 static inline void nm_secure_free(NanoMap* map) {
     if (!map) return;
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        NanoMapEntry* entry = map->buckets[i];
-        while (entry) {
-            NanoMapEntry* next = entry->next;
-            if (entry->key) {
-                size_t key_len = strlen(entry->key);
-                memset(entry->key, 0, key_len);
-                NANODS_FREE(entry->key);
-            }
-            nanods_secure_free(entry, sizeof(NanoMapEntry));
-            entry = next;
-        }
-    }
-    if (map->buckets) {
-        NANODS_FREE(map->buckets);
-        map->buckets = NULL;
-    }
-    map->bucket_count = 0;
-    map->size = 0;
+    uint8_t flags = map->flags;
+    map->flags |= NANODS_FLAG_SECURE;
+    nm_free(map);
+    map->flags = flags;
 }
 
 typedef struct {
     const NanoMap* map;
-    size_t bucket_idx;
     NanoMapEntry* current;
 } NanoMapIterator;
 
+/* First non-empty bucket at or after `from`: old table (unmigrated part), then current */
+static inline NanoMapEntry* nm_entry_scan(const NanoMap* map, int in_old, size_t from) {
+    if (in_old) {
+        for (size_t i = from < map->rehash_idx ? map->rehash_idx : from;
+             i < map->old_bucket_count; i++) {
+            if (map->old_buckets[i]) return map->old_buckets[i];
+        }
+        from = 0;
+    }
+    for (size_t i = from; i < map->bucket_count; i++) {
+        if (map->buckets[i]) return map->buckets[i];
+    }
+    return NULL;
+}
+
+/**
+ * Stateless, read-only walk: unmigrated old buckets first (during a rehash),
+ * then the current table. The successor of a chain's last entry is found
+ * from its cached hash; an old-table slot not yet migrated is told apart
+ * from a new-table one by looking for the entry in its old chain.
+ * Inserting or removing ends the walk.
+ */
+static inline NanoMapEntry* nm_entry_first(const NanoMap* map) {
+    if (!map || map->size == 0) return NULL;
+    return nm_entry_scan(map, map->old_buckets != NULL, 0);
+}
+
+static inline NanoMapEntry* nm_entry_next(const NanoMap* map, const NanoMapEntry* entry) {
+    if (entry->next) return entry->next;
+    if (NANODS_UNLIKELY(map->old_buckets != NULL)) {
+        size_t old_idx = entry->hash % map->old_bucket_count;
+        if (old_idx >= map->rehash_idx) {
+            for (const NanoMapEntry* e = map->old_buckets[old_idx]; e; e = e->next) {
+                if (e == entry) return nm_entry_scan(map, 1, old_idx + 1);
+            }
+        }
+    }
+    return nm_entry_scan(map, 0, entry->hash % map->bucket_count + 1);
+}
+
+/* Same order as nm_entry_first/nm_entry_next; never migrates buckets */
 static inline void nm_iter_init(NanoMapIterator* iter, const NanoMap* map) {
     NANODS_CHECK_NULL_VOID(iter);
     NANODS_CHECK_NULL_VOID(map);
     iter->map = map;
-    iter->bucket_idx = 0;
-    iter->current = NULL;
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        if (map->buckets[i]) {
-            iter->bucket_idx = i;
-            iter->current = map->buckets[i];
-            return;
-        }
-    }
+    iter->current = nm_entry_first(map);
 }
 
 static inline int nm_iter_next(NanoMapIterator* iter, const char** out_key, void** out_value) {
@@ -257,20 +836,33 @@ static inline int nm_iter_next(NanoMapIterator* iter, const char** out_key, void
     if (! iter->current) return NANODS_ERR_EMPTY;
     if (out_key) *out_key = iter->current->key;
     if (out_value) *out_value = iter->current->value;
-    iter->current = iter->current->next;
-    if (! iter->current) {
-        iter->bucket_idx++;
-        while (iter->bucket_idx < iter->map->bucket_count) {
-            if (iter->map->buckets[iter->bucket_idx]) {
-                iter->current = iter->map->buckets[iter->bucket_idx];
-                break;
-            }
-            iter->bucket_idx++;
-        }
-    }
+    iter->current = nm_entry_next(iter->map, iter->current);
     return NANODS_OK;
 }
 
+#ifdef NANODS_STATS
+/**
+ * Current chain lengths, bucketed like NanoStats.chain_hist (0, 1, 2, 3,
+ * 4-7, 8+ entries per bucket), counting unmigrated old buckets too during
+ * a rehash. Where chain_hist shows what lookups paid, this shows what the
+ * table looks like.
+ */
+static inline void nm_chain_histogram(const NanoMap* map, uint64_t hist[NANODS_STATS_CHAIN_BUCKETS]) {
+    for (int i = 0; i < NANODS_STATS_CHAIN_BUCKETS; i++) hist[i] = 0;
+    if (!map || map->bucket_count == 0) return;
+    for (size_t i = 0; i < map->bucket_count; i++) {
+        size_t len = 0;
+        for (const NanoMapEntry* e = map->buckets[i]; e; e = e->next) len++;
+        hist[nanods_stats_chain_bucket(len)]++;
+    }
+    for (size_t i = map->rehash_idx; map->old_buckets && i < map->old_bucket_count; i++) {
+        size_t len = 0;
+        for (const NanoMapEntry* e = map->old_buckets[i]; e; e = e->next) len++;
+        hist[nanods_stats_chain_bucket(len)]++;
+    }
+}
+#endif
+
 /** @} */
 
 #endif /* NANODS_MAP_IMPL_H */
\ No newline at end of file
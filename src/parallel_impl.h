@@ -0,0 +1,338 @@
+/**
+ * @file parallel_impl.h
+ * @brief Parallel NanoVector algorithms on a NanoThreadPool (opt-in: NANODS_ENABLE_THREADS)
+ */
+
+#ifndef NANODS_PARALLEL_IMPL_H
+#define NANODS_PARALLEL_IMPL_H
+
+#ifdef NANODS_HAVE_THREADS
+
+/**
+ * @defgroup NanoParallel Parallel Vector Algorithms
+ * @{
+ *
+ * nv_par_for_each / nv_par_map / nv_par_reduce / nv_par_filter / nv_par_sort
+ * split the vector over a NanoThreadPool; a NULL pool runs them on the
+ * calling thread. Callbacks run concurrently and must be thread-safe.
+ *
+ * - reduce: `op` must be associative. Each part is folded on its own, then
+ *   the part results are folded into `init` in order.
+ * - filter: prefix-sum compaction. Each part counts its matches, a scan of
+ *   the counts gives every part its output offset, then the parts scatter in
+ *   parallel into an exactly sized `out`. The predicate runs twice per
+ *   element, so it must be pure.
+ * - sort: parts are sorted with qsort, then merged pairwise. Every merge round
+ *   is split into equal output pieces by binary search (merge path), so the
+ *   last rounds keep all threads busy. Uses one n-element scratch buffer and
+ *   is not stable.
+ */
+
+#define NANODS_DEFINE_VECTOR_PARALLEL(T)                                       \
+    typedef struct {                                                           \
+        NanoVector_##T* vec;                                                   \
+        void (*func)(T* item, void* ctx);                                      \
+        void* ctx;                                                             \
+    } NanoParEach_##T;                                                         \
+                                                                               \
+    static inline void nv_par_each_body_##T(size_t begin, size_t end, void* arg) { \
+        NanoParEach_##T* job = (NanoParEach_##T*)arg;                          \
+        for (size_t i = begin; i < end; i++) job->func(&job->vec->data[i], job->ctx); \
+    }                                                                          \
+                                                                               \
+    /* Call func(&item, ctx) on every element, in place */                     \
+    static inline int nv_par_for_each_##T(NanoThreadPool* pool, NanoVector_##T* vec, \
+                                           void (*func)(T* item, void* ctx), void* ctx) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(func, NANODS_ERR_NULL);                              \
+        NanoParEach_##T job;                                                   \
+        job.vec = vec;                                                         \
+        job.func = func;                                                       \
+        job.ctx = ctx;                                                         \
+        return ntp_parallel_for(pool, vec->size, 0, nv_par_each_body_##T, &job); \
+    }                                                                          \
+                                                                               \
+    typedef struct {                                                           \
+        const T* src;                                                          \
+        T* dst;                                                                \
+        T (*func)(T);                                                          \
+    } NanoParMap_##T;                                                          \
+                                                                               \
+    static inline void nv_par_map_body_##T(size_t begin, size_t end, void* arg) { \
+        NanoParMap_##T* job = (NanoParMap_##T*)arg;                            \
+        for (size_t i = begin; i < end; i++) job->dst[i] = job->func(job->src[i]); \
+    }                                                                          \
+                                                                               \
+    /* Parallel nv_map: `out` is initialized and sized once */                 \
+    static inline int nv_par_map_##T(NanoThreadPool* pool, const NanoVector_##T* vec, \
+                                      NanoVector_##T* out, T (*func)(T)) {     \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(func, NANODS_ERR_NULL);                              \
+        nv_init_ex_##T(out, vec->flags);                                       \
+        out->alloc = vec->alloc;                                               \
+        int err = nv_reserve_##T(out, vec->size);                              \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        NanoParMap_##T job;                                                    \
+        job.src = vec->data;                                                   \
+        job.dst = out->data;                                                   \
+        job.func = func;                                                       \
+        err = ntp_parallel_for(pool, vec->size, 0, nv_par_map_body_##T, &job); \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) {                               \
+            nv_free_##T(out);                                                  \
+            return err;                                                        \
+        }                                                                      \
+        out->size = vec->size;                                                 \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    typedef struct {                                                           \
+        const T* data;                                                         \
+        size_t n;                                                              \
+        size_t chunks;                                                         \
+        T (*op)(T, T);                                                         \
+        T* partial;                                                            \
+    } NanoParReduce_##T;                                                       \
+                                                                               \
+    static inline void nv_par_reduce_body_##T(size_t begin, size_t end, void* arg) { \
+        NanoParReduce_##T* job = (NanoParReduce_##T*)arg;                      \
+        for (size_t c = begin; c < end; c++) {                                 \
+            size_t lo = ntp_chunk_begin(job->n, job->chunks, c);               \
+            size_t hi = ntp_chunk_begin(job->n, job->chunks, c + 1);           \
+            T acc = job->data[lo];                                             \
+            for (size_t i = lo + 1; i < hi; i++) acc = job->op(acc, job->data[i]); \
+            job->partial[c] = acc;                                             \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* *out = init op v[0] op v[1] ...; `op` must be associative */            \
+    static inline int nv_par_reduce_##T(NanoThreadPool* pool, const NanoVector_##T* vec, \
+                                         T init, T (*op)(T, T), T* out) {      \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(op, NANODS_ERR_NULL);                                \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        *out = init;                                                           \
+        if (vec->size == 0) return NANODS_OK;                                  \
+        NanoParReduce_##T job;                                                 \
+        job.data = vec->data;                                                  \
+        job.n = vec->size;                                                     \
+        job.chunks = ntp_chunk_count(pool, vec->size);                         \
+        job.op = op;                                                           \
+        job.partial = (T*)NANODS_MALLOC(job.chunks * sizeof(T));               \
+        if (NANODS_UNLIKELY(!job.partial)) return NANODS_ERR_NOMEM;            \
+        int err = ntp_parallel_for(pool, job.chunks, 1, nv_par_reduce_body_##T, &job); \
+        if (NANODS_LIKELY(err == NANODS_OK)) {                                 \
+            for (size_t c = 0; c < job.chunks; c++) *out = op(*out, job.partial[c]); \
+        }                                                                      \
+        NANODS_FREE(job.partial);                                              \
+        return err;                                                            \
+    }                                                                          \
+                                                                               \
+    typedef struct {                                                           \
+        const T* src;                                                          \
+        T* dst;                                                                \
+        size_t n;                                                              \
+        size_t chunks;                                                         \
+        int (*predicate)(T);                                                   \
+        size_t* offset;                /* Per part: match count, then output offset */ \
+    } NanoParFilter_##T;                                                       \
+                                                                               \
+    static inline void nv_par_filter_count_##T(size_t begin, size_t end, void* arg) { \
+        NanoParFilter_##T* job = (NanoParFilter_##T*)arg;                      \
+        for (size_t c = begin; c < end; c++) {                                 \
+            size_t hi = ntp_chunk_begin(job->n, job->chunks, c + 1);           \
+            size_t count = 0;                                                  \
+            for (size_t i = ntp_chunk_begin(job->n, job->chunks, c); i < hi; i++) { \
+                count += job->predicate(job->src[i]) != 0;                     \
+            }                                                                  \
+            job->offset[c] = count;                                            \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void nv_par_filter_scatter_##T(size_t begin, size_t end, void* arg) { \
+        NanoParFilter_##T* job = (NanoParFilter_##T*)arg;                      \
+        for (size_t c = begin; c < end; c++) {                                 \
+            size_t hi = ntp_chunk_begin(job->n, job->chunks, c + 1);           \
+            T* dst = job->dst + job->offset[c];                                \
+            for (size_t i = ntp_chunk_begin(job->n, job->chunks, c); i < hi; i++) { \
+                if (job->predicate(job->src[i])) *dst++ = job->src[i];         \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* Parallel nv_filter (order kept); `predicate` must be pure */            \
+    static inline int nv_par_filter_##T(NanoThreadPool* pool, const NanoVector_##T* vec, \
+                                         NanoVector_##T* out, int (*predicate)(T)) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(predicate, NANODS_ERR_NULL);                         \
+        nv_init_ex_##T(out, vec->flags);                                       \
+        out->alloc = vec->alloc;                                               \
+        if (vec->size == 0) return NANODS_OK;                                  \
+        NanoParFilter_##T job;                                                 \
+        job.src = vec->data;                                                   \
+        job.dst = NULL;                                                        \
+        job.n = vec->size;                                                     \
+        job.chunks = ntp_chunk_count(pool, vec->size);                         \
+        job.predicate = predicate;                                             \
+        job.offset = (size_t*)NANODS_MALLOC(job.chunks * sizeof(size_t));      \
+        if (NANODS_UNLIKELY(!job.offset)) return NANODS_ERR_NOMEM;             \
+        int err = ntp_parallel_for(pool, job.chunks, 1, nv_par_filter_count_##T, &job); \
+        size_t total = 0;                                                      \
+        for (size_t c = 0; c < job.chunks && err == NANODS_OK; c++) {          \
+            size_t count = job.offset[c];                                      \
+            job.offset[c] = total;                                             \
+            total += count;                                                    \
+        }                                                                      \
+        if (NANODS_LIKELY(err == NANODS_OK) && total > 0) {                    \
+            err = nv_reserve_##T(out, total);                                  \
+            if (NANODS_LIKELY(err == NANODS_OK)) {                             \
+                job.dst = out->data;                                           \
+                err = ntp_parallel_for(pool, job.chunks, 1, nv_par_filter_scatter_##T, &job); \
+            }                                                                  \
+        }                                                                      \
+        NANODS_FREE(job.offset);                                               \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) {                               \
+            nv_free_##T(out);                                                  \
+            return err;                                                        \
+        }                                                                      \
+        out->size = total;                                                     \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    typedef struct {                                                           \
+        T* src;                                                                \
+        T* dst;                                                                \
+        size_t* bounds;                /* runs + 1 run boundaries in src */    \
+        size_t runs;                                                           \
+        size_t n;                                                              \
+        size_t pieces;                                                         \
+        int (*cmp)(const void*, const void*);                                  \
+    } NanoParSort_##T;                                                         \
+                                                                               \
+    static inline void nv_par_sort_runs_##T(size_t begin, size_t end, void* arg) { \
+        NanoParSort_##T* job = (NanoParSort_##T*)arg;                          \
+        for (size_t r = begin; r < end; r++) {                                 \
+            qsort(job->src + job->bounds[r], job->bounds[r + 1] - job->bounds[r], \
+                  sizeof(T), job->cmp);                                        \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* Elements of a taken from the first k outputs of a stable merge of a and b */ \
+    static inline size_t nv_par_corank_##T(const T* a, size_t na, const T* b, size_t nb, \
+                                            size_t k, int (*cmp)(const void*, const void*)) { \
+        size_t lo = k > nb ? k - nb : 0;                                       \
+        size_t hi = k < na ? k : na;                                           \
+        while (lo < hi) {                                                      \
+            size_t i = lo + (hi - lo) / 2;                                     \
+            size_t j = k - i;                                                  \
+            if (j > 0 && cmp(&b[j - 1], &a[i]) >= 0) {                         \
+                lo = i + 1;                                                    \
+            } else {                                                           \
+                hi = i;                                                        \
+            }                                                                  \
+        }                                                                      \
+        return lo;                                                             \
+    }                                                                          \
+                                                                               \
+    static inline void nv_par_merge_body_##T(size_t begin, size_t end, void* arg) { \
+        NanoParSort_##T* job = (NanoParSort_##T*)arg;                          \
+        for (size_t p = begin; p < end; p++) {                                 \
+            size_t out_lo = ntp_chunk_begin(job->n, job->pieces, p);           \
+            size_t out_hi = ntp_chunk_begin(job->n, job->pieces, p + 1);       \
+            /* The piece may cover the tail of one merged pair and the head of the next */ \
+            for (size_t r = 0; r < job->runs; r += 2) {                        \
+                size_t lo = job->bounds[r];                                    \
+                size_t mid = job->bounds[r + 1];                               \
+                size_t hi = r + 2 <= job->runs ? job->bounds[r + 2] : mid;     \
+                if (hi <= out_lo) continue;                                    \
+                if (lo >= out_hi) break;                                       \
+                const T* a = job->src + lo;                                    \
+                const T* b = job->src + mid;                                   \
+                size_t na = mid - lo, nb = hi - mid;                           \
+                size_t k0 = (out_lo > lo ? out_lo : lo) - lo;                  \
+                size_t k1 = (out_hi < hi ? out_hi : hi) - lo;                  \
+                size_t i = nv_par_corank_##T(a, na, b, nb, k0, job->cmp);      \
+                size_t i_end = nv_par_corank_##T(a, na, b, nb, k1, job->cmp);  \
+                size_t j = k0 - i, j_end = k1 - i_end;                         \
+                T* dst = job->dst + lo + k0;                                   \
+                while (i < i_end && j < j_end) {                               \
+                    if (job->cmp(&b[j], &a[i]) < 0) {                          \
+                        *dst++ = b[j++];                                       \
+                    } else {                                                   \
+                        *dst++ = a[i++];                                       \
+                    }                                                          \
+                }                                                              \
+                while (i < i_end) *dst++ = a[i++];                             \
+                while (j < j_end) *dst++ = b[j++];                             \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void nv_par_copy_body_##T(size_t begin, size_t end, void* arg) { \
+        NanoParSort_##T* job = (NanoParSort_##T*)arg;                          \
+        memcpy(job->dst + begin, job->src + begin, (end - begin) * sizeof(T)); \
+    }                                                                          \
+                                                                               \
+    /* Sort in place with a qsort comparator; not stable */                    \
+    static inline int nv_par_sort_##T(NanoThreadPool* pool, NanoVector_##T* vec, \
+                                       int (*cmp)(const void*, const void*)) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(cmp, NANODS_ERR_NULL);                               \
+        size_t n = vec->size;                                                  \
+        if (n < 2) return NANODS_OK;                                           \
+        NanoParSort_##T job;                                                   \
+        job.n = n;                                                             \
+        job.cmp = cmp;                                                         \
+        job.runs = ntp_chunk_count(pool, n);                                   \
+        job.pieces = job.runs;                                                 \
+        if (job.runs == 1) {                                                   \
+            qsort(vec->data, n, sizeof(T), cmp);                               \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        job.bounds = (size_t*)NANODS_MALLOC((job.runs + 1) * sizeof(size_t));  \
+        T* scratch = (T*)nanods_mem_alloc(vec->alloc, n * sizeof(T));          \
+        if (NANODS_UNLIKELY(!job.bounds || !scratch)) {                        \
+            NANODS_FREE(job.bounds);                                           \
+            nanods_mem_free(vec->alloc, scratch);                              \
+            return NANODS_ERR_NOMEM;                                           \
+        }                                                                      \
+        for (size_t r = 0; r <= job.runs; r++) job.bounds[r] = ntp_chunk_begin(n, job.runs, r); \
+        job.src = vec->data;                                                   \
+        int err = ntp_parallel_for(pool, job.runs, 1, nv_par_sort_runs_##T, &job); \
+        job.dst = scratch;                                                     \
+        while (err == NANODS_OK && job.runs > 1) {                             \
+            err = ntp_parallel_for(pool, job.pieces, 1, nv_par_merge_body_##T, &job); \
+            if (NANODS_UNLIKELY(err != NANODS_OK)) break;                      \
+            size_t merged = (job.runs + 1) / 2;                                \
+            for (size_t r = 0; r < merged; r++) job.bounds[r] = job.bounds[2 * r]; \
+            job.bounds[merged] = n;                                            \
+            job.runs = merged;                                                 \
+            T* tmp = job.src;                                                  \
+            job.src = job.dst;                                                 \
+            job.dst = tmp;                                                     \
+        }                                                                      \
+        if (job.src != vec->data) {                                            \
+            /* Result (or, after an error, the last complete round) is in scratch */ \
+            job.dst = vec->data;                                               \
+            if (ntp_parallel_for(pool, n, 0, nv_par_copy_body_##T, &job) != NANODS_OK) \
+                memcpy(vec->data, job.src, n * sizeof(T));                     \
+        }                                                                      \
+        NANODS_FREE(job.bounds);                                               \
+        if (vec->flags & NANODS_FLAG_SECURE) {                                 \
+            nanods_mem_secure_free(vec->alloc, scratch, n * sizeof(T));        \
+        } else {                                                               \
+            nanods_mem_free(vec->alloc, scratch);                              \
+        }                                                                      \
+        return err;                                                            \
+    }
+
+NANODS_DEFINE_VECTOR_PARALLEL(int)
+NANODS_DEFINE_VECTOR_PARALLEL(float)
+NANODS_DEFINE_VECTOR_PARALLEL(double)
+
+/** @} */
+
+#endif /* NANODS_HAVE_THREADS */
+
+#endif /* NANODS_PARALLEL_IMPL_H */
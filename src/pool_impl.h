@@ -0,0 +1,170 @@
+/**
+ * @file pool_impl.h
+ * @brief Fixed-size node pool (slab + free list) for linked containers
+ */
+
+#ifndef NANODS_POOL_IMPL_H
+#define NANODS_POOL_IMPL_H
+
+/**
+ * @defgroup NanoPool Node Pool Allocator
+ * @{
+ *
+ * Hands out fixed-size nodes carved from large chunks. Released nodes go on
+ * an intrusive free list and are reused first; the chunks themselves are only
+ * returned by np_free, all at once. A pool may back one container or be
+ * shared by several whose nodes fit in node_size.
+ */
+
+/* Nodes per chunk when 0 is passed to np_init */
+#ifndef NANODS_POOL_DEFAULT_CHUNK
+    #define NANODS_POOL_DEFAULT_CHUNK 64
+#endif
+
+/* Chunk header, padded so the first node keeps malloc's alignment */
+typedef union NanoPoolChunk {
+    union NanoPoolChunk* next;
+    long double align_ld;
+    uint64_t align_u64;
+} NanoPoolChunk;
+
+typedef struct {
+    void* free_list;          /* Released nodes, linked through their first word */
+    NanoPoolChunk* chunks;    /* Every chunk, newest first */
+    uint8_t* bump;            /* Untouched space in the newest chunk */
+    uint8_t* bump_end;
+    size_t node_size;         /* Rounded up to a multiple of sizeof(void*) */
+    size_t nodes_per_chunk;
+    size_t live;              /* Nodes currently handed out */
+    const NanoCtxAllocator* alloc;  /* Chunk allocator, NULL: global */
+    uint8_t flags;
+} NanoPool;
+
+static inline int np_init(NanoPool* pool, size_t node_size, size_t nodes_per_chunk) {
+    NANODS_CHECK_NULL(pool, NANODS_ERR_NULL);
+    if (node_size < sizeof(void*)) node_size = sizeof(void*);
+    if (NANODS_UNLIKELY(node_size > SIZE_MAX - sizeof(void*))) return NANODS_ERR_OVERFLOW;
+    node_size = (node_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    if (nodes_per_chunk == 0) nodes_per_chunk = NANODS_POOL_DEFAULT_CHUNK;
+    size_t chunk_bytes;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(node_size, nodes_per_chunk, &chunk_bytes) ||
+                        nanods_check_add_overflow(chunk_bytes, sizeof(NanoPoolChunk), &chunk_bytes)))
+        return NANODS_ERR_OVERFLOW;
+    pool->free_list = NULL;
+    pool->chunks = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->node_size = node_size;
+    pool->nodes_per_chunk = nodes_per_chunk;
+    pool->live = 0;
+    pool->alloc = NULL;
+    pool->flags = NANODS_FLAG_NONE;
+    return NANODS_OK;
+}
+
+static inline int np_init_ex(NanoPool* pool, size_t node_size, size_t nodes_per_chunk, uint8_t flags) {
+    int err = np_init(pool, node_size, nodes_per_chunk);
+    if (NANODS_LIKELY(err == NANODS_OK)) {
+        pool->flags = flags;
+    }
+    return err;
+}
+
+/* Carve chunks from `alloc` (with its ctx) instead of the global allocator */
+static inline int np_init_alloc(NanoPool* pool, size_t node_size, size_t nodes_per_chunk,
+                                uint8_t flags, const NanoCtxAllocator* alloc) {
+    int err = np_init_ex(pool, node_size, nodes_per_chunk, flags);
+    if (NANODS_LIKELY(err == NANODS_OK)) {
+        pool->alloc = alloc;
+    }
+    return err;
+}
+
+static inline size_t np_chunk_bytes(const NanoPool* pool) {
+    return sizeof(NanoPoolChunk) + pool->node_size * pool->nodes_per_chunk;
+}
+
+/**
+ * O(1): pops the free list, else bumps through the newest chunk.
+ * Returns NULL when a new chunk cannot be allocated.
+ */
+static inline void* np_alloc(NanoPool* pool) {
+    NANODS_CHECK_NULL(pool, NULL);
+    void* node = pool->free_list;
+    if (node) {
+        pool->free_list = *(void**)node;
+        pool->live++;
+        return node;
+    }
+    if (NANODS_UNLIKELY(pool->bump == pool->bump_end)) {
+        NanoPoolChunk* chunk = (NanoPoolChunk*)nanods_mem_alloc(pool->alloc, np_chunk_bytes(pool));
+        if (NANODS_UNLIKELY(!chunk)) return NULL;
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->bump = (uint8_t*)(chunk + 1);
+        pool->bump_end = pool->bump + pool->node_size * pool->nodes_per_chunk;
+    }
+    node = pool->bump;
+    pool->bump += pool->node_size;
+    pool->live++;
+    return node;
+}
+
+/**
+ * O(1): pushes `node` on the free list. It must come from this pool.
+ */
+static inline void np_release(NanoPool* pool, void* node) {
+    NANODS_CHECK_NULL_VOID(pool);
+    if (!node) return;
+    if (pool->flags & NANODS_FLAG_SECURE) {
+        memset(node, 0, pool->node_size);
+    }
+    *(void**)node = pool->free_list;
+    pool->free_list = node;
+    pool->live--;
+}
+
+/**
+ * Returns every chunk at once; all nodes from the pool become invalid.
+ */
+static inline void np_free(NanoPool* pool) {
+    if (!pool) return;
+    NanoPoolChunk* chunk = pool->chunks;
+    while (chunk) {
+        NanoPoolChunk* next = chunk->next;
+        if (pool->flags & NANODS_FLAG_SECURE) {
+            nanods_mem_secure_free(pool->alloc, chunk, np_chunk_bytes(pool));
+        } else {
+            nanods_mem_free(pool->alloc, chunk);
+        }
+        chunk = next;
+    }
+    pool->free_list = NULL;
+    pool->chunks = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->live = 0;
+}
+
+/**
+ * Heap-allocate a pool for a container that owns it (nl_init_pooled etc.)
+ */
+static inline NanoPool* np_create(size_t node_size, size_t nodes_per_chunk, uint8_t flags) {
+    NanoPool* pool = (NanoPool*)NANODS_MALLOC(sizeof(NanoPool));
+    if (NANODS_UNLIKELY(!pool)) return NULL;
+    if (NANODS_UNLIKELY(np_init_ex(pool, node_size, nodes_per_chunk, flags) != NANODS_OK)) {
+        NANODS_FREE(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+static inline void np_destroy(NanoPool* pool) {
+    if (!pool) return;
+    np_free(pool);
+    NANODS_FREE(pool);
+}
+
+/** @} */
+
+#endif /* NANODS_POOL_IMPL_H */
@@ -0,0 +1,170 @@
+/**
+ * @file queue_impl.h
+ * @brief Bounded lock-free multi-producer/multi-consumer queue
+ */
+
+#ifndef NANODS_QUEUE_IMPL_H
+#define NANODS_QUEUE_IMPL_H
+
+#ifdef NANODS_HAVE_ATOMICS
+
+/**
+ * @defgroup NanoQueue Bounded MPMC Queue
+ * @{
+ *
+ * Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence number
+ * that tells a thread whether the cell is ready for the lap it is on.
+ * Producers claim a position with one CAS on enqueue_pos, write the element,
+ * then release the cell with seq = pos + 1; consumers claim with a CAS on
+ * dequeue_pos and hand the cell back to the next lap with seq = pos + SIZE.
+ * Elements are stored inline. SIZE must be a power of two.
+ *
+ * NANODS_ERR_FULL / NANODS_ERR_EMPTY are returned in every build mode.
+ */
+
+#define NANODS_DEFINE_QUEUE(T, SIZE)                                           \
+    typedef char NanoQueue_##T##_##SIZE##_size_must_be_power_of_two[           \
+        ((SIZE) >= 2 && ((SIZE) & ((SIZE) - 1)) == 0) ? 1 : -1];               \
+                                                                               \
+    typedef struct {                                                           \
+        NANODS_ATOMIC(size_t) seq;                                             \
+        T data;                                                                \
+    } NanoQueueCell_##T##_##SIZE;                                              \
+                                                                               \
+    typedef struct {                                                           \
+        uint8_t flags;                 /* Read-only after init */              \
+        char pad_flags[NANODS_CACHE_LINE - 1];                                 \
+        NANODS_ATOMIC(size_t) enqueue_pos;                                     \
+        char pad_enqueue[NANODS_CACHE_LINE - sizeof(size_t)];                  \
+        NANODS_ATOMIC(size_t) dequeue_pos;                                     \
+        char pad_dequeue[NANODS_CACHE_LINE - sizeof(size_t)];                  \
+        NanoQueueCell_##T##_##SIZE cells[SIZE];                                \
+    } NanoQueue_##T##_##SIZE;                                                  \
+                                                                               \
+    /* Not thread-safe: call before any thread uses the queue */               \
+    static inline void nq_init_##T##_##SIZE(NanoQueue_##T##_##SIZE* queue) {   \
+        NANODS_CHECK_NULL_VOID(queue);                                         \
+        for (size_t i = 0; i < (SIZE); i++) {                                  \
+            NANODS_ATOMIC_STORE(&queue->cells[i].seq, i, NANODS_MO_RELAXED);   \
+        }                                                                      \
+        NANODS_ATOMIC_STORE(&queue->enqueue_pos, (size_t)0, NANODS_MO_RELAXED); \
+        NANODS_ATOMIC_STORE(&queue->dequeue_pos, (size_t)0, NANODS_MO_RELAXED); \
+        queue->flags = NANODS_FLAG_NONE;                                       \
+    }                                                                          \
+                                                                               \
+    static inline void nq_init_ex_##T##_##SIZE(NanoQueue_##T##_##SIZE* queue,  \
+                                                 uint8_t flags) {              \
+        NANODS_CHECK_NULL_VOID(queue);                                         \
+        nq_init_##T##_##SIZE(queue);                                           \
+        queue->flags = flags;                                                  \
+    }                                                                          \
+                                                                               \
+    static inline int nq_try_push_##T##_##SIZE(NanoQueue_##T##_##SIZE* queue,  \
+                                                 T value) {                    \
+        NANODS_CHECK_NULL(queue, NANODS_ERR_NULL);                             \
+        NanoQueueCell_##T##_##SIZE* cell;                                      \
+        size_t pos = NANODS_ATOMIC_LOAD(&queue->enqueue_pos, NANODS_MO_RELAXED); \
+        for (;;) {                                                             \
+            cell = &queue->cells[pos & ((SIZE) - 1)];                          \
+            size_t seq = NANODS_ATOMIC_LOAD(&cell->seq, NANODS_MO_ACQUIRE);    \
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;                      \
+            if (dif == 0) {                                                    \
+                if (NANODS_ATOMIC_CAS_WEAK(&queue->enqueue_pos, &pos, pos + 1, \
+                                           NANODS_MO_RELAXED, NANODS_MO_RELAXED)) break; \
+            } else if (dif < 0) {                                              \
+                return NANODS_ERR_FULL;    /* Cell still holds last lap's element */ \
+            } else {                                                           \
+                pos = NANODS_ATOMIC_LOAD(&queue->enqueue_pos, NANODS_MO_RELAXED); \
+            }                                                                  \
+        }                                                                      \
+        cell->data = value;                                                    \
+        NANODS_ATOMIC_STORE(&cell->seq, pos + 1, NANODS_MO_RELEASE);           \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nq_try_pop_##T##_##SIZE(NanoQueue_##T##_##SIZE* queue,   \
+                                                T* out) {                      \
+        NANODS_CHECK_NULL(queue, NANODS_ERR_NULL);                             \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NanoQueueCell_##T##_##SIZE* cell;                                      \
+        size_t pos = NANODS_ATOMIC_LOAD(&queue->dequeue_pos, NANODS_MO_RELAXED); \
+        for (;;) {                                                             \
+            cell = &queue->cells[pos & ((SIZE) - 1)];                          \
+            size_t seq = NANODS_ATOMIC_LOAD(&cell->seq, NANODS_MO_ACQUIRE);    \
+            intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);                \
+            if (dif == 0) {                                                    \
+                if (NANODS_ATOMIC_CAS_WEAK(&queue->dequeue_pos, &pos, pos + 1, \
+                                           NANODS_MO_RELAXED, NANODS_MO_RELAXED)) break; \
+            } else if (dif < 0) {                                              \
+                return NANODS_ERR_EMPTY;   /* Producer has not filled this lap yet */ \
+            } else {                                                           \
+                pos = NANODS_ATOMIC_LOAD(&queue->dequeue_pos, NANODS_MO_RELAXED); \
+            }                                                                  \
+        }                                                                      \
+        *out = cell->data;                                                     \
+        if (queue->flags & NANODS_FLAG_SECURE) memset(&cell->data, 0, sizeof(T)); \
+        NANODS_ATOMIC_STORE(&cell->seq, pos + (SIZE), NANODS_MO_RELEASE);      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /**                                                                        \
+     * Pop up to `max` elements with a single CAS: the run of ready cells at   \
+     * dequeue_pos is claimed at once. Returns the count (0 when empty).       \
+     */                                                                        \
+    static inline size_t nq_try_pop_n_##T##_##SIZE(NanoQueue_##T##_##SIZE* queue, \
+                                                     T* out, size_t max) {     \
+        if (NANODS_UNLIKELY(!queue || !out)) return 0;                         \
+        if (max > (SIZE)) max = (SIZE);                                        \
+        size_t pos = NANODS_ATOMIC_LOAD(&queue->dequeue_pos, NANODS_MO_RELAXED); \
+        size_t n;                                                              \
+        for (;;) {                                                             \
+            n = 0;                                                             \
+            while (n < max) {                                                  \
+                size_t seq = NANODS_ATOMIC_LOAD(&queue->cells[(pos + n) & ((SIZE) - 1)].seq, \
+                                                NANODS_MO_ACQUIRE);            \
+                if (seq != pos + n + 1) break;                                 \
+                n++;                                                           \
+            }                                                                  \
+            if (n == 0) {                                                      \
+                /* Empty unless another consumer moved dequeue_pos meanwhile */ \
+                size_t now = NANODS_ATOMIC_LOAD(&queue->dequeue_pos, NANODS_MO_RELAXED); \
+                if (now == pos) return 0;                                      \
+                pos = now;                                                     \
+                continue;                                                      \
+            }                                                                  \
+            if (NANODS_ATOMIC_CAS_WEAK(&queue->dequeue_pos, &pos, pos + n,     \
+                                       NANODS_MO_RELAXED, NANODS_MO_RELAXED)) break; \
+        }                                                                      \
+        for (size_t i = 0; i < n; i++) {                                       \
+            NanoQueueCell_##T##_##SIZE* cell = &queue->cells[(pos + i) & ((SIZE) - 1)]; \
+            out[i] = cell->data;                                               \
+            if (queue->flags & NANODS_FLAG_SECURE) memset(&cell->data, 0, sizeof(T)); \
+            NANODS_ATOMIC_STORE(&cell->seq, pos + i + (SIZE), NANODS_MO_RELEASE); \
+        }                                                                      \
+        return n;                                                              \
+    }                                                                          \
+                                                                               \
+    /* Snapshot; exact only while no other thread is pushing or popping */     \
+    static inline size_t nq_size_##T##_##SIZE(NanoQueue_##T##_##SIZE* queue) { \
+        if (!queue) return 0;                                                  \
+        size_t head = NANODS_ATOMIC_LOAD(&queue->dequeue_pos, NANODS_MO_ACQUIRE); \
+        size_t tail = NANODS_ATOMIC_LOAD(&queue->enqueue_pos, NANODS_MO_ACQUIRE); \
+        return tail > head ? tail - head : 0;                                  \
+    }                                                                          \
+                                                                               \
+    static inline size_t nq_capacity_##T##_##SIZE(const NanoQueue_##T##_##SIZE* queue) { \
+        return queue ? (size_t)(SIZE) : 0;                                     \
+    }
+
+/* Pre-defined queues */
+NANODS_DEFINE_QUEUE(int, 256)
+NANODS_DEFINE_QUEUE(int, 1024)
+
+typedef NanoQueue_int_256 IntQueue256;
+typedef NanoQueue_int_1024 IntQueue1024;
+
+/** @} */
+
+#endif /* NANODS_HAVE_ATOMICS */
+
+#endif /* NANODS_QUEUE_IMPL_H */
@@ -9,8 +9,19 @@
 /**
  * @defgroup NanoRing Circular Buffer (Ring Buffer)
  * @{
+ *
+ * Index arithmetic uses the compile-time SIZE: a power of two wraps with a
+ * mask, any other size with a compare instead of a runtime division.
  */
 
+#define NANODS_RING_IS_POW2(SIZE) (((SIZE) & ((SIZE) - 1)) == 0)
+
+/* Wrap an index in [0, 2 * SIZE) back into [0, SIZE) */
+#define NANODS_RING_WRAP(i, SIZE) \
+    (NANODS_RING_IS_POW2(SIZE) ? ((i) & ((SIZE) - 1)) : ((i) >= (SIZE) ? (i) - (SIZE) : (i)))
+
+#define NANODS_RING_NEXT(i, SIZE) NANODS_RING_WRAP((i) + 1, SIZE)
+
 #define NANODS_DEFINE_RING(T, SIZE)                                            \
     typedef struct {                                                           \
         T data[SIZE];                                                          \
@@ -19,8 +30,15 @@
         size_t count;                                                          \
         size_t capacity;                                                       \
         uint8_t flags;                                                         \
+        NANODS_STATS_MEMBER                                                    \
     } NanoRing_##T##_##SIZE;                                                   \
                                                                                \
+    /* Up to two contiguous runs of slots, split where the ring wraps */       \
+    typedef struct {                                                           \
+        T* ptr[2];                                                             \
+        size_t len[2];                                                         \
+    } NanoRingSpan_##T##_##SIZE;                                               \
+                                                                               \
     static inline void nr_init_##T##_##SIZE(NanoRing_##T##_##SIZE* ring) {    \
         NANODS_CHECK_NULL_VOID(ring);                                          \
         ring->head = 0;                                                        \
@@ -28,6 +46,7 @@
         ring->count = 0;                                                       \
         ring->capacity = SIZE;                                                 \
         ring->flags = NANODS_FLAG_NONE;                                        \
+        NANODS_STAT_INIT(ring);                                                \
     }                                                                          \
                                                                                \
     static inline void nr_init_ex_##T##_##SIZE(NanoRing_##T##_##SIZE* ring,   \
@@ -38,26 +57,45 @@
         ring->count = 0;                                                       \
         ring->capacity = SIZE;                                                 \
         ring->flags = flags;                                                   \
+        NANODS_STAT_INIT(ring);                                                \
     }                                                                          \
                                                                                \
     static inline int nr_write_##T##_##SIZE(NanoRing_##T##_##SIZE* ring,      \
                                               T value) {                       \
         NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
-        NANODS_CHECK_FULL(ring->count, ring->capacity, NANODS_ERR_FULL);      \
+        if (ring->count == (SIZE) && (ring->flags & NANODS_FLAG_OVERWRITE)) {  \
+            ring->head = NANODS_RING_NEXT(ring->head, SIZE);  /* Drop the oldest */ \
+            ring->count--;                                                     \
+        }                                                                      \
+        NANODS_STAT_ONLY(if (ring->count == (SIZE)) NANODS_STAT_ADD(ring, rejected_full, 1);) \
+        NANODS_CHECK_FULL(ring->count, (SIZE), NANODS_ERR_FULL);               \
         ring->data[ring->tail] = value;                                        \
-        ring->tail = (ring->tail + 1) % ring->capacity;                        \
+        ring->tail = NANODS_RING_NEXT(ring->tail, SIZE);                       \
         ring->count++;                                                         \
+        NANODS_STAT_PEAK(ring, ring->count);                                   \
         return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
+    /* Drop the n oldest elements; NANODS_FLAG_SECURE wipes their slots */     \
+    static inline void nr_consume_##T##_##SIZE(NanoRing_##T##_##SIZE* ring, size_t n) {\
+        if (ring->flags & NANODS_FLAG_SECURE) {                                \
+            size_t first = (SIZE) - ring->head;                                \
+            if (first > n) first = n;                                          \
+            memset(&ring->data[ring->head], 0, first * sizeof(T));             \
+            memset(&ring->data[0], 0, (n - first) * sizeof(T));                \
+        }                                                                      \
+        ring->head = NANODS_RING_WRAP(ring->head + n, SIZE);                   \
+        ring->count -= n;                                                      \
+    }                                                                          \
+                                                                               \
     static inline int nr_read_##T##_##SIZE(NanoRing_##T##_##SIZE* ring,       \
                                              T* out) {                         \
         NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
         NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
-        NANODS_CHECK_EMPTY(ring->count, NANODS_ERR_EMPTY);                    \
+        NANODS_STAT_ONLY(if (ring->count == 0) NANODS_STAT_ADD(ring, rejected_empty, 1);) \
+        NANODS_CHECK_EMPTY_OUT(ring->count, out, NANODS_ERR_EMPTY);            \
         *out = ring->data[ring->head];                                         \
-        ring->head = (ring->head + 1) % ring->capacity;                        \
-        ring->count--;                                                         \
+        nr_consume_##T##_##SIZE(ring, 1);                                      \
         return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
@@ -65,11 +103,113 @@
                                              T* out) {                         \
         NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
         NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
-        NANODS_CHECK_EMPTY(ring->count, NANODS_ERR_EMPTY);                    \
+        NANODS_CHECK_EMPTY_OUT(ring->count, out, NANODS_ERR_EMPTY);            \
         *out = ring->data[ring->head];                                         \
         return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
+    /**                                                                        \
+     * Copy up to n elements in with at most two memcpy calls; returns how many \
+     * fit. With NANODS_FLAG_OVERWRITE all n are taken and the oldest dropped. \
+     */                                                                        \
+    static inline size_t nr_write_n_##T##_##SIZE(NanoRing_##T##_##SIZE* ring,  \
+                                                   const T* src, size_t n) {   \
+        if (NANODS_UNLIKELY(!ring || !src)) return 0;                          \
+        size_t accepted = n;                                                   \
+        size_t space = (SIZE) - ring->count;                                   \
+        if (n > space) {                                                       \
+            if (ring->flags & NANODS_FLAG_OVERWRITE) {                         \
+                if (n > (SIZE)) {                                              \
+                    src += n - (SIZE);  /* Only the newest SIZE survive */     \
+                    n = (SIZE);                                                \
+                }                                                              \
+                size_t drop = n - space;                                       \
+                ring->head = NANODS_RING_WRAP(ring->head + drop, SIZE);        \
+                ring->count -= drop;                                           \
+            } else {                                                           \
+                NANODS_STAT_ADD(ring, rejected_full, n - space);               \
+                n = space;                                                     \
+                accepted = n;                                                  \
+            }                                                                  \
+        }                                                                      \
+        size_t first = (SIZE) - ring->tail;                                    \
+        if (first > n) first = n;                                              \
+        memcpy(&ring->data[ring->tail], src, first * sizeof(T));               \
+        memcpy(&ring->data[0], src + first, (n - first) * sizeof(T));          \
+        ring->tail = NANODS_RING_WRAP(ring->tail + n, SIZE);                   \
+        ring->count += n;                                                      \
+        NANODS_STAT_PEAK(ring, ring->count);                                   \
+        return accepted;                                                       \
+    }                                                                          \
+                                                                               \
+    /* Copy up to n oldest elements out without consuming them */              \
+    static inline size_t nr_peek_n_##T##_##SIZE(const NanoRing_##T##_##SIZE* ring, \
+                                                  T* dst, size_t n) {          \
+        if (NANODS_UNLIKELY(!ring || !dst)) return 0;                          \
+        if (n > ring->count) n = ring->count;                                  \
+        size_t first = (SIZE) - ring->head;                                    \
+        if (first > n) first = n;                                              \
+        memcpy(dst, &ring->data[ring->head], first * sizeof(T));               \
+        memcpy(dst + first, &ring->data[0], (n - first) * sizeof(T));          \
+        return n;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline size_t nr_read_n_##T##_##SIZE(NanoRing_##T##_##SIZE* ring,   \
+                                                  T* dst, size_t n) {          \
+        NANODS_STAT_ONLY(if (ring && n > 0 && ring->count == 0) NANODS_STAT_ADD(ring, rejected_empty, 1);) \
+        n = nr_peek_n_##T##_##SIZE(ring, dst, n);                              \
+        if (n == 0) return 0;                                                  \
+        nr_consume_##T##_##SIZE(ring, n);                                      \
+        return n;                                                              \
+    }                                                                          \
+                                                                               \
+    /**                                                                        \
+     * Zero-copy write: describe the free slots (two spans when they wrap),    \
+     * fill them in place, then publish with nr_write_commit. Returns the      \
+     * total free count. Never overwrites, whatever the flags.                 \
+     */                                                                        \
+    static inline size_t nr_write_reserve_##T##_##SIZE(NanoRing_##T##_##SIZE* ring, \
+                                                         NanoRingSpan_##T##_##SIZE* span) { \
+        if (NANODS_UNLIKELY(!ring || !span)) return 0;                         \
+        size_t space = (SIZE) - ring->count;                                   \
+        size_t first = (SIZE) - ring->tail;                                    \
+        if (first > space) first = space;                                      \
+        span->ptr[0] = &ring->data[ring->tail];                                \
+        span->len[0] = first;                                                  \
+        span->ptr[1] = &ring->data[0];                                         \
+        span->len[1] = space - first;                                          \
+        return space;                                                          \
+    }                                                                          \
+                                                                               \
+    static inline int nr_write_commit_##T##_##SIZE(NanoRing_##T##_##SIZE* ring, size_t n) { \
+        NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
+        if (NANODS_UNLIKELY(n > (SIZE) - ring->count)) return NANODS_ERR_BOUNDS; \
+        ring->tail = NANODS_RING_WRAP(ring->tail + n, SIZE);                   \
+        ring->count += n;                                                      \
+        NANODS_STAT_PEAK(ring, ring->count);                                   \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Zero-copy read: the oldest elements in place; release with nr_read_commit */ \
+    static inline size_t nr_read_reserve_##T##_##SIZE(NanoRing_##T##_##SIZE* ring, \
+                                                        NanoRingSpan_##T##_##SIZE* span) { \
+        if (NANODS_UNLIKELY(!ring || !span)) return 0;                         \
+        size_t first = (SIZE) - ring->head;                                    \
+        if (first > ring->count) first = ring->count;                          \
+        span->ptr[0] = &ring->data[ring->head];                                \
+        span->len[0] = first;                                                  \
+        span->ptr[1] = &ring->data[0];                                         \
+        span->len[1] = ring->count - first;                                    \
+        return ring->count;                                                    \
+    }                                                                          \
+                                                                               \
+    static inline int nr_read_commit_##T##_##SIZE(NanoRing_##T##_##SIZE* ring, size_t n) { \
+        NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
+        if (NANODS_UNLIKELY(n > ring->count)) return NANODS_ERR_BOUNDS;        \
+        nr_consume_##T##_##SIZE(ring, n);                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
     static inline int nr_is_full_##T##_##SIZE(const NanoRing_##T##_##SIZE* ring) { \
         return ring ?  (ring->count == ring->capacity) : 1;                     \
     }                                                                          \
@@ -97,6 +237,12 @@
         }                                                                      \
     }
 
+/* Same ring, rejected at compile time unless SIZE is a power of two */
+#define NANODS_DEFINE_RING_POW2(T, SIZE)                                       \
+    typedef char NanoRing_##T##_##SIZE##_size_must_be_power_of_two[           \
+        ((SIZE) >= 1 && NANODS_RING_IS_POW2(SIZE)) ? 1 : -1];                  \
+    NANODS_DEFINE_RING(T, SIZE)
+
 /* Pre-defined ring buffers */
 NANODS_DEFINE_RING(int, 16)
 NANODS_DEFINE_RING(int, 32)
@@ -0,0 +1,490 @@
+/**
+ * @file simd_impl.h
+ * @brief Vectorized sum/min/max/dot/count/find for the int, float and double vectors
+ */
+
+#ifndef NANODS_SIMD_IMPL_H
+#define NANODS_SIMD_IMPL_H
+
+/**
+ * @defgroup NanoSimd Vector Kernels
+ * @{
+ *
+ * The widest instruction set the compiler targets is chosen at compile time:
+ * AVX-512F, AVX2, SSE2 or NEON, else portable scalar code (NANODS_NO_SIMD
+ * forces that). Build with -mavx2 or -march=native for the wider x86 paths.
+ * Each kernel is written once against a small per-ISA operation table:
+ * NANODS_SIMD_F_* (float), NANODS_SIMD_D_* (double), NANODS_SIMD_I_* (int).
+ *
+ * Sums, dot products, min and max run four independent vector accumulators.
+ * A floating-point sum is therefore not added left to right and may differ
+ * from a serial loop in the last bits. With NaN elements min/max return an
+ * unspecified element. int sums and dot products accumulate in 64 bits.
+ */
+
+static inline int nanods_popcount32(uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_popcount(mask);
+#else
+    int n = 0;
+    while (mask) { mask &= mask - 1; n++; }
+    return n;
+#endif
+}
+
+static inline int nanods_ctz32(uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int n = 0;
+    while (!(mask & 1u)) { mask >>= 1; n++; }
+    return n;
+#endif
+}
+
+#if defined(NANODS_HAVE_AVX512)
+    #define NANODS_SIMD_F_T __m512
+    #define NANODS_SIMD_F_W 16
+    #define NANODS_SIMD_F_LOAD(p) _mm512_loadu_ps(p)
+    #define NANODS_SIMD_F_STORE(p, v) _mm512_storeu_ps(p, v)
+    #define NANODS_SIMD_F_SET1(x) _mm512_set1_ps(x)
+    #define NANODS_SIMD_F_ADD(a, b) _mm512_add_ps(a, b)
+    #define NANODS_SIMD_F_MUL(a, b) _mm512_mul_ps(a, b)
+    #define NANODS_SIMD_F_MIN(a, b) _mm512_min_ps(a, b)
+    #define NANODS_SIMD_F_MAX(a, b) _mm512_max_ps(a, b)
+    #define NANODS_SIMD_F_EQ(a, b) ((uint32_t)_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ))
+
+    #define NANODS_SIMD_D_T __m512d
+    #define NANODS_SIMD_D_W 8
+    #define NANODS_SIMD_D_LOAD(p) _mm512_loadu_pd(p)
+    #define NANODS_SIMD_D_STORE(p, v) _mm512_storeu_pd(p, v)
+    #define NANODS_SIMD_D_SET1(x) _mm512_set1_pd(x)
+    #define NANODS_SIMD_D_ADD(a, b) _mm512_add_pd(a, b)
+    #define NANODS_SIMD_D_MUL(a, b) _mm512_mul_pd(a, b)
+    #define NANODS_SIMD_D_MIN(a, b) _mm512_min_pd(a, b)
+    #define NANODS_SIMD_D_MAX(a, b) _mm512_max_pd(a, b)
+    #define NANODS_SIMD_D_EQ(a, b) ((uint32_t)_mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ))
+
+    #define NANODS_SIMD_I_T __m512i
+    #define NANODS_SIMD_I_W 16
+    #define NANODS_SIMD_I_LOAD(p) _mm512_loadu_si512((const void*)(p))
+    #define NANODS_SIMD_I_STORE(p, v) _mm512_storeu_si512((void*)(p), v)
+    #define NANODS_SIMD_I_SET1(x) _mm512_set1_epi32(x)
+    #define NANODS_SIMD_I_MIN(a, b) _mm512_min_epi32(a, b)
+    #define NANODS_SIMD_I_MAX(a, b) _mm512_max_epi32(a, b)
+    #define NANODS_SIMD_I_EQ(a, b) ((uint32_t)_mm512_cmpeq_epi32_mask(a, b))
+#elif defined(NANODS_HAVE_AVX2)
+    #define NANODS_SIMD_F_T __m256
+    #define NANODS_SIMD_F_W 8
+    #define NANODS_SIMD_F_LOAD(p) _mm256_loadu_ps(p)
+    #define NANODS_SIMD_F_STORE(p, v) _mm256_storeu_ps(p, v)
+    #define NANODS_SIMD_F_SET1(x) _mm256_set1_ps(x)
+    #define NANODS_SIMD_F_ADD(a, b) _mm256_add_ps(a, b)
+    #define NANODS_SIMD_F_MUL(a, b) _mm256_mul_ps(a, b)
+    #define NANODS_SIMD_F_MIN(a, b) _mm256_min_ps(a, b)
+    #define NANODS_SIMD_F_MAX(a, b) _mm256_max_ps(a, b)
+    #define NANODS_SIMD_F_EQ(a, b) ((uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)))
+
+    #define NANODS_SIMD_D_T __m256d
+    #define NANODS_SIMD_D_W 4
+    #define NANODS_SIMD_D_LOAD(p) _mm256_loadu_pd(p)
+    #define NANODS_SIMD_D_STORE(p, v) _mm256_storeu_pd(p, v)
+    #define NANODS_SIMD_D_SET1(x) _mm256_set1_pd(x)
+    #define NANODS_SIMD_D_ADD(a, b) _mm256_add_pd(a, b)
+    #define NANODS_SIMD_D_MUL(a, b) _mm256_mul_pd(a, b)
+    #define NANODS_SIMD_D_MIN(a, b) _mm256_min_pd(a, b)
+    #define NANODS_SIMD_D_MAX(a, b) _mm256_max_pd(a, b)
+    #define NANODS_SIMD_D_EQ(a, b) ((uint32_t)_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)))
+
+    #define NANODS_SIMD_I_T __m256i
+    #define NANODS_SIMD_I_W 8
+    #define NANODS_SIMD_I_LOAD(p) _mm256_loadu_si256((const __m256i*)(const void*)(p))
+    #define NANODS_SIMD_I_STORE(p, v) _mm256_storeu_si256((__m256i*)(void*)(p), v)
+    #define NANODS_SIMD_I_SET1(x) _mm256_set1_epi32(x)
+    #define NANODS_SIMD_I_MIN(a, b) _mm256_min_epi32(a, b)
+    #define NANODS_SIMD_I_MAX(a, b) _mm256_max_epi32(a, b)
+    #define NANODS_SIMD_I_EQ(a, b) \
+        ((uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))))
+#elif defined(NANODS_HAVE_SSE2)
+    /* SSE2 has no 32-bit integer min/max (SSE4.1 does) */
+    static inline __m128i nanods_sse2_min_epi32(__m128i a, __m128i b) {
+        __m128i lt = _mm_cmplt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+    }
+
+    static inline __m128i nanods_sse2_max_epi32(__m128i a, __m128i b) {
+        __m128i gt = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+    }
+
+    #define NANODS_SIMD_F_T __m128
+    #define NANODS_SIMD_F_W 4
+    #define NANODS_SIMD_F_LOAD(p) _mm_loadu_ps(p)
+    #define NANODS_SIMD_F_STORE(p, v) _mm_storeu_ps(p, v)
+    #define NANODS_SIMD_F_SET1(x) _mm_set1_ps(x)
+    #define NANODS_SIMD_F_ADD(a, b) _mm_add_ps(a, b)
+    #define NANODS_SIMD_F_MUL(a, b) _mm_mul_ps(a, b)
+    #define NANODS_SIMD_F_MIN(a, b) _mm_min_ps(a, b)
+    #define NANODS_SIMD_F_MAX(a, b) _mm_max_ps(a, b)
+    #define NANODS_SIMD_F_EQ(a, b) ((uint32_t)_mm_movemask_ps(_mm_cmpeq_ps(a, b)))
+
+    #define NANODS_SIMD_D_T __m128d
+    #define NANODS_SIMD_D_W 2
+    #define NANODS_SIMD_D_LOAD(p) _mm_loadu_pd(p)
+    #define NANODS_SIMD_D_STORE(p, v) _mm_storeu_pd(p, v)
+    #define NANODS_SIMD_D_SET1(x) _mm_set1_pd(x)
+    #define NANODS_SIMD_D_ADD(a, b) _mm_add_pd(a, b)
+    #define NANODS_SIMD_D_MUL(a, b) _mm_mul_pd(a, b)
+    #define NANODS_SIMD_D_MIN(a, b) _mm_min_pd(a, b)
+    #define NANODS_SIMD_D_MAX(a, b) _mm_max_pd(a, b)
+    #define NANODS_SIMD_D_EQ(a, b) ((uint32_t)_mm_movemask_pd(_mm_cmpeq_pd(a, b)))
+
+    #define NANODS_SIMD_I_T __m128i
+    #define NANODS_SIMD_I_W 4
+    #define NANODS_SIMD_I_LOAD(p) _mm_loadu_si128((const __m128i*)(const void*)(p))
+    #define NANODS_SIMD_I_STORE(p, v) _mm_storeu_si128((__m128i*)(void*)(p), v)
+    #define NANODS_SIMD_I_SET1(x) _mm_set1_epi32(x)
+    #define NANODS_SIMD_I_MIN(a, b) nanods_sse2_min_epi32(a, b)
+    #define NANODS_SIMD_I_MAX(a, b) nanods_sse2_max_epi32(a, b)
+    #define NANODS_SIMD_I_EQ(a, b) ((uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))))
+#elif defined(NANODS_HAVE_NEON)
+    /* NEON has no movemask: weight each all-ones lane by its bit and add across */
+    static inline uint32_t nanods_neon_mask32(uint32x4_t eq) {
+        static const uint32_t bits[4] = {1, 2, 4, 8};
+        return vaddvq_u32(vandq_u32(eq, vld1q_u32(bits)));
+    }
+
+    static inline uint32_t nanods_neon_mask64(uint64x2_t eq) {
+        static const uint64_t bits[2] = {1, 2};
+        return (uint32_t)vaddvq_u64(vandq_u64(eq, vld1q_u64(bits)));
+    }
+
+    #define NANODS_SIMD_F_T float32x4_t
+    #define NANODS_SIMD_F_W 4
+    #define NANODS_SIMD_F_LOAD(p) vld1q_f32(p)
+    #define NANODS_SIMD_F_STORE(p, v) vst1q_f32(p, v)
+    #define NANODS_SIMD_F_SET1(x) vdupq_n_f32(x)
+    #define NANODS_SIMD_F_ADD(a, b) vaddq_f32(a, b)
+    #define NANODS_SIMD_F_MUL(a, b) vmulq_f32(a, b)
+    #define NANODS_SIMD_F_MIN(a, b) vminq_f32(a, b)
+    #define NANODS_SIMD_F_MAX(a, b) vmaxq_f32(a, b)
+    #define NANODS_SIMD_F_EQ(a, b) nanods_neon_mask32(vceqq_f32(a, b))
+
+    #define NANODS_SIMD_D_T float64x2_t
+    #define NANODS_SIMD_D_W 2
+    #define NANODS_SIMD_D_LOAD(p) vld1q_f64(p)
+    #define NANODS_SIMD_D_STORE(p, v) vst1q_f64(p, v)
+    #define NANODS_SIMD_D_SET1(x) vdupq_n_f64(x)
+    #define NANODS_SIMD_D_ADD(a, b) vaddq_f64(a, b)
+    #define NANODS_SIMD_D_MUL(a, b) vmulq_f64(a, b)
+    #define NANODS_SIMD_D_MIN(a, b) vminq_f64(a, b)
+    #define NANODS_SIMD_D_MAX(a, b) vmaxq_f64(a, b)
+    #define NANODS_SIMD_D_EQ(a, b) nanods_neon_mask64(vceqq_f64(a, b))
+
+    #define NANODS_SIMD_I_T int32x4_t
+    #define NANODS_SIMD_I_W 4
+    #define NANODS_SIMD_I_LOAD(p) vld1q_s32(p)
+    #define NANODS_SIMD_I_STORE(p, v) vst1q_s32(p, v)
+    #define NANODS_SIMD_I_SET1(x) vdupq_n_s32(x)
+    #define NANODS_SIMD_I_MIN(a, b) vminq_s32(a, b)
+    #define NANODS_SIMD_I_MAX(a, b) vmaxq_s32(a, b)
+    #define NANODS_SIMD_I_EQ(a, b) nanods_neon_mask32(vceqq_s32(a, b))
+#else
+    /* Portable: one lane; the four accumulators still break the dependency chain */
+    #define NANODS_SIMD_F_T float
+    #define NANODS_SIMD_F_W 1
+    #define NANODS_SIMD_F_LOAD(p) (*(p))
+    #define NANODS_SIMD_F_STORE(p, v) (*(p) = (v))
+    #define NANODS_SIMD_F_SET1(x) (x)
+    #define NANODS_SIMD_F_ADD(a, b) ((a) + (b))
+    #define NANODS_SIMD_F_MUL(a, b) ((a) * (b))
+    #define NANODS_SIMD_F_MIN(a, b) ((b) < (a) ? (b) : (a))
+    #define NANODS_SIMD_F_MAX(a, b) ((a) < (b) ? (b) : (a))
+    #define NANODS_SIMD_F_EQ(a, b) ((uint32_t)((a) == (b)))
+
+    #define NANODS_SIMD_D_T double
+    #define NANODS_SIMD_D_W 1
+    #define NANODS_SIMD_D_LOAD(p) (*(p))
+    #define NANODS_SIMD_D_STORE(p, v) (*(p) = (v))
+    #define NANODS_SIMD_D_SET1(x) (x)
+    #define NANODS_SIMD_D_ADD(a, b) ((a) + (b))
+    #define NANODS_SIMD_D_MUL(a, b) ((a) * (b))
+    #define NANODS_SIMD_D_MIN(a, b) ((b) < (a) ? (b) : (a))
+    #define NANODS_SIMD_D_MAX(a, b) ((a) < (b) ? (b) : (a))
+    #define NANODS_SIMD_D_EQ(a, b) ((uint32_t)((a) == (b)))
+
+    #define NANODS_SIMD_I_T int
+    #define NANODS_SIMD_I_W 1
+    #define NANODS_SIMD_I_LOAD(p) (*(p))
+    #define NANODS_SIMD_I_STORE(p, v) (*(p) = (v))
+    #define NANODS_SIMD_I_SET1(x) (x)
+    #define NANODS_SIMD_I_MIN(a, b) ((b) < (a) ? (b) : (a))
+    #define NANODS_SIMD_I_MAX(a, b) ((a) < (b) ? (b) : (a))
+    #define NANODS_SIMD_I_EQ(a, b) ((uint32_t)((a) == (b)))
+#endif
+
+/* min/max/count/find on raw arrays; P selects the operation table */
+#define NANODS_DEFINE_SIMD_KERNELS(T, P)                                       \
+    static inline T nanods_simd_min_##T(const T* data, size_t n) {             \
+        NANODS_SIMD_##P##_T acc0 = NANODS_SIMD_##P##_SET1(data[0]);            \
+        NANODS_SIMD_##P##_T acc1 = acc0, acc2 = acc0, acc3 = acc0;             \
+        size_t i = 0;                                                          \
+        for (; i + 4 * NANODS_SIMD_##P##_W <= n; i += 4 * NANODS_SIMD_##P##_W) { \
+            acc0 = NANODS_SIMD_##P##_MIN(acc0, NANODS_SIMD_##P##_LOAD(data + i)); \
+            acc1 = NANODS_SIMD_##P##_MIN(acc1, NANODS_SIMD_##P##_LOAD(data + i + NANODS_SIMD_##P##_W)); \
+            acc2 = NANODS_SIMD_##P##_MIN(acc2, NANODS_SIMD_##P##_LOAD(data + i + 2 * NANODS_SIMD_##P##_W)); \
+            acc3 = NANODS_SIMD_##P##_MIN(acc3, NANODS_SIMD_##P##_LOAD(data + i + 3 * NANODS_SIMD_##P##_W)); \
+        }                                                                      \
+        for (; i + NANODS_SIMD_##P##_W <= n; i += NANODS_SIMD_##P##_W) {       \
+            acc0 = NANODS_SIMD_##P##_MIN(acc0, NANODS_SIMD_##P##_LOAD(data + i)); \
+        }                                                                      \
+        acc0 = NANODS_SIMD_##P##_MIN(NANODS_SIMD_##P##_MIN(acc0, acc1), NANODS_SIMD_##P##_MIN(acc2, acc3)); \
+        T lanes[NANODS_SIMD_##P##_W];                                          \
+        NANODS_SIMD_##P##_STORE(lanes, acc0);                                  \
+        T result = lanes[0];                                                   \
+        for (size_t k = 1; k < NANODS_SIMD_##P##_W; k++) if (lanes[k] < result) result = lanes[k]; \
+        for (; i < n; i++) if (data[i] < result) result = data[i];             \
+        return result;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline T nanods_simd_max_##T(const T* data, size_t n) {             \
+        NANODS_SIMD_##P##_T acc0 = NANODS_SIMD_##P##_SET1(data[0]);            \
+        NANODS_SIMD_##P##_T acc1 = acc0, acc2 = acc0, acc3 = acc0;             \
+        size_t i = 0;                                                          \
+        for (; i + 4 * NANODS_SIMD_##P##_W <= n; i += 4 * NANODS_SIMD_##P##_W) { \
+            acc0 = NANODS_SIMD_##P##_MAX(acc0, NANODS_SIMD_##P##_LOAD(data + i)); \
+            acc1 = NANODS_SIMD_##P##_MAX(acc1, NANODS_SIMD_##P##_LOAD(data + i + NANODS_SIMD_##P##_W)); \
+            acc2 = NANODS_SIMD_##P##_MAX(acc2, NANODS_SIMD_##P##_LOAD(data + i + 2 * NANODS_SIMD_##P##_W)); \
+            acc3 = NANODS_SIMD_##P##_MAX(acc3, NANODS_SIMD_##P##_LOAD(data + i + 3 * NANODS_SIMD_##P##_W)); \
+        }                                                                      \
+        for (; i + NANODS_SIMD_##P##_W <= n; i += NANODS_SIMD_##P##_W) {       \
+            acc0 = NANODS_SIMD_##P##_MAX(acc0, NANODS_SIMD_##P##_LOAD(data + i)); \
+        }                                                                      \
+        acc0 = NANODS_SIMD_##P##_MAX(NANODS_SIMD_##P##_MAX(acc0, acc1), NANODS_SIMD_##P##_MAX(acc2, acc3)); \
+        T lanes[NANODS_SIMD_##P##_W];                                          \
+        NANODS_SIMD_##P##_STORE(lanes, acc0);                                  \
+        T result = lanes[0];                                                   \
+        for (size_t k = 1; k < NANODS_SIMD_##P##_W; k++) if (result < lanes[k]) result = lanes[k]; \
+        for (; i < n; i++) if (result < data[i]) result = data[i];             \
+        return result;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline size_t nanods_simd_count_##T(const T* data, size_t n, T value) { \
+        NANODS_SIMD_##P##_T needle = NANODS_SIMD_##P##_SET1(value);            \
+        size_t count = 0, i = 0;                                               \
+        for (; i + NANODS_SIMD_##P##_W <= n; i += NANODS_SIMD_##P##_W) {       \
+            uint32_t mask = NANODS_SIMD_##P##_EQ(NANODS_SIMD_##P##_LOAD(data + i), needle); \
+            count += (size_t)nanods_popcount32(mask);                          \
+        }                                                                      \
+        for (; i < n; i++) count += data[i] == value;                          \
+        return count;                                                          \
+    }                                                                          \
+                                                                               \
+    /* Index of the first element equal to value, n if none */                 \
+    static inline size_t nanods_simd_find_##T(const T* data, size_t n, T value) { \
+        NANODS_SIMD_##P##_T needle = NANODS_SIMD_##P##_SET1(value);            \
+        size_t i = 0;                                                          \
+        for (; i + NANODS_SIMD_##P##_W <= n; i += NANODS_SIMD_##P##_W) {       \
+            uint32_t mask = NANODS_SIMD_##P##_EQ(NANODS_SIMD_##P##_LOAD(data + i), needle); \
+            if (mask) return i + (size_t)nanods_ctz32(mask);                   \
+        }                                                                      \
+        for (; i < n; i++) if (data[i] == value) return i;                     \
+        return n;                                                              \
+    }
+
+/* Floating-point sum and dot product */
+#define NANODS_DEFINE_SIMD_FP_KERNELS(T, P)                                    \
+    static inline T nanods_simd_sum_##T(const T* data, size_t n) {             \
+        NANODS_SIMD_##P##_T acc0 = NANODS_SIMD_##P##_SET1((T)0);               \
+        NANODS_SIMD_##P##_T acc1 = acc0, acc2 = acc0, acc3 = acc0;             \
+        size_t i = 0;                                                          \
+        for (; i + 4 * NANODS_SIMD_##P##_W <= n; i += 4 * NANODS_SIMD_##P##_W) { \
+            acc0 = NANODS_SIMD_##P##_ADD(acc0, NANODS_SIMD_##P##_LOAD(data + i)); \
+            acc1 = NANODS_SIMD_##P##_ADD(acc1, NANODS_SIMD_##P##_LOAD(data + i + NANODS_SIMD_##P##_W)); \
+            acc2 = NANODS_SIMD_##P##_ADD(acc2, NANODS_SIMD_##P##_LOAD(data + i + 2 * NANODS_SIMD_##P##_W)); \
+            acc3 = NANODS_SIMD_##P##_ADD(acc3, NANODS_SIMD_##P##_LOAD(data + i + 3 * NANODS_SIMD_##P##_W)); \
+        }                                                                      \
+        for (; i + NANODS_SIMD_##P##_W <= n; i += NANODS_SIMD_##P##_W) {       \
+            acc0 = NANODS_SIMD_##P##_ADD(acc0, NANODS_SIMD_##P##_LOAD(data + i)); \
+        }                                                                      \
+        acc0 = NANODS_SIMD_##P##_ADD(NANODS_SIMD_##P##_ADD(acc0, acc1), NANODS_SIMD_##P##_ADD(acc2, acc3)); \
+        T lanes[NANODS_SIMD_##P##_W];                                          \
+        NANODS_SIMD_##P##_STORE(lanes, acc0);                                  \
+        T sum = 0;                                                             \
+        for (size_t k = 0; k < NANODS_SIMD_##P##_W; k++) sum += lanes[k];      \
+        for (; i < n; i++) sum += data[i];                                     \
+        return sum;                                                            \
+    }                                                                          \
+                                                                               \
+    static inline T nanods_simd_dot_##T(const T* a, const T* b, size_t n) {    \
+        NANODS_SIMD_##P##_T acc0 = NANODS_SIMD_##P##_SET1((T)0);               \
+        NANODS_SIMD_##P##_T acc1 = acc0, acc2 = acc0, acc3 = acc0;             \
+        size_t i = 0;                                                          \
+        for (; i + 4 * NANODS_SIMD_##P##_W <= n; i += 4 * NANODS_SIMD_##P##_W) { \
+            acc0 = NANODS_SIMD_##P##_ADD(acc0, NANODS_SIMD_##P##_MUL(NANODS_SIMD_##P##_LOAD(a + i), \
+                                                                     NANODS_SIMD_##P##_LOAD(b + i))); \
+            acc1 = NANODS_SIMD_##P##_ADD(acc1, NANODS_SIMD_##P##_MUL(          \
+                NANODS_SIMD_##P##_LOAD(a + i + NANODS_SIMD_##P##_W),           \
+                NANODS_SIMD_##P##_LOAD(b + i + NANODS_SIMD_##P##_W)));         \
+            acc2 = NANODS_SIMD_##P##_ADD(acc2, NANODS_SIMD_##P##_MUL(          \
+                NANODS_SIMD_##P##_LOAD(a + i + 2 * NANODS_SIMD_##P##_W),       \
+                NANODS_SIMD_##P##_LOAD(b + i + 2 * NANODS_SIMD_##P##_W)));     \
+            acc3 = NANODS_SIMD_##P##_ADD(acc3, NANODS_SIMD_##P##_MUL(          \
+                NANODS_SIMD_##P##_LOAD(a + i + 3 * NANODS_SIMD_##P##_W),       \
+                NANODS_SIMD_##P##_LOAD(b + i + 3 * NANODS_SIMD_##P##_W)));     \
+        }                                                                      \
+        for (; i + NANODS_SIMD_##P##_W <= n; i += NANODS_SIMD_##P##_W) {       \
+            acc0 = NANODS_SIMD_##P##_ADD(acc0, NANODS_SIMD_##P##_MUL(NANODS_SIMD_##P##_LOAD(a + i), \
+                                                                     NANODS_SIMD_##P##_LOAD(b + i))); \
+        }                                                                      \
+        acc0 = NANODS_SIMD_##P##_ADD(NANODS_SIMD_##P##_ADD(acc0, acc1), NANODS_SIMD_##P##_ADD(acc2, acc3)); \
+        T lanes[NANODS_SIMD_##P##_W];                                          \
+        NANODS_SIMD_##P##_STORE(lanes, acc0);                                  \
+        T sum = 0;                                                             \
+        for (size_t k = 0; k < NANODS_SIMD_##P##_W; k++) sum += lanes[k];      \
+        for (; i < n; i++) sum += a[i] * b[i];                                 \
+        return sum;                                                            \
+    }
+
+NANODS_DEFINE_SIMD_KERNELS(int, I)
+NANODS_DEFINE_SIMD_KERNELS(float, F)
+NANODS_DEFINE_SIMD_KERNELS(double, D)
+NANODS_DEFINE_SIMD_FP_KERNELS(float, F)
+NANODS_DEFINE_SIMD_FP_KERNELS(double, D)
+
+/* int sum and dot product widen to 64-bit lanes, so they need their own paths */
+static inline long long nanods_simd_sum_int(const int* data, size_t n) {
+    size_t i = 0;
+    uint64_t sum = 0;              /* Unsigned: wraps instead of overflowing */
+#if defined(NANODS_HAVE_AVX512)
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(data + i));
+        acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+        acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    uint64_t lanes[8];
+    _mm512_storeu_si512((void*)lanes, acc);
+    for (int k = 0; k < 8; k++) sum += lanes[k];
+#elif defined(NANODS_HAVE_AVX2)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(data + i));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)(void*)lanes, acc);
+    for (int k = 0; k < 4; k++) sum += lanes[k];
+#elif defined(NANODS_HAVE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(data + i));
+        __m128i sign = _mm_srai_epi32(v, 31);  /* Sign-extend by interleaving */
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)(void*)lanes, acc);
+    sum += lanes[0] + lanes[1];
+#elif defined(NANODS_HAVE_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 4 <= n; i += 4) acc = vpadalq_s32(acc, vld1q_s32(data + i));
+    sum += (uint64_t)vaddvq_s64(acc);
+#endif
+    for (; i < n; i++) sum += (uint64_t)(int64_t)data[i];
+    return (long long)sum;
+}
+
+static inline long long nanods_simd_dot_int(const int* a, const int* b, size_t n) {
+    size_t i = 0;
+    uint64_t sum = 0;
+#if defined(NANODS_HAVE_AVX512)
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8) {
+        __m512i va = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(const void*)(a + i)));
+        __m512i vb = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(const void*)(b + i)));
+        acc = _mm512_add_epi64(acc, _mm512_mul_epi32(va, vb));
+    }
+    uint64_t lanes[8];
+    _mm512_storeu_si512((void*)lanes, acc);
+    for (int k = 0; k < 8; k++) sum += lanes[k];
+#elif defined(NANODS_HAVE_AVX2)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(const void*)(a + i)));
+        __m256i vb = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(const void*)(b + i)));
+        acc = _mm256_add_epi64(acc, _mm256_mul_epi32(va, vb));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)(void*)lanes, acc);
+    for (int k = 0; k < 4; k++) sum += lanes[k];
+#elif defined(NANODS_HAVE_NEON)
+    int64x2_t acc_lo = vdupq_n_s64(0), acc_hi = vdupq_n_s64(0);
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t va = vld1q_s32(a + i), vb = vld1q_s32(b + i);
+        acc_lo = vmlal_s32(acc_lo, vget_low_s32(va), vget_low_s32(vb));
+        acc_hi = vmlal_high_s32(acc_hi, va, vb);
+    }
+    sum += (uint64_t)vaddvq_s64(vaddq_s64(acc_lo, acc_hi));
+#endif
+    /* SSE2 lacks a signed 32x32->64 multiply: scalar, which compilers unroll */
+    for (; i < n; i++) sum += (uint64_t)((int64_t)a[i] * b[i]);
+    return (long long)sum;
+}
+
+/* Vector-level API; S is the type of sums and dot products */
+#define NANODS_DEFINE_VECTOR_SIMD(T, S)                                        \
+    static inline S nv_sum_##T(const NanoVector_##T* vec) {                    \
+        if (!vec || vec->size == 0) return (S)0;                               \
+        return (S)nanods_simd_sum_##T(vec->data, vec->size);                   \
+    }                                                                          \
+                                                                               \
+    static inline int nv_min_##T(const NanoVector_##T* vec, T* out) {          \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_EMPTY(vec->size, NANODS_ERR_EMPTY);                       \
+        *out = nanods_simd_min_##T(vec->data, vec->size);                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nv_max_##T(const NanoVector_##T* vec, T* out) {          \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_EMPTY(vec->size, NANODS_ERR_EMPTY);                       \
+        *out = nanods_simd_max_##T(vec->data, vec->size);                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* NANODS_ERR_BOUNDS unless both vectors have the same size */             \
+    static inline int nv_dot_##T(const NanoVector_##T* a, const NanoVector_##T* b, S* out) { \
+        NANODS_CHECK_NULL(a, NANODS_ERR_NULL);                                 \
+        NANODS_CHECK_NULL(b, NANODS_ERR_NULL);                                 \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        if (NANODS_UNLIKELY(a->size != b->size)) return NANODS_ERR_BOUNDS;     \
+        *out = a->size ? (S)nanods_simd_dot_##T(a->data, b->data, a->size) : (S)0; \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline size_t nv_count_##T(const NanoVector_##T* vec, T value) {    \
+        if (!vec || vec->size == 0) return 0;                                  \
+        return nanods_simd_count_##T(vec->data, vec->size, value);             \
+    }                                                                          \
+                                                                               \
+    /* First index of an element equal to value */                             \
+    static inline int nv_find_##T(const NanoVector_##T* vec, T value, size_t* index) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (vec->size == 0) return NANODS_ERR_NOTFOUND;                        \
+        size_t i = nanods_simd_find_##T(vec->data, vec->size, value);          \
+        if (i == vec->size) return NANODS_ERR_NOTFOUND;                        \
+        if (index) *index = i;                                                 \
+        return NANODS_OK;                                                      \
+    }
+
+NANODS_DEFINE_VECTOR_SIMD(int, long long)
+NANODS_DEFINE_VECTOR_SIMD(float, float)
+NANODS_DEFINE_VECTOR_SIMD(double, double)
+
+/** @} */
+
+#endif /* NANODS_SIMD_IMPL_H */
@@ -0,0 +1,315 @@
+/**
+ * @file small_vector_impl.h
+ * @brief Dynamic array that keeps its first N elements inline
+ */
+
+#ifndef NANODS_SMALL_VECTOR_IMPL_H
+#define NANODS_SMALL_VECTOR_IMPL_H
+
+/**
+ * @defgroup NanoSmallVector Small-Buffer Vector
+ * @{
+ *
+ * NANODS_DEFINE_SMALL_VECTOR(T, N) defines NanoSmallVector_T_N, a vector
+ * with room for N elements inside the struct. Nothing is allocated until the
+ * N + 1st element; past that it behaves like NanoVector_T, grows the same way
+ * and uses the same allocator rules. The functions mirror the nv_* API with an
+ * nsv_ prefix and a T_N suffix:
+ *
+ *     NANODS_DEFINE_SMALL_VECTOR(int, 8)
+ *     NanoSmallVector_int_8 tags;
+ *     nsv_init_int_8(&tags);
+ *     nsv_push_int_8(&tags, 42);            (no allocation)
+ *     nsv_free_int_8(&tags);
+ *
+ * `data` points into the struct while the elements are inline, so a small
+ * vector must not be copied with `=` or memcpy; nsv_move_T_N relocates one.
+ * nsv_shrink_to_fit moves back inline once size <= N.
+ */
+
+#define NANODS_DEFINE_SMALL_VECTOR(T, N)                                       \
+    typedef struct {                                                           \
+        T* data;                          /* inline_data or a heap block */    \
+        size_t size;                                                           \
+        size_t capacity;                  /* N while inline */                 \
+        const NanoCtxAllocator* alloc;    /* NULL: global allocator */         \
+        uint8_t flags;                                                         \
+        T inline_data[N];                                                      \
+    } NanoSmallVector_##T##_##N;                                               \
+                                                                               \
+    static inline void nsv_init_ex_##T##_##N(NanoSmallVector_##T##_##N* vec, uint8_t flags) { \
+        NANODS_CHECK_NULL_VOID(vec);                                           \
+        vec->data = vec->inline_data;                                          \
+        vec->size = 0;                                                         \
+        vec->capacity = N;                                                     \
+        vec->flags = flags;                                                    \
+        vec->alloc = NULL;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline void nsv_init_##T##_##N(NanoSmallVector_##T##_##N* vec) {    \
+        nsv_init_ex_##T##_##N(vec, NANODS_FLAG_NONE);                          \
+    }                                                                          \
+                                                                               \
+    static inline void nsv_init_alloc_##T##_##N(NanoSmallVector_##T##_##N* vec, uint8_t flags, \
+                                                 const NanoCtxAllocator* alloc) { \
+        NANODS_CHECK_NULL_VOID(vec);                                           \
+        nsv_init_ex_##T##_##N(vec, flags);                                     \
+        vec->alloc = alloc;                                                    \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_is_inline_##T##_##N(const NanoSmallVector_##T##_##N* vec) { \
+        return vec && vec->data == vec->inline_data;                           \
+    }                                                                          \
+                                                                               \
+    /* Drop the heap block (if any) and return to the empty inline state */    \
+    static inline void nsv_release_##T##_##N(NanoSmallVector_##T##_##N* vec, int secure) { \
+        if (vec->data != vec->inline_data) {                                   \
+            if (secure) {                                                      \
+                nanods_mem_secure_free(vec->alloc, vec->data, vec->capacity * sizeof(T)); \
+            } else {                                                           \
+                nanods_mem_free(vec->alloc, vec->data);                        \
+            }                                                                  \
+        }                                                                      \
+        if (secure) memset(vec->inline_data, 0, sizeof(vec->inline_data));     \
+        vec->data = vec->inline_data;                                          \
+        vec->size = 0;                                                         \
+        vec->capacity = N;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_reserve_##T##_##N(NanoSmallVector_##T##_##N* vec, size_t new_capacity) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (new_capacity <= vec->capacity) return NANODS_OK;                   \
+        size_t byte_size;                                                      \
+        if (NANODS_UNLIKELY(nanods_check_mul_overflow(new_capacity, sizeof(T), &byte_size))) \
+            return NANODS_ERR_OVERFLOW;                                        \
+        T* new_data;                                                           \
+        if (vec->data == vec->inline_data) {                                   \
+            /* Spill: the inline slots are copied out and stay unused */       \
+            new_data = (T*)nanods_mem_alloc(vec->alloc, byte_size);            \
+            if (NANODS_UNLIKELY(!new_data)) return NANODS_ERR_NOMEM;           \
+            memcpy(new_data, vec->inline_data, vec->size * sizeof(T));         \
+            if (vec->flags & NANODS_FLAG_SECURE) {                             \
+                memset(vec->inline_data, 0, sizeof(vec->inline_data));         \
+            }                                                                  \
+        } else {                                                               \
+            new_data = (T*)nanods_mem_realloc(vec->alloc, vec->data, byte_size); \
+            if (NANODS_UNLIKELY(!new_data)) return NANODS_ERR_NOMEM;           \
+        }                                                                      \
+        vec->data = new_data;                                                  \
+        vec->capacity = new_capacity;                                          \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_grow_##T##_##N(NanoSmallVector_##T##_##N* vec, size_t extra) { \
+        size_t needed;                                                         \
+        if (NANODS_UNLIKELY(nanods_check_add_overflow(vec->size, extra, &needed))) \
+            return NANODS_ERR_OVERFLOW;                                        \
+        if (NANODS_LIKELY(needed <= vec->capacity)) return NANODS_OK;          \
+        return nsv_reserve_##T##_##N(vec, nanods_vector_grow_capacity(vec->capacity, needed)); \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_push_##T##_##N(NanoSmallVector_##T##_##N* vec, T value) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (NANODS_UNLIKELY(vec->size >= vec->capacity)) {                     \
+            int err = nsv_grow_##T##_##N(vec, 1);                              \
+            if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                 \
+        }                                                                      \
+        vec->data[vec->size++] = value;                                        \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_extend_##T##_##N(NanoSmallVector_##T##_##N* vec, const T* src, \
+                                            size_t count) {                    \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (count == 0) return NANODS_OK;                                      \
+        NANODS_CHECK_NULL(src, NANODS_ERR_NULL);                               \
+        int aliased = src >= vec->data && src < vec->data + vec->size;         \
+        size_t offset = aliased ? (size_t)(src - vec->data) : 0;               \
+        int err = nsv_grow_##T##_##N(vec, count);                              \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        if (aliased) src = vec->data + offset;                                 \
+        memcpy(vec->data + vec->size, src, count * sizeof(T));                 \
+        vec->size += count;                                                    \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_insert_range_##T##_##N(NanoSmallVector_##T##_##N* vec, size_t index, \
+                                                  const T* src, size_t count) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_BOUNDS(index, vec->size + 1, NANODS_ERR_BOUNDS);          \
+        if (count == 0) return NANODS_OK;                                      \
+        NANODS_CHECK_NULL(src, NANODS_ERR_NULL);                               \
+        int aliased = src >= vec->data && src < vec->data + vec->size;         \
+        size_t offset = aliased ? (size_t)(src - vec->data) : 0;               \
+        int err = nsv_grow_##T##_##N(vec, count);                              \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        memmove(vec->data + index + count, vec->data + index, (vec->size - index) * sizeof(T)); \
+        if (aliased) {                                                         \
+            size_t before = offset < index ? index - offset : 0;               \
+            if (before > count) before = count;                                \
+            memcpy(vec->data + index, vec->data + offset, before * sizeof(T)); \
+            memcpy(vec->data + index + before, vec->data + offset + before + count, \
+                   (count - before) * sizeof(T));                              \
+        } else {                                                               \
+            memcpy(vec->data + index, src, count * sizeof(T));                 \
+        }                                                                      \
+        vec->size += count;                                                    \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_erase_range_##T##_##N(NanoSmallVector_##T##_##N* vec, size_t index, \
+                                                 size_t count) {               \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_BOUNDS(index, vec->size + 1, NANODS_ERR_BOUNDS);          \
+        NANODS_CHECK_BOUNDS(count, vec->size - index + 1, NANODS_ERR_BOUNDS);  \
+        if (count == 0) return NANODS_OK;                                      \
+        memmove(vec->data + index, vec->data + index + count,                  \
+                (vec->size - index - count) * sizeof(T));                      \
+        vec->size -= count;                                                    \
+        if (vec->flags & NANODS_FLAG_SECURE) {                                 \
+            memset(vec->data + vec->size, 0, count * sizeof(T));               \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_resize_##T##_##N(NanoSmallVector_##T##_##N* vec, size_t new_size, \
+                                            T fill) {                          \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (new_size <= vec->size) {                                           \
+            if ((vec->flags & NANODS_FLAG_SECURE) && new_size < vec->size) {   \
+                memset(vec->data + new_size, 0, (vec->size - new_size) * sizeof(T)); \
+            }                                                                  \
+            vec->size = new_size;                                              \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        if (new_size > vec->capacity) {                                        \
+            int err = nsv_reserve_##T##_##N(vec, new_size);                    \
+            if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                 \
+        }                                                                      \
+        for (size_t i = vec->size; i < new_size; i++) vec->data[i] = fill;     \
+        vec->size = new_size;                                                  \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Back to inline storage when the elements fit, else trim the heap block */ \
+    static inline int nsv_shrink_to_fit_##T##_##N(NanoSmallVector_##T##_##N* vec) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (vec->data == vec->inline_data || vec->capacity == vec->size) return NANODS_OK; \
+        T* old_data = vec->data;                                               \
+        size_t old_bytes = vec->capacity * sizeof(T);                          \
+        if (vec->size <= N) {                                                  \
+            memcpy(vec->inline_data, old_data, vec->size * sizeof(T));         \
+            vec->data = vec->inline_data;                                      \
+            vec->capacity = N;                                                 \
+        } else if (vec->flags & NANODS_FLAG_SECURE) {                          \
+            T* new_data = (T*)nanods_mem_alloc(vec->alloc, vec->size * sizeof(T)); \
+            if (NANODS_UNLIKELY(!new_data)) return NANODS_ERR_NOMEM;           \
+            memcpy(new_data, old_data, vec->size * sizeof(T));                 \
+            vec->data = new_data;                                              \
+            vec->capacity = vec->size;                                         \
+        } else {                                                               \
+            T* new_data = (T*)nanods_mem_realloc(vec->alloc, old_data, vec->size * sizeof(T)); \
+            if (NANODS_UNLIKELY(!new_data)) return NANODS_ERR_NOMEM;           \
+            vec->data = new_data;                                              \
+            vec->capacity = vec->size;                                         \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        if (vec->flags & NANODS_FLAG_SECURE) {                                 \
+            nanods_mem_secure_free(vec->alloc, old_data, old_bytes);           \
+        } else {                                                               \
+            nanods_mem_free(vec->alloc, old_data);                             \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_get_##T##_##N(const NanoSmallVector_##T##_##N* vec, size_t index, \
+                                         T* out) {                             \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_BOUNDS(index, vec->size, NANODS_ERR_BOUNDS);              \
+        *out = vec->data[index];                                               \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_set_##T##_##N(NanoSmallVector_##T##_##N* vec, size_t index, T value) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_BOUNDS(index, vec->size, NANODS_ERR_BOUNDS);              \
+        vec->data[index] = value;                                              \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_pop_##T##_##N(NanoSmallVector_##T##_##N* vec, T* out) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_EMPTY(vec->size, NANODS_ERR_EMPTY);                       \
+        if (out) *out = vec->data[vec->size - 1];                              \
+        vec->size--;                                                           \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline size_t nsv_size_##T##_##N(const NanoSmallVector_##T##_##N* vec) { \
+        return vec ? vec->size : 0;                                            \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_empty_##T##_##N(const NanoSmallVector_##T##_##N* vec) { \
+        return vec ? (vec->size == 0) : 1;                                     \
+    }                                                                          \
+                                                                               \
+    static inline void nsv_clear_##T##_##N(NanoSmallVector_##T##_##N* vec) {   \
+        if (vec) vec->size = 0;                                                \
+    }                                                                          \
+                                                                               \
+    /* Leaves an empty, inline, reusable vector */                             \
+    static inline void nsv_free_##T##_##N(NanoSmallVector_##T##_##N* vec) {    \
+        if (vec) nsv_release_##T##_##N(vec, vec->flags & NANODS_FLAG_SECURE);  \
+    }                                                                          \
+                                                                               \
+    static inline void nsv_secure_free_##T##_##N(NanoSmallVector_##T##_##N* vec) { \
+        if (vec) nsv_release_##T##_##N(vec, 1);                                \
+    }                                                                          \
+                                                                               \
+    /* Relocate src into uninitialized dst; src is left empty */               \
+    static inline void nsv_move_##T##_##N(NanoSmallVector_##T##_##N* dst,      \
+                                           NanoSmallVector_##T##_##N* src) {   \
+        NANODS_CHECK_NULL_VOID(dst);                                           \
+        NANODS_CHECK_NULL_VOID(src);                                           \
+        if (dst == src) return;                                                \
+        int was_inline = src->data == src->inline_data;                        \
+        memcpy(dst, src, sizeof(*dst));                                        \
+        if (was_inline) {                                                      \
+            dst->data = dst->inline_data;                                      \
+            if (src->flags & NANODS_FLAG_SECURE) {                             \
+                memset(src->inline_data, 0, sizeof(src->inline_data));         \
+            }                                                                  \
+        }                                                                      \
+        src->data = src->inline_data;                                          \
+        src->size = 0;                                                         \
+        src->capacity = N;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline NanoIter nsv_iter_##T##_##N(NanoSmallVector_##T##_##N* vec) { \
+        NanoIter it;                                                           \
+        it.type = NANODS_ITER_VECTOR;                                          \
+        it.container = vec;                                                    \
+        it.index = 0;                                                          \
+        it.ptr = (vec && vec->size > 0) ? &vec->data[0] : NULL;                \
+        it.internal = NULL;                                                    \
+        it.finished = (!vec || vec->size == 0);                                \
+        return it;                                                             \
+    }                                                                          \
+                                                                               \
+    static inline int nsv_iter_next_##T##_##N(NanoIter* it) {                  \
+        if (!it || it->finished) return 0;                                     \
+        NanoSmallVector_##T##_##N* vec = (NanoSmallVector_##T##_##N*)it->container; \
+        it->index++;                                                           \
+        if (it->index >= vec->size) {                                          \
+            it->finished = 1;                                                  \
+            it->ptr = NULL;                                                    \
+            return 0;                                                          \
+        }                                                                      \
+        it->ptr = &vec->data[it->index];                                       \
+        return 1;                                                              \
+    }
+
+/** @} */
+
+#endif /* NANODS_SMALL_VECTOR_IMPL_H */
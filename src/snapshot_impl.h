@@ -0,0 +1,595 @@
+/**
+ * @file snapshot_impl.h
+ * @brief Binary snapshots of vectors and maps, with zero-copy (mmap) attach
+ */
+
+#ifndef NANODS_SNAPSHOT_IMPL_H
+#define NANODS_SNAPSHOT_IMPL_H
+
+#ifndef NANODS_NO_SNAPSHOT
+
+/**
+ * @defgroup NanoSnapshot Snapshot Files
+ * @{
+ *
+ * nv_save_T / nm_save write a container to one file; nsnap_open maps it
+ * read-only (POSIX mmap, or one read into memory elsewhere) and serves
+ * lookups straight from the file. Nothing is deserialized, so attaching costs
+ * the same for ten entries or ten million, and processes that open the same
+ * file share its pages.
+ *
+ * Layout: a 128-byte header, then for vectors the raw elements (64-byte
+ * aligned), for maps a linear-probing index followed by the entries. Every
+ * reference inside the file is a byte offset from its start, never a pointer.
+ * Integers are in host byte order; a snapshot only attaches on a host with
+ * the same byte order (checked). Files are written to `path.tmp` and renamed
+ * over `path`, so a process that has the old file mapped keeps reading it.
+ *
+ *     Map index slot (16 bytes)       Map entry (8-byte aligned)
+ *     ┌──────────────────────────┐    ┌─────────┬───────────┬──────────┬───────┐
+ *     │ entry offset (0 = empty) │    │ key_len │ value_len │ key, NUL │ value │
+ *     │ hash  │ key_len          │    └─────────┴───────────┴──────────┴───────┘
+ *     └──────────────────────────┘
+ *
+ * The index hashes with FNV-1a and the seed stored in the header. nsnap_open
+ * checks the header and every lookup bounds-checks what it reads; nsnap_verify
+ * additionally checksums the whole payload.
+ */
+
+#define NANODS_SNAPSHOT_VERSION 1
+#define NANODS_SNAP_HEADER_SIZE 128
+#define NANODS_SNAP_BYTE_ORDER 0x01020304u
+
+typedef enum {
+    NANODS_SNAP_VECTOR = 1,
+    NANODS_SNAP_MAP = 2
+} NanoSnapKind;
+
+typedef struct {
+    char magic[8];                         /* "NANOSNAP" */
+    uint32_t version;                      /* NANODS_SNAPSHOT_VERSION */
+    uint32_t byte_order;                   /* NANODS_SNAP_BYTE_ORDER as written */
+    uint32_t kind;                         /* NanoSnapKind */
+    uint32_t elem_size;                    /* Vector element size; 0 for maps */
+    uint64_t file_size;
+    uint64_t count;                        /* Elements or entries */
+    uint64_t data_offset;                  /* Vector elements, or the map index */
+    uint64_t bucket_count;                 /* Map index slots (power of two) */
+    uint64_t checksum;                     /* Over bytes [NANODS_SNAP_HEADER_SIZE, file_size) */
+    uint32_t seed;                         /* Map index hash seed */
+    uint32_t reserved;
+} NanoSnapHeader;
+
+typedef struct {
+    uint64_t offset;                       /* Entry record; 0 marks an empty slot */
+    uint32_t hash;
+    uint32_t key_len;
+} NanoSnapSlot;
+
+typedef struct {
+    const uint8_t* base;
+    size_t size;
+    const NanoSnapHeader* header;
+    void* owned;                           /* Heap copy when the file was read, not mapped */
+    int mapped;
+} NanoSnapshot;
+
+/* Returns the value's byte length and points *bytes at them; called twice per value */
+typedef size_t (*NanoSnapValueFn)(const void* value, const void** bytes, void* ctx);
+
+static inline size_t nsnap_align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static inline uint64_t nsnap_mix(uint64_t h, uint64_t word) {
+    return nanods_wymix(h ^ word ^ 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull);
+}
+
+/* ---- Writing ---------------------------------------------------------------- */
+
+typedef struct {
+    FILE* file;
+    char* tmp_path;
+    uint64_t pos;                          /* Absolute file offset */
+    uint64_t checksum;
+    uint64_t word;                         /* Payload bytes not yet folded in */
+    unsigned word_len;
+    int err;
+} NanoSnapWriter;
+
+static inline void nsnap_put(NanoSnapWriter* w, const void* data, size_t size) {
+    if (w->err || size == 0) return;
+    if (NANODS_UNLIKELY(fwrite(data, 1, size, w->file) != size)) {
+        w->err = NANODS_ERR_IO;
+        return;
+    }
+    w->pos += size;
+    const uint8_t* p = (const uint8_t*)data;
+    while (size > 0) {
+        if (w->word_len == 0 && size >= 8) {
+            w->checksum = nsnap_mix(w->checksum, nanods_load_le64(p));
+            p += 8;
+            size -= 8;
+            continue;
+        }
+        w->word |= (uint64_t)*p++ << (8 * w->word_len);
+        size--;
+        if (++w->word_len == 8) {
+            w->checksum = nsnap_mix(w->checksum, w->word);
+            w->word = 0;
+            w->word_len = 0;
+        }
+    }
+}
+
+/* Zero bytes up to the next multiple of `align` */
+static inline void nsnap_pad(NanoSnapWriter* w, size_t align) {
+    static const uint8_t zeros[64] = {0};
+    size_t rem = (size_t)(w->pos % align);
+    if (rem) nsnap_put(w, zeros, align - rem);
+}
+
+static inline int nsnap_writer_open(NanoSnapWriter* w, const char* path) {
+    static const uint8_t zeros[NANODS_SNAP_HEADER_SIZE] = {0};
+    size_t len = strlen(path);
+    w->file = NULL;
+    w->pos = NANODS_SNAP_HEADER_SIZE;
+    w->checksum = 0;
+    w->word = 0;
+    w->word_len = 0;
+    w->err = NANODS_OK;
+    w->tmp_path = (char*)NANODS_MALLOC(len + 5);
+    if (NANODS_UNLIKELY(!w->tmp_path)) return NANODS_ERR_NOMEM;
+    memcpy(w->tmp_path, path, len);
+    memcpy(w->tmp_path + len, ".tmp", 5);
+    w->file = fopen(w->tmp_path, "wb");
+    if (NANODS_UNLIKELY(!w->file ||
+                        fwrite(zeros, 1, sizeof(zeros), w->file) != sizeof(zeros))) {
+        if (w->file) fclose(w->file);
+        remove(w->tmp_path);
+        NANODS_FREE(w->tmp_path);
+        return NANODS_ERR_IO;
+    }
+    return NANODS_OK;
+}
+
+/* Fill in size and checksum, write the header, then move the file into place */
+static inline int nsnap_writer_close(NanoSnapWriter* w, NanoSnapHeader* header,
+                                     const char* path) {
+    int err = w->err;
+    if (err == NANODS_OK) {
+        header->file_size = w->pos;
+        header->checksum = w->checksum;
+        if (fseek(w->file, 0, SEEK_SET) != 0 ||
+            fwrite(header, 1, sizeof(*header), w->file) != sizeof(*header)) {
+            err = NANODS_ERR_IO;
+        }
+    }
+    if (fclose(w->file) != 0 && err == NANODS_OK) err = NANODS_ERR_IO;
+#ifdef _WIN32
+    if (err == NANODS_OK) remove(path);    /* rename does not replace on Windows */
+#endif
+    if (err == NANODS_OK && rename(w->tmp_path, path) != 0) err = NANODS_ERR_IO;
+    if (err != NANODS_OK) remove(w->tmp_path);
+    NANODS_FREE(w->tmp_path);
+    return err;
+}
+
+static inline void nsnap_header_init(NanoSnapHeader* header, NanoSnapKind kind) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, "NANOSNAP", 8);
+    header->version = NANODS_SNAPSHOT_VERSION;
+    header->byte_order = NANODS_SNAP_BYTE_ORDER;
+    header->kind = (uint32_t)kind;
+}
+
+/* Write `count` elements of `elem_size` bytes as a vector snapshot */
+static inline int nsnap_save_array(const char* path, const void* data, size_t count,
+                                   size_t elem_size) {
+    NANODS_CHECK_NULL(path, NANODS_ERR_NULL);
+    size_t bytes;
+    if (NANODS_UNLIKELY(elem_size == 0 || elem_size > UINT32_MAX ||
+                        nanods_check_mul_overflow(count, elem_size, &bytes))) {
+        return NANODS_ERR_OVERFLOW;
+    }
+    if (NANODS_UNLIKELY(bytes > 0 && !data)) return NANODS_ERR_NULL;
+    NanoSnapHeader header;
+    nsnap_header_init(&header, NANODS_SNAP_VECTOR);
+    header.elem_size = (uint32_t)elem_size;
+    header.count = count;
+    header.data_offset = NANODS_SNAP_HEADER_SIZE;
+    NanoSnapWriter w;
+    int err = nsnap_writer_open(&w, path);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    nsnap_put(&w, data, bytes);
+    nsnap_pad(&w, 8);
+    return nsnap_writer_close(&w, &header, path);
+}
+
+static inline size_t nsnap_entry_size(size_t key_len, size_t value_len) {
+    return 8 + nsnap_align8(key_len + 1) + nsnap_align8(value_len);
+}
+
+/* Values are `*(size_t*)ctx` bytes at the stored pointer (NULL values: empty) */
+static inline size_t nsnap_fixed_value(const void* value, const void** bytes, void* ctx) {
+    *bytes = value;
+    return value ? *(const size_t*)ctx : 0;
+}
+
+/**
+ * Write a NanoMap snapshot. `encode` turns each value into bytes (see
+ * NanoSnapValueFn); it is called twice per value and must return the same
+ * bytes both times. The index is built in memory: 16 bytes per slot, at most
+ * 0.75 load.
+ */
+static inline int nm_save_ex(const NanoMap* map, const char* path, NanoSnapValueFn encode,
+                             void* ctx) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(path, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(encode, NANODS_ERR_NULL);
+    size_t count = map->size;
+    size_t buckets = 16;
+    while (buckets / 4 * 3 < count) {
+        if (NANODS_UNLIKELY(nanods_check_mul_overflow(buckets, 2, &buckets))) {
+            return NANODS_ERR_OVERFLOW;
+        }
+    }
+    size_t index_bytes;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(buckets, sizeof(NanoSnapSlot), &index_bytes))) {
+        return NANODS_ERR_OVERFLOW;
+    }
+    NanoSnapSlot* slots = (NanoSnapSlot*)NANODS_MALLOC(index_bytes);
+    if (NANODS_UNLIKELY(!slots)) return NANODS_ERR_NOMEM;
+    memset(slots, 0, index_bytes);
+
+    /* Pass 1: lay the entries out and fill the index */
+    uint32_t seed = map->seed;
+    uint64_t offset = NANODS_SNAP_HEADER_SIZE + (uint64_t)index_bytes;
+    int err = NANODS_OK;
+    for (NanoMapEntry* e = nm_entry_first(map); e; e = nm_entry_next(map, e)) {
+        const void* bytes;
+        size_t value_len = encode(e->value, &bytes, ctx);
+        if (NANODS_UNLIKELY(value_len > UINT32_MAX)) {
+            err = NANODS_ERR_OVERFLOW;
+            break;
+        }
+        size_t key_len;
+        uint32_t hash = map->hash_kind == NANODS_HASH_FNV1A
+            ? e->hash : nanods_fnv1a_hash_len(e->key, seed, &key_len);
+        size_t mask = buckets - 1;
+        size_t i = hash & mask;
+        while (slots[i].offset) i = (i + 1) & mask;
+        slots[i].offset = offset;
+        slots[i].hash = hash;
+        slots[i].key_len = e->key_len;
+        offset += nsnap_entry_size(e->key_len, value_len);
+    }
+
+    /* Pass 2: stream the index and the entries in the same order */
+    NanoSnapHeader header;
+    nsnap_header_init(&header, NANODS_SNAP_MAP);
+    header.count = count;
+    header.data_offset = NANODS_SNAP_HEADER_SIZE;
+    header.bucket_count = buckets;
+    header.seed = seed;
+    NanoSnapWriter w;
+    if (err == NANODS_OK) err = nsnap_writer_open(&w, path);
+    if (err != NANODS_OK) {
+        NANODS_FREE(slots);
+        return err;
+    }
+    nsnap_put(&w, slots, index_bytes);
+    NANODS_FREE(slots);
+    for (NanoMapEntry* e = nm_entry_first(map); e; e = nm_entry_next(map, e)) {
+        const void* bytes;
+        uint32_t lens[2];
+        lens[0] = e->key_len;
+        lens[1] = (uint32_t)encode(e->value, &bytes, ctx);
+        nsnap_put(&w, lens, sizeof(lens));
+        nsnap_put(&w, e->key, (size_t)e->key_len + 1);
+        nsnap_pad(&w, 8);
+        nsnap_put(&w, bytes, lens[1]);
+        nsnap_pad(&w, 8);
+    }
+    if (w.err == NANODS_OK && w.pos != offset) w.err = NANODS_ERR_FORMAT;  /* encode changed its mind */
+    return nsnap_writer_close(&w, &header, path);
+}
+
+/* Write a snapshot whose values are `value_size` bytes each, copied from the value pointers */
+static inline int nm_save(const NanoMap* map, const char* path, size_t value_size) {
+    return nm_save_ex(map, path, nsnap_fixed_value, &value_size);
+}
+
+/* ---- Attaching -------------------------------------------------------------- */
+
+static inline int nsnap_check(const NanoSnapshot* snap) {
+    const NanoSnapHeader* h = (const NanoSnapHeader*)(const void*)snap->base;
+    if (snap->size < NANODS_SNAP_HEADER_SIZE || memcmp(h->magic, "NANOSNAP", 8) != 0 ||
+        h->version != NANODS_SNAPSHOT_VERSION || h->byte_order != NANODS_SNAP_BYTE_ORDER ||
+        h->file_size != snap->size || snap->size % 8 != 0 ||
+        h->data_offset < NANODS_SNAP_HEADER_SIZE || h->data_offset % 8 != 0 ||
+        h->data_offset > snap->size) {
+        return NANODS_ERR_FORMAT;
+    }
+    size_t room = snap->size - (size_t)h->data_offset;
+    size_t bytes;
+    if (h->kind == NANODS_SNAP_VECTOR) {
+        if (h->elem_size == 0 || nanods_check_mul_overflow((size_t)h->count, h->elem_size, &bytes) ||
+            bytes > room) {
+            return NANODS_ERR_FORMAT;
+        }
+    } else if (h->kind == NANODS_SNAP_MAP) {
+        if (h->bucket_count == 0 || (h->bucket_count & (h->bucket_count - 1)) != 0 ||
+            h->count >= h->bucket_count ||
+            nanods_check_mul_overflow((size_t)h->bucket_count, sizeof(NanoSnapSlot), &bytes) ||
+            bytes > room) {
+            return NANODS_ERR_FORMAT;
+        }
+    } else {
+        return NANODS_ERR_FORMAT;
+    }
+    return NANODS_OK;
+}
+
+/* Use a snapshot already in memory (8-byte aligned); `data` must outlive `snap` */
+static inline int nsnap_attach(NanoSnapshot* snap, const void* data, size_t size) {
+    NANODS_CHECK_NULL(snap, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(data, NANODS_ERR_NULL);
+    snap->base = (const uint8_t*)data;
+    snap->size = size;
+    snap->header = NULL;
+    snap->owned = NULL;
+    snap->mapped = 0;
+    if (NANODS_UNLIKELY((uintptr_t)data % 8 != 0)) return NANODS_ERR_BOUNDS;
+    int err = nsnap_check(snap);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    snap->header = (const NanoSnapHeader*)data;
+    return NANODS_OK;
+}
+
+static inline void nsnap_close(NanoSnapshot* snap) {
+    if (!snap) return;
+#ifdef NANODS_HAVE_MMAP
+    if (snap->mapped) munmap((void*)(uintptr_t)snap->base, snap->size);
+#endif
+    if (snap->owned) NANODS_FREE(snap->owned);
+    snap->base = NULL;
+    snap->size = 0;
+    snap->header = NULL;
+    snap->owned = NULL;
+    snap->mapped = 0;
+}
+
+/* Read the whole file into one heap block (platforms without mmap) */
+static inline int nsnap_read_file(NanoSnapshot* snap, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (NANODS_UNLIKELY(!file)) return NANODS_ERR_IO;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    if (NANODS_UNLIKELY(size < NANODS_SNAP_HEADER_SIZE || fseek(file, 0, SEEK_SET) != 0)) {
+        fclose(file);
+        return size < 0 ? NANODS_ERR_IO : NANODS_ERR_FORMAT;
+    }
+    void* data = NANODS_MALLOC((size_t)size);
+    if (NANODS_UNLIKELY(!data)) {
+        fclose(file);
+        return NANODS_ERR_NOMEM;
+    }
+    size_t got = fread(data, 1, (size_t)size, file);
+    fclose(file);
+    if (NANODS_UNLIKELY(got != (size_t)size)) {
+        NANODS_FREE(data);
+        return NANODS_ERR_IO;
+    }
+    int err = nsnap_attach(snap, data, (size_t)size);
+    snap->owned = data;
+    if (err != NANODS_OK) nsnap_close(snap);
+    return err;
+}
+
+/**
+ * Open a snapshot file read-only. On POSIX the file is mapped, so pages load
+ * on first touch and are shared between processes; elsewhere it is read into
+ * memory once. Only the header is checked here.
+ */
+static inline int nsnap_open(NanoSnapshot* snap, const char* path) {
+    NANODS_CHECK_NULL(snap, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(path, NANODS_ERR_NULL);
+    snap->base = NULL;
+    snap->size = 0;
+    snap->header = NULL;
+    snap->owned = NULL;
+    snap->mapped = 0;
+#ifdef NANODS_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (NANODS_UNLIKELY(fd < 0)) return NANODS_ERR_IO;
+    struct stat st;
+    if (NANODS_UNLIKELY(fstat(fd, &st) != 0)) {
+        close(fd);
+        return NANODS_ERR_IO;
+    }
+    if (NANODS_UNLIKELY(st.st_size < NANODS_SNAP_HEADER_SIZE)) {
+        close(fd);
+        return NANODS_ERR_FORMAT;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (NANODS_UNLIKELY(data == MAP_FAILED)) return NANODS_ERR_IO;
+    int err = nsnap_attach(snap, data, (size_t)st.st_size);
+    snap->mapped = 1;
+    if (err != NANODS_OK) nsnap_close(snap);
+    return err;
+#else
+    return nsnap_read_file(snap, path);
+#endif
+}
+
+/* Checksum the whole payload: NANODS_ERR_FORMAT if any byte changed since it was written */
+static inline int nsnap_verify(const NanoSnapshot* snap) {
+    NANODS_CHECK_NULL(snap, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(!snap->header)) return NANODS_ERR_FORMAT;
+    uint64_t h = 0;
+    for (size_t i = NANODS_SNAP_HEADER_SIZE; i < snap->size; i += 8) {
+        h = nsnap_mix(h, nanods_load_le64(snap->base + i));
+    }
+    return h == snap->header->checksum ? NANODS_OK : NANODS_ERR_FORMAT;
+}
+
+static inline size_t nsnap_count(const NanoSnapshot* snap) {
+    return (snap && snap->header) ? (size_t)snap->header->count : 0;
+}
+
+/* Elements of a vector snapshot, in place; NANODS_ERR_FORMAT for another kind or element size */
+static inline int nsnap_vector_data(const NanoSnapshot* snap, size_t elem_size,
+                                    const void** data, size_t* count) {
+    NANODS_CHECK_NULL(snap, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(data, NANODS_ERR_NULL);
+    const NanoSnapHeader* h = snap->header;
+    if (NANODS_UNLIKELY(!h || h->kind != NANODS_SNAP_VECTOR || h->elem_size != elem_size)) {
+        return NANODS_ERR_FORMAT;
+    }
+    *data = snap->base + h->data_offset;
+    if (count) *count = (size_t)h->count;
+    return NANODS_OK;
+}
+
+/*
+ * Entry record at `offset`, or NULL if it would run past the end of the file
+ * or its key is not exactly key_len bytes followed by a NUL. The lengths come
+ * from the file, so the record size is computed in 64 bits: in size_t a
+ * key_len of UINT32_MAX would wrap to a 16-byte record on 32-bit targets.
+ */
+static inline const uint8_t* nsnap_entry_at(const NanoSnapshot* snap, uint64_t offset,
+                                            uint32_t* key_len, uint32_t* value_len) {
+    if (NANODS_UNLIKELY(offset % 8 != 0 || offset > snap->size - 8)) return NULL;
+    const uint8_t* rec = snap->base + offset;
+    memcpy(key_len, rec, 4);
+    memcpy(value_len, rec + 4, 4);
+    uint64_t need = 8 + (((uint64_t)*key_len + 8) & ~(uint64_t)7) +
+                    (((uint64_t)*value_len + 7) & ~(uint64_t)7);
+    if (NANODS_UNLIKELY(need > (uint64_t)(snap->size - offset))) return NULL;
+    if (NANODS_UNLIKELY(rec[8 + (size_t)*key_len] != '\0' || memchr(rec + 8, 0, *key_len)))
+        return NULL;
+    return rec;
+}
+
+/* Value bytes for `key` straight from the snapshot (NULL if absent) */
+static inline const void* nsnap_map_get(const NanoSnapshot* snap, const char* key,
+                                        size_t* value_len) {
+    NANODS_CHECK_NULL(snap, NULL);
+    NANODS_CHECK_NULL(key, NULL);
+    const NanoSnapHeader* h = snap->header;
+    if (NANODS_UNLIKELY(!h || h->kind != NANODS_SNAP_MAP)) return NULL;
+    size_t key_len;
+    uint32_t hash = nanods_fnv1a_hash_len(key, h->seed, &key_len);
+    const NanoSnapSlot* slots = (const NanoSnapSlot*)(const void*)(snap->base + h->data_offset);
+    size_t mask = (size_t)h->bucket_count - 1;
+    size_t i = hash & mask;
+    for (size_t probes = 0; probes <= mask; probes++, i = (i + 1) & mask) {
+        const NanoSnapSlot* slot = &slots[i];
+        if (slot->offset == 0) return NULL;
+        if (slot->hash != hash || slot->key_len != key_len) continue;
+        uint32_t rec_key_len, rec_value_len;
+        const uint8_t* rec = nsnap_entry_at(snap, slot->offset, &rec_key_len, &rec_value_len);
+        if (rec && rec_key_len == key_len && memcmp(rec + 8, key, key_len) == 0) {
+            if (value_len) *value_len = rec_value_len;
+            return rec + 8 + nsnap_align8(key_len + 1);
+        }
+    }
+    return NULL;
+}
+
+static inline int nsnap_map_has(const NanoSnapshot* snap, const char* key) {
+    return nsnap_map_get(snap, key, NULL) != NULL;
+}
+
+/**
+ * Walk a map snapshot: start with *cursor = 0; NANODS_ERR_NOTFOUND after the
+ * last entry. `key` and `value` point into the snapshot.
+ */
+static inline int nsnap_map_next(const NanoSnapshot* snap, size_t* cursor, const char** key,
+                                 const void** value, size_t* value_len) {
+    NANODS_CHECK_NULL(snap, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(cursor, NANODS_ERR_NULL);
+    const NanoSnapHeader* h = snap->header;
+    if (NANODS_UNLIKELY(!h || h->kind != NANODS_SNAP_MAP)) return NANODS_ERR_FORMAT;
+    const NanoSnapSlot* slots = (const NanoSnapSlot*)(const void*)(snap->base + h->data_offset);
+    while (*cursor < h->bucket_count) {
+        const NanoSnapSlot* slot = &slots[(*cursor)++];
+        if (slot->offset == 0) continue;
+        uint32_t key_len, len;
+        const uint8_t* rec = nsnap_entry_at(snap, slot->offset, &key_len, &len);
+        if (NANODS_UNLIKELY(!rec)) return NANODS_ERR_FORMAT;
+        if (key) *key = (const char*)(rec + 8);
+        if (value) *value = rec + 8 + nsnap_align8((size_t)key_len + 1);
+        if (value_len) *value_len = len;
+        return NANODS_OK;
+    }
+    return NANODS_ERR_NOTFOUND;
+}
+
+/**
+ * Initialize `map` with every entry of a map snapshot. Keys are copied;
+ * values point into the snapshot (NULL for empty values), so it must stay
+ * open while the map is in use. On any error (another kind, a corrupt
+ * record, no memory) the map is left empty as after nm_init, with nothing
+ * to free.
+ */
+static inline int nm_load(NanoMap* map, const NanoSnapshot* snap) {
+    NANODS_CHECK_NULL(map, NANODS_ERR_NULL);
+    nm_init(map);
+    NANODS_CHECK_NULL(snap, NANODS_ERR_NULL);
+    if (NANODS_UNLIKELY(!snap->header || snap->header->kind != NANODS_SNAP_MAP)) {
+        return NANODS_ERR_FORMAT;
+    }
+    size_t buckets = 16;
+    while (buckets / 4 * 3 < nsnap_count(snap)) buckets *= 2;
+    int err = nm_init_with_capacity(map, buckets);
+    size_t cursor = 0;
+    const char* key;
+    const void* value;
+    size_t value_len;
+    while (err == NANODS_OK) {
+        err = nsnap_map_next(snap, &cursor, &key, &value, &value_len);
+        if (err == NANODS_ERR_NOTFOUND) return NANODS_OK;
+        if (err == NANODS_OK) err = nm_set(map, key, value_len ? (void*)(uintptr_t)value : NULL);
+    }
+    nm_free(map);
+    return err;
+}
+
+#define NANODS_DEFINE_VECTOR_SNAPSHOT(T)                                       \
+    static inline int nv_save_##T(const NanoVector_##T* vec, const char* path) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        return nsnap_save_array(path, vec->data, vec->size, sizeof(T));        \
+    }                                                                          \
+                                                                               \
+    /* Elements in place; NANODS_ERR_FORMAT unless this is a vector of sizeof(T) */ \
+    static inline int nv_view_##T(const NanoSnapshot* snap, const T** data, size_t* count) { \
+        const void* raw;                                                       \
+        int err = nsnap_vector_data(snap, sizeof(T), &raw, count);             \
+        if (err == NANODS_OK) *data = (const T*)raw;                           \
+        return err;                                                            \
+    }                                                                          \
+                                                                               \
+    /* Initialize `vec` with a copy of a vector snapshot */                    \
+    static inline int nv_load_##T(NanoVector_##T* vec, const NanoSnapshot* snap) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        const T* data;                                                         \
+        size_t count;                                                          \
+        int err = nv_view_##T(snap, &data, &count);                            \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        nv_init_##T(vec);                                                      \
+        return nv_extend_##T(vec, data, count);                                \
+    }
+
+NANODS_DEFINE_VECTOR_SNAPSHOT(int)
+NANODS_DEFINE_VECTOR_SNAPSHOT(float)
+NANODS_DEFINE_VECTOR_SNAPSHOT(double)
+NANODS_DEFINE_VECTOR_SNAPSHOT(char)
+
+/** @} */
+
+#endif /* NANODS_NO_SNAPSHOT */
+
+#endif /* NANODS_SNAPSHOT_IMPL_H */
@@ -0,0 +1,263 @@
+/**
+ * @file sort_impl.h
+ * @brief Sorting and binary search for NanoVector
+ */
+
+#ifndef NANODS_SORT_IMPL_H
+#define NANODS_SORT_IMPL_H
+
+/**
+ * @defgroup NanoSort Vector Sorting and Search
+ * @{
+ *
+ * NANODS_DEFINE_VECTOR_SORT_BY(T, NAME, LESS) generates an introsort and
+ * binary searches whose order is the expression LESS over `a` and `b` (true
+ * when a sorts before b), expanded inline instead of a qsort-style callback:
+ *
+ *     NANODS_DEFINE_VECTOR_SORT_BY(Point, by_x, a.x < b.x)
+ *     nv_sort_by_x_Point(&points);
+ *
+ * NANODS_DEFINE_VECTOR_SORT(T) uses `a < b` and drops NAME from the function
+ * names (nv_sort_int, nv_lower_bound_int, ...); it is predefined for every
+ * predefined vector. Introsort is not stable. For a float type under `<`, the
+ * position of NaNs is unspecified, but memory stays in bounds.
+ *
+ * nv_radix_sort_int/float/double is an LSD radix sort on the key's bytes.
+ * Signed and floating-point keys are mapped to unsigned integers that sort in
+ * the same order (flip the sign bit; for negative floats flip every bit).
+ * Passes where every key has the same byte are skipped. It needs an
+ * n-element scratch buffer from the vector's allocator.
+ */
+
+/* Ranges this short finish with insertion sort */
+#ifndef NANODS_SORT_INSERTION_THRESHOLD
+    #define NANODS_SORT_INSERTION_THRESHOLD 16
+#endif
+
+/* Introsort and binary search; S is the function suffix (T or NAME_T) */
+#define NANODS_DEFINE_VECTOR_SORT_IMPL(T, S, LESS)                             \
+    static inline int nv_sort_less_##S(T a, T b) {                             \
+        return (LESS);                                                         \
+    }                                                                          \
+                                                                               \
+    static inline void nv_sort_insertion_##S(T* data, size_t n) {              \
+        for (size_t i = 1; i < n; i++) {                                       \
+            T value = data[i];                                                 \
+            size_t j = i;                                                      \
+            while (j > 0 && nv_sort_less_##S(value, data[j - 1])) {            \
+                data[j] = data[j - 1];                                         \
+                j--;                                                           \
+            }                                                                  \
+            data[j] = value;                                                   \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void nv_sort_sift_##S(T* data, size_t root, size_t n) {      \
+        T value = data[root];                                                  \
+        for (;;) {                                                             \
+            size_t child = 2 * root + 1;                                       \
+            if (child >= n) break;                                             \
+            if (child + 1 < n && nv_sort_less_##S(data[child], data[child + 1])) child++; \
+            if (!nv_sort_less_##S(value, data[child])) break;                  \
+            data[root] = data[child];                                          \
+            root = child;                                                      \
+        }                                                                      \
+        data[root] = value;                                                    \
+    }                                                                          \
+                                                                               \
+    static inline void nv_sort_heap_##S(T* data, size_t n) {                   \
+        for (size_t i = n / 2; i-- > 0; ) nv_sort_sift_##S(data, i, n);        \
+        while (n > 1) {                                                        \
+            n--;                                                               \
+            T top = data[0];                                                   \
+            data[0] = data[n];                                                 \
+            data[n] = top;                                                     \
+            nv_sort_sift_##S(data, 0, n);                                      \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void nv_sort_range_##S(T* data, size_t n, unsigned depth) {  \
+        while (n > NANODS_SORT_INSERTION_THRESHOLD) {                          \
+            if (depth == 0) {                                                  \
+                /* Quicksort is going quadratic on this input */               \
+                nv_sort_heap_##S(data, n);                                     \
+                return;                                                        \
+            }                                                                  \
+            depth--;                                                           \
+            /* Median of three; data[n - 1] then bounds the right-to-left scan */ \
+            size_t mid = n / 2;                                                \
+            T tmp;                                                             \
+            if (nv_sort_less_##S(data[mid], data[0])) {                        \
+                tmp = data[mid]; data[mid] = data[0]; data[0] = tmp;           \
+            }                                                                  \
+            if (nv_sort_less_##S(data[n - 1], data[mid])) {                    \
+                tmp = data[n - 1]; data[n - 1] = data[mid]; data[mid] = tmp;   \
+                if (nv_sort_less_##S(data[mid], data[0])) {                    \
+                    tmp = data[mid]; data[mid] = data[0]; data[0] = tmp;       \
+                }                                                              \
+            }                                                                  \
+            T pivot = data[mid];                                               \
+            size_t i = 0, j = n - 1;                                           \
+            for (;;) {                                                         \
+                while (i < n - 1 && nv_sort_less_##S(data[i], pivot)) i++;     \
+                while (j > 0 && nv_sort_less_##S(pivot, data[j])) j--;         \
+                if (i >= j) break;                                             \
+                tmp = data[i]; data[i] = data[j]; data[j] = tmp;               \
+                i++;                                                           \
+                j--;                                                           \
+            }                                                                  \
+            /* [0, j] sorts before [j + 1, n); recurse into the smaller side */ \
+            size_t left = j + 1;                                               \
+            if (left < n - left) {                                             \
+                nv_sort_range_##S(data, left, depth);                          \
+                data += left;                                                  \
+                n -= left;                                                     \
+            } else {                                                           \
+                nv_sort_range_##S(data + left, n - left, depth);               \
+                n = left;                                                      \
+            }                                                                  \
+        }                                                                      \
+        nv_sort_insertion_##S(data, n);                                        \
+    }                                                                          \
+                                                                               \
+    /* In place, O(n log n) worst case; not stable */                          \
+    static inline void nv_sort_##S(NanoVector_##T* vec) {                      \
+        NANODS_CHECK_NULL_VOID(vec);                                           \
+        unsigned depth = 0;                                                    \
+        for (size_t n = vec->size; n > 1; n >>= 1) depth += 2;                 \
+        nv_sort_range_##S(vec->data, vec->size, depth);                        \
+    }                                                                          \
+                                                                               \
+    static inline int nv_is_sorted_##S(const NanoVector_##T* vec) {            \
+        if (!vec) return 1;                                                    \
+        for (size_t i = 1; i < vec->size; i++) {                               \
+            if (nv_sort_less_##S(vec->data[i], vec->data[i - 1])) return 0;    \
+        }                                                                      \
+        return 1;                                                              \
+    }                                                                          \
+                                                                               \
+    /* First index whose element is not before `value` (size if none) */       \
+    static inline size_t nv_lower_bound_##S(const NanoVector_##T* vec, T value) { \
+        if (!vec) return 0;                                                    \
+        const T* first = vec->data;                                            \
+        size_t len = vec->size;                                                \
+        while (len > 0) {                                                      \
+            size_t half = len / 2;                                             \
+            if (nv_sort_less_##S(first[half], value)) {                        \
+                first += half + 1;                                             \
+                len -= half + 1;                                               \
+            } else {                                                           \
+                len = half;                                                    \
+            }                                                                  \
+        }                                                                      \
+        return (size_t)(first - vec->data);                                    \
+    }                                                                          \
+                                                                               \
+    /* First index whose element sorts after `value` (size if none) */         \
+    static inline size_t nv_upper_bound_##S(const NanoVector_##T* vec, T value) { \
+        if (!vec) return 0;                                                    \
+        const T* first = vec->data;                                            \
+        size_t len = vec->size;                                                \
+        while (len > 0) {                                                      \
+            size_t half = len / 2;                                             \
+            if (!nv_sort_less_##S(value, first[half])) {                       \
+                first += half + 1;                                             \
+                len -= half + 1;                                               \
+            } else {                                                           \
+                len = half;                                                    \
+            }                                                                  \
+        }                                                                      \
+        return (size_t)(first - vec->data);                                    \
+    }                                                                          \
+                                                                               \
+    /* Index of an element equivalent to `value` in a sorted vector */         \
+    static inline int nv_bsearch_##S(const NanoVector_##T* vec, T value, size_t* index) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        size_t i = nv_lower_bound_##S(vec, value);                             \
+        if (i == vec->size || nv_sort_less_##S(value, vec->data[i])) return NANODS_ERR_NOTFOUND; \
+        if (index) *index = i;                                                 \
+        return NANODS_OK;                                                      \
+    }
+
+#define NANODS_DEFINE_VECTOR_SORT(T) NANODS_DEFINE_VECTOR_SORT_IMPL(T, T, a < b)
+#define NANODS_DEFINE_VECTOR_SORT_BY(T, NAME, LESS)                            \
+    NANODS_DEFINE_VECTOR_SORT_IMPL(T, NAME##_##T, LESS)
+
+NANODS_DEFINE_VECTOR_SORT(int)
+NANODS_DEFINE_VECTOR_SORT(float)
+NANODS_DEFINE_VECTOR_SORT(double)
+NANODS_DEFINE_VECTOR_SORT(char)
+
+/* Radix keys: unsigned integers in the same order as the values */
+static inline uint32_t nanods_radix_key_int(int value) {
+    return (uint32_t)value ^ 0x80000000u;
+}
+
+static inline uint32_t nanods_radix_key_float(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits ^ ((uint32_t)-(int32_t)(bits >> 31) | 0x80000000u);
+}
+
+static inline uint64_t nanods_radix_key_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits ^ ((uint64_t)-(int64_t)(bits >> 63) | 0x8000000000000000ull);
+}
+
+/* LSD radix sort, one byte per pass; K is the key type */
+#define NANODS_DEFINE_VECTOR_RADIX_SORT(T, K)                                  \
+    static inline int nv_radix_sort_##T(NanoVector_##T* vec) {                 \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        size_t n = vec->size;                                                  \
+        if (n < 2) return NANODS_OK;                                           \
+        size_t bytes;                                                          \
+        if (NANODS_UNLIKELY(nanods_check_mul_overflow(n, sizeof(T), &bytes)))  \
+            return NANODS_ERR_OVERFLOW;                                        \
+        T* scratch = (T*)nanods_mem_alloc(vec->alloc, bytes);                  \
+        if (NANODS_UNLIKELY(!scratch)) return NANODS_ERR_NOMEM;                \
+        /* Every histogram in one read of the data */                          \
+        size_t counts[sizeof(K)][256];                                         \
+        memset(counts, 0, sizeof(counts));                                     \
+        for (size_t i = 0; i < n; i++) {                                       \
+            K key = nanods_radix_key_##T(vec->data[i]);                        \
+            for (size_t pass = 0; pass < sizeof(K); pass++) {                  \
+                counts[pass][(key >> (8 * pass)) & 0xFF]++;                    \
+            }                                                                  \
+        }                                                                      \
+        T* src = vec->data;                                                    \
+        T* dst = scratch;                                                      \
+        for (size_t pass = 0; pass < sizeof(K); pass++) {                      \
+            size_t* count = counts[pass];                                      \
+            K first = (nanods_radix_key_##T(src[0]) >> (8 * pass)) & 0xFF;     \
+            if (count[first] == n) continue;   /* Same byte everywhere */      \
+            size_t offset = 0;                                                 \
+            for (size_t d = 0; d < 256; d++) {                                 \
+                size_t c = count[d];                                           \
+                count[d] = offset;                                             \
+                offset += c;                                                   \
+            }                                                                  \
+            for (size_t i = 0; i < n; i++) {                                   \
+                K digit = (nanods_radix_key_##T(src[i]) >> (8 * pass)) & 0xFF; \
+                dst[count[digit]++] = src[i];                                  \
+            }                                                                  \
+            T* tmp = src;                                                      \
+            src = dst;                                                         \
+            dst = tmp;                                                         \
+        }                                                                      \
+        if (src != vec->data) memcpy(vec->data, src, bytes);                   \
+        if (vec->flags & NANODS_FLAG_SECURE) {                                 \
+            nanods_mem_secure_free(vec->alloc, scratch, bytes);                \
+        } else {                                                               \
+            nanods_mem_free(vec->alloc, scratch);                              \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }
+
+NANODS_DEFINE_VECTOR_RADIX_SORT(int, uint32_t)
+NANODS_DEFINE_VECTOR_RADIX_SORT(float, uint32_t)
+NANODS_DEFINE_VECTOR_RADIX_SORT(double, uint64_t)
+
+/** @} */
+
+#endif /* NANODS_SORT_IMPL_H */
@@ -0,0 +1,136 @@
+/**
+ * @file spsc_ring_impl.h
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ */
+
+#ifndef NANODS_SPSC_RING_IMPL_H
+#define NANODS_SPSC_RING_IMPL_H
+
+#ifdef NANODS_HAVE_ATOMICS
+
+/**
+ * @defgroup NanoSpscRing Lock-free SPSC Ring Buffer
+ * @{
+ *
+ * One producer thread calls nsr_write, one consumer thread calls nsr_read /
+ * nsr_peek; no locks are taken. Each side owns one index on its own cache
+ * line and keeps a cached copy of the other side's index, so the shared line
+ * is only re-read when the ring looks full (producer) or empty (consumer).
+ * The index store is a release and the reload an acquire, which publishes
+ * the slot contents along with it.
+ *
+ * Indices run over SIZE + 1 slots with one always left empty, so the ring
+ * holds up to SIZE elements and needs no shared count.
+ * NANODS_ERR_FULL / NANODS_ERR_EMPTY are returned in every build mode, since
+ * both are routine when the two sides run concurrently.
+ */
+
+#define NANODS_DEFINE_SPSC_RING(T, SIZE)                                       \
+    typedef struct {                                                           \
+        /* Consumer cache line */                                              \
+        NANODS_ATOMIC(size_t) head;    /* Next slot to read */                 \
+        size_t tail_cache;             /* Consumer's last view of tail */      \
+        uint8_t flags;                 /* Read by the consumer only */         \
+        char pad_consumer[NANODS_CACHE_LINE - 2 * sizeof(size_t) - 1];         \
+        /* Producer cache line */                                              \
+        NANODS_ATOMIC(size_t) tail;    /* Next slot to write */                \
+        size_t head_cache;             /* Producer's last view of head */      \
+        char pad_producer[NANODS_CACHE_LINE - 2 * sizeof(size_t)];             \
+        T data[(SIZE) + 1];                                                    \
+    } NanoSpscRing_##T##_##SIZE;                                               \
+                                                                               \
+    static inline void nsr_init_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring) { \
+        NANODS_CHECK_NULL_VOID(ring);                                          \
+        NANODS_ATOMIC_STORE(&ring->head, (size_t)0, NANODS_MO_RELAXED);        \
+        NANODS_ATOMIC_STORE(&ring->tail, (size_t)0, NANODS_MO_RELAXED);        \
+        ring->tail_cache = 0;                                                  \
+        ring->head_cache = 0;                                                  \
+        ring->flags = NANODS_FLAG_NONE;                                        \
+    }                                                                          \
+                                                                               \
+    static inline void nsr_init_ex_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring, \
+                                                  uint8_t flags) {             \
+        NANODS_CHECK_NULL_VOID(ring);                                          \
+        nsr_init_##T##_##SIZE(ring);                                           \
+        ring->flags = flags;                                                   \
+    }                                                                          \
+                                                                               \
+    /* Producer only */                                                        \
+    static inline int nsr_write_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring,  \
+                                               T value) {                      \
+        NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
+        size_t tail = NANODS_ATOMIC_LOAD(&ring->tail, NANODS_MO_RELAXED);      \
+        size_t next = tail == (SIZE) ? 0 : tail + 1;                           \
+        if (NANODS_UNLIKELY(next == ring->head_cache)) {                       \
+            ring->head_cache = NANODS_ATOMIC_LOAD(&ring->head, NANODS_MO_ACQUIRE); \
+            if (next == ring->head_cache) return NANODS_ERR_FULL;              \
+        }                                                                      \
+        ring->data[tail] = value;                                              \
+        NANODS_ATOMIC_STORE(&ring->tail, next, NANODS_MO_RELEASE);             \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Consumer only */                                                        \
+    static inline int nsr_read_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring,   \
+                                              T* out) {                        \
+        NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        size_t head = NANODS_ATOMIC_LOAD(&ring->head, NANODS_MO_RELAXED);      \
+        if (NANODS_UNLIKELY(head == ring->tail_cache)) {                       \
+            ring->tail_cache = NANODS_ATOMIC_LOAD(&ring->tail, NANODS_MO_ACQUIRE); \
+            if (head == ring->tail_cache) return NANODS_ERR_EMPTY;             \
+        }                                                                      \
+        *out = ring->data[head];                                               \
+        if (ring->flags & NANODS_FLAG_SECURE) {                                \
+            memset(&ring->data[head], 0, sizeof(T));                           \
+        }                                                                      \
+        NANODS_ATOMIC_STORE(&ring->head, head == (SIZE) ? 0 : head + 1, NANODS_MO_RELEASE); \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Consumer only */                                                        \
+    static inline int nsr_peek_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring,   \
+                                              T* out) {                        \
+        NANODS_CHECK_NULL(ring, NANODS_ERR_NULL);                              \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        size_t head = NANODS_ATOMIC_LOAD(&ring->head, NANODS_MO_RELAXED);      \
+        if (head == ring->tail_cache) {                                        \
+            ring->tail_cache = NANODS_ATOMIC_LOAD(&ring->tail, NANODS_MO_ACQUIRE); \
+            if (head == ring->tail_cache) return NANODS_ERR_EMPTY;             \
+        }                                                                      \
+        *out = ring->data[head];                                               \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Exact on the calling side's own thread; a snapshot from any other */    \
+    static inline size_t nsr_size_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring) { \
+        if (!ring) return 0;                                                   \
+        size_t head = NANODS_ATOMIC_LOAD(&ring->head, NANODS_MO_ACQUIRE);      \
+        size_t tail = NANODS_ATOMIC_LOAD(&ring->tail, NANODS_MO_ACQUIRE);      \
+        return tail >= head ? tail - head : tail + (SIZE) + 1 - head;          \
+    }                                                                          \
+                                                                               \
+    static inline int nsr_is_empty_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring) { \
+        return nsr_size_##T##_##SIZE(ring) == 0;                               \
+    }                                                                          \
+                                                                               \
+    static inline int nsr_is_full_##T##_##SIZE(NanoSpscRing_##T##_##SIZE* ring) { \
+        return ring ? nsr_size_##T##_##SIZE(ring) == (SIZE) : 1;               \
+    }                                                                          \
+                                                                               \
+    static inline size_t nsr_capacity_##T##_##SIZE(const NanoSpscRing_##T##_##SIZE* ring) { \
+        return ring ? (size_t)(SIZE) : 0;                                      \
+    }
+
+/* Pre-defined SPSC rings */
+NANODS_DEFINE_SPSC_RING(int, 256)
+NANODS_DEFINE_SPSC_RING(int, 1024)
+
+typedef NanoSpscRing_int_256 IntSpscRing256;
+typedef NanoSpscRing_int_1024 IntSpscRing1024;
+
+/** @} */
+
+#endif /* NANODS_HAVE_ATOMICS */
+
+#endif /* NANODS_SPSC_RING_IMPL_H */
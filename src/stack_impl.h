@@ -17,6 +17,11 @@
         nv_init_ex_##T(stack, flags);                                          \
     }                                                                          \
                                                                                \
+    static inline void ns_init_alloc_##T(NanoStack_##T* stack, uint8_t flags,  \
+                                          const NanoCtxAllocator* alloc) {     \
+        nv_init_alloc_##T(stack, flags, alloc);                                \
+    }                                                                          \
+                                                                               \
     static inline int ns_push_##T(NanoStack_##T* stack, T value) {            \
         return nv_push_##T(stack, value);                                     \
     }                                                                          \
@@ -28,7 +33,7 @@
     static inline int ns_peek_##T(const NanoStack_##T* stack, T* out) {       \
         NANODS_CHECK_NULL(stack, NANODS_ERR_NULL);                             \
         NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
-        NANODS_CHECK_EMPTY(stack->size, NANODS_ERR_EMPTY);                    \
+        NANODS_CHECK_EMPTY_OUT(stack->size, out, NANODS_ERR_EMPTY);            \
         *out = stack->data[stack->size - 1];                                   \
         return NANODS_OK;                                                      \
     }                                                                          \
@@ -0,0 +1,134 @@
+/**
+ * @file strpool_impl.h
+ * @brief String interning pool: stable ids and cached hashes for NanoMap keys
+ */
+
+#ifndef NANODS_STRPOOL_IMPL_H
+#define NANODS_STRPOOL_IMPL_H
+
+/**
+ * @defgroup NanoStrPool String Interning Pool
+ * @{
+ *
+ * nsp_intern gives equal strings the same NanoStrId, numbered 0, 1, 2, ...
+ * in first-seen order. Each string is stored once, inline in an entry of the
+ * pool's own NanoMap; entries never move, so nsp_str pointers stay valid
+ * until nsp_free.
+ *
+ * nsp_key(pool, id) returns a NanoMapKey with the hash already computed.
+ * Pass it to nm_get_h/nm_set_h/... on any map with
+ * nm_same_hashing(&pool->index, map) to look a known key up with no hashing:
+ *
+ *     NanoStrId id;
+ *     nsp_intern(&names, "content-type", &id);      // Once, at startup
+ *     void* v = nm_get_h(&headers, nsp_key(&names, id));
+ */
+
+typedef uint32_t NanoStrId;
+#define NANODS_STR_ID_NONE UINT32_MAX
+
+typedef struct {
+    NanoMap index;             /* String -> id, stored in the value pointer */
+    NanoMapEntry** entries;    /* By id: key bytes, length and hash */
+    size_t count;
+    size_t capacity;
+} NanoStrPool;
+
+static inline void nsp_init(NanoStrPool* pool) {
+    NANODS_CHECK_NULL_VOID(pool);
+    nm_init(&pool->index);
+    pool->entries = NULL;
+    pool->count = 0;
+    pool->capacity = 0;
+}
+
+/* Flags (e.g. NANODS_FLAG_SECURE) and allocator apply to the strings and the id table */
+static inline void nsp_init_alloc(NanoStrPool* pool, uint8_t flags, const NanoCtxAllocator* alloc) {
+    NANODS_CHECK_NULL_VOID(pool);
+    nsp_init(pool);
+    nm_init_alloc(&pool->index, flags, alloc);
+}
+
+/* Id of `str`, adding it if new; *out_id may be NULL */
+static inline int nsp_intern(NanoStrPool* pool, const char* str, NanoStrId* out_id) {
+    NANODS_CHECK_NULL(pool, NANODS_ERR_NULL);
+    NANODS_CHECK_NULL(str, NANODS_ERR_NULL);
+    NanoMapKey key = nm_key(&pool->index, str);
+    NanoMapEntry* entry;
+    int inserted;
+    int err = nm_upsert_entry(&pool->index, key, &entry, &inserted);
+    if (NANODS_UNLIKELY(err != NANODS_OK)) return err;
+    if (inserted) {
+        if (NANODS_UNLIKELY(pool->count == pool->capacity)) {
+            size_t capacity = nanods_vector_grow_capacity(pool->capacity, pool->count + 1);
+            size_t bytes;
+            err = NANODS_ERR_OVERFLOW;
+            if (NANODS_LIKELY(pool->count < NANODS_STR_ID_NONE &&
+                              !nanods_check_mul_overflow(capacity, sizeof(NanoMapEntry*), &bytes))) {
+                NanoMapEntry** entries = (NanoMapEntry**)nanods_mem_realloc(
+                    pool->index.alloc, pool->entries, bytes);
+                err = entries ? NANODS_OK : NANODS_ERR_NOMEM;
+                if (entries) {
+                    pool->entries = entries;
+                    pool->capacity = capacity;
+                }
+            }
+            if (NANODS_UNLIKELY(err != NANODS_OK)) {
+                nm_remove_h(&pool->index, key);
+                return err;
+            }
+        }
+        entry->value = (void*)(uintptr_t)pool->count;
+        pool->entries[pool->count++] = entry;
+    }
+    if (out_id) *out_id = (NanoStrId)(uintptr_t)entry->value;
+    return NANODS_OK;
+}
+
+/* Id of `str` if interned, else NANODS_STR_ID_NONE; never adds */
+static inline NanoStrId nsp_find(const NanoStrPool* pool, const char* str) {
+    NANODS_CHECK_NULL(pool, NANODS_STR_ID_NONE);
+    NANODS_CHECK_NULL(str, NANODS_STR_ID_NONE);
+    void* value;
+    if (!nm_lookup(&pool->index, str, &value)) return NANODS_STR_ID_NONE;
+    return (NanoStrId)(uintptr_t)value;
+}
+
+/* Interned copy of the string (NUL-terminated), or NULL for an unknown id */
+static inline const char* nsp_str(const NanoStrPool* pool, NanoStrId id) {
+    if (!pool || id >= pool->count) return NULL;
+    return pool->entries[id]->key;
+}
+
+static inline size_t nsp_len(const NanoStrPool* pool, NanoStrId id) {
+    if (!pool || id >= pool->count) return 0;
+    return pool->entries[id]->key_len;
+}
+
+/* Pre-hashed key for the _h map calls; str is NULL for an unknown id */
+static inline NanoMapKey nsp_key(const NanoStrPool* pool, NanoStrId id) {
+    NanoMapKey key = { NULL, 0, 0 };
+    if (!pool || id >= pool->count) return key;
+    const NanoMapEntry* entry = pool->entries[id];
+    key.str = entry->key;
+    key.len = entry->key_len;
+    key.hash = entry->hash;
+    return key;
+}
+
+static inline size_t nsp_size(const NanoStrPool* pool) {
+    return pool ? pool->count : 0;
+}
+
+static inline void nsp_free(NanoStrPool* pool) {
+    if (!pool) return;
+    nanods_mem_free(pool->index.alloc, pool->entries);
+    nm_free(&pool->index);
+    pool->entries = NULL;
+    pool->count = 0;
+    pool->capacity = 0;
+}
+
+/** @} */
+
+#endif /* NANODS_STRPOOL_IMPL_H */
@@ -0,0 +1,428 @@
+/**
+ * @file thread_pool_impl.h
+ * @brief Work-stealing thread pool (opt-in: NANODS_ENABLE_THREADS)
+ */
+
+#ifndef NANODS_THREAD_POOL_IMPL_H
+#define NANODS_THREAD_POOL_IMPL_H
+
+#ifdef NANODS_HAVE_THREADS
+
+/**
+ * @defgroup NanoThreadPool Work-stealing Thread Pool
+ * @{
+ *
+ * ntp_init(pool, n) starts n - 1 workers; the thread that calls
+ * ntp_parallel_for runs tasks too while it waits, so n is the total
+ * parallelism. Each worker owns a bounded Chase-Lev deque: it pushes and pops
+ * its own tasks at the bottom, idle threads steal from the top with one CAS.
+ * Tasks spawned from outside the pool go on a mutex-protected injection list.
+ * A worker that finds nothing yields NANODS_THREAD_SPIN times, then sleeps on
+ * a condition variable until new work is published.
+ *
+ * ntp_parallel_for halves [0, n) until a piece is at most `grain` long and
+ * pushes each right half, so thieves always take the largest piece left.
+ * Task descriptors are preallocated per call; nothing is allocated per task.
+ */
+
+/* Task slots per worker deque (power of two); overflow goes to the injection list */
+#ifndef NANODS_THREAD_DEQUE_SIZE
+    #define NANODS_THREAD_DEQUE_SIZE 1024
+#endif
+
+/* Empty search rounds before an idle worker goes to sleep */
+#ifndef NANODS_THREAD_SPIN
+    #define NANODS_THREAD_SPIN 64
+#endif
+
+/* Upper bound for ntp_init's thread count */
+#ifndef NANODS_THREAD_MAX
+    #define NANODS_THREAD_MAX 256
+#endif
+
+/* Smallest piece ntp_parallel_for picks on its own (grain = 0) */
+#ifndef NANODS_PAR_MIN_GRAIN
+    #define NANODS_PAR_MIN_GRAIN 2048
+#endif
+
+typedef struct NanoTask {
+    void (*run)(struct NanoTask* task);
+    struct NanoTask* next;             /* Injection list link */
+} NanoTask;
+
+typedef struct {
+    NANODS_ATOMIC(int64_t) top;        /* Thieves take from here */
+    char pad_top[NANODS_CACHE_LINE - sizeof(int64_t)];
+    NANODS_ATOMIC(int64_t) bottom;     /* The owner pushes and pops here */
+    char pad_bottom[NANODS_CACHE_LINE - sizeof(int64_t)];
+    NANODS_ATOMIC(NanoTask*) slots[NANODS_THREAD_DEQUE_SIZE];
+} NanoWsDeque;
+
+struct NanoThreadPool;
+
+typedef struct {
+    NanoWsDeque deque;
+    struct NanoThreadPool* pool;
+    pthread_t thread;
+    size_t index;
+} NanoWorker;
+
+typedef struct NanoThreadPool {
+    NanoWorker* workers;
+    size_t num_workers;                /* Threads started by ntp_init */
+    pthread_mutex_t lock;              /* Guards the injection list and sleeping */
+    pthread_cond_t wake;
+    NanoTask* inject_head;
+    NanoTask* inject_tail;
+    NANODS_ATOMIC(size_t) inject_count;
+    NANODS_ATOMIC(size_t) sleepers;
+    NANODS_ATOMIC(int) stop;
+} NanoThreadPool;
+
+/* The worker running on this thread, if any */
+static NANODS_THREAD_LOCAL NanoWorker* g_nanods_current_worker = NULL;
+
+static inline void nws_init(NanoWsDeque* dq) {
+    NANODS_ATOMIC_STORE(&dq->top, (int64_t)0, NANODS_MO_RELAXED);
+    NANODS_ATOMIC_STORE(&dq->bottom, (int64_t)0, NANODS_MO_RELAXED);
+}
+
+/* Owner only */
+static inline int nws_push(NanoWsDeque* dq, NanoTask* task) {
+    int64_t b = NANODS_ATOMIC_LOAD(&dq->bottom, NANODS_MO_RELAXED);
+    int64_t t = NANODS_ATOMIC_LOAD(&dq->top, NANODS_MO_ACQUIRE);
+    if (NANODS_UNLIKELY(b - t >= NANODS_THREAD_DEQUE_SIZE)) return NANODS_ERR_FULL;
+    NANODS_ATOMIC_STORE(&dq->slots[b & (NANODS_THREAD_DEQUE_SIZE - 1)], task, NANODS_MO_RELAXED);
+    /* Publishes the slot; seq_cst so a worker going to sleep cannot miss it */
+    NANODS_ATOMIC_STORE(&dq->bottom, b + 1, NANODS_MO_SEQ_CST);
+    return NANODS_OK;
+}
+
+/* Owner only: newest task first */
+static inline NanoTask* nws_pop(NanoWsDeque* dq) {
+    int64_t b = NANODS_ATOMIC_LOAD(&dq->bottom, NANODS_MO_RELAXED) - 1;
+    NANODS_ATOMIC_STORE(&dq->bottom, b, NANODS_MO_SEQ_CST);
+    int64_t t = NANODS_ATOMIC_LOAD(&dq->top, NANODS_MO_SEQ_CST);
+    if (t > b) {
+        NANODS_ATOMIC_STORE(&dq->bottom, b + 1, NANODS_MO_RELAXED);
+        return NULL;
+    }
+    NanoTask* task = NANODS_ATOMIC_LOAD(&dq->slots[b & (NANODS_THREAD_DEQUE_SIZE - 1)],
+                                        NANODS_MO_RELAXED);
+    if (t == b) {
+        /* Last task: race the thieves for it */
+        if (!NANODS_ATOMIC_CAS_STRONG(&dq->top, &t, t + 1, NANODS_MO_SEQ_CST, NANODS_MO_RELAXED))
+            task = NULL;
+        NANODS_ATOMIC_STORE(&dq->bottom, b + 1, NANODS_MO_RELAXED);
+    }
+    return task;
+}
+
+/* Any thread: oldest task first; NULL when empty or another thief won */
+static inline NanoTask* nws_steal(NanoWsDeque* dq) {
+    int64_t t = NANODS_ATOMIC_LOAD(&dq->top, NANODS_MO_SEQ_CST);
+    int64_t b = NANODS_ATOMIC_LOAD(&dq->bottom, NANODS_MO_SEQ_CST);
+    if (t >= b) return NULL;
+    NanoTask* task = NANODS_ATOMIC_LOAD(&dq->slots[t & (NANODS_THREAD_DEQUE_SIZE - 1)],
+                                        NANODS_MO_RELAXED);
+    if (!NANODS_ATOMIC_CAS_STRONG(&dq->top, &t, t + 1, NANODS_MO_SEQ_CST, NANODS_MO_RELAXED))
+        return NULL;
+    return task;
+}
+
+static inline int nws_is_empty(NanoWsDeque* dq) {
+    return NANODS_ATOMIC_LOAD(&dq->top, NANODS_MO_SEQ_CST) >=
+           NANODS_ATOMIC_LOAD(&dq->bottom, NANODS_MO_SEQ_CST);
+}
+
+/* Threads that run tasks: the workers plus the waiting caller */
+static inline size_t ntp_size(const NanoThreadPool* pool) {
+    return pool ? pool->num_workers + 1 : 1;
+}
+
+static inline NanoWorker* ntp_self(NanoThreadPool* pool) {
+    NanoWorker* w = g_nanods_current_worker;
+    return (w && w->pool == pool) ? w : NULL;
+}
+
+static inline int ntp_has_work(NanoThreadPool* pool) {
+    if (NANODS_ATOMIC_LOAD(&pool->inject_count, NANODS_MO_SEQ_CST) > 0) return 1;
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        if (!nws_is_empty(&pool->workers[i].deque)) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Queue `task` for any thread of the pool: on the calling worker's deque,
+ * else (outside the pool, or deque full) on the injection list.
+ */
+static inline void ntp_spawn(NanoThreadPool* pool, NanoTask* task) {
+    NanoWorker* self = ntp_self(pool);
+    if (self && nws_push(&self->deque, task) == NANODS_OK) {
+        if (NANODS_ATOMIC_LOAD(&pool->sleepers, NANODS_MO_SEQ_CST) > 0) {
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->wake);
+            pthread_mutex_unlock(&pool->lock);
+        }
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    task->next = NULL;
+    if (pool->inject_tail) {
+        pool->inject_tail->next = task;
+    } else {
+        pool->inject_head = task;
+    }
+    pool->inject_tail = task;
+    NANODS_ATOMIC_FETCH_ADD(&pool->inject_count, (size_t)1, NANODS_MO_SEQ_CST);
+    if (NANODS_ATOMIC_LOAD(&pool->sleepers, NANODS_MO_RELAXED) > 0) pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static inline NanoTask* ntp_take_injected(NanoThreadPool* pool) {
+    if (NANODS_ATOMIC_LOAD(&pool->inject_count, NANODS_MO_RELAXED) == 0) return NULL;
+    pthread_mutex_lock(&pool->lock);
+    NanoTask* task = pool->inject_head;
+    if (task) {
+        pool->inject_head = task->next;
+        if (!pool->inject_head) pool->inject_tail = NULL;
+        NANODS_ATOMIC_FETCH_SUB(&pool->inject_count, (size_t)1, NANODS_MO_RELAXED);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return task;
+}
+
+/* One search round: own deque, injection list, then the other workers' deques */
+static inline NanoTask* ntp_find_task(NanoThreadPool* pool, NanoWorker* self) {
+    NanoTask* task;
+    if (self && (task = nws_pop(&self->deque)) != NULL) return task;
+    if ((task = ntp_take_injected(pool)) != NULL) return task;
+    size_t n = pool->num_workers;
+    size_t start = self ? self->index + 1 : 0;
+    for (size_t i = 0; i < n; i++) {
+        NanoWorker* victim = &pool->workers[(start + i) % n];
+        if (victim == self) continue;
+        if ((task = nws_steal(&victim->deque)) != NULL) return task;
+    }
+    return NULL;
+}
+
+static inline void* ntp_worker_main(void* arg) {
+    NanoWorker* self = (NanoWorker*)arg;
+    NanoThreadPool* pool = self->pool;
+    g_nanods_current_worker = self;
+    unsigned idle = 0;
+    while (!NANODS_ATOMIC_LOAD(&pool->stop, NANODS_MO_ACQUIRE)) {
+        NanoTask* task = ntp_find_task(pool, self);
+        if (task) {
+            task->run(task);
+            idle = 0;
+            continue;
+        }
+        if (++idle < NANODS_THREAD_SPIN) {
+            sched_yield();
+            continue;
+        }
+        /* Announce the sleeper before the last look; pairs with ntp_spawn */
+        pthread_mutex_lock(&pool->lock);
+        NANODS_ATOMIC_FETCH_ADD(&pool->sleepers, (size_t)1, NANODS_MO_SEQ_CST);
+        while (!NANODS_ATOMIC_LOAD(&pool->stop, NANODS_MO_RELAXED) && !ntp_has_work(pool)) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        NANODS_ATOMIC_FETCH_SUB(&pool->sleepers, (size_t)1, NANODS_MO_SEQ_CST);
+        pthread_mutex_unlock(&pool->lock);
+        idle = 0;
+    }
+    g_nanods_current_worker = NULL;
+    return NULL;
+}
+
+static inline void ntp_shutdown(NanoThreadPool* pool, size_t started) {
+    pthread_mutex_lock(&pool->lock);
+    NANODS_ATOMIC_STORE(&pool->stop, 1, NANODS_MO_RELEASE);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    NANODS_FREE(pool->workers);
+    pool->workers = NULL;
+    pool->num_workers = 0;
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/**
+ * Start a pool running `num_threads` threads in total (0: one per online CPU).
+ * num_threads = 1 starts no workers; every parallel call then runs inline.
+ */
+static inline int ntp_init(NanoThreadPool* pool, size_t num_threads) {
+    NANODS_CHECK_NULL(pool, NANODS_ERR_NULL);
+    if (num_threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = online > 0 ? (size_t)online : 1;
+    }
+    if (num_threads > NANODS_THREAD_MAX) num_threads = NANODS_THREAD_MAX;
+    pool->workers = NULL;
+    pool->num_workers = 0;
+    pool->inject_head = NULL;
+    pool->inject_tail = NULL;
+    NANODS_ATOMIC_STORE(&pool->inject_count, (size_t)0, NANODS_MO_RELAXED);
+    NANODS_ATOMIC_STORE(&pool->sleepers, (size_t)0, NANODS_MO_RELAXED);
+    NANODS_ATOMIC_STORE(&pool->stop, 0, NANODS_MO_RELAXED);
+    if (NANODS_UNLIKELY(pthread_mutex_init(&pool->lock, NULL) != 0)) return NANODS_ERR_NOMEM;
+    if (NANODS_UNLIKELY(pthread_cond_init(&pool->wake, NULL) != 0)) {
+        pthread_mutex_destroy(&pool->lock);
+        return NANODS_ERR_NOMEM;
+    }
+    size_t workers = num_threads - 1;
+    if (workers == 0) return NANODS_OK;
+    pool->workers = (NanoWorker*)NANODS_MALLOC(workers * sizeof(NanoWorker));
+    if (NANODS_UNLIKELY(!pool->workers)) {
+        ntp_shutdown(pool, 0);
+        return NANODS_ERR_NOMEM;
+    }
+    for (size_t i = 0; i < workers; i++) {
+        nws_init(&pool->workers[i].deque);
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+    }
+    /* Every deque is valid before the first thread starts stealing */
+    pool->num_workers = workers;
+    for (size_t i = 0; i < workers; i++) {
+        if (NANODS_UNLIKELY(pthread_create(&pool->workers[i].thread, NULL,
+                                           ntp_worker_main, &pool->workers[i]) != 0)) {
+            ntp_shutdown(pool, i);
+            return NANODS_ERR_NOMEM;
+        }
+    }
+    return NANODS_OK;
+}
+
+/**
+ * Stop and join the workers. No parallel call may be in flight.
+ */
+static inline void ntp_free(NanoThreadPool* pool) {
+    if (!pool) return;
+    ntp_shutdown(pool, pool->num_workers);
+}
+
+/* Process [begin, end) of the range; called concurrently on disjoint pieces */
+typedef void (*NanoRangeFn)(size_t begin, size_t end, void* ctx);
+
+struct NanoRangeJob;
+
+typedef struct {
+    NanoTask base;
+    struct NanoRangeJob* job;
+    size_t begin;
+    size_t end;
+} NanoRangeTask;
+
+typedef struct NanoRangeJob {
+    NanoThreadPool* pool;
+    NanoRangeFn body;
+    void* ctx;
+    size_t grain;
+    NanoRangeTask* tasks;              /* One descriptor per split */
+    size_t max_tasks;
+    NANODS_ATOMIC(size_t) next_task;
+    NANODS_ATOMIC(size_t) remaining;   /* Elements not processed yet */
+} NanoRangeJob;
+
+static inline void ntp_range_run(NanoTask* task) {
+    NanoRangeTask* piece = (NanoRangeTask*)task;
+    NanoRangeJob* job = piece->job;
+    size_t begin = piece->begin;
+    size_t end = piece->end;
+    while (end - begin > job->grain) {
+        size_t slot = NANODS_ATOMIC_FETCH_ADD(&job->next_task, (size_t)1, NANODS_MO_RELAXED);
+        if (NANODS_UNLIKELY(slot >= job->max_tasks)) break;
+        size_t mid = begin + (end - begin) / 2;
+        NanoRangeTask* right = &job->tasks[slot];
+        right->base.run = ntp_range_run;
+        right->job = job;
+        right->begin = mid;
+        right->end = end;
+        ntp_spawn(job->pool, &right->base);
+        end = mid;
+    }
+    job->body(begin, end, job->ctx);
+    /* Last use of job: the caller may return as soon as this hits zero */
+    NANODS_ATOMIC_FETCH_SUB(&job->remaining, end - begin, NANODS_MO_RELEASE);
+}
+
+/**
+ * Run body over [0, n) in pieces of at most `grain` elements (0: picked from
+ * n and the thread count) and return once every piece is done. The caller
+ * runs pieces too. A NULL pool, or one without workers, runs body(0, n) inline.
+ */
+static inline int ntp_parallel_for(NanoThreadPool* pool, size_t n, size_t grain,
+                                   NanoRangeFn body, void* ctx) {
+    NANODS_CHECK_NULL(body, NANODS_ERR_NULL);
+    if (n == 0) return NANODS_OK;
+    if (grain == 0) {
+        grain = n / (ntp_size(pool) * 8);
+        if (grain < NANODS_PAR_MIN_GRAIN) grain = NANODS_PAR_MIN_GRAIN;
+    }
+    if (!pool || pool->num_workers == 0 || n <= grain) {
+        body(0, n, ctx);
+        return NANODS_OK;
+    }
+    NanoRangeJob job;
+    job.pool = pool;
+    job.body = body;
+    job.ctx = ctx;
+    job.grain = grain;
+    /* Pieces are longer than grain / 2, so there are fewer than 2n / grain + 1 */
+    job.max_tasks = (n / grain + 1) * 2;
+    size_t bytes;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(job.max_tasks, sizeof(NanoRangeTask), &bytes)))
+        return NANODS_ERR_OVERFLOW;
+    job.tasks = (NanoRangeTask*)NANODS_MALLOC(bytes);
+    if (NANODS_UNLIKELY(!job.tasks)) return NANODS_ERR_NOMEM;
+    NANODS_ATOMIC_STORE(&job.next_task, (size_t)0, NANODS_MO_RELAXED);
+    NANODS_ATOMIC_STORE(&job.remaining, n, NANODS_MO_RELAXED);
+
+    NanoRangeTask root;
+    root.base.run = ntp_range_run;
+    root.job = &job;
+    root.begin = 0;
+    root.end = n;
+    ntp_range_run(&root.base);
+
+    /* Help until every piece has finished, including those stolen from us */
+    NanoWorker* self = ntp_self(pool);
+    while (NANODS_ATOMIC_LOAD(&job.remaining, NANODS_MO_ACQUIRE) != 0) {
+        NanoTask* task = ntp_find_task(pool, self);
+        if (task) {
+            task->run(task);
+        } else {
+            sched_yield();
+        }
+    }
+    NANODS_FREE(job.tasks);
+    return NANODS_OK;
+}
+
+/* Fixed partition of n elements into `chunks` near-equal parts: start of part c */
+static inline size_t ntp_chunk_begin(size_t n, size_t chunks, size_t c) {
+    size_t q = n / chunks;
+    size_t r = n % chunks;
+    return c * q + (c < r ? c : r);
+}
+
+/* Parts for algorithms that keep per-part results (reduce, filter, sort) */
+static inline size_t ntp_chunk_count(const NanoThreadPool* pool, size_t n) {
+    size_t chunks = (n + NANODS_PAR_MIN_GRAIN - 1) / NANODS_PAR_MIN_GRAIN;
+    size_t limit = (pool && pool->num_workers > 0) ? ntp_size(pool) * 8 : 1;
+    if (chunks > limit) chunks = limit;
+    return chunks ? chunks : 1;
+}
+
+/** @} */
+
+#endif /* NANODS_HAVE_THREADS */
+
+#endif /* NANODS_THREAD_POOL_IMPL_H */
@@ -0,0 +1,263 @@
+/**
+ * @file typed_map_impl.h
+ * @brief Macro-generated typed hash map for integer and POD keys
+ */
+
+#ifndef NANODS_TYPED_MAP_IMPL_H
+#define NANODS_TYPED_MAP_IMPL_H
+
+/**
+ * @defgroup NanoTypedMap Typed Hash Map
+ * @{
+ *
+ * NANODS_DEFINE_MAP(K, V) generates NanoMap_K_V with keys and values stored
+ * inline in one open-addressing table (linear probing, 3/4 max load).
+ * K and V must be single identifiers; typedef compound types first.
+ *
+ * NANODS_DEFINE_MAP_EX(K, V, HASH, EQ) takes custom macros:
+ *   HASH(key, seed) -> uint64_t    EQ(a, b) -> nonzero when equal
+ */
+
+/* Integer keys: seeded fmix64 mixer */
+#define NANODS_MAP_HASH_INT(key, seed) nanods_hash_u64((uint64_t)(key), (seed))
+#define NANODS_MAP_EQ_INT(a, b) ((a) == (b))
+
+/* POD keys: hashes and compares the raw bytes, so zero any padding first */
+#define NANODS_MAP_HASH_POD(key, seed) nanods_wyhash(&(key), sizeof(key), (seed))
+#define NANODS_MAP_EQ_POD(a, b) (memcmp(&(a), &(b), sizeof(a)) == 0)
+
+#define NANODS_DEFINE_MAP_EX(K, V, HASH, EQ)                                   \
+    typedef struct {                                                           \
+        K key;                                                                 \
+        V value;                                                               \
+    } NanoMapSlot_##K##_##V;                                                   \
+                                                                               \
+    typedef struct {                                                           \
+        NanoMapSlot_##K##_##V* slots;  /* One block: slots, then ctrl bytes */ \
+        uint8_t* ctrl;                 /* 0 = empty, 0x80 | 7-bit tag = full */ \
+        size_t capacity;               /* Power of two */                      \
+        size_t size;                                                           \
+        const NanoCtxAllocator* alloc;  /* NULL: global allocator */           \
+        uint32_t seed;                                                         \
+        uint8_t flags;                                                         \
+    } NanoMap_##K##_##V;                                                       \
+                                                                               \
+    typedef struct {                                                           \
+        const NanoMap_##K##_##V* map;                                          \
+        size_t index;                                                          \
+    } NanoMapIterator_##K##_##V;                                               \
+                                                                               \
+    static inline void nm_init_##K##_##V(NanoMap_##K##_##V* map) {             \
+        NANODS_CHECK_NULL_VOID(map);                                           \
+        map->slots = NULL;                                                     \
+        map->ctrl = NULL;                                                      \
+        map->capacity = 0;                                                     \
+        map->size = 0;                                                         \
+        map->alloc = NULL;                                                     \
+        map->seed = nanods_get_seed();                                         \
+        map->flags = NANODS_FLAG_NONE;                                         \
+    }                                                                          \
+                                                                               \
+    static inline void nm_init_ex_##K##_##V(NanoMap_##K##_##V* map, uint8_t flags) { \
+        NANODS_CHECK_NULL_VOID(map);                                           \
+        nm_init_##K##_##V(map);                                                \
+        map->flags = flags;                                                    \
+    }                                                                          \
+                                                                               \
+    /* Use `alloc` (with its ctx) for the table instead of the global allocator */ \
+    static inline void nm_init_alloc_##K##_##V(NanoMap_##K##_##V* map, uint8_t flags, \
+                                               const NanoCtxAllocator* alloc) { \
+        NANODS_CHECK_NULL_VOID(map);                                           \
+        nm_init_ex_##K##_##V(map, flags);                                      \
+        map->alloc = alloc;                                                    \
+    }                                                                          \
+                                                                               \
+    static inline void nm_release_##K##_##V(NanoMap_##K##_##V* map) {          \
+        if (!map->slots) return;                                               \
+        if (map->flags & NANODS_FLAG_SECURE) {                                 \
+            nanods_mem_secure_free(map->alloc, map->slots,                     \
+                                   map->capacity * (sizeof(NanoMapSlot_##K##_##V) + 1)); \
+        } else {                                                               \
+            nanods_mem_free(map->alloc, map->slots);                           \
+        }                                                                      \
+        map->slots = NULL;                                                     \
+        map->ctrl = NULL;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Index of `key`, or SIZE_MAX if absent. Load <= 3/4 keeps an empty slot */ \
+    static inline size_t nm_find_##K##_##V(const NanoMap_##K##_##V* map, K key, uint64_t hash) { \
+        if (map->capacity == 0) return SIZE_MAX;                               \
+        size_t mask = map->capacity - 1;                                       \
+        size_t i = (size_t)hash & mask;                                        \
+        uint8_t tag = (uint8_t)(0x80 | (hash >> 57));                          \
+        while (map->ctrl[i] != 0) {                                            \
+            if (map->ctrl[i] == tag && EQ(map->slots[i].key, key)) return i;   \
+            i = (i + 1) & mask;                                                \
+        }                                                                      \
+        return SIZE_MAX;                                                       \
+    }                                                                          \
+                                                                               \
+    static inline void nm_place_##K##_##V(NanoMap_##K##_##V* map, const NanoMapSlot_##K##_##V* slot, uint64_t hash) { \
+        size_t mask = map->capacity - 1;                                       \
+        size_t i = (size_t)hash & mask;                                        \
+        while (map->ctrl[i] != 0) i = (i + 1) & mask;                          \
+        map->ctrl[i] = (uint8_t)(0x80 | (hash >> 57));                         \
+        map->slots[i] = *slot;                                                 \
+    }                                                                          \
+                                                                               \
+    static inline int nm_rehash_##K##_##V(NanoMap_##K##_##V* map, size_t new_capacity) { \
+        size_t byte_size;                                                      \
+        if (NANODS_UNLIKELY(nanods_check_mul_overflow(new_capacity, sizeof(NanoMapSlot_##K##_##V) + 1, &byte_size))) \
+            return NANODS_ERR_OVERFLOW;                                        \
+        uint8_t* block = (uint8_t*)nanods_mem_alloc(map->alloc, byte_size);    \
+        if (NANODS_UNLIKELY(!block)) return NANODS_ERR_NOMEM;                  \
+        NanoMap_##K##_##V old = *map;                                          \
+        map->slots = (NanoMapSlot_##K##_##V*)(void*)block;                     \
+        map->ctrl = block + new_capacity * sizeof(NanoMapSlot_##K##_##V);      \
+        map->capacity = new_capacity;                                          \
+        memset(map->ctrl, 0, new_capacity);                                    \
+        for (size_t i = 0; i < old.capacity; i++) {                            \
+            if (old.ctrl[i] == 0) continue;                                    \
+            nm_place_##K##_##V(map, &old.slots[i], HASH(old.slots[i].key, map->seed)); \
+        }                                                                      \
+        nm_release_##K##_##V(&old);                                            \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Size the table so `expected` entries fit without growing */             \
+    static inline int nm_reserve_##K##_##V(NanoMap_##K##_##V* map, size_t expected) { \
+        NANODS_CHECK_NULL(map, NANODS_ERR_NULL);                               \
+        size_t capacity = 16;                                                  \
+        while (capacity / NANODS_MAP_LOAD_DEN * NANODS_MAP_LOAD_NUM < expected) { \
+            if (NANODS_UNLIKELY(capacity > SIZE_MAX / 2)) return NANODS_ERR_OVERFLOW; \
+            capacity *= 2;                                                     \
+        }                                                                      \
+        if (capacity <= map->capacity) return NANODS_OK;                       \
+        return nm_rehash_##K##_##V(map, capacity);                             \
+    }                                                                          \
+                                                                               \
+    static inline int nm_set_##K##_##V(NanoMap_##K##_##V* map, K key, V value) { \
+        NANODS_CHECK_NULL(map, NANODS_ERR_NULL);                               \
+        uint64_t hash = HASH(key, map->seed);                                  \
+        size_t idx = nm_find_##K##_##V(map, key, hash);                        \
+        if (idx != SIZE_MAX) {                                                 \
+            map->slots[idx].value = value;                                     \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        if (NANODS_UNLIKELY((map->size + 1) * NANODS_MAP_LOAD_DEN > map->capacity * NANODS_MAP_LOAD_NUM)) { \
+            if (NANODS_UNLIKELY(map->capacity > SIZE_MAX / 2)) return NANODS_ERR_OVERFLOW; \
+            int err = nm_rehash_##K##_##V(map, map->capacity ? map->capacity * 2 : 16); \
+            if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                 \
+        }                                                                      \
+        NanoMapSlot_##K##_##V slot;                                            \
+        slot.key = key;                                                        \
+        slot.value = value;                                                    \
+        nm_place_##K##_##V(map, &slot, hash);                                  \
+        map->size++;                                                           \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int nm_get_##K##_##V(const NanoMap_##K##_##V* map, K key, V* out) { \
+        NANODS_CHECK_NULL(map, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        size_t idx = nm_find_##K##_##V(map, key, HASH(key, map->seed));        \
+        if (idx == SIZE_MAX) return NANODS_ERR_NOTFOUND;                       \
+        *out = map->slots[idx].value;                                          \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Pointer to the stored value, valid until the next insert or remove */   \
+    static inline V* nm_get_ptr_##K##_##V(NanoMap_##K##_##V* map, K key) {     \
+        NANODS_CHECK_NULL(map, NULL);                                          \
+        size_t idx = nm_find_##K##_##V(map, key, HASH(key, map->seed));        \
+        return idx == SIZE_MAX ? NULL : &map->slots[idx].value;                \
+    }                                                                          \
+                                                                               \
+    static inline int nm_has_##K##_##V(const NanoMap_##K##_##V* map, K key) {  \
+        NANODS_CHECK_NULL(map, 0);                                             \
+        return nm_find_##K##_##V(map, key, HASH(key, map->seed)) != SIZE_MAX;  \
+    }                                                                          \
+                                                                               \
+    /* Backward-shift deletion: no tombstones, probe chains stay short */      \
+    static inline int nm_remove_##K##_##V(NanoMap_##K##_##V* map, K key) {     \
+        NANODS_CHECK_NULL(map, NANODS_ERR_NULL);                               \
+        size_t hole = nm_find_##K##_##V(map, key, HASH(key, map->seed));       \
+        if (hole == SIZE_MAX) return NANODS_ERR_NOTFOUND;                      \
+        size_t mask = map->capacity - 1;                                       \
+        for (size_t j = (hole + 1) & mask; map->ctrl[j] != 0; j = (j + 1) & mask) { \
+            size_t home = (size_t)HASH(map->slots[j].key, map->seed) & mask;   \
+            if (((j - home) & mask) >= ((j - hole) & mask)) {                  \
+                map->slots[hole] = map->slots[j];                              \
+                map->ctrl[hole] = map->ctrl[j];                                \
+                hole = j;                                                      \
+            }                                                                  \
+        }                                                                      \
+        map->ctrl[hole] = 0;                                                   \
+        if (map->flags & NANODS_FLAG_SECURE) {                                 \
+            memset(&map->slots[hole], 0, sizeof(NanoMapSlot_##K##_##V));       \
+        }                                                                      \
+        map->size--;                                                           \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline size_t nm_size_##K##_##V(const NanoMap_##K##_##V* map) {     \
+        return map ? map->size : 0;                                            \
+    }                                                                          \
+                                                                               \
+    static inline int nm_empty_##K##_##V(const NanoMap_##K##_##V* map) {       \
+        return map ? (map->size == 0) : 1;                                     \
+    }                                                                          \
+                                                                               \
+    static inline void nm_clear_##K##_##V(NanoMap_##K##_##V* map) {            \
+        if (!map || map->capacity == 0) return;                                \
+        if (map->flags & NANODS_FLAG_SECURE) {                                 \
+            memset(map->slots, 0, map->capacity * sizeof(NanoMapSlot_##K##_##V)); \
+        }                                                                      \
+        memset(map->ctrl, 0, map->capacity);                                   \
+        map->size = 0;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline void nm_free_##K##_##V(NanoMap_##K##_##V* map) {             \
+        if (!map) return;                                                      \
+        nm_release_##K##_##V(map);                                             \
+        map->capacity = 0;                                                     \
+        map->size = 0;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline void nm_secure_free_##K##_##V(NanoMap_##K##_##V* map) {      \
+        if (!map) return;                                                      \
+        uint8_t flags = map->flags;                                            \
+        map->flags |= NANODS_FLAG_SECURE;                                      \
+        nm_free_##K##_##V(map);                                                \
+        map->flags = flags;                                                    \
+    }                                                                          \
+                                                                               \
+    static inline void nm_iter_init_##K##_##V(NanoMapIterator_##K##_##V* iter, const NanoMap_##K##_##V* map) { \
+        NANODS_CHECK_NULL_VOID(iter);                                          \
+        iter->map = map;                                                       \
+        iter->index = 0;                                                       \
+    }                                                                          \
+                                                                               \
+    static inline int nm_iter_next_##K##_##V(NanoMapIterator_##K##_##V* iter, K* out_key, V* out_value) { \
+        NANODS_CHECK_NULL(iter, NANODS_ERR_NULL);                              \
+        const NanoMap_##K##_##V* map = iter->map;                              \
+        while (map && iter->index < map->capacity) {                           \
+            size_t i = iter->index++;                                          \
+            if (map->ctrl[i] == 0) continue;                                   \
+            if (out_key) *out_key = map->slots[i].key;                         \
+            if (out_value) *out_value = map->slots[i].value;                   \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        return NANODS_ERR_EMPTY;                                               \
+    }
+
+#define NANODS_DEFINE_MAP(K, V) \
+    NANODS_DEFINE_MAP_EX(K, V, NANODS_MAP_HASH_INT, NANODS_MAP_EQ_INT)
+
+/* Pre-defined common types */
+NANODS_DEFINE_MAP(int, int)
+NANODS_DEFINE_MAP(uint64_t, uint64_t)
+
+/** @} */
+
+#endif /* NANODS_TYPED_MAP_IMPL_H */
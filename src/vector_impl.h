@@ -11,12 +11,41 @@
  * @{
  */
 
+/* Capacity grows by NUM/DEN (default 2x) when a push or bulk append needs room */
+#ifndef NANODS_VECTOR_GROWTH_NUM
+    #define NANODS_VECTOR_GROWTH_NUM 2
+#endif
+#ifndef NANODS_VECTOR_GROWTH_DEN
+    #define NANODS_VECTOR_GROWTH_DEN 1
+#endif
+
+/* First allocation of an empty vector */
+#ifndef NANODS_VECTOR_MIN_CAPACITY
+    #define NANODS_VECTOR_MIN_CAPACITY 8
+#endif
+
+/**
+ * Next capacity for a vector holding `capacity` slots that needs `needed`:
+ * the geometric step, or exactly `needed` when that is larger
+ */
+static inline size_t nanods_vector_grow_capacity(size_t capacity, size_t needed) {
+    size_t grown;
+    if (NANODS_UNLIKELY(nanods_check_mul_overflow(capacity, NANODS_VECTOR_GROWTH_NUM, &grown))) {
+        grown = SIZE_MAX;
+    }
+    grown /= NANODS_VECTOR_GROWTH_DEN;
+    if (grown < NANODS_VECTOR_MIN_CAPACITY) grown = NANODS_VECTOR_MIN_CAPACITY;
+    return grown > needed ? grown : needed;
+}
+
 #define NANODS_DEFINE_VECTOR(T)                                                \
     typedef struct {                                                           \
         T* data;                                                               \
         size_t size;                                                           \
         size_t capacity;                                                       \
+        const NanoCtxAllocator* alloc;    /* NULL: global allocator */         \
         uint8_t flags;                                                         \
+        NANODS_STATS_MEMBER                                                    \
     } NanoVector_##T;                                                          \
                                                                                \
     static inline void nv_init_##T(NanoVector_##T* vec) {                     \
@@ -25,6 +54,8 @@
         vec->size = 0;                                                         \
         vec->capacity = 0;                                                     \
         vec->flags = NANODS_FLAG_NONE;                                         \
+        vec->alloc = NULL;                                                     \
+        NANODS_STAT_INIT(vec);                                                 \
     }                                                                          \
                                                                                \
     static inline void nv_init_ex_##T(NanoVector_##T* vec, uint8_t flags) {   \
@@ -33,6 +64,16 @@
         vec->size = 0;                                                         \
         vec->capacity = 0;                                                     \
         vec->flags = flags;                                                    \
+        vec->alloc = NULL;                                                     \
+        NANODS_STAT_INIT(vec);                                                 \
+    }                                                                          \
+                                                                               \
+    /* Use `alloc` (with its ctx) for this vector instead of the global allocator */ \
+    static inline void nv_init_alloc_##T(NanoVector_##T* vec, uint8_t flags,   \
+                                          const NanoCtxAllocator* alloc) {     \
+        NANODS_CHECK_NULL_VOID(vec);                                           \
+        nv_init_ex_##T(vec, flags);                                            \
+        vec->alloc = alloc;                                                    \
     }                                                                          \
                                                                                \
     static inline int nv_reserve_##T(NanoVector_##T* vec, size_t new_capacity) { \
@@ -41,22 +82,139 @@
         size_t byte_size;                                                      \
         if (NANODS_UNLIKELY(nanods_check_mul_overflow(new_capacity, sizeof(T), &byte_size))) \
             return NANODS_ERR_OVERFLOW;                                        \
-        T* new_data = (T*)NANODS_REALLOC(vec->data, byte_size);               \
+        T* new_data = (T*)nanods_mem_realloc(vec->alloc, vec->data, byte_size); \
         if (NANODS_UNLIKELY(! new_data)) return NANODS_ERR_NOMEM;              \
+        NANODS_STAT_LOCAL(vec, allocs, 1);                                     \
+        NANODS_STAT_LOCAL(vec, bytes, byte_size);                              \
+        NANODS_STAT_ADD(vec, reallocs, 1);                                     \
         vec->data = new_data;                                                  \
         vec->capacity = new_capacity;                                          \
         return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
-    static inline int nv_push_##T(NanoVector_##T* vec, T value) {             \
+    /* Make room for `extra` more elements, growing geometrically */           \
+    static inline int nv_grow_##T(NanoVector_##T* vec, size_t extra) {         \
+        size_t needed;                                                         \
+        if (NANODS_UNLIKELY(nanods_check_add_overflow(vec->size, extra, &needed))) \
+            return NANODS_ERR_OVERFLOW;                                        \
+        NANODS_STAT_PEAK(vec, needed);                                         \
+        if (NANODS_LIKELY(needed <= vec->capacity)) return NANODS_OK;          \
+        return nv_reserve_##T(vec, nanods_vector_grow_capacity(vec->capacity, needed)); \
+    }                                                                          \
+                                                                               \
+    static inline int nv_push_##T(NanoVector_##T* vec, T value) {              \
         NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
         if (NANODS_UNLIKELY(vec->size >= vec->capacity)) {                     \
-            size_t new_capacity = vec->capacity == 0 ? 8 : vec->capacity * 2; \
-            if (NANODS_UNLIKELY(new_capacity < vec->capacity)) return NANODS_ERR_OVERFLOW; \
-            int err = nv_reserve_##T(vec, new_capacity);                      \
+            int err = nv_grow_##T(vec, 1);                                     \
             if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                 \
         }                                                                      \
         vec->data[vec->size++] = value;                                        \
+        NANODS_STAT_PEAK(vec, vec->size);                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Append `count` elements with one capacity check and one memcpy */       \
+    static inline int nv_extend_##T(NanoVector_##T* vec, const T* src, size_t count) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (count == 0) return NANODS_OK;                                      \
+        NANODS_CHECK_NULL(src, NANODS_ERR_NULL);                               \
+        /* `src` may point into this vector; find it again after a realloc */  \
+        int aliased = vec->data && src >= vec->data && src < vec->data + vec->size; \
+        size_t offset = aliased ? (size_t)(src - vec->data) : 0;               \
+        int err = nv_grow_##T(vec, count);                                     \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        if (aliased) src = vec->data + offset;                                 \
+        memcpy(vec->data + vec->size, src, count * sizeof(T));                 \
+        vec->size += count;                                                    \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Insert `count` elements before `index` (index == size appends) */       \
+    static inline int nv_insert_range_##T(NanoVector_##T* vec, size_t index,   \
+                                           const T* src, size_t count) {       \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_BOUNDS(index, vec->size + 1, NANODS_ERR_BOUNDS);          \
+        if (count == 0) return NANODS_OK;                                      \
+        NANODS_CHECK_NULL(src, NANODS_ERR_NULL);                               \
+        int aliased = vec->data && src >= vec->data && src < vec->data + vec->size; \
+        size_t offset = aliased ? (size_t)(src - vec->data) : 0;               \
+        int err = nv_grow_##T(vec, count);                                     \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        memmove(vec->data + index + count, vec->data + index, (vec->size - index) * sizeof(T)); \
+        if (aliased) {                                                         \
+            /* Source elements before `index` stayed put, the rest moved up by count */ \
+            size_t before = offset < index ? index - offset : 0;               \
+            if (before > count) before = count;                                \
+            memcpy(vec->data + index, vec->data + offset, before * sizeof(T)); \
+            memcpy(vec->data + index + before, vec->data + offset + before + count, \
+                   (count - before) * sizeof(T));                              \
+        } else {                                                               \
+            memcpy(vec->data + index, src, count * sizeof(T));                 \
+        }                                                                      \
+        vec->size += count;                                                    \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Remove [index, index + count); the tail moves down with one memmove */  \
+    static inline int nv_erase_range_##T(NanoVector_##T* vec, size_t index, size_t count) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_BOUNDS(index, vec->size + 1, NANODS_ERR_BOUNDS);          \
+        NANODS_CHECK_BOUNDS(count, vec->size - index + 1, NANODS_ERR_BOUNDS);  \
+        if (count == 0) return NANODS_OK;                                      \
+        memmove(vec->data + index, vec->data + index + count,                  \
+                (vec->size - index - count) * sizeof(T));                      \
+        vec->size -= count;                                                    \
+        if (vec->flags & NANODS_FLAG_SECURE) {                                 \
+            memset(vec->data + vec->size, 0, count * sizeof(T));               \
+        }                                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Grow to `new_size` filling new slots with `fill`, or truncate */        \
+    static inline int nv_resize_##T(NanoVector_##T* vec, size_t new_size, T fill) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (new_size <= vec->size) {                                           \
+            if ((vec->flags & NANODS_FLAG_SECURE) && new_size < vec->size) {   \
+                memset(vec->data + new_size, 0, (vec->size - new_size) * sizeof(T)); \
+            }                                                                  \
+            vec->size = new_size;                                              \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        if (new_size > vec->capacity) {                                        \
+            int err = nv_reserve_##T(vec, new_size);                           \
+            if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                 \
+        }                                                                      \
+        for (size_t i = vec->size; i < new_size; i++) vec->data[i] = fill;     \
+        vec->size = new_size;                                                  \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    /* Release unused capacity; secure vectors copy so no stale bytes are left behind */ \
+    static inline int nv_shrink_to_fit_##T(NanoVector_##T* vec) {              \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        if (vec->capacity == vec->size) return NANODS_OK;                      \
+        if (vec->size == 0) {                                                  \
+            if (vec->flags & NANODS_FLAG_SECURE) {                             \
+                nanods_mem_secure_free(vec->alloc, vec->data, vec->capacity * sizeof(T)); \
+            } else {                                                           \
+                nanods_mem_free(vec->alloc, vec->data);                        \
+            }                                                                  \
+            vec->data = NULL;                                                  \
+            vec->capacity = 0;                                                 \
+            return NANODS_OK;                                                  \
+        }                                                                      \
+        T* new_data;                                                           \
+        if (vec->flags & NANODS_FLAG_SECURE) {                                 \
+            new_data = (T*)nanods_mem_alloc(vec->alloc, vec->size * sizeof(T)); \
+            if (NANODS_UNLIKELY(!new_data)) return NANODS_ERR_NOMEM;           \
+            memcpy(new_data, vec->data, vec->size * sizeof(T));                \
+            nanods_mem_secure_free(vec->alloc, vec->data, vec->capacity * sizeof(T)); \
+        } else {                                                               \
+            new_data = (T*)nanods_mem_realloc(vec->alloc, vec->data, vec->size * sizeof(T)); \
+            if (NANODS_UNLIKELY(!new_data)) return NANODS_ERR_NOMEM;           \
+        }                                                                      \
+        vec->data = new_data;                                                  \
+        vec->capacity = vec->size;                                             \
         return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
@@ -98,9 +256,9 @@
     static inline void nv_free_##T(NanoVector_##T* vec) {                     \
         if (vec && vec->data) {                                                \
             if (vec->flags & NANODS_FLAG_SECURE) {                             \
-                nanods_secure_free(vec->data, vec->capacity * sizeof(T));      \
+                nanods_mem_secure_free(vec->alloc, vec->data, vec->capacity * sizeof(T)); \
             } else {                                                           \
-                NANODS_FREE(vec->data);                                        \
+                nanods_mem_free(vec->alloc, vec->data);                        \
             }                                                                  \
             vec->data = NULL;                                                  \
         }                                                                      \
@@ -112,7 +270,7 @@
                                                                                \
     static inline void nv_secure_free_##T(NanoVector_##T* vec) {              \
         if (vec && vec->data && vec->capacity > 0) {                           \
-            nanods_secure_free(vec->data, vec->capacity * sizeof(T));          \
+            nanods_mem_secure_free(vec->alloc, vec->data, vec->capacity * sizeof(T)); \
             vec->data = NULL;                                                  \
         }                                                                      \
         if (vec) {                                                             \
@@ -126,15 +284,14 @@
         NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
         NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
         NANODS_CHECK_NULL(func, NANODS_ERR_NULL);                              \
-        nv_init_##T(out);                                                      \
+        nv_init_ex_##T(out, vec->flags);                                       \
+        out->alloc = vec->alloc;                                               \
+        int err = nv_reserve_##T(out, vec->size);                              \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
         for (size_t i = 0; i < vec->size; i++) {                               \
-            T mapped = func(vec->data[i]);                                     \
-            int err = nv_push_##T(out, mapped);                                \
-            if (NANODS_UNLIKELY(err != NANODS_OK)) {                           \
-                nv_free_##T(out);                                              \
-                return err;                                                    \
-            }                                                                  \
+            out->data[i] = func(vec->data[i]);                                 \
         }                                                                      \
+        out->size = vec->size;                                                 \
         return NANODS_OK;                                                      \
     }                                                                          \
                                                                                \
@@ -143,7 +300,8 @@
         NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
         NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
         NANODS_CHECK_NULL(predicate, NANODS_ERR_NULL);                         \
-        nv_init_##T(out);                                                      \
+        nv_init_ex_##T(out, vec->flags);                                       \
+        out->alloc = vec->alloc;                                               \
         for (size_t i = 0; i < vec->size; i++) {                               \
             if (predicate(vec->data[i])) {                                     \
                 int err = nv_push_##T(out, vec->data[i]);                      \
@@ -156,6 +314,101 @@
         return NANODS_OK;                                                      \
     }
 
+/**
+ * Inlined map/filter/reduce. EXPR and PRED are expressions over the element
+ * `x` (and the accumulator `acc` for reduce), expanded into the loop body, so
+ * there is no call per element and the compiler can vectorize. Each macro
+ * needs NANODS_DEFINE_VECTOR(T) first. Example:
+ *
+ *     NANODS_DEFINE_VECTOR_MAP(int, scale, x * 3 + 1)     nv_map_scale_int(&v, &out)
+ *     NANODS_DEFINE_VECTOR_FILTER(int, even, x % 2 == 0)  nv_filter_even_int(&v, &out)
+ *     NANODS_DEFINE_VECTOR_REDUCE(int, sum, long, acc + x) nv_reduce_sum_int(&v, 0)
+ *
+ * Like nv_map/nv_filter and their nv_par_* twins, `out` takes the source's
+ * flags and allocator, so the result of a SECURE vector is SECURE too.
+ */
+
+/* nv_map_NAME_T (into a fresh `out` sized once) and nv_map_inplace_NAME_T */
+#define NANODS_DEFINE_VECTOR_MAP(T, NAME, EXPR)                                \
+    static inline int nv_map_##NAME##_##T(const NanoVector_##T* vec, NanoVector_##T* out) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        nv_init_ex_##T(out, vec->flags);                                       \
+        out->alloc = vec->alloc;                                               \
+        int err = nv_reserve_##T(out, vec->size);                              \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        const T* src = vec->data;                                              \
+        T* dst = out->data;                                                    \
+        size_t n = vec->size;                                                  \
+        for (size_t i = 0; i < n; i++) {                                       \
+            T x = src[i];                                                      \
+            dst[i] = (EXPR);                                                   \
+        }                                                                      \
+        out->size = n;                                                         \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline void nv_map_inplace_##NAME##_##T(NanoVector_##T* vec) {      \
+        NANODS_CHECK_NULL_VOID(vec);                                           \
+        T* data = vec->data;                                                   \
+        size_t n = vec->size;                                                  \
+        for (size_t i = 0; i < n; i++) {                                       \
+            T x = data[i];                                                     \
+            data[i] = (EXPR);                                                  \
+        }                                                                      \
+    }
+
+/* nv_filter_NAME_T (stable, into `out`) and nv_filter_inplace_NAME_T */
+#define NANODS_DEFINE_VECTOR_FILTER(T, NAME, PRED)                             \
+    static inline int nv_filter_##NAME##_##T(const NanoVector_##T* vec, NanoVector_##T* out) { \
+        NANODS_CHECK_NULL(vec, NANODS_ERR_NULL);                               \
+        NANODS_CHECK_NULL(out, NANODS_ERR_NULL);                               \
+        nv_init_ex_##T(out, vec->flags);                                       \
+        out->alloc = vec->alloc;                                               \
+        int err = nv_reserve_##T(out, vec->size);                              \
+        if (NANODS_UNLIKELY(err != NANODS_OK)) return err;                     \
+        const T* src = vec->data;                                              \
+        T* dst = out->data;                                                    \
+        size_t n = vec->size, kept = 0;                                        \
+        for (size_t i = 0; i < n; i++) {                                       \
+            T x = src[i];                                                      \
+            dst[kept] = x;                 /* Branchless: always store, keep if PRED */ \
+            kept += (PRED) ? 1 : 0;                                            \
+        }                                                                      \
+        out->size = kept;                                                      \
+        return NANODS_OK;                                                      \
+    }                                                                          \
+                                                                               \
+    static inline size_t nv_filter_inplace_##NAME##_##T(NanoVector_##T* vec) { \
+        if (!vec) return 0;                                                    \
+        T* data = vec->data;                                                   \
+        size_t n = vec->size, kept = 0;                                        \
+        for (size_t i = 0; i < n; i++) {                                       \
+            T x = data[i];                                                     \
+            data[kept] = x;                                                    \
+            kept += (PRED) ? 1 : 0;                                            \
+        }                                                                      \
+        if ((vec->flags & NANODS_FLAG_SECURE) && kept < n) {                   \
+            memset(data + kept, 0, (n - kept) * sizeof(T));                    \
+        }                                                                      \
+        vec->size = kept;                                                      \
+        return n - kept;                                                       \
+    }
+
+/* nv_reduce_NAME_T(vec, init): folds `acc = EXPR` left to right from init */
+#define NANODS_DEFINE_VECTOR_REDUCE(T, NAME, ACC_T, EXPR)                      \
+    static inline ACC_T nv_reduce_##NAME##_##T(const NanoVector_##T* vec, ACC_T init) { \
+        ACC_T acc = init;                                                      \
+        if (!vec) return acc;                                                  \
+        const T* data = vec->data;                                             \
+        size_t n = vec->size;                                                  \
+        for (size_t i = 0; i < n; i++) {                                       \
+            T x = data[i];                                                     \
+            acc = (EXPR);                                                      \
+        }                                                                      \
+        return acc;                                                            \
+    }
+
 NANODS_DEFINE_VECTOR(int)
 NANODS_DEFINE_VECTOR(float)
 NANODS_DEFINE_VECTOR(double)
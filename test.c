@@ -1,6 +1,10 @@
 #define NANODS_IMPLEMENTATION
+#ifndef _WIN32
+    #define NANODS_ENABLE_THREADS
+#endif
 #include "nanods.h"
 #include <stdio.h>
+#include <math.h>
 
 typedef struct {
     int x;
@@ -11,6 +15,16 @@ NANODS_DEFINE_VECTOR(Point)
 NANODS_DEFINE_STACK(Point)
 NANODS_DEFINE_LIST(Point)
 NANODS_DEFINE_LIST2(Point)
+NANODS_DEFINE_MAP_EX(Point, int, NANODS_MAP_HASH_POD, NANODS_MAP_EQ_POD)
+NANODS_DEFINE_RING_POW2(short, 64)
+NANODS_DEFINE_RING(short, 48)
+NANODS_DEFINE_VECTOR_MAP(int, triple_plus_one, x * 3 + 1)
+NANODS_DEFINE_VECTOR_FILTER(int, even, x % 2 == 0)
+NANODS_DEFINE_VECTOR_REDUCE(int, sum, long long, acc + x)
+NANODS_DEFINE_VECTOR_REDUCE(int, max, int, x > acc ? x : acc)
+NANODS_DEFINE_VECTOR_SORT_BY(Point, by_xy, a.x < b.x || (a.x == b.x && a.y < b.y))
+NANODS_DEFINE_SMALL_VECTOR(int, 4)
+NANODS_DEFINE_HEAP_BY(Point, by_x_desc, a.x > b.x)
 
 /* Helper functions for functional tests */
 int double_value(int x) {
@@ -25,6 +39,124 @@ int is_positive(int x) {
     return x > 0;
 }
 
+int add_int(int a, int b) {
+    return a + b;
+}
+
+int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/* Counting allocator for allocation-traffic tests */
+static size_t g_test_mallocs = 0;
+static size_t g_test_frees = 0;
+
+static void* counting_malloc(size_t size) {
+    g_test_mallocs++;
+    return malloc(size);
+}
+
+static void* counting_realloc(void* ptr, size_t size) {
+    return realloc(ptr, size);
+}
+
+static void counting_free(void* ptr) {
+    if (ptr) g_test_frees++;
+    free(ptr);
+}
+
+/* Context-carrying allocator: each container counts into its own tally */
+typedef struct {
+    size_t allocs;
+    size_t frees;
+} AllocTally;
+
+/* Object linked into several intrusive lists at once */
+typedef struct {
+    int id;
+    NanoIListHook lru;
+    NanoIListHook group;
+} Conn;
+
+static void* tally_malloc(void* ctx, size_t size) {
+    ((AllocTally*)ctx)->allocs++;
+    return malloc(size);
+}
+
+static void* tally_realloc(void* ctx, void* ptr, size_t size) {
+    if (!ptr) ((AllocTally*)ctx)->allocs++;
+    return realloc(ptr, size);
+}
+
+static void tally_free(void* ctx, void* ptr) {
+    if (ptr) ((AllocTally*)ctx)->frees++;
+    free(ptr);
+}
+
+#ifndef NANODS_NO_SNAPSHOT
+/* Snapshot encoder for NUL-terminated string values (the NUL is kept) */
+static size_t snap_encode_str(const void* value, const void** bytes, void* ctx) {
+    (void)ctx;
+    *bytes = value;
+    return strlen((const char*)value) + 1;
+}
+#endif
+
+#ifdef NANODS_HAVE_THREADS
+#define CMAP_STABLE 256
+#define CMAP_CHURN 4096
+
+/* One writer churns c<k> keys while readers look up s<i> keys that always exist */
+typedef struct {
+    NanoConcurrentMap* map;
+    int* values;        /* s<i> maps to &values[i] or &values[i + CMAP_STABLE] */
+    int* churn;         /* c<k> maps to &churn[k], and churn[k] == k */
+    int rounds;
+    int errors;
+} CMapWorker;
+
+static void* cmap_reader(void* arg) {
+    CMapWorker* w = (CMapWorker*)arg;
+    char key[16];
+    for (int r = 0; r < w->rounds; r++) {
+        int i = r % CMAP_STABLE;
+        snprintf(key, sizeof(key), "s%d", i);
+        int* v = (int*)ncm_get(w->map, key);
+        if (v != &w->values[i] && v != &w->values[i + CMAP_STABLE]) w->errors++;
+        int k = (r * 7) % CMAP_CHURN;
+        snprintf(key, sizeof(key), "c%d", k);
+        int* c = (int*)ncm_get(w->map, key);
+        if (c && *c != k) w->errors++;
+    }
+    return NULL;
+}
+
+static void* cmap_writer(void* arg) {
+    CMapWorker* w = (CMapWorker*)arg;
+    char key[16];
+    for (int r = 0; r < w->rounds; r++) {
+        int k = r % CMAP_CHURN;
+        snprintf(key, sizeof(key), "c%d", k);
+        if ((r / CMAP_CHURN) % 2 == 0) {
+            if (ncm_set(w->map, key, &w->churn[k]) != NANODS_OK) w->errors++;
+        } else if (ncm_remove(w->map, key) != NANODS_OK) {
+            w->errors++;
+        }
+        if (r % 16 == 0) {
+            int i = (r / 16) % CMAP_STABLE;
+            snprintf(key, sizeof(key), "s%d", i);
+            ncm_set(w->map, key, &w->values[i + ((r / 16 / CMAP_STABLE) % 2) * CMAP_STABLE]);
+        }
+    }
+    for (int k = 0; k < CMAP_CHURN; k++) {
+        snprintf(key, sizeof(key), "c%d", k);
+        ncm_remove(w->map, key);
+    }
+    return NULL;
+}
+#endif
+
 int main(void) {
     printf("=== NanoDS v%s Test Suite ===\n\n", NANODS_VERSION);
     
@@ -398,6 +530,2400 @@ int main(void) {
     printf("✅ Test skipped (not a failure)\n\n");
 #endif
     
+    /* =========================================================================
+     * TEST 12: Map Growth (Incremental Rehashing)
+     * =========================================================================
+     */
+    printf("TEST 12: Map Growth (Incremental Rehashing)\n");
+    printf("--------------------------------------------\n");
+    
+    {
+        NanoMap big;
+        nm_init(&big);
+        
+        static int big_vals[10000];
+        char key_buf[32];
+        for (int i = 0; i < 10000; i++) {
+            big_vals[i] = i;
+            snprintf(key_buf, sizeof(key_buf), "key_%d", i);
+            nm_set(&big, key_buf, &big_vals[i]);
+        }
+        
+        int missing = 0;
+        for (int i = 0; i < 10000; i++) {
+            snprintf(key_buf, sizeof(key_buf), "key_%d", i);
+            int* v = (int*)nm_get(&big, key_buf);
+            if (!v || *v != i) missing++;
+        }
+        
+        for (int i = 0; i < 10000; i += 2) {
+            snprintf(key_buf, sizeof(key_buf), "key_%d", i);
+            nm_remove(&big, key_buf);
+        }
+        
+        size_t iterated = 0;
+        NanoMapIterator big_iter;
+        nm_iter_init(&big_iter, &big);
+        while (nm_iter_next(&big_iter, NULL, NULL) == NANODS_OK) {
+            iterated++;
+        }
+        
+        /* Mid-rehash: reads through a const map neither migrate nor miss entries */
+        NanoMap mid;
+        nm_init(&mid);
+        static int mid_vals[2000];
+        int mid_n = 0;
+        while (mid_n < 2000 && (mid_n < 100 || !mid.old_buckets)) {
+            mid_vals[mid_n] = mid_n;
+            snprintf(key_buf, sizeof(key_buf), "mid_%d", mid_n);
+            nm_set(&mid, key_buf, &mid_vals[mid_n]);
+            mid_n++;
+        }
+        for (int extra = 0; extra < 5; extra++, mid_n++) {   /* Land in the new table */
+            mid_vals[mid_n] = mid_n;
+            snprintf(key_buf, sizeof(key_buf), "mid_%d", mid_n);
+            nm_set(&mid, key_buf, &mid_vals[mid_n]);
+        }
+        const NanoMap* mid_ro = &mid;
+        size_t mid_idx = mid.rehash_idx;
+        int mid_ok = mid.old_buckets != NULL;
+        for (int i = 0; i < mid_n && mid_ok; i++) {
+            snprintf(key_buf, sizeof(key_buf), "mid_%d", i);
+            mid_ok = nm_get(mid_ro, key_buf) == &mid_vals[i] && nm_has(mid_ro, key_buf);
+        }
+        long mid_sum = 0, mid_walked = 0;
+        NANODS_MAP_FOREACH(mid_ro, e) {
+            mid_sum += *(int*)e->value;
+            mid_walked++;
+        }
+        NanoMapIterator mid_iter;
+        nm_iter_init(&mid_iter, mid_ro);
+        void* mid_value;
+        while (nm_iter_next(&mid_iter, NULL, &mid_value) == NANODS_OK) mid_sum -= *(int*)mid_value;
+        mid_ok = mid_ok && mid.rehash_idx == mid_idx && mid.old_buckets != NULL &&
+                 mid_walked == mid_n && mid_sum == 0;
+        nm_free(&mid);
+        if (!mid_ok) {
+            printf("❌ Mid-rehash reads failed\n");
+            nm_free(&big);
+            return 1;
+        }
+        
+        printf("Entries: %zu, buckets: %zu, load factor: %.2f\n",
+               nm_size(&big), big.bucket_count, (double)big.size / big.bucket_count);
+        
+        if (missing != 0 || nm_size(&big) != 5000 || iterated != 5000 ||
+            big.old_buckets != NULL || big.size * 4 > big.bucket_count * 3) {
+            printf("❌ Map growth test failed\n");
+            nm_free(&big);
+            return 1;
+        }
+        
+        nm_free(&big);
+    }
+    printf("✅ Map growth test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 13: NanoFlatMap (Open Addressing, SIMD Group Probing)
+     * =========================================================================
+     */
+    printf("TEST 13: NanoFlatMap (Open Addressing)\n");
+    printf("---------------------------------------\n");
+    
+    {
+        NanoFlatMap flat;
+        nfm_init_ex(&flat, NANODS_FLAG_SECURE);
+        
+        static int flat_vals[20000];
+        char key_buf[32];
+        for (int i = 0; i < 20000; i++) {
+            flat_vals[i] = i;
+            snprintf(key_buf, sizeof(key_buf), "flat_%d", i);
+            nfm_set(&flat, key_buf, &flat_vals[i]);
+        }
+        nfm_set(&flat, "flat_7", &flat_vals[8]);  /* Overwrite keeps size */
+        
+        /* Churn: remove and re-insert to exercise tombstones */
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < 20000; i += 3) {
+                snprintf(key_buf, sizeof(key_buf), "flat_%d", i);
+                nfm_remove(&flat, key_buf);
+            }
+            for (int i = 0; i < 20000; i += 3) {
+                snprintf(key_buf, sizeof(key_buf), "flat_%d", i);
+                nfm_set(&flat, key_buf, &flat_vals[i]);
+            }
+        }
+        
+        int bad = 0;
+        for (int i = 0; i < 20000; i++) {
+            snprintf(key_buf, sizeof(key_buf), "flat_%d", i);
+            int* v = (int*)nfm_get(&flat, key_buf);
+            int expected = (i == 7) ? 8 : i;
+            if (!v || *v != expected) bad++;
+        }
+        if (nfm_has(&flat, "missing") || nfm_remove(&flat, "missing") != NANODS_ERR_NOTFOUND) bad++;
+        
+        size_t iterated = 0;
+        NanoFlatMapIterator flat_iter;
+        nfm_iter_init(&flat_iter, &flat);
+        while (nfm_iter_next(&flat_iter, NULL, NULL) == NANODS_OK) {
+            iterated++;
+        }
+        
+        printf("Entries: %zu, capacity: %zu, tombstones: %zu\n",
+               nfm_size(&flat), flat.capacity, flat.tombstones);
+        
+        if (bad != 0 || nfm_size(&flat) != 20000 || iterated != 20000) {
+            printf("❌ Flat map test failed\n");
+            nfm_free(&flat);
+            return 1;
+        }
+        
+        nfm_free(&flat);
+    }
+    printf("✅ Flat map test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 14: Map Entry Hash/Length Cache (Shared-Prefix Keys)
+     * =========================================================================
+     */
+    printf("TEST 14: Map Entry Hash/Length Cache\n");
+    printf("-------------------------------------\n");
+    
+    {
+        NanoMap routes;
+        nm_init_ex(&routes, NANODS_FLAG_SECURE);
+        
+        const char* paths[] = {
+            "/api/v1/users", "/api/v1/users/", "/api/v1/user", "/api/v1/users/42"
+        };
+        int route_ids[4] = {0, 1, 2, 3};
+        for (int i = 0; i < 4; i++) {
+            nm_set(&routes, paths[i], &route_ids[i]);
+        }
+        
+        size_t bucket_idx;
+        NanoMapEntry* entry = nm_find_entry(&routes, "/api/v1/users/42", &bucket_idx);
+        int ok = entry && entry->key_len == strlen("/api/v1/users/42") &&
+                 entry->hash == nanods_fnv1a_hash_seeded("/api/v1/users/42", routes.seed);
+        
+        nm_remove(&routes, "/api/v1/users/");
+        for (int i = 0; i < 4; i++) {
+            int* id = (int*)nm_get(&routes, paths[i]);
+            if (i == 1 ? id != NULL : (!id || *id != i)) ok = 0;
+        }
+        
+        printf("Routes: %zu, cached key_len: %u\n", nm_size(&routes), entry ? entry->key_len : 0);
+        
+        if (!ok || nm_size(&routes) != 3) {
+            printf("❌ Map entry cache test failed\n");
+            nm_free(&routes);
+            return 1;
+        }
+        
+        nm_free(&routes);
+    }
+    printf("✅ Map entry cache test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 15: Single-Allocation Map Entries (Inline Keys)
+     * =========================================================================
+     */
+    printf("TEST 15: Single-Allocation Map Entries\n");
+    printf("---------------------------------------\n");
+    
+    {
+        NanoAllocator counting = {
+            .malloc_fn = counting_malloc,
+            .realloc_fn = counting_realloc,
+            .free_fn = counting_free
+        };
+        
+        NanoMap inline_map;
+        nm_init_with_capacity(&inline_map, 64);
+        
+        nanods_set_allocator(&counting);
+        g_test_mallocs = 0;
+        g_test_frees = 0;
+        int payload = 7;
+        nm_set(&inline_map, "alpha", &payload);
+        nm_set(&inline_map, "beta", &payload);
+        nm_set(&inline_map, "alpha", &payload);  /* Update: no allocation */
+        size_t set_mallocs = g_test_mallocs;
+        nm_remove(&inline_map, "alpha");
+        size_t remove_frees = g_test_frees;
+        nm_free(&inline_map);
+        nanods_set_allocator(NULL);
+        
+        printf("Mallocs for 2 new keys: %zu, frees for 1 remove: %zu\n",
+               set_mallocs, remove_frees);
+        
+        if (set_mallocs != 2 || remove_frees != 1) {
+            printf("❌ Single-allocation entry test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Single-allocation entry test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 16: Pluggable Hash Functions
+     * =========================================================================
+     */
+    printf("TEST 16: Pluggable Hash Functions\n");
+    printf("----------------------------------\n");
+    
+    {
+        /* SipHash-2-4 reference vector: key 00..0f, message 00..0e */
+        uint8_t bytes[16];
+        for (int i = 0; i < 16; i++) bytes[i] = (uint8_t)i;
+        uint64_t sip_key[2] = { nanods_load_le64(bytes), nanods_load_le64(bytes + 8) };
+        uint64_t sip24 = nanods_siphash(bytes, 15, sip_key, 2, 4);
+        uint64_t sip13 = nanods_siphash13("hello", 5, sip_key);
+        uint64_t other_key[2] = { sip_key[0] ^ 1, sip_key[1] };
+        int sip_ok = sip24 == 0xa129ca6149be45e5ull &&
+                     sip13 == nanods_siphash13("hello", 5, sip_key) &&
+                     sip13 != nanods_siphash13("hello", 5, other_key);
+        /* wyhash final v4 reference vector */
+        int wy_ok = nanods_wyhash("abc", 3, 2) == 0xa97f2f7b1d9b3314ull &&
+                    nanods_wyhash("abc", 3, 3) != 0xa97f2f7b1d9b3314ull;
+        
+        NanoHashKind kinds[] = { NANODS_HASH_FNV1A, NANODS_HASH_WYHASH, NANODS_HASH_SIPHASH13 };
+        int map_ok = 1;
+        static int hash_vals[200];
+        char hkey[48];
+        for (int k = 0; k < 3; k++) {
+            NanoMap hm;
+            nm_init(&hm);
+            nm_set_hash_kind(&hm, kinds[k]);
+            for (int i = 0; i < 200; i++) {
+                hash_vals[i] = i;
+                snprintf(hkey, sizeof(hkey), "hash/kind/key/%d/with/a/longer/suffix", i);
+                nm_set(&hm, hkey, &hash_vals[i]);
+            }
+            for (int i = 0; i < 200; i += 2) {
+                snprintf(hkey, sizeof(hkey), "hash/kind/key/%d/with/a/longer/suffix", i);
+                nm_remove(&hm, hkey);
+            }
+            /* Switch hash on a populated map: entries must remain reachable */
+            nm_set_hash_kind(&hm, kinds[(k + 1) % 3]);
+            for (int i = 0; i < 200; i++) {
+                snprintf(hkey, sizeof(hkey), "hash/kind/key/%d/with/a/longer/suffix", i);
+                int* v = (int*)nm_get(&hm, hkey);
+                if ((i % 2 == 0) ? v != NULL : (v == NULL || *v != i)) map_ok = 0;
+            }
+            if (nm_size(&hm) != 100) map_ok = 0;
+            nm_free(&hm);
+        }
+        
+        printf("SipHash vectors: %s, wyhash vectors: %s, maps per hash: %s\n",
+               sip_ok ? "ok" : "bad", wy_ok ? "ok" : "bad", map_ok ? "ok" : "bad");
+        
+        if (!sip_ok || !wy_ok || !map_ok) {
+            printf("❌ Pluggable hash test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Pluggable hash test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 17: Typed Hash Map (Inline Integer and POD Keys)
+     * =========================================================================
+     */
+    printf("TEST 17: Typed Hash Map\n");
+    printf("------------------------\n");
+    
+    {
+        NanoMap_int_int ids;
+        nm_init_int_int(&ids);
+        for (int i = 0; i < 5000; i++) nm_set_int_int(&ids, i * 7, i);
+        for (int i = 0; i < 5000; i += 3) nm_remove_int_int(&ids, i * 7);
+        nm_set_int_int(&ids, 7, -1);  /* Update in place */
+        
+        int ids_ok = nm_size_int_int(&ids) == 5000 - 1667;
+        for (int i = 0; i < 5000; i++) {
+            int v;
+            int err = nm_get_int_int(&ids, i * 7, &v);
+            if (i % 3 == 0) {
+                if (err != NANODS_ERR_NOTFOUND) ids_ok = 0;
+            } else if (err != NANODS_OK || v != (i == 1 ? -1 : i)) {
+                ids_ok = 0;
+            }
+        }
+        size_t iterated = 0;
+        NanoMapIterator_int_int it;
+        nm_iter_init_int_int(&it, &ids);
+        while (nm_iter_next_int_int(&it, NULL, NULL) == NANODS_OK) iterated++;
+        if (iterated != nm_size_int_int(&ids)) ids_ok = 0;
+        nm_free_int_int(&ids);
+        
+        NanoMap_uint64_t_uint64_t big;
+        nm_init_uint64_t_uint64_t(&big);
+        nm_reserve_uint64_t_uint64_t(&big, 1000);
+        size_t reserved = big.capacity;
+        for (uint64_t i = 0; i < 1000; i++) nm_set_uint64_t_uint64_t(&big, i << 40, i);
+        uint64_t* slot = nm_get_ptr_uint64_t_uint64_t(&big, (uint64_t)999 << 40);
+        int big_ok = slot && *slot == 999 && big.capacity == reserved &&
+                     !nm_has_uint64_t_uint64_t(&big, 1);
+        nm_free_uint64_t_uint64_t(&big);
+        
+        NanoMap_Point_int grid;
+        nm_init_Point_int(&grid);
+        Point origin = {0, 0}, corner = {3, 4};
+        nm_set_Point_int(&grid, origin, 1);
+        nm_set_Point_int(&grid, corner, 5);
+        int dist = 0;
+        int pod_ok = nm_get_Point_int(&grid, corner, &dist) == NANODS_OK && dist == 5 &&
+                     nm_remove_Point_int(&grid, origin) == NANODS_OK &&
+                     !nm_has_Point_int(&grid, origin);
+        nm_free_Point_int(&grid);
+        
+        printf("int keys: %s, uint64_t keys: %s, POD keys: %s\n",
+               ids_ok ? "ok" : "bad", big_ok ? "ok" : "bad", pod_ok ? "ok" : "bad");
+        
+        if (!ids_ok || !big_ok || !pod_ok) {
+            printf("❌ Typed map test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Typed map test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 18: Node Pools for Lists and Map Entries
+     * =========================================================================
+     */
+    printf("TEST 18: Node Pools\n");
+    printf("--------------------\n");
+    
+    {
+        NanoAllocator counting = {
+            .malloc_fn = counting_malloc,
+            .realloc_fn = counting_realloc,
+            .free_fn = counting_free
+        };
+        nanods_set_allocator(&counting);
+        g_test_mallocs = 0;
+        g_test_frees = 0;
+        
+        /* Owned pool: 1000 nodes in 16 chunks of 64, recycled on churn */
+        NanoList_int queue;
+        nl_init_pooled_int(&queue, 64);
+        for (int i = 0; i < 1000; i++) nl_push_back_int(&queue, i);
+        size_t fill_mallocs = g_test_mallocs;
+        int front = -1, order_ok = 1;
+        for (int i = 0; i < 1000; i++) {
+            nl_pop_front_int(&queue, &front);
+            if (front != i) order_ok = 0;
+            nl_push_back_int(&queue, i);
+        }
+        size_t churn_mallocs = g_test_mallocs - fill_mallocs;
+        nl_free_int(&queue);
+        int owned_ok = order_ok && fill_mallocs == 17 && churn_mallocs == 0 &&
+                       g_test_frees == g_test_mallocs;
+        
+        /* Shared pool: a list and a list2 draw from the same chunks */
+        NanoPool shared;
+        np_init(&shared, sizeof(NanoList2Node_int), 32);
+        NanoList_int a;
+        NanoList2_int b;
+        int shared_ok = nl_init_pool_int(&a, &shared) == NANODS_OK &&
+                        nl2_init_pool_int(&b, &shared) == NANODS_OK;
+        for (int i = 0; i < 40; i++) {
+            nl_push_front_int(&a, i);
+            nl2_push_back_int(&b, i);
+        }
+        int last = -1;
+        nl2_pop_back_int(&b, &last);
+        if (last != 39 || shared.live != 79) shared_ok = 0;
+        nl_free_int(&a);
+        nl2_free_int(&b);
+        if (shared.live != 0) shared_ok = 0;
+        np_free(&shared);
+        
+        /* Map entries: short keys pooled, a long key falls back to malloc */
+        NanoMap pooled_map;
+        nm_init_pooled(&pooled_map, 0);
+        int mv = 1;
+        char pk[16];
+        for (int i = 0; i < 100; i++) {
+            snprintf(pk, sizeof(pk), "k%d", i);
+            nm_set(&pooled_map, pk, &mv);
+        }
+        nm_set(&pooled_map, "a-key-that-is-longer-than-the-pool-node-size", &mv);
+        nm_remove(&pooled_map, "k5");
+        int map_pool_ok = nm_size(&pooled_map) == 100 && pooled_map.pool->live == 99 &&
+                          nm_get(&pooled_map, "k99") == &mv &&
+                          nm_get(&pooled_map, "a-key-that-is-longer-than-the-pool-node-size") == &mv;
+        nm_free(&pooled_map);
+        
+        nanods_set_allocator(NULL);
+        int balanced = g_test_frees == g_test_mallocs;
+        printf("owned: %s, shared: %s, map: %s, mallocs %zu / frees %zu\n",
+               owned_ok ? "ok" : "bad", shared_ok ? "ok" : "bad",
+               map_pool_ok ? "ok" : "bad", g_test_mallocs, g_test_frees);
+        
+        if (!owned_ok || !shared_ok || !map_pool_ok || !balanced) {
+            printf("❌ Node pool test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Node pool test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 19: Arena Allocator
+     * =========================================================================
+     */
+    printf("TEST 19: Arena Allocator\n");
+    printf("-------------------------\n");
+    
+    {
+        NanoArena arena;
+        nanods_arena_init(&arena, 4096);
+        
+        /* Last allocation resizes in place; anything else is copied */
+        char* a = (char*)nanods_arena_alloc(&arena, 100);
+        memset(a, 'x', 100);
+        char* grown = (char*)nanods_arena_realloc(&arena, a, 200);
+        char* other = (char*)nanods_arena_alloc(&arena, 8);
+        char* moved = (char*)nanods_arena_realloc(&arena, grown, 300);
+        int realloc_ok = grown == a && moved != a && other != NULL &&
+                         moved[0] == 'x' && moved[99] == 'x' &&
+                         ((uintptr_t)other % NANODS_ARENA_ALIGN) == 0;
+        void* big = nanods_arena_alloc(&arena, 1 << 20);  /* Dedicated block */
+        if (!big) realloc_ok = 0;
+        
+        /* Temporary containers for one "request", then drop them all at once */
+        NanoAllocator* before = nanods_get_allocator();
+        int vec_ok = 1, arena_map_ok = 1;
+        for (int request = 0; request < 3; request++) {
+            nanods_set_arena(&arena);
+            NanoVector_int scratch;
+            nv_init_int(&scratch);
+            for (int i = 0; i < 1000; i++) nv_push_int(&scratch, i);
+            NanoMap headers;
+            nm_init(&headers);
+            int hv = request;
+            char hk[16];
+            for (int i = 0; i < 100; i++) {
+                snprintf(hk, sizeof(hk), "h%d", i);
+                nm_set(&headers, hk, &hv);
+            }
+            if (scratch.data[999] != 999) vec_ok = 0;
+            if (nm_get(&headers, "h42") != &hv || nm_size(&headers) != 100) arena_map_ok = 0;
+            nm_free(&headers);  /* No-op frees */
+            nv_free_int(&scratch);
+            nanods_set_arena(NULL);
+            nanods_arena_reset(&arena);
+        }
+        int reset_ok = nanods_get_allocator() == before && arena.used == 0 &&
+                       arena.blocks != NULL && arena.blocks->next == NULL;
+        
+        /* An allocator set while the arena is active is the one restored after it */
+        static NanoAllocator swapped = { malloc, realloc, free };
+        nanods_set_arena(&arena);
+        nanods_set_allocator(&swapped);
+        int kept_arena = nanods_get_allocator() != &swapped;
+        nanods_set_arena(NULL);
+        reset_ok = reset_ok && kept_arena && nanods_get_allocator() == &swapped;
+        nanods_set_allocator(before);
+        nanods_arena_reset(&arena);
+        
+        /* A vector from before the scope grows and is freed by its own allocator */
+        NanoVector_int older;
+        nv_init_int(&older);
+        nv_push_int(&older, 1);
+        nanods_set_arena(&arena);
+        for (int i = 0; i < 1000; i++) nv_push_int(&older, i);
+        int foreign_ok = !nanods_arena_owns(&arena, older.data) && older.data[1000] == 999 &&
+                         nanods_arena_owns(&arena, nanods_arena_alloc(&arena, 8));
+        nv_free_int(&older);
+        nanods_set_arena(NULL);
+        nanods_arena_free(&arena);
+        
+        printf("realloc: %s, vector: %s, map: %s, reset: %s, foreign: %s\n",
+               realloc_ok ? "ok" : "bad", vec_ok ? "ok" : "bad",
+               arena_map_ok ? "ok" : "bad", reset_ok ? "ok" : "bad", foreign_ok ? "ok" : "bad");
+        
+        if (!realloc_ok || !vec_ok || !arena_map_ok || !reset_ok || !foreign_ok) {
+            printf("❌ Arena allocator test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Arena allocator test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 20: Per-Container Allocators
+     * =========================================================================
+     */
+    printf("TEST 20: Per-Container Allocators\n");
+    printf("----------------------------------\n");
+    
+    {
+        AllocTally vec_tally = {0, 0}, map_tally = {0, 0}, list_tally = {0, 0};
+        NanoCtxAllocator vec_alloc = { tally_malloc, tally_realloc, tally_free, &vec_tally };
+        NanoCtxAllocator map_alloc = { tally_malloc, tally_realloc, tally_free, &map_tally };
+        NanoCtxAllocator list_alloc = { tally_malloc, tally_realloc, tally_free, &list_tally };
+        NanoAllocator* before = nanods_get_allocator();
+        
+        NanoVector_int v;
+        nv_init_alloc_int(&v, NANODS_FLAG_NONE, &vec_alloc);
+        for (int i = 0; i < 1000; i++) nv_push_int(&v, i);
+        NanoMap m;
+        nm_init_alloc(&m, NANODS_FLAG_NONE, &map_alloc);
+        char key[16];
+        int mv = 7;
+        for (int i = 0; i < 200; i++) {
+            snprintf(key, sizeof(key), "k%d", i);
+            nm_set(&m, key, &mv);
+        }
+        NanoFlatMap fm;
+        nfm_init_alloc(&fm, NANODS_FLAG_NONE, &map_alloc);
+        for (int i = 0; i < 200; i++) {
+            snprintf(key, sizeof(key), "f%d", i);
+            nfm_set(&fm, key, &mv);
+        }
+        NanoList_int l;
+        nl_init_alloc_int(&l, NANODS_FLAG_SECURE, &list_alloc);
+        for (int i = 0; i < 50; i++) nl_push_back_int(&l, i);
+        
+        int routed_ok = vec_tally.allocs > 0 && map_tally.allocs > 400 && list_tally.allocs == 50 &&
+                        nm_get(&m, "k199") == &mv && nfm_get(&fm, "f0") == &mv &&
+                        v.data[999] == 999 && nanods_get_allocator() == before;
+        nv_free_int(&v);
+        nm_free(&m);
+        nfm_free(&fm);
+        nl_free_int(&l);
+        int balanced_ok = vec_tally.allocs == vec_tally.frees &&
+                          map_tally.allocs == map_tally.frees &&
+                          list_tally.allocs == list_tally.frees;
+        
+        /* Arena handle for one map only; everything else stays on the heap */
+        NanoArena arena;
+        nanods_arena_init(&arena, 0);
+        NanoCtxAllocator scratch_alloc = nanods_arena_allocator(&arena);
+        NanoMap_int_int scratch;
+        nm_init_alloc_int_int(&scratch, NANODS_FLAG_NONE, &scratch_alloc);
+        for (int i = 0; i < 500; i++) nm_set_int_int(&scratch, i, i * 2);
+        int got = 0;
+        nm_get_int_int(&scratch, 321, &got);
+        int arena_ok = got == 642 && arena.used > 0 && nanods_get_allocator() == before;
+        nm_free_int_int(&scratch);
+        nanods_arena_free(&arena);
+        
+        printf("routed: %s, balanced: %s, arena handle: %s\n",
+               routed_ok ? "ok" : "bad", balanced_ok ? "ok" : "bad", arena_ok ? "ok" : "bad");
+        
+        if (!routed_ok || !balanced_ok || !arena_ok) {
+            printf("❌ Per-container allocator test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Per-container allocator test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 21: Lock-free SPSC Ring
+     * =========================================================================
+     */
+    printf("TEST 21: Lock-free SPSC Ring\n");
+    printf("-----------------------------\n");
+    
+#ifdef NANODS_HAVE_ATOMICS
+    {
+        IntSpscRing256 ring;
+        nsr_init_int_256(&ring);
+        int fill_ok = nsr_is_empty_int_256(&ring) && nsr_capacity_int_256(&ring) == 256;
+        for (int i = 0; i < 256; i++) {
+            if (nsr_write_int_256(&ring, i) != NANODS_OK) fill_ok = 0;
+        }
+        if (nsr_write_int_256(&ring, 999) != NANODS_ERR_FULL || !nsr_is_full_int_256(&ring)) fill_ok = 0;
+        
+        /* Interleave reads and writes so both indices wrap several times */
+        int order_ok = 1, peeked = -1, val = -1;
+        int next_write = 256, next_read = 0;
+        nsr_peek_int_256(&ring, &peeked);
+        for (int round = 0; round < 2000; round++) {
+            for (int k = 0; k < 3; k++) {
+                if (nsr_read_int_256(&ring, &val) != NANODS_OK || val != next_read++) order_ok = 0;
+            }
+            for (int k = 0; k < 3; k++) {
+                if (nsr_write_int_256(&ring, next_write++) != NANODS_OK) order_ok = 0;
+            }
+        }
+        if (peeked != 0 || nsr_size_int_256(&ring) != 256) order_ok = 0;
+        while (nsr_read_int_256(&ring, &val) == NANODS_OK) {
+            if (val != next_read++) order_ok = 0;
+        }
+        int drain_ok = next_read == next_write && nsr_is_empty_int_256(&ring) &&
+                       nsr_read_int_256(&ring, &val) == NANODS_ERR_EMPTY;
+        int layout_ok = offsetof(IntSpscRing256, tail) >= NANODS_CACHE_LINE &&
+                        offsetof(IntSpscRing256, data) >= 2 * NANODS_CACHE_LINE;
+        
+        printf("fill: %s, order across wrap: %s, drain: %s, layout: %s\n",
+               fill_ok ? "ok" : "bad", order_ok ? "ok" : "bad",
+               drain_ok ? "ok" : "bad", layout_ok ? "ok" : "bad");
+        
+        if (!fill_ok || !order_ok || !drain_ok || !layout_ok) {
+            printf("❌ SPSC ring test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ SPSC ring test passed\n\n");
+#else
+    printf("Skipped (atomics not available)\n\n");
+#endif
+    
+    /* =========================================================================
+     * TEST 22: Bounded MPMC Queue
+     * =========================================================================
+     */
+    printf("TEST 22: Bounded MPMC Queue\n");
+    printf("----------------------------\n");
+    
+#ifdef NANODS_HAVE_ATOMICS
+    {
+        IntQueue256 queue;
+        nq_init_int_256(&queue);
+        int push_ok = nq_capacity_int_256(&queue) == 256;
+        for (int i = 0; i < 256; i++) {
+            if (nq_try_push_int_256(&queue, i) != NANODS_OK) push_ok = 0;
+        }
+        if (nq_try_push_int_256(&queue, -1) != NANODS_ERR_FULL || nq_size_int_256(&queue) != 256) push_ok = 0;
+        
+        /* Single pops and batches, several laps around the cells */
+        int order_ok = 1, val = -1, next_read = 0, next_write = 256;
+        int batch[100];
+        for (int lap = 0; lap < 20; lap++) {
+            if (nq_try_pop_int_256(&queue, &val) != NANODS_OK || val != next_read++) order_ok = 0;
+            size_t got = nq_try_pop_n_int_256(&queue, batch, 99);
+            if (got != 99) order_ok = 0;
+            for (size_t i = 0; i < got; i++) {
+                if (batch[i] != next_read++) order_ok = 0;
+            }
+            for (int i = 0; i < 100; i++) {
+                if (nq_try_push_int_256(&queue, next_write++) != NANODS_OK) order_ok = 0;
+            }
+        }
+        size_t rest = 0, got;
+        while ((got = nq_try_pop_n_int_256(&queue, batch, 100)) > 0) {
+            for (size_t i = 0; i < got; i++) {
+                if (batch[i] != next_read++) order_ok = 0;
+            }
+            rest += got;
+        }
+        int drain_ok = rest == 256 && next_read == next_write &&
+                       nq_try_pop_int_256(&queue, &val) == NANODS_ERR_EMPTY &&
+                       nq_try_pop_n_int_256(&queue, batch, 10) == 0 && nq_size_int_256(&queue) == 0;
+        
+        IntQueue256 secret;
+        nq_init_ex_int_256(&secret, NANODS_FLAG_SECURE);
+        nq_try_push_int_256(&secret, 0x5EC2E7);
+        nq_try_pop_int_256(&secret, &val);
+        int wipe_ok = val == 0x5EC2E7 && secret.cells[0].data == 0;
+        
+        printf("push/full: %s, FIFO over laps: %s, drain: %s, secure wipe: %s\n",
+               push_ok ? "ok" : "bad", order_ok ? "ok" : "bad",
+               drain_ok ? "ok" : "bad", wipe_ok ? "ok" : "bad");
+        
+        if (!push_ok || !order_ok || !drain_ok || !wipe_ok) {
+            printf("❌ MPMC queue test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ MPMC queue test passed\n\n");
+#else
+    printf("Skipped (atomics not available)\n\n");
+#endif
+    
+    /* =========================================================================
+     * TEST 23: Ring Bulk Transfer
+     * =========================================================================
+     */
+    printf("TEST 23: Ring Bulk Transfer\n");
+    printf("----------------------------\n");
+    
+    {
+        NanoRing_short_64 pow2;
+        NanoRing_short_48 odd;
+        nr_init_short_64(&pow2);
+        nr_init_short_48(&odd);
+        short block[40], out[64];
+        for (int i = 0; i < 40; i++) block[i] = (short)i;
+        
+        /* Offset the indices so later blocks straddle the wrap point */
+        int bulk_ok = 1;
+        short next_in = 0, next_pow2 = 0, next_odd = 0;
+        for (int round = 0; round < 50; round++) {
+            for (int i = 0; i < 40; i++) block[i] = (short)(next_in + i);
+            next_in = (short)(next_in + 40);
+            if (nr_write_n_short_64(&pow2, block, 40) != 40) bulk_ok = 0;
+            if (nr_write_n_short_48(&odd, block, 40) != 40) bulk_ok = 0;
+            size_t peeked = nr_peek_n_short_64(&pow2, out, 64);
+            if (peeked != 40 || out[0] != next_pow2 || out[39] != (short)(next_pow2 + 39)) bulk_ok = 0;
+            size_t got = nr_read_n_short_64(&pow2, out, 64);
+            for (size_t i = 0; i < got; i++) {
+                if (out[i] != next_pow2++) bulk_ok = 0;
+            }
+            got = nr_read_n_short_48(&odd, out, 25);
+            short single;
+            while (nr_size_short_48(&odd) > 0 && nr_read_short_48(&odd, &single) == NANODS_OK) {
+                out[got++] = single;
+            }
+            if (got != 40) bulk_ok = 0;
+            for (size_t i = 0; i < got; i++) {
+                if (out[i] != next_odd++) bulk_ok = 0;
+            }
+        }
+        
+        /* Partial writes stop at capacity; mixing with single-element calls */
+        nr_write_n_short_48(&odd, block, 40);
+        size_t partial = nr_write_n_short_48(&odd, block, 40);
+        int partial_ok = partial == 8 && nr_is_full_short_48(&odd) &&
+                         nr_write_n_short_48(&odd, block, 1) == 0;
+        nr_clear_short_48(&odd);
+        nr_write_short_48(&odd, 7);
+        if (nr_read_n_short_48(&odd, out, 10) != 1 || out[0] != 7 ||
+            nr_read_n_short_48(&odd, out, 10) != 0) partial_ok = 0;
+        
+        printf("bulk across wrap: %s, partial: %s\n",
+               bulk_ok ? "ok" : "bad", partial_ok ? "ok" : "bad");
+        
+        if (!bulk_ok || !partial_ok) {
+            printf("❌ Ring bulk test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Ring bulk test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 24: Ring Reserve/Commit and Overwrite-Oldest
+     * =========================================================================
+     */
+    printf("TEST 24: Ring Reserve/Commit and Overwrite-Oldest\n");
+    printf("--------------------------------------------------\n");
+    
+    {
+        /* Fill slots in place the way recv() would, across the wrap point */
+        CharRing16 rx;
+        nr_init_ex_char_16(&rx, NANODS_FLAG_SECURE);
+        const char* wire = "0123456789abcdefghijklmnopqrstuvwxyz";
+        size_t sent = 0, seen = 0;
+        int zc_ok = 1;
+        NanoRingSpan_char_16 span;
+        for (int round = 0; round < 5; round++) {
+            size_t room = nr_write_reserve_char_16(&rx, &span);
+            size_t want = room < 7 ? room : 7;
+            size_t first = want < span.len[0] ? want : span.len[0];
+            memcpy(span.ptr[0], wire + sent, first);
+            memcpy(span.ptr[1], wire + sent + first, want - first);
+            if (nr_write_commit_char_16(&rx, want) != NANODS_OK) zc_ok = 0;
+            sent += want;
+            
+            size_t avail = nr_read_reserve_char_16(&rx, &span);
+            size_t take = avail < 5 ? avail : 5;
+            for (size_t i = 0; i < take; i++) {
+                char c = i < span.len[0] ? span.ptr[0][i] : span.ptr[1][i - span.len[0]];
+                if (c != wire[seen + i]) zc_ok = 0;
+            }
+            if (span.len[0] + span.len[1] != avail) zc_ok = 0;
+            char* consumed = span.ptr[0];
+            nr_read_commit_char_16(&rx, take);
+            if (take > 0 && consumed[0] != 0) zc_ok = 0;   /* Secure wipe */
+            seen += take;
+        }
+        if (nr_write_commit_char_16(&rx, 17) != NANODS_ERR_BOUNDS ||
+            nr_read_commit_char_16(&rx, nr_size_char_16(&rx) + 1) != NANODS_ERR_BOUNDS) zc_ok = 0;
+        
+        /* Copying reads wipe what they consume too, across the wrap point */
+        char copied[16], one;
+        nr_write_n_char_16(&rx, "secret", 6);
+        size_t at = rx.head, left = nr_size_char_16(&rx);
+        if (at + left <= 16 || nr_read_n_char_16(&rx, copied, 16) != left) zc_ok = 0;
+        for (size_t i = 0; i < left; i++) {
+            if (rx.data[(at + i) % 16] != 0) zc_ok = 0;
+        }
+        nr_write_char_16(&rx, 'k');
+        at = rx.head;
+        if (nr_read_char_16(&rx, &one) != NANODS_OK || one != 'k' || rx.data[at] != 0) zc_ok = 0;
+        
+        /* Overwrite-oldest: the ring keeps the newest 16 */
+        IntRing16 recent;
+        nr_init_ex_int_16(&recent, NANODS_FLAG_OVERWRITE);
+        int ow_ok = 1;
+        for (int i = 0; i < 40; i++) {
+            if (nr_write_int_16(&recent, i) != NANODS_OK) ow_ok = 0;
+        }
+        int oldest = -1;
+        nr_peek_int_16(&recent, &oldest);
+        if (oldest != 24 || !nr_is_full_int_16(&recent)) ow_ok = 0;
+        int burst[20], out[16];
+        for (int i = 0; i < 20; i++) burst[i] = 100 + i;
+        if (nr_write_n_int_16(&recent, burst, 5) != 5) ow_ok = 0;
+        nr_peek_n_int_16(&recent, out, 16);
+        if (out[0] != 29 || out[15] != 104) ow_ok = 0;
+        if (nr_write_n_int_16(&recent, burst, 20) != 20) ow_ok = 0;
+        nr_read_n_int_16(&recent, out, 16);
+        if (out[0] != 104 || out[15] != 119 || !nr_is_empty_int_16(&recent)) ow_ok = 0;
+        
+        printf("reserve/commit: %s, overwrite-oldest: %s\n",
+               zc_ok ? "ok" : "bad", ow_ok ? "ok" : "bad");
+        
+        if (!zc_ok || !ow_ok) {
+            printf("❌ Ring reserve/overwrite test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Ring reserve/overwrite test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 25: Vector Bulk and Range Operations
+     * =========================================================================
+     */
+    printf("TEST 25: Vector Bulk and Range Operations\n");
+    printf("------------------------------------------\n");
+    
+    {
+        IntVector v;
+        nv_init_int(&v);
+        int src[10];
+        for (int i = 0; i < 10; i++) src[i] = i;
+        
+        nv_extend_int(&v, src, 10);
+        nv_extend_int(&v, v.data, 10);          /* From itself, forces a realloc */
+        int extend_ok = nv_size_int(&v) == 20 && v.data[10] == 0 && v.data[19] == 9 &&
+                        v.capacity >= 20 && nv_extend_int(&v, NULL, 0) == NANODS_OK;
+        
+        /* [0..9, 0..9] -> insert 100,101 at 5 -> [0..4, 100, 101, 5..9, 0..9] */
+        int ins[2] = {100, 101};
+        nv_insert_range_int(&v, 5, ins, 2);
+        int range_ok = nv_size_int(&v) == 22 && v.data[4] == 4 && v.data[5] == 100 &&
+                       v.data[6] == 101 && v.data[7] == 5 && v.data[21] == 9;
+        nv_insert_range_int(&v, 22, ins, 2);     /* index == size appends */
+        if (v.data[22] != 100 || v.data[23] != 101) range_ok = 0;
+        nv_erase_range_int(&v, 5, 2);
+        nv_erase_range_int(&v, 20, 2);
+        for (int i = 0; i < 20; i++) {
+            if (v.data[i] != i % 10) range_ok = 0;
+        }
+        /* Aliased insert that straddles the insertion point: copy [3, 7) to index 5 */
+        nv_insert_range_int(&v, 5, v.data + 3, 4);
+        int expect[8] = {0, 1, 2, 3, 4, 3, 4, 5};
+        for (int i = 0; i < 8; i++) {
+            if (v.data[i] != expect[i]) range_ok = 0;
+        }
+        if (v.data[8] != 6 || v.data[9] != 5 || nv_size_int(&v) != 24) range_ok = 0;
+        nv_erase_range_int(&v, 5, 4);
+        if (nv_size_int(&v) != 20 || v.data[5] != 5) range_ok = 0;
+        
+        nv_resize_int(&v, 30, -1);
+        int resize_ok = nv_size_int(&v) == 30 && v.data[19] == 9 && v.data[20] == -1 && v.data[29] == -1;
+        nv_resize_int(&v, 3, 0);
+        if (nv_size_int(&v) != 3 || v.data[2] != 2) resize_ok = 0;
+        nv_shrink_to_fit_int(&v);
+        if (v.capacity != 3 || v.data[0] != 0 || v.data[2] != 2) resize_ok = 0;
+        nv_clear_int(&v);
+        nv_shrink_to_fit_int(&v);
+        if (v.data != NULL || v.capacity != 0) resize_ok = 0;
+        nv_free_int(&v);
+        
+        /* Secure vectors wipe erased and truncated slots */
+        IntVector sv;
+        nv_init_ex_int(&sv, NANODS_FLAG_SECURE);
+        nv_extend_int(&sv, src, 10);
+        nv_erase_range_int(&sv, 0, 4);
+        int secure_ok = sv.data[0] == 4 && sv.data[6] == 0 && sv.data[9] == 0;
+        nv_resize_int(&sv, 2, 0);
+        if (sv.data[2] != 0 || sv.data[5] != 0) secure_ok = 0;
+        nv_shrink_to_fit_int(&sv);
+        if (sv.capacity != 2 || sv.data[1] != 5) secure_ok = 0;
+        nv_free_int(&sv);
+        
+        int growth_ok = nanods_vector_grow_capacity(0, 1) == NANODS_VECTOR_MIN_CAPACITY &&
+                        nanods_vector_grow_capacity(16, 17) >= 17 &&
+                        nanods_vector_grow_capacity(16, 1000) == 1000 &&
+                        nanods_vector_grow_capacity(SIZE_MAX / 2 + 1, SIZE_MAX / 2 + 2) >= SIZE_MAX / 2 + 2;
+        
+        printf("extend: %s, insert/erase range: %s, resize/shrink: %s, secure: %s, growth: %s\n",
+               extend_ok ? "ok" : "bad", range_ok ? "ok" : "bad", resize_ok ? "ok" : "bad",
+               secure_ok ? "ok" : "bad", growth_ok ? "ok" : "bad");
+        
+        if (!extend_ok || !range_ok || !resize_ok || !secure_ok || !growth_ok) {
+            printf("❌ Vector bulk test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Vector bulk test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 26: Inlined Map/Filter/Reduce
+     * =========================================================================
+     */
+    printf("TEST 26: Inlined Map/Filter/Reduce\n");
+    printf("-----------------------------------\n");
+    
+    {
+        IntVector v, mapped, evens;
+        nv_init_int(&v);
+        for (int i = 0; i < 1000; i++) nv_push_int(&v, i);
+        
+        nv_map_triple_plus_one_int(&v, &mapped);
+        int map_ok = nv_size_int(&mapped) == 1000 && mapped.capacity == 1000 &&
+                     mapped.data[0] == 1 && mapped.data[999] == 2998;
+        IntVector via_ptr;
+        nv_map_int(&v, &via_ptr, double_value);   /* Function-pointer form now sized once too */
+        if (via_ptr.capacity != 1000 || via_ptr.data[999] != 1998) map_ok = 0;
+        nv_free_int(&via_ptr);
+        
+        /* Macro and function-pointer forms follow the same rule: out takes the source's flags */
+        IntVector secret, by_macro, by_ptr;
+        nv_init_ex_int(&secret, NANODS_FLAG_SECURE);
+        nv_push_int(&secret, 4);
+        nv_map_triple_plus_one_int(&secret, &by_macro);
+        nv_map_int(&secret, &by_ptr, double_value);
+        if (!(by_macro.flags & NANODS_FLAG_SECURE) || by_ptr.flags != by_macro.flags) map_ok = 0;
+        nv_free_int(&by_ptr);
+        nv_filter_int(&secret, &by_ptr, is_even);
+        if (by_ptr.flags != secret.flags) map_ok = 0;
+        nv_free_int(&by_macro);
+        nv_free_int(&by_ptr);
+        nv_free_int(&secret);
+        
+        nv_filter_even_int(&v, &evens);
+        int filter_ok = nv_size_int(&evens) == 500 && evens.data[0] == 0 && evens.data[499] == 998;
+        size_t removed = nv_filter_inplace_even_int(&mapped);   /* 3i+1 even <=> i odd */
+        if (removed != 500 || nv_size_int(&mapped) != 500 || mapped.data[0] != 4) filter_ok = 0;
+        
+        int reduce_ok = nv_reduce_sum_int(&v, 0) == 499500 &&
+                        nv_reduce_sum_int(&v, 10) == 499510 &&
+                        nv_reduce_max_int(&v, -1) == 999;
+        nv_map_inplace_triple_plus_one_int(&v);
+        if (nv_reduce_sum_int(&v, 0) != 3LL * 499500 + 1000) reduce_ok = 0;
+        IntVector none;
+        nv_init_int(&none);
+        if (nv_reduce_sum_int(&none, 7) != 7 || nv_filter_inplace_even_int(&none) != 0) reduce_ok = 0;
+        
+        printf("map: %s, filter: %s, reduce: %s\n",
+               map_ok ? "ok" : "bad", filter_ok ? "ok" : "bad", reduce_ok ? "ok" : "bad");
+        
+        nv_free_int(&v);
+        nv_free_int(&mapped);
+        nv_free_int(&evens);
+        
+        if (!map_ok || !filter_ok || !reduce_ok) {
+            printf("❌ Inlined map/filter/reduce test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Inlined map/filter/reduce test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 27: Thread Pool and Parallel Algorithms
+     * =========================================================================
+     */
+    printf("TEST 27: Thread Pool and Parallel Algorithms\n");
+    printf("---------------------------------------------\n");
+    
+#ifdef NANODS_HAVE_THREADS
+    {
+        NanoThreadPool pool;
+        if (ntp_init(&pool, 4) != NANODS_OK || ntp_size(&pool) != 4) {
+            printf("❌ Thread pool init failed\n");
+            return 1;
+        }
+        
+        const int n = 100003;
+        IntVector v, serial, par;
+        nv_init_int(&v);
+        for (int i = 0; i < n; i++) nv_push_int(&v, (int)((i * 7919LL) % 1000) - 500);
+        
+        nv_map_int(&v, &serial, double_value);
+        nv_par_map_int(&pool, &v, &par, double_value);
+        int map_ok = nv_size_int(&par) == (size_t)n &&
+                     memcmp(par.data, serial.data, n * sizeof(int)) == 0;
+        nv_free_int(&serial);
+        nv_free_int(&par);
+        
+        nv_filter_int(&v, &serial, is_positive);
+        nv_par_filter_int(&pool, &v, &par, is_positive);
+        int filter_ok = nv_size_int(&par) == nv_size_int(&serial) && nv_size_int(&par) > 0 &&
+                        memcmp(par.data, serial.data, par.size * sizeof(int)) == 0;
+        nv_free_int(&serial);
+        nv_free_int(&par);
+        
+        long long expected = 5;
+        for (int i = 0; i < n; i++) expected += v.data[i];
+        int sum = 0, inline_sum = 0;
+        nv_par_reduce_int(&pool, &v, 5, add_int, &sum);
+        nv_par_reduce_int(NULL, &v, 5, add_int, &inline_sum);
+        int reduce_ok = sum == expected && inline_sum == expected;
+        
+        nv_extend_int(&serial, v.data, v.size);   /* serial was freed: starts empty */
+        qsort(serial.data, serial.size, sizeof(int), compare_int);
+        nv_par_sort_int(&pool, &v, compare_int);
+        int sort_ok = memcmp(v.data, serial.data, n * sizeof(int)) == 0;
+        IntVector small;
+        nv_init_int(&small);
+        int small_data[] = {3, -1, 2};
+        nv_extend_int(&small, small_data, 3);
+        nv_par_sort_int(&pool, &small, compare_int);
+        if (small.data[0] != -1 || small.data[2] != 3) sort_ok = 0;
+        
+        printf("map: %s, filter: %s, reduce: %s, sort: %s\n", map_ok ? "ok" : "bad",
+               filter_ok ? "ok" : "bad", reduce_ok ? "ok" : "bad", sort_ok ? "ok" : "bad");
+        
+        nv_free_int(&v);
+        nv_free_int(&serial);
+        nv_free_int(&small);
+        ntp_free(&pool);
+        
+        /* One thread: no workers, everything runs inline */
+        NanoThreadPool solo;
+        int solo_ok = ntp_init(&solo, 1) == NANODS_OK && ntp_size(&solo) == 1;
+        IntVector w;
+        nv_init_int(&w);
+        for (int i = 0; i < 5000; i++) nv_push_int(&w, 5000 - i);
+        nv_par_sort_int(&solo, &w, compare_int);
+        if (w.data[0] != 1 || w.data[4999] != 5000) solo_ok = 0;
+        nv_free_int(&w);
+        ntp_free(&solo);
+        
+        if (!map_ok || !filter_ok || !reduce_ok || !sort_ok || !solo_ok) {
+            printf("❌ Parallel algorithms test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Parallel algorithms test passed\n\n");
+#else
+    printf("Skipped (threads not available)\n\n");
+#endif
+    
+    /* =========================================================================
+     * TEST 28: Sorting and Binary Search
+     * =========================================================================
+     */
+    printf("TEST 28: Sorting and Binary Search\n");
+    printf("-----------------------------------\n");
+    
+    {
+        const int n = 20000;
+        IntVector ints, ref;
+        nv_init_int(&ints);
+        nv_init_int(&ref);
+        uint32_t state = 7;
+        for (int i = 0; i < n; i++) {
+            state = state * 1664525u + 1013904223u;
+            nv_push_int(&ints, (int)state);   /* Full range, both signs */
+        }
+        nv_push_int(&ints, INT32_MIN);
+        nv_push_int(&ints, INT32_MAX);
+        nv_extend_int(&ref, ints.data, ints.size);
+        qsort(ref.data, ref.size, sizeof(int), compare_int);
+        
+        nv_sort_int(&ints);
+        int sort_ok = memcmp(ints.data, ref.data, ref.size * sizeof(int)) == 0 && nv_is_sorted_int(&ints);
+        
+        /* Adversarial shapes: sorted, reversed, all equal */
+        IntVector shape;
+        nv_init_int(&shape);
+        for (int i = 0; i < 5000; i++) nv_push_int(&shape, 5000 - i);
+        nv_sort_int(&shape);
+        if (!nv_is_sorted_int(&shape) || shape.data[0] != 1) sort_ok = 0;
+        nv_sort_int(&shape);
+        for (int i = 0; i < 5000; i++) shape.data[i] = 42;
+        nv_sort_int(&shape);
+        if (!nv_is_sorted_int(&shape)) sort_ok = 0;
+        
+        /* Radix sort gives the same order as the comparison sort */
+        for (size_t i = 0; i < ref.size; i++) ints.data[i] = ref.data[(i * 7919) % ref.size];
+        int radix_ok = nv_radix_sort_int(&ints) == NANODS_OK &&
+                       memcmp(ints.data, ref.data, ref.size * sizeof(int)) == 0;
+        
+        FloatVector floats;
+        nv_init_float(&floats);
+        float float_data[] = {3.5f, -0.0f, -2.25f, 1e30f, -1e30f, 0.0f, -7.0f, 0.5f, 2.0f, -0.5f};
+        nv_extend_float(&floats, float_data, 10);
+        nv_radix_sort_float(&floats);
+        if (!nv_is_sorted_float(&floats) || floats.data[0] != -1e30f || floats.data[9] != 1e30f ||
+            !signbit(floats.data[4]) || signbit(floats.data[5])) radix_ok = 0;   /* -0.0 before +0.0 */
+        
+        DoubleVector doubles;
+        nv_init_double(&doubles);
+        for (int i = 0; i < 3000; i++) nv_push_double(&doubles, ((i * 37) % 3000 - 1500) * 0.125);
+        nv_radix_sort_double(&doubles);
+        if (!nv_is_sorted_double(&doubles) || doubles.data[0] != -187.5) radix_ok = 0;
+        
+        /* Custom order on a struct */
+        NanoVector_Point points;
+        nv_init_Point(&points);
+        Point pts[] = {{2, 1}, {1, 9}, {2, 0}, {1, 3}};
+        nv_extend_Point(&points, pts, 4);
+        nv_sort_by_xy_Point(&points);
+        if (points.data[0].y != 3 || points.data[1].y != 9 || points.data[2].y != 0) sort_ok = 0;
+        
+        /* Searches over duplicates: 0 0 1 1 2 2 ... */
+        IntVector dup;
+        nv_init_int(&dup);
+        for (int i = 0; i < 200; i++) nv_push_int(&dup, i / 2);
+        size_t at = 0;
+        int search_ok = nv_lower_bound_int(&dup, 10) == 20 && nv_upper_bound_int(&dup, 10) == 22 &&
+                        nv_lower_bound_int(&dup, -5) == 0 && nv_lower_bound_int(&dup, 500) == 200 &&
+                        nv_bsearch_int(&dup, 37, &at) == NANODS_OK && dup.data[at] == 37 &&
+                        nv_bsearch_int(&dup, 100, NULL) == NANODS_ERR_NOTFOUND &&
+                        nv_bsearch_by_xy_Point(&points, pts[0], &at) == NANODS_OK && at == 3;
+        
+        printf("sort: %s, radix: %s, search: %s\n",
+               sort_ok ? "ok" : "bad", radix_ok ? "ok" : "bad", search_ok ? "ok" : "bad");
+        
+        nv_free_int(&ints);
+        nv_free_int(&ref);
+        nv_free_int(&shape);
+        nv_free_float(&floats);
+        nv_free_double(&doubles);
+        nv_free_Point(&points);
+        nv_free_int(&dup);
+        
+        if (!sort_ok || !radix_ok || !search_ok) {
+            printf("❌ Sorting test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Sorting test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 29: Vectorized Reductions and Search
+     * =========================================================================
+     */
+    printf("TEST 29: Vectorized Reductions and Search\n");
+    printf("------------------------------------------\n");
+    
+    {
+        IntVector ia, ib;
+        FloatVector fa, fb;
+        DoubleVector da, db;
+        nv_init_int(&ia); nv_init_int(&ib);
+        nv_init_float(&fa); nv_init_float(&fb);
+        nv_init_double(&da); nv_init_double(&db);
+        int reduce_ok = 1, search_ok = 1;
+        uint32_t state = 99;
+        
+        /* Every length up to 130 exercises each vector width and its scalar tail */
+        for (int n = 1; n <= 130 && reduce_ok && search_ok; n++) {
+            state = state * 1664525u + 1013904223u;
+            int value = (int)(state >> 22) - 512;
+            nv_push_int(&ia, value);
+            nv_push_int(&ib, 3 - value);
+            nv_push_float(&fa, (float)value);    /* Small integers: float sums are exact */
+            nv_push_float(&fb, 0.5f);
+            nv_push_double(&da, value * 0.25);
+            nv_push_double(&db, 2.0);
+            
+            long long isum = 0, idot = 0, idot_out = 0;
+            int imin = ia.data[0], imax = ia.data[0], iout = 0;
+            double dsum = 0, ddot = 0, dout = 0;
+            float fsum = 0, fmin = fa.data[0], fout = 0;
+            for (int i = 0; i < n; i++) {
+                isum += ia.data[i];
+                idot += (long long)ia.data[i] * ib.data[i];
+                if (ia.data[i] < imin) imin = ia.data[i];
+                if (ia.data[i] > imax) imax = ia.data[i];
+                fsum += fa.data[i];
+                if (fa.data[i] < fmin) fmin = fa.data[i];
+                dsum += da.data[i];
+                ddot += da.data[i] * db.data[i];
+            }
+            if (nv_sum_int(&ia) != isum || nv_dot_int(&ia, &ib, &idot_out) != NANODS_OK || idot_out != idot ||
+                nv_min_int(&ia, &iout) != NANODS_OK || iout != imin ||
+                nv_max_int(&ia, &iout) != NANODS_OK || iout != imax ||
+                nv_sum_float(&fa) != fsum || nv_min_float(&fa, &fout) != NANODS_OK || fout != fmin ||
+                nv_sum_double(&da) != dsum || nv_dot_double(&da, &db, &dout) != NANODS_OK || dout != ddot) {
+                reduce_ok = 0;
+            }
+            
+            /* Last element is found at its first occurrence; counts match a plain loop */
+            size_t first = 0, at = 99999, count = 0;
+            while (ia.data[first] != value) first++;
+            for (int i = 0; i < n; i++) count += ia.data[i] == value;
+            if (nv_find_int(&ia, value, &at) != NANODS_OK || at != first ||
+                nv_find_float(&fa, (float)value, &at) != NANODS_OK || at != first ||
+                nv_find_double(&da, value * 0.25, &at) != NANODS_OK || at != first ||
+                nv_count_int(&ia, value) != count || nv_count_float(&fa, (float)value) != count ||
+                nv_find_int(&ia, 100000, NULL) != NANODS_ERR_NOTFOUND ||
+                nv_count_double(&da, 0.1) != 0) {
+                search_ok = 0;
+            }
+        }
+        
+        /* int sums do not overflow 32 bits; size mismatches are rejected */
+        IntVector big, wide;
+        nv_init_int(&big);
+        nv_init_int(&wide);
+        for (int i = 0; i < 1000; i++) {
+            nv_push_int(&big, INT32_MAX);
+            nv_push_int(&wide, -(1 << 20));
+        }
+        long long big_dot = 0;
+        if (nv_sum_int(&big) != 1000LL * INT32_MAX ||
+            nv_dot_int(&big, &wide, &big_dot) != NANODS_OK || big_dot != -1000LL * INT32_MAX * (1 << 20) ||
+            nv_dot_int(&big, &ia, &big_dot) != NANODS_ERR_BOUNDS) reduce_ok = 0;
+        
+        printf("reductions: %s, search: %s\n", reduce_ok ? "ok" : "bad", search_ok ? "ok" : "bad");
+        
+        nv_free_int(&ia); nv_free_int(&ib);
+        nv_free_float(&fa); nv_free_float(&fb);
+        nv_free_double(&da); nv_free_double(&db);
+        nv_free_int(&big);
+        nv_free_int(&wide);
+        
+        if (!reduce_ok || !search_ok) {
+            printf("❌ Vector kernel test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Vector kernel test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 30: Small-Buffer Vector
+     * =========================================================================
+     */
+    printf("TEST 30: Small-Buffer Vector\n");
+    printf("-----------------------------\n");
+    
+    {
+        AllocTally tally = {0, 0};
+        NanoCtxAllocator alloc = { tally_malloc, tally_realloc, tally_free, &tally };
+        NanoSmallVector_int_4 sv;
+        nsv_init_alloc_int_4(&sv, NANODS_FLAG_NONE, &alloc);
+        
+        /* Up to N elements: no allocation at all */
+        for (int i = 0; i < 4; i++) nsv_push_int_4(&sv, i * 10);
+        int inline_ok = nsv_is_inline_int_4(&sv) && tally.allocs == 0 && sv.size == 4;
+        
+        /* The 5th spills to the heap, keeping order; later growth reallocates */
+        int spill_ok = 1;
+        for (int i = 4; i < 40; i++) nsv_push_int_4(&sv, i * 10);
+        if (nsv_is_inline_int_4(&sv) || tally.allocs != 1 || sv.size != 40) spill_ok = 0;
+        for (int i = 0; i < 40; i++) if (sv.data[i] != i * 10) spill_ok = 0;
+        int mid[] = {-1, -2};
+        nsv_insert_range_int_4(&sv, 1, mid, 2);
+        nsv_erase_range_int_4(&sv, 5, 30);
+        int value = 0;
+        if (sv.size != 12 || nsv_get_int_4(&sv, 2, &value) != NANODS_OK || value != -2 ||
+            sv.data[5] != 330) spill_ok = 0;
+        
+        /* Iteration goes through NanoIter like a NanoVector */
+        long long sum = 0;
+        size_t seen = 0;
+        for (NanoIter it = nsv_iter_int_4(&sv); nanods_iter_has_next(&it); nsv_iter_next_int_4(&it)) {
+            sum += *(int*)it.ptr;
+            seen++;
+        }
+        int iter_ok = seen == sv.size;
+        for (size_t i = 0; i < sv.size; i++) sum -= sv.data[i];
+        if (sum != 0) iter_ok = 0;
+        
+        /* Shrinking to N or fewer moves back inline and frees the block */
+        nsv_resize_int_4(&sv, 3, 0);
+        nsv_shrink_to_fit_int_4(&sv);
+        if (!nsv_is_inline_int_4(&sv) || tally.frees != 1 || sv.data[1] != -1) inline_ok = 0;
+        
+        /* Moving relocates both inline and spilled vectors */
+        NanoSmallVector_int_4 moved;
+        nsv_move_int_4(&moved, &sv);
+        if (moved.data != moved.inline_data || moved.size != 3 || moved.data[0] != 0 || sv.size != 0) {
+            inline_ok = 0;
+        }
+        for (int i = 0; i < 10; i++) nsv_push_int_4(&moved, i);
+        nsv_move_int_4(&sv, &moved);
+        if (nsv_is_inline_int_4(&sv) || sv.size != 13 || sv.data[12] != 9 || !nsv_is_inline_int_4(&moved)) {
+            spill_ok = 0;
+        }
+        nsv_free_int_4(&sv);
+        nsv_free_int_4(&moved);
+        if (tally.allocs != tally.frees || !nsv_is_inline_int_4(&sv) || sv.capacity != 4) spill_ok = 0;
+        
+        printf("inline: %s, spill: %s, iterator: %s (allocs %zu)\n", inline_ok ? "ok" : "bad",
+               spill_ok ? "ok" : "bad", iter_ok ? "ok" : "bad", tally.allocs);
+        
+        if (!inline_ok || !spill_ok || !iter_ok) {
+            printf("❌ Small vector test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Small vector test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 31: Chunked Deque
+     * =========================================================================
+     */
+    printf("TEST 31: Chunked Deque\n");
+    printf("-----------------------\n");
+    
+    {
+        AllocTally tally = {0, 0};
+        NanoCtxAllocator alloc = { tally_malloc, tally_realloc, tally_free, &tally };
+        IntDeque dq;
+        nd_init_alloc_int(&dq, NANODS_FLAG_NONE, &alloc);
+        
+        /* Random operations at both ends against a plain array model */
+        enum { MODEL = 1 << 16 };
+        static int model[MODEL];
+        size_t model_head = MODEL / 2, model_size = 0;
+        int model_ok = 1;
+        uint32_t state = 5;
+        for (int step = 0; step < 200000 && model_ok; step++) {
+            state = state * 1664525u + 1013904223u;
+            unsigned op = (state >> 16) % 10;
+            int value = (int)(state >> 8);
+            int out = 0;
+            /* Drift toward growth early on, toward shrinking later */
+            if (op < (step < 100000 ? 3u : 2u)) {
+                nd_push_back_int(&dq, value);
+                model[(model_head + model_size++) % MODEL] = value;
+            } else if (op < (step < 100000 ? 6u : 4u)) {
+                nd_push_front_int(&dq, value);
+                model_head = (model_head + MODEL - 1) % MODEL;
+                model[model_head] = value;
+                model_size++;
+            } else if (op < 8 && model_size > 0) {
+                if (nd_pop_front_int(&dq, &out) != NANODS_OK || out != model[model_head]) model_ok = 0;
+                model_head = (model_head + 1) % MODEL;
+                model_size--;
+            } else if (model_size > 0) {
+                if (nd_pop_back_int(&dq, &out) != NANODS_OK ||
+                    out != model[(model_head + model_size - 1) % MODEL]) model_ok = 0;
+                model_size--;
+            }
+            if (dq.size != model_size) model_ok = 0;
+            if (step % 997 == 0 && model_size > 0) {
+                size_t index = (size_t)value % model_size;
+                if (nd_get_int(&dq, index, &out) != NANODS_OK ||
+                    out != model[(model_head + index) % MODEL]) model_ok = 0;
+            }
+        }
+        
+        /* Iterators and spans visit every element in order */
+        int iter_ok = 1;
+        size_t visited = 0;
+        for (NanoIter it = nd_iter_int(&dq); nanods_iter_has_next(&it); nd_iter_next_int(&it)) {
+            if (*(int*)it.ptr != model[(model_head + visited++) % MODEL]) iter_ok = 0;
+        }
+        size_t spanned = 0, run = 0;
+        for (int* span = nd_span_int(&dq, 0, &run); span; span = nd_span_int(&dq, spanned, &run)) {
+            for (size_t k = 0; k < run; k++) {
+                if (span[k] != model[(model_head + spanned + k) % MODEL]) iter_ok = 0;
+            }
+            spanned += run;
+        }
+        if (visited != model_size || spanned != model_size) iter_ok = 0;
+        
+        /* A FIFO in steady state reuses chunks instead of allocating */
+        nd_clear_int(&dq);
+        for (int i = 0; i < 1000; i++) nd_push_back_int(&dq, i);
+        int out = 0, fifo_ok = 1;
+        size_t allocs_before = 0;
+        for (int i = 0; i < 100000; i++) {
+            if (i == 1000) allocs_before = tally.allocs;   /* After one full turn over */
+            nd_pop_front_int(&dq, &out);
+            if (out != i) fifo_ok = 0;
+            nd_push_back_int(&dq, i + 1000);
+        }
+        if (tally.allocs != allocs_before) fifo_ok = 0;
+        if (nd_peek_front_int(&dq, &out) != NANODS_OK || out != 100000 ||
+            nd_peek_back_int(&dq, &out) != NANODS_OK || out != 100999) fifo_ok = 0;
+        
+        nd_free_int(&dq);
+        if (tally.allocs != tally.frees || dq.size != 0) fifo_ok = 0;
+        
+        printf("model: %s, iteration: %s, fifo reuse: %s\n", model_ok ? "ok" : "bad",
+               iter_ok ? "ok" : "bad", fifo_ok ? "ok" : "bad");
+        
+        if (!model_ok || !iter_ok || !fifo_ok) {
+            printf("❌ Deque test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Deque test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 32: Intrusive List
+     * =========================================================================
+     */
+    printf("TEST 32: Intrusive List\n");
+    printf("------------------------\n");
+    
+    {
+        /* Each connection sits on an LRU list and on one of two group lists */
+        Conn conns[8];
+        memset(conns, 0, sizeof(conns));
+        NanoIList lru, groups[2];
+        nil_init(&lru);
+        nil_init(&groups[0]);
+        nil_init(&groups[1]);
+        for (int i = 0; i < 8; i++) {
+            conns[i].id = i;
+            nil_push_front(&lru, &conns[i].lru);
+            nil_push_back(&groups[i % 2], &conns[i].group);
+        }
+        
+        /* LRU: touching 0 and 3 leaves 1 as the oldest */
+        nil_move_to_front(&lru, &conns[0].lru);
+        nil_move_to_front(&lru, &conns[3].lru);
+        Conn* oldest = NANODS_ILIST_ENTRY(nil_back(&lru), Conn, lru);
+        int lru_ok = oldest && oldest->id == 1 &&
+                     NANODS_ILIST_ENTRY(nil_front(&lru), Conn, lru)->id == 3;
+        
+        /* Evicting from the LRU leaves the object on its group list */
+        Conn* evicted = NANODS_ILIST_ENTRY(nil_pop_back(&lru), Conn, lru);
+        if (!evicted || evicted->id != 1 || nil_is_linked(&lru, &evicted->lru) ||
+            !nil_is_linked(&groups[1], &evicted->group) || lru.size != 7) lru_ok = 0;
+        if (nil_remove(&lru, &evicted->lru) != NANODS_ERR_NOTFOUND) lru_ok = 0;
+        
+        /* A hook already on a list, even alone, cannot be linked again */
+        NanoIList solo;
+        nil_init(&solo);
+        nil_push_back(&solo, &evicted->lru);
+        if (nil_push_front(&lru, &conns[0].lru) != NANODS_ERR_BOUNDS ||
+            nil_push_back(&solo, &evicted->lru) != NANODS_ERR_BOUNDS ||
+            nil_insert_after(&lru, &conns[0].lru, &conns[2].lru) != NANODS_ERR_BOUNDS ||
+            nil_insert_before(&lru, &evicted->lru, &conns[7].lru) == NANODS_OK ||
+            lru.size != 7 || solo.size != 1) lru_ok = 0;
+#ifdef NANODS_HARD_SAFETY
+        /* Hooks know their list: removing through the wrong one is refused */
+        if (nil_remove(&lru, &evicted->lru) != NANODS_ERR_NOTFOUND ||
+            nil_remove(&groups[0], &conns[3].lru) != NANODS_ERR_NOTFOUND ||
+            nil_push_back(&lru, &evicted->lru) != NANODS_ERR_BOUNDS ||
+            lru.size != 7 || groups[0].size != 4) lru_ok = 0;
+#endif
+        nil_remove(&solo, &evicted->lru);
+        
+        /* Remove while iterating, insert in the middle, then splice */
+        int list_ok = 1;
+        NANODS_ILIST_FOREACH_SAFE(&groups[0], hook, next) {
+            Conn* c = NANODS_CONTAINER_OF(hook, Conn, group);
+            if (c->id == 4) nil_remove(&groups[0], hook);
+        }
+        nil_insert_after(&groups[0], &conns[2].group, &conns[4].group);   /* 0 2 4 6 */
+        nil_remove(&groups[1], &conns[5].group);
+        nil_insert_before(&groups[1], &conns[1].group, &conns[5].group);  /* 5 1 3 7 */
+        nil_splice_back(&groups[0], &groups[1]);
+        int expect[] = {0, 2, 4, 6, 5, 1, 3, 7};
+        int at = 0;
+        NANODS_ILIST_FOREACH(&groups[0], hook) {
+            if (NANODS_CONTAINER_OF(hook, Conn, group)->id != expect[at++]) list_ok = 0;
+        }
+        if (at != 8 || groups[0].size != 8 || !nil_empty(&groups[1])) list_ok = 0;
+        
+        /* Walking backwards from the tail gives the reverse order */
+        at = 8;
+        for (NanoIListHook* h = nil_back(&groups[0]); h; h = h->prev) {
+            if (NANODS_CONTAINER_OF(h, Conn, group)->id != expect[--at]) list_ok = 0;
+        }
+        nil_splice_front(&groups[1], &groups[0]);
+        if (groups[1].size != 8 || nil_front(&groups[1]) != &conns[0].group) list_ok = 0;
+        nil_clear(&groups[1]);
+        if (nil_is_linked(&groups[1], &conns[7].group) || !nil_empty(&groups[1])) list_ok = 0;
+        
+        printf("lru: %s, links: %s\n", lru_ok ? "ok" : "bad", list_ok ? "ok" : "bad");
+        
+        if (!lru_ok || !list_ok) {
+            printf("❌ Intrusive list test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Intrusive list test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 33: Typed Foreach and Allocation-Free Map Iteration
+     * =========================================================================
+     */
+    printf("TEST 33: Typed Foreach and Allocation-Free Map Iteration\n");
+    printf("---------------------------------------------------------\n");
+    
+    {
+        IntVector vec;
+        nv_init_int(&vec);
+        int loops_ok = 1;
+        NANODS_VECTOR_FOREACH(int, &vec, x) loops_ok = 0;   /* Empty (NULL data): no iterations */
+        for (int i = 1; i <= 100; i++) nv_push_int(&vec, i);
+        long long sum = 0;
+        NANODS_VECTOR_FOREACH(int, &vec, x) sum += *x;
+        NANODS_VECTOR_FOREACH(int, &vec, x) *x *= 2;
+        int seen = 0;
+        NANODS_VECTOR_FOREACH(int, &vec, x) {
+            if (*x > 20) break;
+            seen++;
+        }
+        if (sum != 5050 || vec.data[99] != 200 || seen != 10) loops_ok = 0;
+        
+        IntList list;
+        IntList2 list2;
+        nl_init_int(&list);
+        nl2_init_int(&list2);
+        for (int i = 0; i < 5; i++) {
+            nl_push_back_int(&list, i);
+            nl2_push_back_int(&list2, i);
+        }
+        int expect = 0;
+        NANODS_LIST_FOREACH(int, &list, node) if (node->data != expect++) loops_ok = 0;
+        NANODS_LIST2_FOREACH(int, &list2, node) if (node->data != 5 - expect--) loops_ok = 0;
+        expect = 4;
+        NANODS_LIST2_FOREACH_REVERSE(int, &list2, node) if (node->data != expect--) loops_ok = 0;
+        
+        /* Map walks: neither the macro nor NanoIter allocates */
+        NanoAllocator counting = {
+            .malloc_fn = counting_malloc,
+            .realloc_fn = counting_realloc,
+            .free_fn = counting_free
+        };
+        NanoMap map;
+        nm_init(&map);
+        static int values[200];
+        char key[16];
+        for (int i = 0; i < 200; i++) {
+            values[i] = i;
+            snprintf(key, sizeof(key), "k%d", i);
+            nm_set(&map, key, &values[i]);
+        }
+        nanods_set_allocator(&counting);
+        g_test_mallocs = 0;
+        long long map_sum = 0;
+        size_t entries = 0;
+        NANODS_MAP_FOREACH(&map, e) {
+            map_sum += *(int*)e->value;
+            entries++;
+        }
+        size_t iter_entries = 0;
+        for (NanoIter it = nm_iter(&map); nanods_iter_has_next(&it); nm_iter_advance(&it)) {
+            NanoMapEntry* e = nm_iter_entry(&it);
+            if (e != it.ptr || nm_get(&map, e->key) != e->value) loops_ok = 0;
+            iter_entries++;
+        }
+        size_t walk_mallocs = g_test_mallocs;
+        nanods_set_allocator(NULL);
+        int map_ok = entries == 200 && iter_entries == 200 && map_sum == 199 * 200 / 2 &&
+                     walk_mallocs == 0;
+        
+        NanoMap empty;
+        nm_init(&empty);
+        NANODS_MAP_FOREACH(&empty, e) map_ok = 0;
+        NanoIter none = nm_iter(&empty);
+        if (nanods_iter_has_next(&none)) map_ok = 0;
+        nm_iter_free(&none);
+        
+        printf("loops: %s, map: %s (mallocs during walks: %zu)\n",
+               loops_ok ? "ok" : "bad", map_ok ? "ok" : "bad", walk_mallocs);
+        
+        nv_free_int(&vec);
+        nl_free_int(&list);
+        nl2_free_int(&list2);
+        nm_free(&map);
+        nm_free(&empty);
+        
+        if (!loops_ok || !map_ok) {
+            printf("❌ Foreach test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Foreach test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 34: Concurrent Sharded Map
+     * =========================================================================
+     */
+    printf("TEST 34: Concurrent Sharded Map\n");
+    printf("--------------------------------\n");
+    
+#ifdef NANODS_HAVE_THREADS
+    {
+        NanoConcurrentMap map;
+        int basic_ok = ncm_init(&map, 0) == NANODS_OK && map.shard_count == NANODS_CMAP_SHARDS;
+        NanoConcurrentMap odd;
+        if (ncm_init(&odd, 5) != NANODS_OK || odd.shard_count != 8) basic_ok = 0;
+        ncm_free(&odd);
+        
+        static int values[2 * CMAP_STABLE];
+        static int churn[CMAP_CHURN];
+        char key[16];
+        for (int i = 0; i < CMAP_CHURN; i++) churn[i] = i;
+        for (int i = 0; i < CMAP_STABLE; i++) {
+            snprintf(key, sizeof(key), "s%d", i);
+            ncm_set(&map, key, &values[i]);
+        }
+        
+        enum { READERS = 3 };
+        pthread_t threads[READERS + 1];
+        CMapWorker workers[READERS + 1];
+        for (int t = 0; t <= READERS; t++) {
+            workers[t].map = &map;
+            workers[t].values = values;
+            workers[t].churn = churn;
+            workers[t].rounds = t == READERS ? 6 * CMAP_CHURN : 40000;
+            workers[t].errors = 0;
+            pthread_create(&threads[t], NULL, t == READERS ? cmap_writer : cmap_reader, &workers[t]);
+        }
+        int errors = 0;
+        for (int t = 0; t <= READERS; t++) {
+            pthread_join(threads[t], NULL);
+            errors += workers[t].errors;
+        }
+        int concurrent_ok = errors == 0 && ncm_size(&map) == CMAP_STABLE;
+        
+        /* Single-threaded semantics match NanoMap */
+        if (ncm_remove(&map, "missing") != NANODS_ERR_NOTFOUND || ncm_get(&map, "missing") ||
+            !ncm_has(&map, "s7") || ncm_set(&map, "s7", &values[1]) != NANODS_OK ||
+            ncm_get(&map, "s7") != &values[1] || ncm_size(&map) != CMAP_STABLE) {
+            basic_ok = 0;
+        }
+        
+        /* With every reader slot busy, lookups fall back to the shard lock */
+        for (size_t i = 0; i < NANODS_CMAP_READERS; i++) {
+            NANODS_ATOMIC_STORE(&map.readers[i].epoch, (uint64_t)1, NANODS_MO_RELAXED);
+        }
+        int fallback_ok = ncm_get(&map, "s3") == &values[3] || ncm_get(&map, "s3") == &values[3 + CMAP_STABLE];
+        for (size_t i = 0; i < NANODS_CMAP_READERS; i++) {
+            NANODS_ATOMIC_STORE(&map.readers[i].epoch, (uint64_t)0, NANODS_MO_RELAXED);
+        }
+        
+        ncm_clear(&map);
+        if (!ncm_empty(&map) || ncm_get(&map, "s0") || ncm_set(&map, "s0", &values[0]) != NANODS_OK ||
+            ncm_get(&map, "s0") != &values[0]) {
+            basic_ok = 0;
+        }
+        ncm_free(&map);
+        
+        /* Retired entries and tables are all handed back by ncm_free */
+        AllocTally tally = {0, 0};
+        NanoCtxAllocator alloc = { tally_malloc, tally_realloc, tally_free, &tally };
+        NanoConcurrentMap counted;
+        ncm_init_alloc(&counted, 4, NANODS_FLAG_SECURE, &alloc);
+        for (int i = 0; i < 1000; i++) {
+            snprintf(key, sizeof(key), "k%d", i);
+            ncm_set(&counted, key, &churn[i]);
+        }
+        for (int i = 0; i < 1000; i += 2) {
+            snprintf(key, sizeof(key), "k%d", i);
+            ncm_remove(&counted, key);
+        }
+        if (ncm_size(&counted) != 500 || ncm_get(&counted, "k999") != &churn[999]) basic_ok = 0;
+        ncm_free(&counted);
+        int leak_ok = tally.allocs > 0 && tally.allocs == tally.frees;
+        
+        printf("concurrent: %s (%d errors), fallback: %s, single-thread: %s, frees: %s\n",
+               concurrent_ok ? "ok" : "bad", errors, fallback_ok ? "ok" : "bad",
+               basic_ok ? "ok" : "bad", leak_ok ? "ok" : "bad");
+        
+        if (!concurrent_ok || !fallback_ok || !basic_ok || !leak_ok) {
+            printf("❌ Concurrent map test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Concurrent map test passed\n\n");
+#else
+    printf("Skipped (threads not available)\n\n");
+#endif
+    
+    /* =========================================================================
+     * TEST 35: Snapshot Files
+     * =========================================================================
+     */
+    printf("TEST 35: Snapshot Files\n");
+    printf("-----------------------\n");
+    
+#ifndef NANODS_NO_SNAPSHOT
+    {
+        const char* vec_path = "nanods_test_vec.snap";
+        const char* map_path = "nanods_test_map.snap";
+        
+        /* Vector: save, view in place, load a copy */
+        NanoVector_double dv;
+        nv_init_double(&dv);
+        for (int i = 0; i < 1000; i++) nv_push_double(&dv, i * 0.5);
+        int vec_ok = nv_save_double(&dv, vec_path) == NANODS_OK;
+        NanoSnapshot vsnap;
+        vec_ok = vec_ok && nsnap_open(&vsnap, vec_path) == NANODS_OK;
+        const double* view = NULL;
+        size_t view_count = 0;
+        if (vec_ok) {
+            vec_ok = nv_view_double(&vsnap, &view, &view_count) == NANODS_OK &&
+                     view_count == 1000 && ((uintptr_t)view % 8) == 0 &&
+                     memcmp(view, dv.data, 1000 * sizeof(double)) == 0 &&
+                     nsnap_verify(&vsnap) == NANODS_OK;
+            const int* wrong_type;
+            vec_ok = vec_ok && nv_view_int(&vsnap, &wrong_type, NULL) == NANODS_ERR_FORMAT;
+            NanoMap not_map;
+            memset(&not_map, 0xA5, sizeof(not_map));
+            vec_ok = vec_ok && nm_load(&not_map, &vsnap) == NANODS_ERR_FORMAT &&
+                     not_map.buckets == NULL && nm_size(&not_map) == 0;
+            NanoVector_double copy;
+            vec_ok = vec_ok && nv_load_double(&copy, &vsnap) == NANODS_OK &&
+                     copy.size == 1000 && copy.data[999] == 499.5;
+            if (vec_ok) nv_free_double(&copy);
+            nsnap_close(&vsnap);
+        }
+        nv_free_double(&dv);
+        
+        /* Map with fixed-size values */
+        NanoMap src;
+        nm_init(&src);
+        static int values[5000];
+        char key[32];
+        for (int i = 0; i < 5000; i++) {
+            values[i] = i * 7;
+            snprintf(key, sizeof(key), "key_%d", i);
+            nm_set(&src, key, &values[i]);
+        }
+        nm_set(&src, "", &values[1]);
+        NanoSnapshot msnap;
+        int map_ok = nm_save(&src, map_path, sizeof(int)) == NANODS_OK &&
+                     nsnap_open(&msnap, map_path) == NANODS_OK;
+        if (map_ok) {
+            map_ok = nsnap_count(&msnap) == 5001 && nsnap_verify(&msnap) == NANODS_OK;
+            for (int i = 0; i < 5000 && map_ok; i++) {
+                snprintf(key, sizeof(key), "key_%d", i);
+                size_t len = 0;
+                const int* v = (const int*)nsnap_map_get(&msnap, key, &len);
+                map_ok = v && len == sizeof(int) && *v == i * 7;
+            }
+            map_ok = map_ok && nsnap_map_has(&msnap, "") &&
+                     !nsnap_map_has(&msnap, "key_5000") && !nsnap_map_has(&msnap, "key_");
+            
+            size_t cursor = 0, walked = 0;
+            const char* k;
+            while (nsnap_map_next(&msnap, &cursor, &k, NULL, NULL) == NANODS_OK) walked++;
+            map_ok = map_ok && walked == 5001;
+            
+            NanoMap loaded;
+            map_ok = map_ok && nm_load(&loaded, &msnap) == NANODS_OK;
+            if (map_ok) {
+                const int* v = (const int*)nm_get(&loaded, "key_4321");
+                map_ok = nm_size(&loaded) == 5001 && v && *v == 4321 * 7;
+                nm_free(&loaded);
+            }
+            
+            const double* not_vec;
+            map_ok = map_ok && nv_view_double(&msnap, &not_vec, NULL) == NANODS_ERR_FORMAT;
+            nsnap_close(&msnap);
+        }
+        nm_free(&src);
+        
+        /* Variable-length values through an encoder */
+        NanoMap names;
+        nm_init(&names);
+        nm_set(&names, "alice", (void*)"engineer");
+        nm_set(&names, "bob", (void*)"");
+        nm_set(&names, "carol", (void*)"a considerably longer title");
+        int ex_ok = nm_save_ex(&names, map_path, snap_encode_str, NULL) == NANODS_OK &&
+                    nsnap_open(&msnap, map_path) == NANODS_OK;
+        if (ex_ok) {
+            size_t len = 0;
+            const char* title = (const char*)nsnap_map_get(&msnap, "carol", &len);
+            ex_ok = title && len == strlen("a considerably longer title") + 1 &&
+                    strcmp(title, "a considerably longer title") == 0;
+            title = (const char*)nsnap_map_get(&msnap, "bob", &len);
+            ex_ok = ex_ok && title && len == 1 && title[0] == '\0';
+            
+            /* Keys that lost their NUL, gained one inside, or claim 4 GB are rejected */
+            uint64_t* kbuf = (uint64_t*)malloc(msnap.size);
+            for (int variant = 0; variant < 3 && ex_ok; variant++) {
+                memcpy(kbuf, msnap.base, msnap.size);
+                NanoSnapshot bad;
+                size_t cursor = 0;
+                const char* k = NULL;
+                ex_ok = nsnap_attach(&bad, kbuf, msnap.size) == NANODS_OK &&
+                        nsnap_map_next(&bad, &cursor, &k, NULL, NULL) == NANODS_OK;
+                if (!ex_ok) break;
+                char* kw = (char*)kbuf + (k - (const char*)bad.base);
+                size_t klen = strlen(kw);
+                if (variant == 0) {
+                    memset(kw + klen, 'x', ((klen + 8) & ~(size_t)7) - klen);   /* NUL and padding */
+                } else if (variant == 1) {
+                    kw[0] = '\0';
+                } else {
+                    uint32_t huge = UINT32_MAX;
+                    memcpy(kw - 8, &huge, 4);   /* key_len */
+                }
+                cursor = 0;
+                NanoMap bad_map;
+                ex_ok = nsnap_map_next(&bad, &cursor, &k, NULL, NULL) == NANODS_ERR_FORMAT &&
+                        nm_load(&bad_map, &bad) == NANODS_ERR_FORMAT &&
+                        bad_map.buckets == NULL && nm_size(&bad_map) == 0;
+            }
+            free(kbuf);
+            
+            /* A copy in memory: corruption fails verify, truncation fails attach */
+            uint64_t* buf = (uint64_t*)malloc(msnap.size);
+            memcpy(buf, msnap.base, msnap.size);
+            NanoSnapshot mem;
+            ex_ok = ex_ok && nsnap_attach(&mem, buf, msnap.size) == NANODS_OK &&
+                    nsnap_verify(&mem) == NANODS_OK;
+            ((uint8_t*)buf)[msnap.size - 3] ^= 0x40;
+            ex_ok = ex_ok && nsnap_verify(&mem) == NANODS_ERR_FORMAT;
+            ex_ok = ex_ok && nsnap_attach(&mem, buf, msnap.size - 8) == NANODS_ERR_FORMAT;
+            memcpy(buf, "NOTASNAP", 8);
+            ex_ok = ex_ok && nsnap_attach(&mem, buf, msnap.size) == NANODS_ERR_FORMAT;
+            free(buf);
+            nsnap_close(&msnap);
+        }
+        nm_free(&names);
+        
+        ex_ok = ex_ok && nsnap_open(&msnap, "nanods_missing.snap") == NANODS_ERR_IO;
+        remove(vec_path);
+        remove(map_path);
+        
+        printf("vector: %s, map: %s, encoded/corrupt: %s\n", vec_ok ? "ok" : "bad",
+               map_ok ? "ok" : "bad", ex_ok ? "ok" : "bad");
+        
+        if (!vec_ok || !map_ok || !ex_ok) {
+            printf("❌ Snapshot test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Snapshot test passed\n\n");
+#else
+    printf("Skipped (NANODS_NO_SNAPSHOT defined)\n\n");
+#endif
+    
+    /* =========================================================================
+     * TEST 36: Statistics (NANODS_STATS)
+     * =========================================================================
+     */
+    printf("TEST 36: Statistics (NANODS_STATS)\n");
+    printf("-------------------------------------------\n");
+#ifdef NANODS_STATS
+    {
+        nanods_stats_reset();
+        
+        /* Vector: capacity changes and the high-water mark */
+        IntVector svec;
+        nv_init_int(&svec);
+        for (int i = 0; i < 1000; i++) nv_push_int(&svec, i);
+        svec.size = 10;
+        const NanoStats* vs = NANODS_STATS_OF(&svec);
+        int vec_ok = vs->reallocs > 0 && vs->reallocs == vs->allocs && vs->bytes > 0 &&
+                      vs->peak_size == 1000;
+        nv_free_int(&svec);
+        
+        /* Map: every lookup lands in exactly one histogram bucket */
+        NanoMap smap;
+        nm_init(&smap);
+        char key[32];
+        static int sval = 7;
+        for (int i = 0; i < 2000; i++) {
+            snprintf(key, sizeof(key), "stat_%d", i);
+            nm_set(&smap, key, &sval);
+        }
+        for (int i = 0; i < 2000; i++) {
+            snprintf(key, sizeof(key), "stat_%d", i);
+            (void)nm_get(&smap, key);
+        }
+        (void)nm_get(&smap, "stat_missing");
+        const NanoStats* ms = NANODS_STATS_OF(&smap);
+        uint64_t hist_sum = 0;
+        for (int i = 0; i < NANODS_STATS_CHAIN_BUCKETS; i++) hist_sum += ms->chain_hist[i];
+        int map_ok = ms->lookups >= 4001 && hist_sum == ms->lookups &&
+                      ms->probes >= 2000 && ms->grows > 0 && ms->peak_size == 2000 &&
+                      ms->allocs > 0;
+        
+        uint64_t chains[NANODS_STATS_CHAIN_BUCKETS];
+        nm_chain_histogram(&smap, chains);
+        uint64_t chain_sum = 0;
+        for (int i = 0; i < NANODS_STATS_CHAIN_BUCKETS; i++) chain_sum += chains[i];
+        size_t unmigrated = smap.old_buckets ? smap.old_bucket_count - smap.rehash_idx : 0;
+        map_ok = map_ok && chain_sum == smap.bucket_count + unmigrated;
+        nanods_stats_dump(stdout, "  map", ms);
+        nm_free(&smap);
+        
+        /* Ring: refused elements on both ends */
+        NanoRing_int_64 sring;
+        nr_init_int_64(&sring);
+        int burst[80] = {0};
+        size_t written = nr_write_n_int_64(&sring, burst, 80);
+        size_t drained = nr_read_n_int_64(&sring, burst, 80);
+        (void)nr_read_n_int_64(&sring, burst, 1);
+        const NanoStats* rs = NANODS_STATS_OF(&sring);
+        int ring_ok = rs->rejected_full == 80 - written && rs->rejected_empty == 1 &&
+                       rs->peak_size == written && drained == written;
+        
+        /* Global totals saw all of the above, including every free */
+        NanoStats global;
+        nanods_stats_global(&global);
+        int global_ok = global.allocs >= vs->allocs + ms->allocs && global.frees > 0 &&
+                         global.lookups >= ms->lookups && global.probes >= ms->probes &&
+                         global.grows >= ms->grows && global.rejected_full >= rs->rejected_full &&
+                         global.rejected_empty >= 1;
+        nanods_stats_dump(stdout, "  global", &global);
+        nanods_stats_reset();
+        nanods_stats_global(&global);
+        global_ok = global_ok && global.allocs == 0 && global.lookups == 0 &&
+                    global.rejected_full == 0;
+        
+        printf("vector: %s, map: %s, ring: %s, global: %s\n", vec_ok ? "ok" : "bad",
+               map_ok ? "ok" : "bad", ring_ok ? "ok" : "bad", global_ok ? "ok" : "bad");
+        
+        if (!vec_ok || !map_ok || !ring_ok || !global_ok) {
+            printf("❌ Statistics test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Statistics test passed\n\n");
+#else
+    printf("Skipped (NANODS_STATS not defined)\n\n");
+#endif
+    
+    /* =========================================================================
+     * TEST 37: Priority Queues (NanoHeap)
+     * =========================================================================
+     */
+    printf("TEST 37: Priority Queues (NanoHeap)\n");
+    printf("-------------------------------------------\n");
+    {
+        /* Pops come out in sorted order, same as qsort of the input */
+        enum { HEAP_N = 2000 };
+        int* ref = (int*)malloc(HEAP_N * sizeof(int));
+        IntHeap heap;
+        nh_init_int(&heap);
+        uint32_t x = 12345;
+        for (int i = 0; i < HEAP_N; i++) {
+            x = x * 1103515245u + 12345u;
+            ref[i] = (int)(x >> 8) % 500 - 250;
+            nh_push_int(&heap, ref[i]);
+        }
+        qsort(ref, HEAP_N, sizeof(int), compare_int);
+        int heap_ok = nh_is_heap_int(&heap) && nh_size_int(&heap) == HEAP_N;
+        int top;
+        heap_ok = heap_ok && nh_peek_int(&heap, &top) == NANODS_OK && top == ref[0];
+        for (int i = 0; i < HEAP_N && heap_ok; i++) {
+            heap_ok = nh_pop_int(&heap, &top) == NANODS_OK && top == ref[i];
+        }
+        heap_ok = heap_ok && nh_empty_int(&heap);
+        
+        /* Heapify in place, then replace_top keeps the order */
+        IntVector raw;
+        nv_init_int(&raw);
+        for (int i = HEAP_N - 1; i >= 0; i--) nv_push_int(&raw, ref[i]);
+        nh_heapify_int(&raw);
+        heap_ok = heap_ok && nh_is_heap_int(&raw);
+        heap_ok = heap_ok && nh_replace_top_int(&raw, 1000, &top) == NANODS_OK && top == ref[0] &&
+                  nh_is_heap_int(&raw) && raw.size == HEAP_N;
+        heap_ok = heap_ok && nh_peek_int(&raw, &top) == NANODS_OK && top == ref[1];
+        nh_free_int(&raw);
+        nh_free_int(&heap);
+        
+        /* Custom order over a struct: max-heap by x */
+        NanoHeap_by_x_desc_Point points;
+        nh_init_by_x_desc_Point(&points);
+        for (int i = 0; i < 50; i++) {
+            nh_push_by_x_desc_Point(&points, (Point){ (i * 37) % 50, i });
+        }
+        Point best;
+        heap_ok = heap_ok && nh_pop_by_x_desc_Point(&points, &best) == NANODS_OK &&
+                  best.x == 49 && nh_is_heap_by_x_desc_Point(&points);
+        nh_free_by_x_desc_Point(&points);
+        
+        /* Indexed heap against a brute-force key table */
+        enum { IDS = 300 };
+        int keys[IDS];
+        int present[IDS] = {0};
+        IntIndexedHeap iheap;
+        nih_init_int(&iheap);
+        int idx_ok = 1;
+        for (int step = 0; step < 20000 && idx_ok; step++) {
+            x = x * 1103515245u + 12345u;
+            size_t id = (x >> 8) % IDS;
+            int key = (int)((x >> 4) % 10000);
+            switch ((x >> 24) % 4) {
+                case 0:   /* Insert or reschedule */
+                    idx_ok = nih_push_int(&iheap, id, key) == NANODS_OK;
+                    keys[id] = key;
+                    present[id] = 1;
+                    break;
+                case 1:   /* Decrease only when earlier */
+                    if (!present[id]) {
+                        idx_ok = nih_decrease_key_int(&iheap, id, key) == NANODS_ERR_NOTFOUND;
+                        break;
+                    }
+                    idx_ok = nih_decrease_key_int(&iheap, id, key) == NANODS_OK;
+                    if (key < keys[id]) keys[id] = key;
+                    break;
+                case 2:
+                    idx_ok = nih_remove_int(&iheap, id) ==
+                             (present[id] ? NANODS_OK : NANODS_ERR_NOTFOUND);
+                    present[id] = 0;
+                    break;
+                default: {
+                    int min_key = 10000;   /* Above every key */
+                    for (int i = 0; i < IDS; i++) {
+                        if (present[i] && keys[i] < min_key) min_key = keys[i];
+                    }
+                    size_t got_id;
+                    int got_key;
+                    if (min_key == 10000) {
+                        idx_ok = nih_empty_int(&iheap);
+                        break;
+                    }
+                    idx_ok = nih_pop_int(&iheap, &got_id, &got_key) == NANODS_OK &&
+                             got_key == min_key && present[got_id] && keys[got_id] == min_key;
+                    present[got_id] = 0;
+                    break;
+                }
+            }
+            int k;
+            idx_ok = idx_ok && nih_contains_int(&iheap, id) == present[id] &&
+                     (!present[id] || (nih_key_int(&iheap, id, &k) == NANODS_OK && k == keys[id]));
+        }
+        size_t live = 0;
+        for (int i = 0; i < IDS; i++) live += (size_t)present[i];
+        idx_ok = idx_ok && nih_size_int(&iheap) == live;
+        nih_clear_int(&iheap);
+        idx_ok = idx_ok && nih_empty_int(&iheap) && !nih_contains_int(&iheap, 0) &&
+                 nih_push_int(&iheap, 7, 3) == NANODS_OK && nih_size_int(&iheap) == 1;
+        nih_free_int(&iheap);
+        
+        /* Dijkstra on a 20x20 grid with unit weights: distance is Manhattan */
+        enum { GRID = 20 };
+        DoubleIndexedHeap pq;
+        nih_init_double(&pq);
+        double dist[GRID * GRID];
+        for (int i = 0; i < GRID * GRID; i++) dist[i] = 1e300;
+        dist[0] = 0.0;
+        nih_push_double(&pq, 0, 0.0);
+        size_t u;
+        double du;
+        while (!nih_empty_double(&pq)) {
+            nih_pop_double(&pq, &u, &du);
+            int ux = (int)u % GRID, uy = (int)u / GRID;
+            const int dx[4] = { 1, -1, 0, 0 }, dy[4] = { 0, 0, 1, -1 };
+            for (int d = 0; d < 4; d++) {
+                int vx = ux + dx[d], vy = uy + dy[d];
+                if (vx < 0 || vy < 0 || vx >= GRID || vy >= GRID) continue;
+                size_t v = (size_t)(vy * GRID + vx);
+                if (du + 1.0 < dist[v]) {
+                    dist[v] = du + 1.0;
+                    nih_push_double(&pq, v, dist[v]);
+                }
+            }
+        }
+        int dijkstra_ok = 1;
+        for (int i = 0; i < GRID * GRID; i++) {
+            dijkstra_ok = dijkstra_ok && dist[i] == (double)(i % GRID + i / GRID);
+        }
+        nih_free_double(&pq);
+        free(ref);
+        
+        printf("heap: %s, indexed: %s, dijkstra: %s\n", heap_ok ? "ok" : "bad",
+               idx_ok ? "ok" : "bad", dijkstra_ok ? "ok" : "bad");
+        
+        if (!heap_ok || !idx_ok || !dijkstra_ok) {
+            printf("❌ Priority queue test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Priority queue test passed\n\n");
+    
+    /* =========================================================================
+     * TEST 38: Pre-hashed Keys and String Pool
+     * =========================================================================
+     */
+    printf("TEST 38: Pre-hashed Keys and String Pool\n");
+    printf("-------------------------------------------\n");
+    {
+        /* Keys hashed up front stay valid while the map grows and rehashes */
+        enum { HKEYS = 3000 };
+        static char hkey_buf[HKEYS][16];
+        static int hvals[HKEYS];
+        NanoMapKey* hkeys = (NanoMapKey*)malloc(HKEYS * sizeof(NanoMapKey));
+        NanoMap hmap;
+        nm_init(&hmap);
+        for (int i = 0; i < HKEYS; i++) {
+            snprintf(hkey_buf[i], sizeof(hkey_buf[i]), "hk_%d", i);
+            hkeys[i] = nm_key(&hmap, hkey_buf[i]);
+        }
+        int h_ok = 1;
+        for (int i = 0; i < HKEYS; i++) {
+            hvals[i] = i;
+            h_ok = h_ok && nm_set_h(&hmap, hkeys[i], &hvals[i]) == NANODS_OK;
+        }
+        for (int i = 0; i < HKEYS && h_ok; i++) {
+            h_ok = nm_get_h(&hmap, hkeys[i]) == &hvals[i] && nm_get(&hmap, hkey_buf[i]) == &hvals[i];
+        }
+        h_ok = h_ok && nm_size(&hmap) == HKEYS && nm_remove_h(&hmap, hkeys[7]) == NANODS_OK &&
+               !nm_has(&hmap, "hk_7") && !nm_has_h(&hmap, hkeys[7]) &&
+               nm_remove_h(&hmap, hkeys[7]) == NANODS_ERR_NOTFOUND;
+        
+        /* nm_lookup tells a stored NULL from a missing key */
+        void* found = &hvals[0];
+        h_ok = h_ok && nm_set(&hmap, "null_value", NULL) == NANODS_OK &&
+               nm_lookup(&hmap, "null_value", &found) == 1 && found == NULL &&
+               nm_lookup(&hmap, "absent", &found) == 0 && nm_lookup_h(&hmap, hkeys[8], NULL) == 1;
+        
+        /* Hashes carry over between maps that hash alike */
+        NanoMap other;
+        nm_init(&other);
+        h_ok = h_ok && nm_same_hashing(&hmap, &other) &&
+               nm_set_h(&other, hkeys[1], &hvals[1]) == NANODS_OK &&
+               nm_get(&other, "hk_1") == &hvals[1];
+        nm_set_hash_kind(&other, NANODS_HASH_SIPHASH13);
+        h_ok = h_ok && !nm_same_hashing(&hmap, &other) && nm_get(&other, "hk_1") == &hvals[1];
+        nm_free(&other);
+        nm_free(&hmap);
+        
+        /* Get-or-insert: word counts with one hash per word */
+        const char* words[] = { "a", "b", "a", "c", "a", "b" };
+        NanoMap counts;
+        nm_init(&counts);
+        int fresh = 0;
+        for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+            int inserted;
+            void** slot = nm_upsert(&counts, words[i], &inserted);
+            if (!slot) {
+                h_ok = 0;
+                break;
+            }
+            fresh += inserted;
+            *slot = (void*)((uintptr_t)*slot + 1);
+        }
+        h_ok = h_ok && fresh == 3 && nm_size(&counts) == 3 &&
+               (uintptr_t)nm_get(&counts, "a") == 3 && (uintptr_t)nm_get(&counts, "b") == 2 &&
+               (uintptr_t)nm_get(&counts, "c") == 1;
+        void** again = nm_upsert_h(&counts, nm_key(&counts, "a"), &fresh);
+        h_ok = h_ok && again && fresh == 0 && (uintptr_t)*again == 3;
+        nm_free(&counts);
+        
+        /* String pool: stable ids and pointers, keys usable in other maps */
+        NanoStrPool pool;
+        nsp_init(&pool);
+        NanoStrId first, dup, id;
+        int pool_ok = nsp_intern(&pool, "content-type", &first) == NANODS_OK && first == 0;
+        const char* first_str = nsp_str(&pool, first);
+        for (int i = 0; i < HKEYS && pool_ok; i++) {
+            pool_ok = nsp_intern(&pool, hkey_buf[i], &id) == NANODS_OK && id == (NanoStrId)i + 1;
+        }
+        pool_ok = pool_ok && nsp_intern(&pool, "content-type", &dup) == NANODS_OK && dup == first &&
+                  nsp_size(&pool) == HKEYS + 1 && nsp_str(&pool, first) == first_str &&
+                  strcmp(first_str, "content-type") == 0 && nsp_len(&pool, first) == 12 &&
+                  nsp_find(&pool, "hk_42") == 43 && nsp_find(&pool, "nope") == NANODS_STR_ID_NONE &&
+                  nsp_size(&pool) == HKEYS + 1 && nsp_str(&pool, HKEYS + 1) == NULL &&
+                  nsp_key(&pool, HKEYS + 1).str == NULL;
+        NanoMap headers;
+        nm_init(&headers);
+        static int json = 1;
+        nm_set(&headers, "content-type", &json);
+        pool_ok = pool_ok && nm_same_hashing(&pool.index, &headers) &&
+                  nm_get_h(&headers, nsp_key(&pool, first)) == &json &&
+                  nm_get_h(&headers, nsp_key(&pool, 5)) == NULL;
+        nm_free(&headers);
+        nsp_free(&pool);
+        free(hkeys);
+        
+        printf("pre-hashed: %s, string pool: %s\n", h_ok ? "ok" : "bad", pool_ok ? "ok" : "bad");
+        
+        if (!h_ok || !pool_ok) {
+            printf("❌ Pre-hashed key test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Pre-hashed key test passed\n\n");
+    
+    /*
+     * =========================================================================
+     * TEST 39: Batched Lookups
+     * =========================================================================
+     */
+    printf("TEST 39: Batched Lookups\n");
+    printf("-------------------------------------------\n");
+    {
+        enum { BKEYS = 2000, BQUERIES = 1237 };
+        static char bkey_buf[BKEYS * 2][16];
+        static int bvals[BKEYS];
+        const char** bqueries = (const char**)malloc(BQUERIES * sizeof(char*));
+        NanoMapKey* bhashed = (NanoMapKey*)malloc(BQUERIES * sizeof(NanoMapKey));
+        void** bout = (void**)malloc(BQUERIES * sizeof(void*));
+        uint8_t* bfound = (uint8_t*)malloc(BQUERIES);
+        NanoMap bmap;
+        nm_init(&bmap);
+        for (int i = 0; i < BKEYS * 2; i++) {
+            snprintf(bkey_buf[i], sizeof(bkey_buf[i]), "bk_%d", i);
+        }
+        int b_ok = 1;
+        
+        /* Empty map: nothing found and every output cleared */
+        bqueries[0] = bkey_buf[0];
+        bout[0] = bkey_buf[0];
+        bfound[0] = 1;
+        b_ok = nm_get_batch(&bmap, bqueries, 1, bout) == 0 && bout[0] == NULL &&
+               nm_has_batch(&bmap, bqueries, 1, bfound) == 0 && bfound[0] == 0;
+        
+        /* Stop inserting mid-rehash so batches also walk the old buckets */
+        int inserted = 0;
+        while (inserted < BKEYS && (inserted < BKEYS / 2 || !bmap.old_buckets)) {
+            bvals[inserted] = inserted;
+            b_ok = b_ok && nm_set(&bmap, bkey_buf[inserted], &bvals[inserted]) == NANODS_OK;
+            inserted++;
+        }
+        b_ok = b_ok && bmap.old_buckets != NULL;
+        
+        /* Mixed hits, misses and a NULL key; count is not a multiple of the batch size */
+        size_t expect = 0;
+        for (int i = 0; i < BQUERIES; i++) {
+            int k = (i * 7919) % (BKEYS * 2);
+            bqueries[i] = (i == 100) ? NULL : bkey_buf[k];
+            if (bqueries[i] && k < inserted) expect++;
+        }
+        b_ok = b_ok && nm_get_batch(&bmap, bqueries, BQUERIES, bout) == expect &&
+               nm_has_batch(&bmap, bqueries, BQUERIES, bfound) == expect &&
+               nm_has_batch(&bmap, bqueries, BQUERIES, NULL) == expect;
+        for (int i = 0; i < BQUERIES && b_ok; i++) {
+            void* single = bqueries[i] ? nm_get(&bmap, bqueries[i]) : NULL;
+            b_ok = bout[i] == single && bfound[i] == (single != NULL);
+        }
+        
+        /* Pre-hashed variants; skip the NULL key */
+        for (int i = 0; i < BQUERIES; i++) {
+            bhashed[i] = nm_key(&bmap, bqueries[i] ? bqueries[i] : "bk_0");
+        }
+        size_t expect_h = expect + 1;    /* "bk_0" stands in for the NULL key */
+        b_ok = b_ok && nm_get_batch_h(&bmap, bhashed, BQUERIES, bout) == expect_h &&
+               nm_has_batch_h(&bmap, bhashed, BQUERIES, bfound) == expect_h;
+        for (int i = 0; i < BQUERIES && b_ok; i++) {
+            void* single = nm_get_h(&bmap, bhashed[i]);
+            b_ok = bout[i] == single && bfound[i] == (single != NULL);
+        }
+        b_ok = b_ok && nm_get_batch(&bmap, bqueries, 0, bout) == 0 &&
+               nm_has_batch_h(&bmap, bhashed, 0, bfound) == 0;
+        
+        nm_free(&bmap);
+        free(bfound);
+        free(bout);
+        free(bhashed);
+        free(bqueries);
+        printf("Batched: %d keys in map, %zu of %d queries hit\n", inserted, expect, BQUERIES);
+        if (!b_ok) {
+            printf("❌ Batched lookups disagree with nm_get\n");
+            return 1;
+        }
+    }
+    printf("✅ Batched lookup test passed\n\n");
+    
+    /*
+     * =========================================================================
+     * TEST 40: Bloom Filters (NanoBloom, nm_enable_filter)
+     * =========================================================================
+     */
+    printf("TEST 40: Bloom Filters (NanoBloom, nm_enable_filter)\n");
+    printf("-------------------------------------------\n");
+    {
+        enum { FKEYS = 10000 };
+        static char fkey_buf[FKEYS * 2][16];
+        for (int i = 0; i < FKEYS * 2; i++) {
+            snprintf(fkey_buf[i], sizeof(fkey_buf[i]), "fk_%d", i);
+        }
+        
+        /* Standalone: no false negatives, ~1% false positives at capacity */
+        NanoBloom seen;
+        int bloom_ok = nbf_init(&seen, FKEYS) == NANODS_OK;
+        int fresh = 0;
+        for (int i = 0; i < FKEYS && bloom_ok; i++) {
+            fresh += nbf_add(&seen, fkey_buf[i], strlen(fkey_buf[i]));
+        }
+        int dup = nbf_add(&seen, fkey_buf[0], strlen(fkey_buf[0]));
+        int fp = 0;
+        for (int i = 0; i < FKEYS && bloom_ok; i++) {
+            bloom_ok = nbf_test(&seen, fkey_buf[i], strlen(fkey_buf[i]));
+            fp += nbf_test(&seen, fkey_buf[FKEYS + i], strlen(fkey_buf[FKEYS + i]));
+        }
+        bloom_ok = bloom_ok && dup == 0 && fresh > FKEYS * 97 / 100 && fp < FKEYS * 3 / 100;
+        
+        /* Any 64-bit hash; union of two filters; a second view of the same memory */
+        NanoBloom odds;
+        bloom_ok = bloom_ok && nbf_init(&odds, FKEYS) == NANODS_OK;
+        for (uint64_t i = 1; i < 2000 && bloom_ok; i += 2) nbf_add_hash(&odds, i);
+        NanoBloom view;
+        bloom_ok = bloom_ok && nbf_merge(&seen, &odds) == NANODS_OK &&
+                   nbf_attach(&view, seen.blocks, nbf_bytes(&seen), seen.seed) == NANODS_OK &&
+                   nbf_test_hash(&view, 1999) && nbf_test(&view, "fk_42", 5) &&
+                   nbf_attach(&view, (char*)seen.blocks + 4, 32, seen.seed) == NANODS_ERR_BOUNDS;
+        NanoBloom small;
+        bloom_ok = bloom_ok && nbf_init(&small, 10) == NANODS_OK &&
+                   nbf_merge(&seen, &small) == NANODS_ERR_BOUNDS;
+        nbf_clear(&small);
+        bloom_ok = bloom_ok && !nbf_test_hash(&small, 7);
+        nbf_free(&small);
+        nbf_free(&odds);
+        nbf_free(&seen);
+        
+        /* Map filter: enabled mid-rehash, kept in sync through growth and removals */
+        static int fvals[FKEYS];
+        NanoMap fmap;
+        nm_init(&fmap);
+        int map_ok = 1;
+        int n = 0;
+        while (n < 1000 || !fmap.old_buckets) {
+            fvals[n] = n;
+            map_ok = map_ok && nm_set(&fmap, fkey_buf[n], &fvals[n]) == NANODS_OK;
+            n++;
+        }
+        map_ok = map_ok && nm_enable_filter(&fmap, 0) == NANODS_OK && nm_has_filter(&fmap);
+        for (; n < FKEYS; n++) {
+            fvals[n] = n;
+            map_ok = map_ok && nm_set(&fmap, fkey_buf[n], &fvals[n]) == NANODS_OK;
+        }
+        for (int i = 0; i < FKEYS; i += 3) {
+            map_ok = map_ok && nm_remove(&fmap, fkey_buf[i]) == NANODS_OK;
+        }
+        map_ok = map_ok && nm_remove(&fmap, fkey_buf[0]) == NANODS_ERR_NOTFOUND &&
+                 nm_remove(&fmap, fkey_buf[FKEYS]) == NANODS_ERR_NOTFOUND;
+        for (int i = 0; i < FKEYS * 2 && map_ok; i++) {
+            void* expect = (i < FKEYS && i % 3 != 0) ? &fvals[i] : NULL;
+            map_ok = nm_get(&fmap, fkey_buf[i]) == expect;
+        }
+        
+        /* Batched lookups take the filter path too */
+        const char* fq[64];
+        void* fout[64];
+        size_t fexpect = 0;
+        for (int i = 0; i < 64; i++) {
+            fq[i] = fkey_buf[i * 311 % (FKEYS * 2)];
+            fexpect += (i * 311 % (FKEYS * 2)) < FKEYS && (i * 311 % (FKEYS * 2)) % 3 != 0;
+        }
+        map_ok = map_ok && nm_get_batch(&fmap, fq, 64, fout) == fexpect;
+        for (int i = 0; i < 64 && map_ok; i++) map_ok = fout[i] == nm_get(&fmap, fq[i]);
+        
+        /* Rehashing under another hash rebuilds the filter */
+        map_ok = map_ok && nm_set_hash_kind(&fmap, NANODS_HASH_WYHASH) == NANODS_OK &&
+                 nm_has_filter(&fmap) && nm_get(&fmap, fkey_buf[1]) == &fvals[1] &&
+                 nm_get(&fmap, fkey_buf[FKEYS - 2]) == &fvals[FKEYS - 2];
+        nm_clear(&fmap);
+        map_ok = map_ok && !nm_has(&fmap, fkey_buf[1]) &&
+                 nm_set(&fmap, fkey_buf[1], &fvals[1]) == NANODS_OK && nm_has(&fmap, fkey_buf[1]);
+        nm_disable_filter(&fmap);
+        map_ok = map_ok && !nm_has_filter(&fmap) && nm_get(&fmap, fkey_buf[1]) == &fvals[1];
+        nm_free(&fmap);
+
+        /* Churn at a steady size: the filter is rebuilt by same-size rehashes */
+        nm_init(&fmap);
+        map_ok = map_ok && nm_enable_filter(&fmap, 0) == NANODS_OK;
+        for (int i = 0; i < 1000; i++) {
+            map_ok = map_ok && nm_set(&fmap, fkey_buf[i], &fvals[i]) == NANODS_OK;
+        }
+        size_t fbuckets = fmap.bucket_count;
+        for (int i = 1000; i < FKEYS * 2 && map_ok; i++) {
+            map_ok = nm_remove(&fmap, fkey_buf[i - 1000]) == NANODS_OK &&
+                     nm_set(&fmap, fkey_buf[i], &fvals[i % FKEYS]) == NANODS_OK &&
+                     fmap.filter_keys <= fmap.filter_capacity + fbuckets / NANODS_MAP_REHASH_STEP + 1 &&
+                     nm_get(&fmap, fkey_buf[i - 500]) == &fvals[(i - 500) % FKEYS];
+        }
+        map_ok = map_ok && fmap.bucket_count == fbuckets && fmap.filter_capacity <= fbuckets &&
+                 !nm_has(&fmap, fkey_buf[0]);
+        nm_free(&fmap);
+        
+        printf("bloom: %s (%d false positives in %d), map filter: %s\n",
+               bloom_ok ? "ok" : "bad", fp, FKEYS, map_ok ? "ok" : "bad");
+        if (!bloom_ok || !map_ok) {
+            printf("❌ Bloom filter test failed\n");
+            return 1;
+        }
+    }
+    printf("✅ Bloom filter test passed\n\n");
+    
     /* =========================================================================
      * FINAL REPORT
      * =========================================================================